@@ -10,6 +10,10 @@ See the Mulan PSL v2 for more details. */
 
 #include "analyze.h"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
 /**
  * @description: 分析器，进行语义分析和查询重写，需要检查不符合语义规定的部分
  * @param {shared_ptr<ast::TreeNode>} parse parser生成的结果集
@@ -45,15 +49,29 @@ std::shared_ptr<Query> Analyze::do_analyze(std::shared_ptr<ast::TreeNode> parse)
             }
         }
         //处理where条件
-        get_clause(x->conds, query->conds);
-        check_clause(query->tables, query->conds);
+        get_clause(x->conds, query->conds, query->always_false);
+        check_clause(query->tables, query->conds, query->always_false);
     } else if (auto x = std::dynamic_pointer_cast<ast::UpdateStmt>(parse)) {
-        /** TODO: */
-
+        // 处理set子句，常量转换为列的类型
+        TabMeta &tab = sm_manager_->db_.get_table(x->tab_name);
+        for (auto &sv_set_clause : x->set_clauses) {
+            SetClause set_clause = {.lhs = {.tab_name = x->tab_name, .col_name = sv_set_clause->col_name},
+                                    .rhs = convert_sv_value(sv_set_clause->val)};
+            auto col = tab.get_col(sv_set_clause->col_name);
+            if (col->type == TYPE_FLOAT && set_clause.rhs.type == TYPE_INT) {
+                set_clause.rhs.set_float(static_cast<float>(set_clause.rhs.int_val));
+            } else if (col->type != set_clause.rhs.type) {
+                throw IncompatibleTypeError(coltype2str(col->type), coltype2str(set_clause.rhs.type));
+            }
+            query->set_clauses.push_back(set_clause);
+        }
+        //处理where条件
+        get_clause(x->conds, query->conds, query->always_false);
+        check_clause({x->tab_name}, query->conds, query->always_false);
     } else if (auto x = std::dynamic_pointer_cast<ast::DeleteStmt>(parse)) {
         //处理where条件
-        get_clause(x->conds, query->conds);
-        check_clause({x->tab_name}, query->conds);        
+        get_clause(x->conds, query->conds, query->always_false);
+        check_clause({x->tab_name}, query->conds, query->always_false);
     } else if (auto x = std::dynamic_pointer_cast<ast::InsertStmt>(parse)) {
         // 处理insert 的values值
         for (auto &sv_val : x->vals) {
@@ -98,16 +116,82 @@ void Analyze::get_all_cols(const std::vector<std::string> &tab_names, std::vecto
     }
 }
 
-void Analyze::get_clause(const std::vector<std::shared_ptr<ast::BinaryExpr>> &sv_conds, std::vector<Condition> &conds) {
+/**
+ * @description: 比较两个同类型的常量，返回值同memcmp
+ */
+static int compare_value(const Value &a, const Value &b) {
+    switch (a.type) {
+        case TYPE_INT:
+            return (a.int_val < b.int_val) ? -1 : ((a.int_val > b.int_val) ? 1 : 0);
+        case TYPE_FLOAT:
+            return (a.float_val < b.float_val) ? -1 : ((a.float_val > b.float_val) ? 1 : 0);
+        case TYPE_STRING:
+            return a.str_val.compare(b.str_val);
+        default:
+            throw InternalError("Unexpected value type");
+    }
+}
+
+static bool eval_comp(int cmp, CompOp op) {
+    switch (op) {
+        case OP_EQ: return cmp == 0;
+        case OP_NE: return cmp != 0;
+        case OP_LT: return cmp < 0;
+        case OP_GT: return cmp > 0;
+        case OP_LE: return cmp <= 0;
+        case OP_GE: return cmp >= 0;
+        default:
+            throw InternalError("Unexpected op type");
+    }
+}
+
+// 交换比较运算两侧的操作数后对应的运算符，例如 3 < a 等价于 a > 3
+static CompOp swap_comp_op(CompOp op) {
+    static const CompOp swap_op[] = {OP_EQ, OP_NE, OP_GT, OP_LT, OP_GE, OP_LE};
+    return swap_op[op];
+}
+
+/**
+ * @description: 把where子句转换为Condition：常量在左侧的条件交换为列在左侧，两侧都是常量的条件直接求值
+ * @param {vector<shared_ptr<ast::BinaryExpr>>} &sv_conds parser生成的条件
+ * @param {vector<Condition>} &conds 输出的条件
+ * @param {bool} &always_false 存在恒为假的常量条件时置为true
+ */
+void Analyze::get_clause(const std::vector<std::shared_ptr<ast::BinaryExpr>> &sv_conds, std::vector<Condition> &conds,
+                         bool &always_false) {
     conds.clear();
     for (auto &expr : sv_conds) {
         Condition cond;
-        cond.lhs_col = {.tab_name = expr->lhs->tab_name, .col_name = expr->lhs->col_name};
         cond.op = convert_sv_comp_op(expr->op);
-        if (auto rhs_val = std::dynamic_pointer_cast<ast::Value>(expr->rhs)) {
+        auto lhs = expr->lhs;
+        auto rhs = expr->rhs;
+        if (std::dynamic_pointer_cast<ast::Col>(lhs) == nullptr) {
+            if (std::dynamic_pointer_cast<ast::Col>(rhs) == nullptr) {
+                // 常量比较常量，折叠为true/false
+                Value lhs_val = convert_sv_value(std::dynamic_pointer_cast<ast::Value>(lhs));
+                Value rhs_val = convert_sv_value(std::dynamic_pointer_cast<ast::Value>(rhs));
+                if (lhs_val.type == TYPE_INT && rhs_val.type == TYPE_FLOAT) {
+                    lhs_val.set_float(lhs_val.int_val);
+                } else if (lhs_val.type == TYPE_FLOAT && rhs_val.type == TYPE_INT) {
+                    rhs_val.set_float(rhs_val.int_val);
+                } else if (lhs_val.type != rhs_val.type) {
+                    throw IncompatibleTypeError(coltype2str(lhs_val.type), coltype2str(rhs_val.type));
+                }
+                if (!eval_comp(compare_value(lhs_val, rhs_val), cond.op)) {
+                    always_false = true;
+                }
+                continue;
+            }
+            // const op col 规范化为 col op' const
+            std::swap(lhs, rhs);
+            cond.op = swap_comp_op(cond.op);
+        }
+        auto lhs_col = std::dynamic_pointer_cast<ast::Col>(lhs);
+        cond.lhs_col = {.tab_name = lhs_col->tab_name, .col_name = lhs_col->col_name};
+        if (auto rhs_val = std::dynamic_pointer_cast<ast::Value>(rhs)) {
             cond.is_rhs_val = true;
             cond.rhs_val = convert_sv_value(rhs_val);
-        } else if (auto rhs_col = std::dynamic_pointer_cast<ast::Col>(expr->rhs)) {
+        } else if (auto rhs_col = std::dynamic_pointer_cast<ast::Col>(rhs)) {
             cond.is_rhs_val = false;
             cond.rhs_col = {.tab_name = rhs_col->tab_name, .col_name = rhs_col->col_name};
         }
@@ -115,12 +199,21 @@ void Analyze::get_clause(const std::vector<std::shared_ptr<ast::BinaryExpr>> &sv
     }
 }
 
-void Analyze::check_clause(const std::vector<std::string> &tab_names, std::vector<Condition> &conds) {
+/**
+ * @description: 检查条件中的列并把常量转换为列的类型，之后对条件做化简，并初始化常量的raw数据，
+ *              执行器只需要按列类型直接比较，不需要再逐行检查类型
+ * @param {vector<string>} &tab_names 条件涉及的表
+ * @param {vector<Condition>} &conds 条件，化简后原地修改
+ * @param {bool} &always_false 条件恒为假时置为true，此时conds被清空
+ */
+void Analyze::check_clause(const std::vector<std::string> &tab_names, std::vector<Condition> &conds,
+                           bool &always_false) {
     // auto all_cols = get_all_cols(tab_names);
     std::vector<ColMeta> all_cols;
     get_all_cols(tab_names, all_cols);
-    // Get raw values in where clause
-    for (auto &cond : conds) {
+    auto it = conds.begin();
+    while (it != conds.end()) {
+        auto &cond = *it;
         // Infer table name from column name
         cond.lhs_col = check_column(all_cols, cond.lhs_col);
         if (!cond.is_rhs_val) {
@@ -129,21 +222,246 @@ void Analyze::check_clause(const std::vector<std::string> &tab_names, std::vecto
         TabMeta &lhs_tab = sm_manager_->db_.get_table(cond.lhs_col.tab_name);
         auto lhs_col = lhs_tab.get_col(cond.lhs_col.col_name);
         ColType lhs_type = lhs_col->type;
-        ColType rhs_type;
         if (cond.is_rhs_val) {
-            cond.rhs_val.init_raw(lhs_col->len);
-            rhs_type = cond.rhs_val.type;
+            CondFoldResult res = coerce_cond(cond, lhs_type);
+            if (res != COND_KEEP) {
+                always_false |= (res == COND_FALSE);
+                it = conds.erase(it);
+                continue;
+            }
         } else {
             TabMeta &rhs_tab = sm_manager_->db_.get_table(cond.rhs_col.tab_name);
             auto rhs_col = rhs_tab.get_col(cond.rhs_col.col_name);
-            rhs_type = rhs_col->type;
+            if (lhs_type != rhs_col->type) {
+                throw IncompatibleTypeError(coltype2str(lhs_type), coltype2str(rhs_col->type));
+            }
         }
-        if (lhs_type != rhs_type) {
-            throw IncompatibleTypeError(coltype2str(lhs_type), coltype2str(rhs_type));
+        it++;
+    }
+
+    normalize_clause(conds, always_false);
+    if (always_false) {
+        conds.clear();
+        return;
+    }
+    // Get raw values in where clause
+    for (auto &cond : conds) {
+        if (cond.is_rhs_val) {
+            auto lhs_col = sm_manager_->db_.get_table(cond.lhs_col.tab_name).get_col(cond.lhs_col.col_name);
+            cond.rhs_val.init_raw(lhs_col->len);
         }
     }
 }
 
+/**
+ * @description: 把条件右侧的常量转换为左侧列的类型。int列和非整数的float常量比较时，
+ *              改写为等价的整数比较，例如 a > 3.5 改写为 a >= 4，a = 3.5 恒为假
+ * @return {CondFoldResult} 转换后条件是否仍需保留
+ */
+CondFoldResult Analyze::coerce_cond(Condition &cond, ColType lhs_type) {
+    Value &val = cond.rhs_val;
+    if (lhs_type == val.type) {
+        return COND_KEEP;
+    }
+    if (lhs_type == TYPE_FLOAT && val.type == TYPE_INT) {
+        val.set_float(static_cast<float>(val.int_val));
+        return COND_KEEP;
+    }
+    if (lhs_type != TYPE_INT || val.type != TYPE_FLOAT) {
+        throw IncompatibleTypeError(coltype2str(lhs_type), coltype2str(val.type));
+    }
+    double f = val.float_val;
+    double lo = std::ceil(f);
+    double hi = std::floor(f);
+    bool integral = (lo == f);
+    const double int_min = std::numeric_limits<int>::min();
+    const double int_max = std::numeric_limits<int>::max();
+    switch (cond.op) {
+        case OP_EQ:
+        case OP_NE:
+            if (!integral || f < int_min || f > int_max) {
+                return cond.op == OP_EQ ? COND_FALSE : COND_TRUE;
+            }
+            val.set_int(static_cast<int>(f));
+            return COND_KEEP;
+        case OP_GT:
+        case OP_GE:
+            if (lo > int_max || (lo == int_max && integral && cond.op == OP_GT)) {
+                return COND_FALSE;
+            }
+            if (lo < int_min || (lo == int_min && (cond.op == OP_GE || !integral))) {
+                return COND_TRUE;
+            }
+            if (!integral) {
+                cond.op = OP_GE;
+            }
+            val.set_int(static_cast<int>(lo));
+            return COND_KEEP;
+        case OP_LT:
+        case OP_LE:
+            if (hi < int_min || (hi == int_min && integral && cond.op == OP_LT)) {
+                return COND_FALSE;
+            }
+            if (hi > int_max || (hi == int_max && (cond.op == OP_LE || !integral))) {
+                return COND_TRUE;
+            }
+            if (!integral) {
+                cond.op = OP_LE;
+            }
+            val.set_int(static_cast<int>(hi));
+            return COND_KEEP;
+        default:
+            throw InternalError("Unexpected op type");
+    }
+}
+
+/**
+ * @description: 条件化简：
+ *              1. 同一列两侧的条件（a = a、a < a等）直接求值；
+ *              2. 同一列上的常量条件合并为一个区间，int列的开区间端点转换为闭区间，
+ *                 上下界相等时合并为等值条件（便于匹配索引），区间为空时整个where子句恒为假；
+ *              3. 不等条件的常量落在区间之外时删除。
+ *              化简后的条件按每列第一次出现的位置排列。
+ * @param {vector<Condition>} &conds 已完成类型转换的条件
+ * @param {bool} &always_false 条件恒为假时置为true
+ */
+void Analyze::normalize_clause(std::vector<Condition> &conds, bool &always_false) {
+    struct ColRange {
+        TabCol col;
+        bool has_lo = false, lo_incl = false;
+        bool has_hi = false, hi_incl = false;
+        Value lo, hi;
+        std::vector<Value> ne_vals;
+    };
+    // 每个位置要么是一个列-列条件，要么是一个列上合并后的区间
+    std::vector<std::pair<int, int>> slots;     // (是否为区间, 在对应数组中的下标)
+    std::vector<Condition> col_conds;
+    std::vector<ColRange> ranges;
+
+    auto tighten_lo = [](ColRange &r, const Value &v, bool incl) {
+        int cmp = r.has_lo ? compare_value(v, r.lo) : 1;
+        if (cmp > 0 || (cmp == 0 && !incl)) {
+            r.has_lo = true;
+            r.lo = v;
+            r.lo_incl = incl;
+        }
+    };
+    auto tighten_hi = [](ColRange &r, const Value &v, bool incl) {
+        int cmp = r.has_hi ? compare_value(v, r.hi) : -1;
+        if (cmp < 0 || (cmp == 0 && !incl)) {
+            r.has_hi = true;
+            r.hi = v;
+            r.hi_incl = incl;
+        }
+    };
+
+    for (auto &cond : conds) {
+        if (!cond.is_rhs_val) {
+            if (cond.lhs_col.tab_name == cond.rhs_col.tab_name && cond.lhs_col.col_name == cond.rhs_col.col_name) {
+                if (cond.op == OP_NE || cond.op == OP_LT || cond.op == OP_GT) {
+                    always_false = true;
+                }
+                continue;
+            }
+            slots.emplace_back(0, col_conds.size());
+            col_conds.push_back(cond);
+            continue;
+        }
+        auto pos = std::find_if(ranges.begin(), ranges.end(), [&](const ColRange &r) {
+            return r.col.tab_name == cond.lhs_col.tab_name && r.col.col_name == cond.lhs_col.col_name;
+        });
+        if (pos == ranges.end()) {
+            slots.emplace_back(1, ranges.size());
+            ranges.push_back(ColRange{.col = cond.lhs_col});
+            pos = ranges.end() - 1;
+        }
+        const Value &v = cond.rhs_val;
+        switch (cond.op) {
+            case OP_EQ: tighten_lo(*pos, v, true); tighten_hi(*pos, v, true); break;
+            case OP_NE: pos->ne_vals.push_back(v); break;
+            case OP_GT: tighten_lo(*pos, v, false); break;
+            case OP_GE: tighten_lo(*pos, v, true); break;
+            case OP_LT: tighten_hi(*pos, v, false); break;
+            case OP_LE: tighten_hi(*pos, v, true); break;
+            default: throw InternalError("Unexpected op type");
+        }
+    }
+    if (always_false) {
+        return;
+    }
+
+    std::vector<Condition> result;
+    auto make_cond = [](const TabCol &col, CompOp op, const Value &v) {
+        Condition cond;
+        cond.lhs_col = col;
+        cond.op = op;
+        cond.is_rhs_val = true;
+        cond.rhs_val = v;
+        return cond;
+    };
+    for (auto &slot : slots) {
+        if (slot.first == 0) {
+            result.push_back(col_conds[slot.second]);
+            continue;
+        }
+        ColRange &r = ranges[slot.second];
+        // int列: a > v 等价于 a >= v + 1，a < v 等价于 a <= v - 1
+        if (r.has_lo && !r.lo_incl && r.lo.type == TYPE_INT) {
+            if (r.lo.int_val == std::numeric_limits<int>::max()) {
+                always_false = true;
+                return;
+            }
+            r.lo.set_int(r.lo.int_val + 1);
+            r.lo_incl = true;
+        }
+        if (r.has_hi && !r.hi_incl && r.hi.type == TYPE_INT) {
+            if (r.hi.int_val == std::numeric_limits<int>::min()) {
+                always_false = true;
+                return;
+            }
+            r.hi.set_int(r.hi.int_val - 1);
+            r.hi_incl = true;
+        }
+        bool is_point = false;
+        if (r.has_lo && r.has_hi) {
+            int cmp = compare_value(r.lo, r.hi);
+            if (cmp > 0 || (cmp == 0 && !(r.lo_incl && r.hi_incl))) {
+                always_false = true;
+                return;
+            }
+            is_point = (cmp == 0);
+        }
+        if (is_point) {
+            result.push_back(make_cond(r.col, OP_EQ, r.lo));
+        } else {
+            if (r.has_lo) {
+                result.push_back(make_cond(r.col, r.lo_incl ? OP_GE : OP_GT, r.lo));
+            }
+            if (r.has_hi) {
+                result.push_back(make_cond(r.col, r.hi_incl ? OP_LE : OP_LT, r.hi));
+            }
+        }
+        std::vector<Value> emitted;
+        for (auto &v : r.ne_vals) {
+            int lo_cmp = r.has_lo ? compare_value(v, r.lo) : 1;
+            int hi_cmp = r.has_hi ? compare_value(v, r.hi) : -1;
+            if (lo_cmp < 0 || (lo_cmp == 0 && !r.lo_incl) || hi_cmp > 0 || (hi_cmp == 0 && !r.hi_incl)) {
+                continue;   // 区间之外的值，不等条件恒为真
+            }
+            if (is_point) {
+                always_false = true;    // a = v and a <> v
+                return;
+            }
+            bool dup = std::any_of(emitted.begin(), emitted.end(),
+                                   [&](const Value &e) { return compare_value(e, v) == 0; });
+            if (!dup) {
+                emitted.push_back(v);
+                result.push_back(make_cond(r.col, OP_NE, v));
+            }
+        }
+    }
+    conds = std::move(result);
+}
 
 Value Analyze::convert_sv_value(const std::shared_ptr<ast::Value> &sv_val) {
     Value val;
@@ -153,6 +471,11 @@ Value Analyze::convert_sv_value(const std::shared_ptr<ast::Value> &sv_val) {
         val.set_float(float_lit->val);
     } else if (auto str_lit = std::dynamic_pointer_cast<ast::StringLit>(sv_val)) {
         val.set_str(str_lit->val);
+    } else if (auto var = std::dynamic_pointer_cast<ast::VarRef>(sv_val)) {
+        // 变量只能出现在存储过程中，执行前已经替换为常量
+        throw ProcedureError("variable " + var->name + " is only allowed in a procedure");
+    } else if (auto func = std::dynamic_pointer_cast<ast::FuncCall>(sv_val)) {
+        throw ProcedureError("function " + func->func_name + " is only allowed in a procedure");
     } else {
         throw InternalError("Unexpected sv value type");
     }
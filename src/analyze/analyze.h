@@ -34,11 +34,16 @@ class Query{
     std::vector<SetClause> set_clauses;
     //insert 的values值
     std::vector<Value> values;
+    // where条件经过化简后恒为假，不需要扫描任何记录
+    bool always_false = false;
 
     Query(){}
 
 };
 
+// 单个条件化简的结果：保留、恒为真（可以删除）、恒为假（整个where子句为假）
+enum CondFoldResult { COND_KEEP, COND_TRUE, COND_FALSE };
+
 class Analyze
 {
 private:
@@ -52,8 +57,11 @@ public:
 private:
     TabCol check_column(const std::vector<ColMeta> &all_cols, TabCol target);
     void get_all_cols(const std::vector<std::string> &tab_names, std::vector<ColMeta> &all_cols);
-    void get_clause(const std::vector<std::shared_ptr<ast::BinaryExpr>> &sv_conds, std::vector<Condition> &conds);
-    void check_clause(const std::vector<std::string> &tab_names, std::vector<Condition> &conds);
+    void get_clause(const std::vector<std::shared_ptr<ast::BinaryExpr>> &sv_conds, std::vector<Condition> &conds,
+                    bool &always_false);
+    void check_clause(const std::vector<std::string> &tab_names, std::vector<Condition> &conds, bool &always_false);
+    void normalize_clause(std::vector<Condition> &conds, bool &always_false);
+    CondFoldResult coerce_cond(Condition &cond, ColType lhs_type);
     Value convert_sv_value(const std::shared_ptr<ast::Value> &sv_val);
     CompOp convert_sv_comp_op(ast::SvCompOp op);
 };
@@ -32,26 +32,52 @@ static constexpr int INVALID_TXN_ID = -1;                                     //
 static constexpr int INVALID_TIMESTAMP = -1;                                  // invalid transaction timestamp
 static constexpr int64_t INVALID_LSN = -1;                                    // invalid log sequence number
 static constexpr int64_t TXN_START_ID = 1LL << 62;                            // first txn id
+static constexpr int64_t OCC_LOCK_BIT = 1LL << 61;                            // lock bit in the OCC version word of a tuple
 static constexpr int64_t INVALID_TS = -1;                                     // invalid log sequence number
 static constexpr int HEADER_PAGE_ID = 0;                                      // the header page id
 static constexpr int PAGE_SIZE = 4096;                                        // size of a data page in byte  4KB
 static constexpr int BUFFER_POOL_SIZE = 65536;                                // size of buffer pool 256MB
 // static constexpr int BUFFER_POOL_SIZE = 262144;                                // size of buffer pool 1GB
 static constexpr int LOG_BUFFER_SIZE = (1024 * PAGE_SIZE);                    // size of a log buffer in byte
+static constexpr int LOG_BUFFER_NUM = 4;                                      // number of log buffers, at most 4
+static constexpr int LOG_SEGMENT_SIZE = (16 * 1024 * 1024);                   // size of the log in a segment file in byte
+static constexpr int LOG_SEGMENT_HEADER_SIZE = PAGE_SIZE;                     // size of the header before the log in a segment file
+static constexpr int LOG_SEGMENT_FILE_SIZE = LOG_SEGMENT_HEADER_SIZE + LOG_SEGMENT_SIZE;  // size of a preallocated segment file
+static constexpr int LOG_RECYCLE_SEGMENTS = 4;                                // max number of old log segments kept for reuse
 static constexpr int BUCKET_SIZE = 50;                                        // size of extendible hash bucket
+static constexpr int GC_INTERVAL_MS = 50;                                     // interval of background version gc in ms
+static constexpr int TXN_TABLE_SIZE = 16384;                                  // number of slots in the global txn table, power of 2
+static constexpr int TXN_TABLE_PROBE = 16;                                    // probe window of a txn id in the txn table
+static constexpr int EPOCH_MAX_THREADS = 1024;                                // max number of threads using epoch protection
+static constexpr int REDO_MAX_THREADS = 16;                                   // max number of threads replaying redo logs in recovery
+static constexpr int REDO_BATCH_RECORDS = 4096;                               // redo logs the recovery reader groups by page per dispatch
+static constexpr int SERVER_WORKER_THREADS = 32;                              // number of threads executing client requests
+static constexpr int SERVER_MAX_EVENTS = 256;                                 // max number of events returned by one epoll_wait
+static constexpr int SERVER_MAX_REQUEST_LENGTH = (16 * 1024 * 1024);         // max length of a statement or a frame from a client
+static constexpr int FRAME_HEADER_SIZE = 4;                                   // big-endian payload length before each frame
+static constexpr char FRAME_PROTOCOL_MAGIC[] = "\xffRDB";                     // first bytes sent by a client using frames
+static constexpr int BACKUP_MAX_BYTES_PER_SEC = (32 * 1024 * 1024);           // I/O rate limit of an online backup in bytes per second
+static constexpr int INTERRUPT_CHECK_INTERVAL = 1024;                         // tuples an executor reads between checks for cancel/timeout
+static constexpr int LOCK_WAIT_CHECK_MS = 10;                                 // milliseconds a lock wait sleeps between checks for cancel/timeout
 
 using frame_id_t = int32_t;  // frame id type, 帧页ID, 页在BufferPool中的存储单元称为帧,一帧对应一页
 using page_id_t = int32_t;   // page id type , 页ID
 using txn_id_t = int64_t;    // transaction id type
-using lsn_t = int32_t;       // log sequence number type
+using lsn_t = int64_t;       // log sequence number type
 using slot_offset_t = size_t;  // slot offset type
 using oid_t = uint16_t;
 using timestamp_t = int64_t;  // timestamp type, used for transaction concurrency
 
 // log file
-static const std::string LOG_FILE_NAME = "db.log";
+static const std::string LOG_FILE_NAME = "db.log";                            // prefix of log segment files, db.log.<segment no>
+
+// master record, points to the latest checkpoint in the log file
+static const std::string MASTER_RECORD_NAME = "db.master";
 
 // replacer
 static const std::string REPLACER_TYPE = "LRU";
 
 static const std::string DB_META_NAME = "db.meta";
+
+// source text of stored procedures, each terminated by '\0'
+static const std::string PROCEDURE_FILE_NAME = "db.proc";
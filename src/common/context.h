@@ -10,15 +10,24 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include <atomic>
+#include <chrono>
+
 #include "transaction/transaction.h"
 #include "transaction/concurrency/lock_manager.h"
 #include "recovery/log_manager.h"
 
-// class TransactionManager;
+class TransactionManager;
 
 // used for data_send
 static int const_offset = -1;
 
+// 会话级别的设置，在客户端连接的整个生命周期内有效
+struct SessionVars {
+    bool synchronous_commit_ = true;    // 关闭后提交不等待提交日志持久化，由刷盘线程在log_timeout内持久化
+    int statement_timeout_ = 0;         // 一条语句最长的执行时间（毫秒），超时后中止事务，为0时不限制
+};
+
 class Context {
 public:
     Context (LockManager *lock_mgr, LogManager *log_mgr, 
@@ -28,11 +37,37 @@ public:
             ellipsis_ = false;
           }
 
-    // TransactionManager *txn_mgr_;
+    TransactionManager *txn_mgr_ = nullptr;     // MVCC下执行器通过它访问版本链
+    SessionVars *session_ = nullptr;            // 当前连接的会话设置
+    const std::atomic<bool> *cancel_ = nullptr; // 其他连接通过cancel请求取消当前语句
+    std::chrono::steady_clock::time_point deadline_ = std::chrono::steady_clock::time_point::max();  // 语句超时的时刻
+    int interrupt_ticks_ = 0;                   // 距离上次检查取消和超时读取的元组数
     LockManager *lock_mgr_;
     LogManager *log_mgr_;
     Transaction *txn_;
     char *data_send_;
     int *offset_;
     bool ellipsis_;
+
+    /**
+     * @description: 执行器每读取一个元组调用一次，每INTERRUPT_CHECK_INTERVAL次检查语句是否被取消或者超时，
+     * 是则抛出事务中止异常，由调用者回滚事务、释放锁；执行器在不持有页面锁存器的位置调用
+     */
+    void check_interrupt() {
+        if (++interrupt_ticks_ < INTERRUPT_CHECK_INTERVAL) {
+            return;
+        }
+        interrupt_ticks_ = 0;
+        check_interrupt_now();
+    }
+
+    /* 立即检查语句是否被取消或者超时，用于阻塞等待锁时 */
+    void check_interrupt_now() {
+        if (cancel_ != nullptr && cancel_->load(std::memory_order_relaxed)) {
+            throw TransactionAbortException(txn_->get_transaction_id(), AbortReason::STATEMENT_CANCELED);
+        }
+        if (deadline_ != std::chrono::steady_clock::time_point::max() && std::chrono::steady_clock::now() >= deadline_) {
+            throw TransactionAbortException(txn_->get_transaction_id(), AbortReason::STATEMENT_TIMEOUT);
+        }
+    }
 };
\ No newline at end of file
@@ -0,0 +1,83 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * CRC32C（Castagnoli多项式）校验和，用于检测日志中不完整或损坏的内容
+ * 支持SSE4.2的x86处理器上使用crc32指令，否则按字节查表计算，两者结果相同
+ */
+namespace crc32c {
+
+static constexpr uint32_t POLY = 0x82F63B78;  // 反转后的Castagnoli多项式
+
+inline constexpr std::array<uint32_t, 256> make_table() {
+    std::array<uint32_t, 256> table{};
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t crc = i;
+        for (int j = 0; j < 8; j++) {
+            crc = (crc >> 1) ^ ((crc & 1) ? POLY : 0);
+        }
+        table[i] = crc;
+    }
+    return table;
+}
+
+static constexpr std::array<uint32_t, 256> TABLE = make_table();
+
+inline uint32_t extend_sw(uint32_t crc, const char *data, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        crc = TABLE[(crc ^ static_cast<uint8_t>(data[i])) & 0xFF] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+#if defined(__x86_64__)
+__attribute__((target("sse4.2"))) inline uint32_t extend_hw(uint32_t crc, const char *data, size_t len) {
+    uint64_t crc64 = crc;
+    for (; len >= sizeof(uint64_t); data += sizeof(uint64_t), len -= sizeof(uint64_t)) {
+        uint64_t word;
+        memcpy(&word, data, sizeof(word));
+        crc64 = __builtin_ia32_crc32di(crc64, word);
+    }
+    crc = static_cast<uint32_t>(crc64);
+    for (; len > 0; data++, len--) {
+        crc = __builtin_ia32_crc32qi(crc, static_cast<uint8_t>(*data));
+    }
+    return crc;
+}
+#endif
+
+/**
+ * @description: 在已有的校验和上继续计算一段数据，可以分段计算不连续的数据
+ * @return {uint32_t} 新的校验和
+ * @param {uint32_t} crc 之前的数据的校验和，第一段为0
+ * @param {char*} data 数据
+ * @param {size_t} len 数据长度
+ */
+inline uint32_t extend(uint32_t crc, const char *data, size_t len) {
+    crc = ~crc;
+#if defined(__x86_64__)
+    static const bool has_sse42 = __builtin_cpu_supports("sse4.2");
+    if (has_sse42) {
+        return ~extend_hw(crc, data, len);
+    }
+#endif
+    return ~extend_sw(crc, data, len);
+}
+
+inline uint32_t value(const char *data, size_t len) { return extend(0, data, len); }
+
+}  // namespace crc32c
@@ -71,6 +71,13 @@ class InvalidRecordSizeError : public RMDBError {
     InvalidRecordSizeError(int record_size) : RMDBError("Invalid record size: " + std::to_string(record_size)) {}
 };
 
+class IncompatibleFileFormatError : public RMDBError {
+   public:
+    IncompatibleFileFormatError(const std::string &filename)
+        : RMDBError("Table file " + filename + " was created with an older page layout without tuple metadata; "
+                    "export its data with the previous version and load it into a new database") {}
+};
+
 // IX errors
 class InvalidColLengthError : public RMDBError {
    public:
@@ -158,4 +165,39 @@ class PageNotExistError : public RMDBError {
    public:
     PageNotExistError(const std::string &table_name, int page_no)
         : RMDBError("Page " + std::to_string(page_no) + " in table " + table_name + "not exits") {}
-};
\ No newline at end of file
+};
+
+class ReadOnlyReplicaError : public RMDBError {
+   public:
+    ReadOnlyReplicaError() : RMDBError("Cannot execute write statements on a read-only replica") {}
+};
+
+class BackupError : public RMDBError {
+   public:
+    BackupError(const std::string &msg) : RMDBError("Backup failed: " + msg) {}
+};
+
+class BackupInProgressError : public RMDBError {
+   public:
+    BackupInProgressError() : RMDBError("DDL is not allowed while a backup is in progress") {}
+};
+
+class SessionNotFoundError : public RMDBError {
+   public:
+    SessionNotFoundError(int session_id) : RMDBError("Session not found: " + std::to_string(session_id)) {}
+};
+
+class ProcedureNotFoundError : public RMDBError {
+   public:
+    ProcedureNotFoundError(const std::string &proc_name) : RMDBError("Procedure not found: " + proc_name) {}
+};
+
+class ProcedureExistsError : public RMDBError {
+   public:
+    ProcedureExistsError(const std::string &proc_name) : RMDBError("Procedure already exists: " + proc_name) {}
+};
+
+class ProcedureError : public RMDBError {
+   public:
+    ProcedureError(const std::string &msg) : RMDBError("Procedure error: " + msg) {}
+};
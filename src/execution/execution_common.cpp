@@ -0,0 +1,271 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "execution_common.h"
+
+/**
+ * @description: 从基础元组出发依次应用撤销日志，得到版本链上更早的版本
+ * @return {optional<RmRecord>} 重建出的元组，如果该版本是删除标记则返回nullopt
+ * @param {TabMeta*} schema 元组所在表的元数据
+ * @param {RmRecord&} base_tuple 表堆中的元组
+ * @param {TupleMeta&} base_meta 表堆中元组的元信息
+ * @param {vector<UndoLog>&} undo_logs 从新到旧排列的撤销日志
+ */
+auto ReconstructTuple(const TabMeta *schema, const RmRecord &base_tuple, const TupleMeta &base_meta,
+                      const std::vector<UndoLog> &undo_logs) -> std::optional<RmRecord> {
+    RmRecord tuple(base_tuple);
+    bool is_deleted = base_meta.is_deleted_;
+    for (auto &log : undo_logs) {
+        is_deleted = log.is_deleted_;
+        if (!is_deleted) {
+            TransactionManager::ApplyUndoLog(*schema, log, tuple.data);
+        }
+    }
+    if (is_deleted) {
+        return std::nullopt;
+    }
+    return tuple;
+}
+
+/**
+ * @description: 写写冲突检测（先提交者胜）：元组被其他未提交事务修改，或在当前事务的快照之后被提交修改
+ * @param {timestamp_t} tuple_ts 表堆中元组的时间戳
+ * @param {Transaction*} txn 准备修改元组的事务
+ */
+auto IsWriteWriteConflict(timestamp_t tuple_ts, Transaction *txn) -> bool {
+    return tuple_ts != txn->get_temp_ts() && tuple_ts > txn->get_read_ts();
+}
+
+/**
+ * @description: 快照读，获取rid处的元组对当前事务可见的版本，不加任何锁，也不会被写者阻塞
+ * @return {unique_ptr<RmRecord>} 可见版本，快照中不存在（尚未插入或已删除）时返回nullptr
+ * @param {TabMeta*} schema 元组所在表的元数据
+ * @param {RmFileHandle*} fh 表的数据文件句柄
+ * @param {Rid&} rid 元组位置
+ * @param {Context*} context 执行上下文，提供事务和事务管理器
+ */
+auto GetVisibleTuple(const TabMeta *schema, RmFileHandle *fh, const Rid &rid, Context *context)
+    -> std::unique_ptr<RmRecord> {
+    Transaction *txn = context->txn_;
+    TransactionManager *txn_mgr = context->txn_mgr_;
+    int fd = fh->GetFd();
+
+    // 元组、元信息和版本链表头在同一次页面读锁内读取，写者在页面写锁内同时修改三者
+    std::unique_ptr<RmRecord> base;
+    TupleMeta meta{};
+    std::optional<UndoLink> link = std::nullopt;
+    int record_size = fh->get_file_hdr().record_size;
+    fh->read_tuple(rid, [&](const TupleMeta &tuple_meta, const char *data) {
+        base = std::make_unique<RmRecord>(record_size, const_cast<char *>(data));
+        meta = tuple_meta;
+        if (meta.ts_ != txn->get_temp_ts() && meta.ts_ > txn->get_read_ts()) {
+            link = txn_mgr->GetUndoLink(fd, rid);
+        }
+    });
+
+    // 本事务自己的修改，或快照之前提交的版本
+    if (meta.ts_ == txn->get_temp_ts() || meta.ts_ <= txn->get_read_ts()) {
+        return meta.is_deleted_ ? nullptr : std::move(base);
+    }
+
+    // 沿版本链找到第一个时间戳不超过读时间戳的版本
+    std::vector<UndoLog> undo_logs;
+    while (link.has_value()) {
+        auto undo_log = txn_mgr->GetUndoLogOptional(*link);
+        if (!undo_log.has_value()) {
+            break;
+        }
+        undo_logs.push_back(*undo_log);
+        if (undo_log->ts_ <= txn->get_read_ts()) {
+            auto tuple = ReconstructTuple(schema, *base, meta, undo_logs);
+            if (!tuple.has_value()) {
+                return nullptr;
+            }
+            return std::make_unique<RmRecord>(*tuple);
+        }
+        link = undo_log->prev_version_.IsValid() ? std::make_optional(undo_log->prev_version_) : std::nullopt;
+    }
+    return nullptr;
+}
+
+static Value make_raw_value(const ColMeta &col, const char *data) {
+    Value value;
+    value.type = col.type;
+    value.raw = std::make_shared<RmRecord>(col.len, const_cast<char *>(data + col.offset));
+    return value;
+}
+
+/**
+ * @description: MVCC写入，原地修改表堆中的元组并把旧版本保存到事务的撤销日志中
+ * 同一事务多次修改同一元组时只保留一条撤销日志，新修改的字段追加旧值
+ * @return {bool} 是否修改了元组，元组已被本事务删除时返回false
+ * @param {TabMeta*} schema 元组所在表的元数据
+ * @param {RmFileHandle*} fh 表的数据文件句柄
+ * @param {Rid&} rid 元组位置
+ * @param {char*} new_data 新的元组数据，为nullptr表示删除
+ * @param {Context*} context 执行上下文
+ */
+auto MvccWriteTuple(const TabMeta *schema, RmFileHandle *fh, const Rid &rid, const char *new_data, Context *context)
+    -> bool {
+    Transaction *txn = context->txn_;
+    TransactionManager *txn_mgr = context->txn_mgr_;
+    int fd = fh->GetFd();
+    timestamp_t temp_ts = txn->get_temp_ts();
+    auto &cols = schema->cols;
+
+    auto is_modified = [&](const ColMeta &col, const char *data) {
+        return new_data != nullptr && memcmp(data + col.offset, new_data + col.offset, col.len) != 0;
+    };
+
+    bool modified = false;
+    fh->write_tuple(rid, [&](TupleMeta &meta, char *data) {
+        if (IsWriteWriteConflict(meta.ts_, txn)) {
+            throw TransactionAbortException(txn->get_transaction_id(), AbortReason::WRITE_CONFLICT);
+        }
+        if (meta.is_deleted_) {
+            return false;
+        }
+        auto link = txn_mgr->GetUndoLink(fd, rid);
+        if (meta.ts_ != temp_ts) {
+            // 第一次修改该元组，撤销日志记录被修改字段的旧值
+            UndoLog log{};
+            log.is_deleted_ = false;
+            log.ts_ = meta.ts_;
+            log.prev_version_ = link.value_or(UndoLink{});
+            log.modified_fields_.resize(cols.size(), false);
+            for (size_t i = 0; i < cols.size(); i++) {
+                if (is_modified(cols[i], data)) {
+                    log.modified_fields_[i] = true;
+                    log.tuple_.push_back(make_raw_value(cols[i], data));
+                }
+            }
+            txn_mgr->UpdateUndoLink(fd, rid, txn->AppendUndoLog(std::move(log)));
+        } else if (link.has_value() && link->prev_txn_ == txn->get_transaction_id() && new_data != nullptr) {
+            // 本事务之前修改过该元组，合并到已有的撤销日志；本事务插入的元组没有撤销日志，无需处理
+            UndoLog log = txn->GetUndoLog(link->prev_log_idx_);
+            UndoLog merged = log;
+            merged.tuple_.clear();
+            size_t value_idx = 0;
+            for (size_t i = 0; i < cols.size(); i++) {
+                if (log.modified_fields_[i]) {
+                    merged.tuple_.push_back(log.tuple_[value_idx++]);
+                } else if (is_modified(cols[i], data)) {
+                    merged.modified_fields_[i] = true;
+                    merged.tuple_.push_back(make_raw_value(cols[i], data));
+                }
+            }
+            txn->ModifyUndoLog(link->prev_log_idx_, std::move(merged));
+        }
+
+        if (new_data != nullptr) {
+            memcpy(data, new_data, fh->get_file_hdr().record_size);
+        } else {
+            meta.is_deleted_ = true;
+        }
+        meta.ts_ = temp_ts;
+        modified = true;
+        return true;
+    });
+    return modified;
+}
+
+/**
+ * @description: OCC读：读取元组及其版本字并记入读集合，不加锁；覆盖上本事务缓冲的修改
+ * @return {unique_ptr<RmRecord>} 对当前事务可见的元组，不存在、被其他事务插入但未提交或已被本事务删除时返回nullptr
+ * @param {RmFileHandle*} fh 表的数据文件句柄
+ * @param {Rid&} rid 元组位置
+ * @param {Context*} context 执行上下文
+ */
+auto OccReadTuple(RmFileHandle *fh, const Rid &rid, Context *context) -> std::unique_ptr<RmRecord> {
+    Transaction *txn = context->txn_;
+    auto write_map = txn->get_write_map();
+    auto write = write_map->find(LockDataId(fh->GetFd(), rid, LockDataType::RECORD));
+    if (write != write_map->end()) {
+        // 缓冲修改前已经读过该元组，读集合中已有记录
+        if (write->second->GetWriteType() == WType::DELETE_TUPLE) {
+            return nullptr;
+        }
+        return std::make_unique<RmRecord>(write->second->GetRecord());
+    }
+
+    std::unique_ptr<RmRecord> rec;
+    TupleMeta meta{};
+    int record_size = fh->get_file_hdr().record_size;
+    fh->read_tuple(rid, [&](const TupleMeta &tuple_meta, const char *data) {
+        rec = std::make_unique<RmRecord>(record_size, const_cast<char *>(data));
+        meta = tuple_meta;
+    });
+    if (meta.ts_ == txn->get_temp_ts()) {
+        // 本事务插入的元组
+        return rec;
+    }
+    // 其他事务插入但未提交的元组也记入读集合：它提交后版本字改变，本事务验证失败，从而不会漏读
+    txn->get_read_set()->push_back(OccReadRecord{fh->GetFd(), rid, meta.ts_ & ~OCC_LOCK_BIT});
+    if (meta.is_deleted_) {
+        return nullptr;
+    }
+    return rec;
+}
+
+/**
+ * @description: OCC插入：元组直接写入表堆，以本事务的临时时间戳和删除标记表示尚未提交，对其他事务不可见
+ * @return {Rid} 插入的位置
+ */
+auto OccInsertTuple(RmFileHandle *fh, char *data, Context *context) -> Rid {
+    Transaction *txn = context->txn_;
+    // 先递增表的插入版本，扫描过该表的其他事务提交时会检测到幻读；本事务之前的扫描同步到新的版本
+    uint64_t version = fh->bump_insert_version();
+    auto scan = txn->get_scan_set()->find(fh->GetFd());
+    if (scan != txn->get_scan_set()->end() && scan->second == version) {
+        scan->second = version + 1;
+    }
+    return fh->insert_record(data, TupleMeta{txn->get_temp_ts(), true}, context);
+}
+
+/**
+ * @description: OCC写：更新和删除缓冲在写集合中，提交时验证通过后才写回表堆，同一元组只保留一条写记录
+ * @return {bool} 是否缓冲了修改，元组是本事务插入的（对其他事务不可见）时返回false，由调用者直接修改表堆
+ * @param {string&} tab_name 表名称
+ * @param {RmFileHandle*} fh 表的数据文件句柄
+ * @param {Rid&} rid 元组位置
+ * @param {char*} new_data 新的元组数据，为nullptr表示删除
+ * @param {Context*} context 执行上下文
+ */
+auto OccWriteTuple(const std::string &tab_name, RmFileHandle *fh, const Rid &rid, const char *new_data,
+                   Context *context) -> bool {
+    Transaction *txn = context->txn_;
+    LockDataId id(fh->GetFd(), rid, LockDataType::RECORD);
+    auto write_map = txn->get_write_map();
+    auto write = write_map->find(id);
+    if (write != write_map->end()) {
+        if (new_data == nullptr) {
+            write->second->GetWriteType() = WType::DELETE_TUPLE;
+        } else {
+            memcpy(write->second->GetRecord().data, new_data, write->second->GetRecord().size);
+        }
+        return true;
+    }
+
+    bool own_insert = false;
+    fh->read_tuple(rid, [&](const TupleMeta &meta, const char *data) { own_insert = meta.ts_ == txn->get_temp_ts(); });
+    if (own_insert) {
+        return false;
+    }
+    WriteRecord *write_record;
+    if (new_data == nullptr) {
+        write_record = new WriteRecord(WType::DELETE_TUPLE, tab_name, rid);
+    } else {
+        RmRecord rec(fh->get_file_hdr().record_size, const_cast<char *>(new_data));
+        write_record = new WriteRecord(WType::UPDATE_TUPLE, tab_name, rid, rec);
+    }
+    txn->append_write_record(write_record);
+    write_map->emplace(id, write_record);
+    return true;
+}
@@ -17,9 +17,43 @@ See the Mulan PSL v2 for more details. */
 #include "transaction/transaction.h"
 #include "transaction/transaction_manager.h"
 #include "common/common.h"
+#include "common/context.h"
+#include "record/rm_file_handle.h"
+
+/* 当前语句是否按MVCC执行：读走快照，写生成撤销日志 */
+inline bool IsMvcc(Context *context) {
+    return context != nullptr && context->txn_mgr_ != nullptr && context->txn_ != nullptr &&
+           context->txn_mgr_->get_concurrency_mode() == ConcurrencyMode::MVCC;
+}
+
+/* 当前语句是否按乐观并发控制执行：读记录版本，写缓冲到提交时验证后写回 */
+inline bool IsOcc(Context *context) {
+    return context != nullptr && context->txn_mgr_ != nullptr && context->txn_ != nullptr &&
+           context->txn_mgr_->get_concurrency_mode() == ConcurrencyMode::OCC;
+}
+
+/* 当前语句是否按两阶段封锁执行：读写前需要向锁管理器申请锁 */
+inline bool IsLocking(Context *context) {
+    return context != nullptr && context->lock_mgr_ != nullptr && context->txn_ != nullptr &&
+           context->txn_mgr_ != nullptr &&
+           context->txn_mgr_->get_concurrency_mode() == ConcurrencyMode::TWO_PHASE_LOCKING;
+}
 
 auto ReconstructTuple(const TabMeta *schema, const RmRecord &base_tuple, const TupleMeta &base_meta,
                       const std::vector<UndoLog> &undo_logs) -> std::optional<RmRecord>;
 
 
 auto IsWriteWriteConflict(timestamp_t tuple_ts, Transaction *txn) -> bool;
+
+auto GetVisibleTuple(const TabMeta *schema, RmFileHandle *fh, const Rid &rid, Context *context)
+    -> std::unique_ptr<RmRecord>;
+
+auto MvccWriteTuple(const TabMeta *schema, RmFileHandle *fh, const Rid &rid, const char *new_data, Context *context)
+    -> bool;
+
+auto OccReadTuple(RmFileHandle *fh, const Rid &rid, Context *context) -> std::unique_ptr<RmRecord>;
+
+auto OccInsertTuple(RmFileHandle *fh, char *data, Context *context) -> Rid;
+
+auto OccWriteTuple(const std::string &tab_name, RmFileHandle *fh, const Rid &rid, const char *new_data,
+                   Context *context) -> bool;
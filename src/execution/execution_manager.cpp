@@ -18,6 +18,7 @@ See the Mulan PSL v2 for more details. */
 #include "executor_seq_scan.h"
 #include "executor_update.h"
 #include "index/ix.h"
+#include "procedure_manager.h"
 #include "record_printer.h"
 
 const char *help_info = "Supported SQL syntax:\n"
@@ -31,12 +32,25 @@ const char *help_info = "Supported SQL syntax:\n"
                    "  DELETE FROM table_name [WHERE where_clause]\n"
                    "  UPDATE table_name SET column_name = value [, column_name = value ...] [WHERE where_clause]\n"
                    "  SELECT selector FROM table_name [WHERE where_clause]\n"
+                   "  CREATE PROCEDURE procedure_name ([name type [, name type ...]]) BEGIN procedure_stmt ; [...] END\n"
+                   "  DROP PROCEDURE procedure_name\n"
+                   "  CALL procedure_name ([value [, value ...]])\n"
+                   "  SET statement_timeout = milliseconds\n"
+                   "  SHOW SESSIONS\n"
+                   "  CANCEL session_id\n"
+                   "  ANALYZE table_name\n"
+                   "  CHECKPOINT\n"
+                   "procedure_stmt:\n"
+                   "  {INSERT | DELETE | UPDATE | SELECT} statement, values may be variables or add/sub/mul(x, y)\n"
+                   "  SELECT selector INTO variable [, variable ...] FROM table_name [WHERE where_clause]\n"
+                   "  SET variable = value\n"
+                   "  FOR variable [, variable ...] IN (SELECT ...) BEGIN procedure_stmt ; [...] END\n"
                    "type:\n"
                    "  {INT | FLOAT | CHAR(n)}\n"
                    "where_clause:\n"
                    "  condition [AND condition ...]\n"
                    "condition:\n"
-                   "  column op {column | value}\n"
+                   "  {column | value} op {column | value}\n"
                    "column:\n"
                    "  [table_name.]column_name\n"
                    "op:\n"
@@ -47,15 +61,18 @@ const char *help_info = "Supported SQL syntax:\n"
 // 主要负责执行DDL语句
 void QlManager::run_mutli_query(std::shared_ptr<Plan> plan, Context *context){
     if (auto x = std::dynamic_pointer_cast<DDLPlan>(plan)) {
+        auto ddl_lock = sm_manager_->lock_ddl();
         switch(x->tag) {
             case T_CreateTable:
             {
                 sm_manager_->create_table(x->tab_name_, x->cols_, context);
+                planner_->get_sampler()->invalidate(x->tab_name_);
                 break;
             }
             case T_DropTable:
             {
                 sm_manager_->drop_table(x->tab_name_, context);
+                planner_->get_sampler()->invalidate(x->tab_name_);
                 break;
             }
             case T_CreateIndex:
@@ -90,6 +107,42 @@ void QlManager::run_cmd_utility(std::shared_ptr<Plan> plan, txn_id_t *txn_id, Co
                 sm_manager_->show_tables(context);
                 break;
             }
+            case T_ShowReplication:
+            {
+                show_replication(context);
+                break;
+            }
+            case T_ShowSessions:
+            {
+                if (!sessions_status_) {
+                    throw InternalError("sessions are not available");
+                }
+                print_status(sessions_status_(context->session_), context);
+                break;
+            }
+            case T_Cancel:
+            {
+                if (!cancel_session_) {
+                    throw InternalError("sessions are not available");
+                }
+                cancel_session_(std::stoi(x->tab_name_));
+                break;
+            }
+            case T_Analyze:
+            {
+                analyze(x->tab_name_, context);
+                break;
+            }
+            case T_Backup:
+            {
+                backup(x->tab_name_, context);
+                break;
+            }
+            case T_Checkpoint:
+            {
+                checkpoint(context);
+                break;
+            }
             case T_DescTable:
             {
                 sm_manager_->desc_table(x->tab_name_, context);
@@ -105,18 +158,25 @@ void QlManager::run_cmd_utility(std::shared_ptr<Plan> plan, txn_id_t *txn_id, Co
             {
                 context->txn_ = txn_mgr_->get_transaction(*txn_id);
                 txn_mgr_->commit(context->txn_, context->log_mgr_);
+                // 已结束的事务随时可能被垃圾回收释放，之后不能再访问
+                context->txn_ = nullptr;
+                *txn_id = INVALID_TXN_ID;
                 break;
             }    
             case T_Transaction_rollback:
             {
                 context->txn_ = txn_mgr_->get_transaction(*txn_id);
                 txn_mgr_->abort(context->txn_, context->log_mgr_);
+                context->txn_ = nullptr;
+                *txn_id = INVALID_TXN_ID;
                 break;
             }    
             case T_Transaction_abort:
             {
                 context->txn_ = txn_mgr_->get_transaction(*txn_id);
                 txn_mgr_->abort(context->txn_, context->log_mgr_);
+                context->txn_ = nullptr;
+                *txn_id = INVALID_TXN_ID;
                 break;
             }     
             default:
@@ -124,6 +184,26 @@ void QlManager::run_cmd_utility(std::shared_ptr<Plan> plan, txn_id_t *txn_id, Co
                 break;                        
         }
 
+    } else if (auto x = std::dynamic_pointer_cast<ProcedurePlan>(plan)) {
+        if (procedure_manager_ == nullptr) {
+            throw InternalError("procedures are not available");
+        }
+        switch (x->tag) {
+            // 存储过程的定义保存在备份拷贝的文件中，与表和索引的DDL一样在备份期间拒绝
+            case T_CreateProcedure: {
+                auto ddl_lock = sm_manager_->lock_ddl();
+                procedure_manager_->create_procedure(std::static_pointer_cast<ast::CreateProcedure>(x->stmt_));
+            } break;
+            case T_DropProcedure: {
+                auto ddl_lock = sm_manager_->lock_ddl();
+                procedure_manager_->drop_procedure(std::static_pointer_cast<ast::DropProcedure>(x->stmt_)->proc_name);
+            } break;
+            case T_CallProcedure:
+                procedure_manager_->call(std::static_pointer_cast<ast::CallProcedure>(x->stmt_), txn_id, context);
+                break;
+            default:
+                throw InternalError("Unexpected field type");
+        }
     } else if(auto x = std::dynamic_pointer_cast<SetKnobPlan>(plan)) {
         switch (x->set_knob_type_)
         {
@@ -135,6 +215,25 @@ void QlManager::run_cmd_utility(std::shared_ptr<Plan> plan, txn_id_t *txn_id, Co
             planner_->set_enable_sortmerge_join(x->bool_value_);
             break;
         }
+        case ast::SetKnobType::SynchronousCommit: {
+            if (context->session_ == nullptr) {
+                throw InternalError("session variables are not available");
+            }
+            context->session_->synchronous_commit_ = x->bool_value_;
+            // 对当前事务的提交立即生效
+            if (context->txn_ != nullptr) {
+                context->txn_->set_synchronous_commit(x->bool_value_);
+            }
+            break;
+        }
+        case ast::SetKnobType::StatementTimeout: {
+            if (context->session_ == nullptr) {
+                throw InternalError("session variables are not available");
+            }
+            // 从下一条语句开始生效
+            context->session_->statement_timeout_ = x->int_value_;
+            break;
+        }
         default: {
             throw RMDBError("Not implemented!\n");
             break;
@@ -143,6 +242,62 @@ void QlManager::run_cmd_utility(std::shared_ptr<Plan> plan, txn_id_t *txn_id, Co
     }
 }
 
+// 显示复制状态，每一行为一项状态的名称和值
+void QlManager::show_replication(Context *context) {
+    std::vector<std::pair<std::string, std::string>> status = {{"role", "standalone"}};
+    if (replication_status_) {
+        status = replication_status_();
+    }
+    print_status(status, context);
+}
+
+// 重新采样表，刷新规划器使用的选择率估计，输出采样的页数、记录数和估计的表记录数
+void QlManager::analyze(const std::string &tab_name, Context *context) {
+    if (!sm_manager_->db_.is_table(tab_name)) {
+        throw TableNotFoundError(tab_name);
+    }
+    RmSampleStats stats = planner_->get_sampler()->analyze(tab_name);
+    print_status({{"table", tab_name},
+                  {"pages", std::to_string(stats.total_pages)},
+                  {"sampled_pages", std::to_string(stats.sampled_pages)},
+                  {"sampled_records", std::to_string(stats.sampled_records)},
+                  {"est_records", std::to_string(static_cast<size_t>(stats.est_records() + 0.5))}},
+                 context);
+}
+
+// 在线备份数据库到dir，输出备份的日志范围和拷贝的数据量
+void QlManager::backup(const std::string &dir, Context *context) {
+    if (!backup_) {
+        throw BackupError("backup requires write-ahead logging, which is only enabled on a 2pl primary");
+    }
+    print_status(backup_(dir), context);
+}
+
+// 立即做一次检查点并截断恢复不再需要的日志，输出检查点的日志号
+void QlManager::checkpoint(Context *context) {
+    if (!checkpoint_) {
+        throw InternalError("checkpoint requires write-ahead logging, which is only enabled on a primary");
+    }
+    print_status(checkpoint_(), context);
+}
+
+// 输出名称和值两列的状态，每一行为一项状态
+void QlManager::print_status(const std::vector<std::pair<std::string, std::string>> &status, Context *context) {
+    std::fstream outfile;
+    outfile.open("output.txt", std::ios::out | std::ios::app);
+    outfile << "| Name | Value |\n";
+    RecordPrinter printer(2);
+    printer.print_separator(context);
+    printer.print_record({"Name", "Value"}, context);
+    printer.print_separator(context);
+    for (auto &[name, value] : status) {
+        printer.print_record({name, value}, context);
+        outfile << "| " << name << " | " << value << " |\n";
+    }
+    printer.print_separator(context);
+    outfile.close();
+}
+
 // 执行select语句，select语句的输出除了需要返回客户端外，还需要写入output.txt文件中
 void QlManager::select_from(std::unique_ptr<AbstractExecutor> executorTreeRoot, std::vector<TabCol> sel_cols, 
                             Context *context) {
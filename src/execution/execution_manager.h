@@ -12,6 +12,7 @@ See the Mulan PSL v2 for more details. */
 
 #include <cassert>
 #include <cstring>
+#include <functional>
 #include <memory>
 #include <string>
 #include <vector>
@@ -27,21 +28,80 @@ See the Mulan PSL v2 for more details. */
 #include "optimizer/planner.h"
 
 class Planner;
+class ProcedureManager;
 
 class QlManager {
    private:
     SmManager *sm_manager_;
     TransactionManager *txn_mgr_;
     Planner *planner_;
+    std::function<std::vector<std::pair<std::string, std::string>>()> replication_status_;   // 复制状态
+    std::function<std::vector<std::pair<std::string, std::string>>(const std::string &)> backup_;  // 在线备份
+    std::function<std::vector<std::pair<std::string, std::string>>()> checkpoint_;  // 立即做一次检查点
+    ProcedureManager *procedure_manager_ = nullptr;     // 存储过程
+    std::function<std::vector<std::pair<std::string, std::string>>(const SessionVars *)> sessions_status_;  // 会话状态
+    std::function<void(int)> cancel_session_;           // 取消会话正在执行的语句
 
    public:
     QlManager(SmManager *sm_manager, TransactionManager *txn_mgr, Planner *planner) 
         : sm_manager_(sm_manager),  txn_mgr_(txn_mgr), planner_(planner) {}
 
+    /**
+     * @description: 设置show replication显示的复制状态，没有设置时显示没有开启复制
+     * @param {function} status 返回复制状态，每一项为名称和值
+     */
+    void set_replication_status(std::function<std::vector<std::pair<std::string, std::string>>()> status) {
+        replication_status_ = std::move(status);
+    }
+
+    /**
+     * @description: 设置backup语句执行的在线备份，没有设置时（没有开启日志或者是只读副本）不能备份
+     * @param {function} backup 把数据库备份到参数指定的目录，返回备份结果，每一项为名称和值
+     */
+    void set_backup(std::function<std::vector<std::pair<std::string, std::string>>(const std::string &)> backup) {
+        backup_ = std::move(backup);
+    }
+
+    /**
+     * @description: 设置checkpoint语句执行的检查点，没有设置时（没有开启日志或者是只读副本）不能执行
+     * @param {function} checkpoint 做一次检查点，返回检查点的日志号和截断后保留的最早日志号，每一项为名称和值
+     */
+    void set_checkpoint(std::function<std::vector<std::pair<std::string, std::string>>()> checkpoint) {
+        checkpoint_ = std::move(checkpoint);
+    }
+
+    /**
+     * @description: 设置执行存储过程语句的ProcedureManager
+     * @param {ProcedureManager*} procedure_manager 存储过程管理器
+     */
+    void set_procedure_manager(ProcedureManager *procedure_manager) { procedure_manager_ = procedure_manager; }
+
+    /**
+     * @description: 设置show sessions显示的会话状态和cancel语句取消语句的方式
+     * @param {function} status 返回所有会话的状态，每一项为会话ID和状态，参数为执行show sessions的会话
+     * @param {function} cancel 取消参数指定的会话正在执行的语句，会话不存在时抛出SessionNotFoundError
+     */
+    void set_session_admin(std::function<std::vector<std::pair<std::string, std::string>>(const SessionVars *)> status,
+                           std::function<void(int)> cancel) {
+        sessions_status_ = std::move(status);
+        cancel_session_ = std::move(cancel);
+    }
+
     void run_mutli_query(std::shared_ptr<Plan> plan, Context *context);
     void run_cmd_utility(std::shared_ptr<Plan> plan, txn_id_t *txn_id, Context *context);
     void select_from(std::unique_ptr<AbstractExecutor> executorTreeRoot, std::vector<TabCol> sel_cols,
                         Context *context);
 
     void run_dml(std::unique_ptr<AbstractExecutor> exec);
+
+   private:
+    void show_replication(Context *context);
+
+    void analyze(const std::string &tab_name, Context *context);
+
+    void backup(const std::string &dir, Context *context);
+
+    void checkpoint(Context *context);
+
+    void print_status(const std::vector<std::pair<std::string, std::string>> &status, Context *context);
 };
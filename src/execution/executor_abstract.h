@@ -14,6 +14,7 @@ See the Mulan PSL v2 for more details. */
 #include "common/common.h"
 #include "index/ix.h"
 #include "system/sm.h"
+#include "optimizer/plan.h"
 
 class AbstractExecutor {
    public:
@@ -21,6 +22,10 @@ class AbstractExecutor {
 
     Context *context_;
 
+    // 基数反馈：算子对应的plan节点，以及本轮扫描实际输出的元组数
+    std::shared_ptr<Plan> plan_;
+    size_t num_rows_ = 0;
+
     virtual ~AbstractExecutor() = default;
 
     virtual size_t tupleLen() const { return 0; };
@@ -44,7 +49,7 @@ class AbstractExecutor {
 
     virtual ColMeta get_col_offset(const TabCol &target) { return ColMeta();};
 
-    std::vector<ColMeta>::const_iterator get_col(const std::vector<ColMeta> &rec_cols, const TabCol &target) {
+    static std::vector<ColMeta>::const_iterator get_col(const std::vector<ColMeta> &rec_cols, const TabCol &target) {
         auto pos = std::find_if(rec_cols.begin(), rec_cols.end(), [&](const ColMeta &col) {
             return col.tab_name == target.tab_name && col.name == target.col_name;
         });
@@ -53,4 +58,47 @@ class AbstractExecutor {
         }
         return pos;
     }
+
+    // 算子执行完毕（到达is_end）时调用，把实际输出的元组数回填到plan节点
+    void report_rows() {
+        if (plan_ != nullptr) {
+            plan_->actual_rows_ = num_rows_;
+            plan_->has_actual_rows_ = true;
+        }
+    }
+
+    /**
+     * @description: 判断记录是否满足单个条件，条件右侧可以是常量或同一条记录中的另一列
+     * @return {bool} 满足返回true
+     * @param {vector<ColMeta>} &rec_cols 记录的字段
+     * @param {Condition} &cond 条件
+     * @param {RmRecord} *rec 记录
+     */
+    static bool eval_cond(const std::vector<ColMeta> &rec_cols, const Condition &cond, const RmRecord *rec) {
+        auto lhs_col = get_col(rec_cols, cond.lhs_col);
+        char *lhs = rec->data + lhs_col->offset;
+        char *rhs;
+        if (cond.is_rhs_val) {
+            rhs = cond.rhs_val.raw->data;
+        } else {
+            auto rhs_col = get_col(rec_cols, cond.rhs_col);
+            rhs = rec->data + rhs_col->offset;
+        }
+        int cmp = ix_compare(lhs, rhs, lhs_col->type, lhs_col->len);
+        switch (cond.op) {
+            case OP_EQ: return cmp == 0;
+            case OP_NE: return cmp != 0;
+            case OP_LT: return cmp < 0;
+            case OP_GT: return cmp > 0;
+            case OP_LE: return cmp <= 0;
+            case OP_GE: return cmp >= 0;
+            default:
+                throw InternalError("Unexpected op type");
+        }
+    }
+
+    static bool eval_conds(const std::vector<ColMeta> &rec_cols, const std::vector<Condition> &conds, const RmRecord *rec) {
+        return std::all_of(conds.begin(), conds.end(),
+                           [&](const Condition &cond) { return eval_cond(rec_cols, cond, rec); });
+    }
 };
\ No newline at end of file
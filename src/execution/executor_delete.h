@@ -9,6 +9,7 @@ MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
 See the Mulan PSL v2 for more details. */
 
 #pragma once
+#include "execution_common.h"
 #include "execution_defs.h"
 #include "execution_manager.h"
 #include "executor_abstract.h"
@@ -37,8 +38,53 @@ class DeleteExecutor : public AbstractExecutor {
     }
 
     std::unique_ptr<RmRecord> Next() override {
+        bool mvcc = IsMvcc(context_);
+        bool occ = IsOcc(context_);
+        bool locking = IsLocking(context_);
+        if (locking) {
+            context_->lock_mgr_->lock_IX_on_table(context_->txn_, fh_->GetFd(), context_);
+        }
+        for (auto &rid : rids_) {
+            if (locking) {
+                context_->lock_mgr_->lock_exclusive_on_record(context_->txn_, rid, fh_->GetFd(), context_);
+            }
+            if (mvcc) {
+                // MVCC下只打删除标记并生成撤销日志，旧版本和索引项保留给更早的快照，由垃圾回收清理
+                if (MvccWriteTuple(&tab_, fh_, rid, nullptr, context_)) {
+                    context_->txn_->append_write_record(new WriteRecord(WType::DELETE_TUPLE, tab_name_, rid));
+                }
+                continue;
+            }
+            // OCC下删除缓冲到提交时写回，本事务插入的元组对其他事务不可见，直接物理删除
+            if (occ && OccWriteTuple(tab_name_, fh_, rid, nullptr, context_)) {
+                continue;
+            }
+            auto rec = fh_->get_record(rid, context_);
+            for (auto &index : tab_.indexes) {
+                auto ih = sm_manager_->ihs_.at(sm_manager_->get_ix_manager()->get_index_name(tab_name_, index.cols)).get();
+                ih->delete_entry(index_key(index, rec->data).data(), context_->txn_);
+            }
+            lsn_t undo_next_lsn = context_->txn_ != nullptr ? context_->txn_->get_prev_lsn() : INVALID_LSN;
+            fh_->delete_record(rid, context_);
+            if (context_->txn_ != nullptr && !occ) {
+                auto write_record = new WriteRecord(WType::DELETE_TUPLE, tab_name_, rid, *rec);
+                write_record->SetUndoNextLsn(undo_next_lsn);
+                context_->txn_->append_write_record(write_record);
+            }
+        }
         return nullptr;
     }
 
     Rid &rid() override { return _abstract_rid; }
+
+   private:
+    static std::vector<char> index_key(const IndexMeta &index, const char *data) {
+        std::vector<char> key(index.col_tot_len);
+        int offset = 0;
+        for (auto &col : index.cols) {
+            memcpy(key.data() + offset, data + col.offset, col.len);
+            offset += col.len;
+        }
+        return key;
+    }
 };
\ No newline at end of file
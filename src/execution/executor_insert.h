@@ -9,6 +9,7 @@ MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
 See the Mulan PSL v2 for more details. */
 
 #pragma once
+#include "execution_common.h"
 #include "execution_defs.h"
 #include "execution_manager.h"
 #include "executor_abstract.h"
@@ -49,20 +50,40 @@ class InsertExecutor : public AbstractExecutor {
             val.init_raw(col.len);
             memcpy(rec.data + col.offset, val.raw->data, col.len);
         }
+        bool locking = IsLocking(context_);
+        if (locking) {
+            context_->lock_mgr_->lock_IX_on_table(context_->txn_, fh_->GetFd(), context_);
+        }
         // Insert into record file
-        rid_ = fh_->insert_record(rec.data, context_);
-        
+        lsn_t undo_next_lsn = context_->txn_ != nullptr ? context_->txn_->get_prev_lsn() : INVALID_LSN;
+        // MVCC下新元组带插入事务的临时时间戳，提交前对其他事务不可见
+        if (IsMvcc(context_)) {
+            rid_ = fh_->insert_record(rec.data, TupleMeta{context_->txn_->get_temp_ts(), false}, context_);
+        } else if (IsOcc(context_)) {
+            rid_ = OccInsertTuple(fh_, rec.data, context_);
+        } else {
+            rid_ = fh_->insert_record(rec.data, context_);
+        }
+        if (locking) {
+            context_->lock_mgr_->lock_exclusive_on_record(context_->txn_, rid_, fh_->GetFd(), context_);
+        }
+        if (context_->txn_ != nullptr) {
+            auto write_record = new WriteRecord(WType::INSERT_TUPLE, tab_name_, rid_);
+            write_record->SetUndoNextLsn(undo_next_lsn);
+            context_->txn_->append_write_record(write_record);
+        }
+
         // Insert into index
         for(size_t i = 0; i < tab_.indexes.size(); ++i) {
             auto& index = tab_.indexes[i];
             auto ih = sm_manager_->ihs_.at(sm_manager_->get_ix_manager()->get_index_name(tab_name_, index.cols)).get();
-            char* key = new char[index.col_tot_len];
+            std::vector<char> key(index.col_tot_len);
             int offset = 0;
             for(size_t i = 0; i < index.col_num; ++i) {
-                memcpy(key + offset, rec.data + index.cols[i].offset, index.cols[i].len);
+                memcpy(key.data() + offset, rec.data + index.cols[i].offset, index.cols[i].len);
                 offset += index.cols[i].len;
             }
-            ih->insert_entry(key, rid_, context_->txn_);
+            ih->insert_entry(key.data(), rid_, context_->txn_);
         }
         return nullptr;
     }
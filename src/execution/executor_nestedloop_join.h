@@ -25,9 +25,12 @@ class NestedLoopJoinExecutor : public AbstractExecutor {
     std::vector<Condition> fed_conds_;          // join条件
     bool isend;
 
+    std::unique_ptr<RmRecord> left_rec_;        // 外表当前的记录
+    std::unique_ptr<RmRecord> joined_rec_;      // 当前满足join条件的连接结果
+
    public:
     NestedLoopJoinExecutor(std::unique_ptr<AbstractExecutor> left, std::unique_ptr<AbstractExecutor> right, 
-                            std::vector<Condition> conds) {
+                            std::vector<Condition> conds, Context *context) {
         left_ = std::move(left);
         right_ = std::move(right);
         len_ = left_->tupleLen() + right_->tupleLen();
@@ -40,20 +43,72 @@ class NestedLoopJoinExecutor : public AbstractExecutor {
         cols_.insert(cols_.end(), right_cols.begin(), right_cols.end());
         isend = false;
         fed_conds_ = std::move(conds);
+        context_ = context;
 
     }
 
-    void beginTuple() override {
+    size_t tupleLen() const override { return len_; }
+
+    const std::vector<ColMeta> &cols() const override { return cols_; }
+
+    std::string getType() override { return "NestedLoopJoinExecutor"; }
 
+    void beginTuple() override {
+        num_rows_ = 0;
+        isend = false;
+        left_->beginTuple();
+        if (left_->is_end()) {
+            isend = true;
+            report_rows();
+            return;
+        }
+        left_rec_ = left_->Next();
+        right_->beginTuple();
+        find_next_match();
     }
 
     void nextTuple() override {
-        
+        if (isend) {
+            return;
+        }
+        right_->nextTuple();
+        find_next_match();
     }
 
+    bool is_end() const override { return isend; }
+
     std::unique_ptr<RmRecord> Next() override {
-        return nullptr;
+        return std::make_unique<RmRecord>(*joined_rec_);
     }
 
     Rid &rid() override { return _abstract_rid; }
+
+   private:
+    // 以左儿子为外表、右儿子为内表，从当前位置开始找到下一对满足连接条件的记录
+    // 连接的比较次数可能远多于扫描的记录数，每比较一对记录检查一次语句是否被取消或超时
+    void find_next_match() {
+        while (!left_->is_end()) {
+            while (!right_->is_end()) {
+                context_->check_interrupt();
+                auto right_rec = right_->Next();
+                auto joined = std::make_unique<RmRecord>(len_);
+                memcpy(joined->data, left_rec_->data, left_->tupleLen());
+                memcpy(joined->data + left_->tupleLen(), right_rec->data, right_->tupleLen());
+                if (eval_conds(cols_, fed_conds_, joined.get())) {
+                    joined_rec_ = std::move(joined);
+                    num_rows_++;
+                    return;
+                }
+                right_->nextTuple();
+            }
+            left_->nextTuple();
+            if (left_->is_end()) {
+                break;
+            }
+            left_rec_ = left_->Next();
+            right_->beginTuple();
+        }
+        isend = true;
+        report_rows();
+    }
 };
\ No newline at end of file
@@ -10,6 +10,7 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include "execution_common.h"
 #include "execution_defs.h"
 #include "execution_manager.h"
 #include "executor_abstract.h"
@@ -27,11 +28,14 @@ class SeqScanExecutor : public AbstractExecutor {
 
     Rid rid_;
     std::unique_ptr<RecScan> scan_;     // table_iterator
+    std::unique_ptr<RmRecord> rec_;     // 当前记录，MVCC下为对事务可见的版本
 
     SmManager *sm_manager_;
+    bool always_false_;                 // 条件恒为假，不扫描任何记录
 
    public:
-    SeqScanExecutor(SmManager *sm_manager, std::string tab_name, std::vector<Condition> conds, Context *context) {
+    SeqScanExecutor(SmManager *sm_manager, std::string tab_name, std::vector<Condition> conds, Context *context,
+                    bool always_false = false) {
         sm_manager_ = sm_manager;
         tab_name_ = std::move(tab_name);
         conds_ = std::move(conds);
@@ -43,19 +47,74 @@ class SeqScanExecutor : public AbstractExecutor {
         context_ = context;
 
         fed_conds_ = conds_;
+        always_false_ = always_false;
     }
 
+    size_t tupleLen() const override { return len_; }
+
+    const std::vector<ColMeta> &cols() const override { return cols_; }
+
+    std::string getType() override { return "SeqScanExecutor"; }
+
     void beginTuple() override {
-        
+        num_rows_ = 0;
+        if (always_false_) {
+            scan_ = nullptr;
+            report_rows();
+            return;
+        }
+        // 两阶段封锁下顺序扫描对整张表加S锁，同时防止幻读
+        if (IsLocking(context_)) {
+            context_->lock_mgr_->lock_shared_on_table(context_->txn_, fh_->GetFd(), context_);
+        }
+        // OCC下记录扫描开始时表的插入版本，提交时验证期间没有其他事务插入新元组
+        if (IsOcc(context_)) {
+            context_->txn_->get_scan_set()->emplace(fh_->GetFd(), fh_->get_insert_version());
+        }
+        scan_ = std::make_unique<RmScan>(fh_);
+        find_next_tuple();
     }
 
     void nextTuple() override {
-        
+        if (is_end()) {
+            return;
+        }
+        scan_->next();
+        find_next_tuple();
     }
 
+    bool is_end() const override { return scan_ == nullptr || scan_->is_end(); }
+
     std::unique_ptr<RmRecord> Next() override {
-        return nullptr;
+        return std::make_unique<RmRecord>(*rec_);
     }
 
     Rid &rid() override { return rid_; }
+
+   private:
+    // 从scan_当前位置开始，找到第一条满足fed_conds_的记录，扫描结束时回填实际基数
+    // MVCC下读取快照中的可见版本，不加锁，快照中不存在的元组直接跳过；OCC下读取时记录元组的版本
+    // 每读取一条记录检查一次语句是否被取消或超时，不满足条件的记录很多时也能及时中止
+    void find_next_tuple() {
+        bool mvcc = IsMvcc(context_);
+        bool occ = IsOcc(context_);
+        TabMeta &tab = sm_manager_->db_.get_table(tab_name_);
+        while (!scan_->is_end()) {
+            context_->check_interrupt();
+            rid_ = scan_->rid();
+            if (mvcc) {
+                rec_ = GetVisibleTuple(&tab, fh_, rid_, context_);
+            } else if (occ) {
+                rec_ = OccReadTuple(fh_, rid_, context_);
+            } else {
+                rec_ = fh_->get_record(rid_, context_);
+            }
+            if (rec_ != nullptr && eval_conds(cols_, fed_conds_, rec_.get())) {
+                num_rows_++;
+                return;
+            }
+            scan_->next();
+        }
+        report_rows();
+    }
 };
\ No newline at end of file
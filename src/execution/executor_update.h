@@ -9,6 +9,7 @@ MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
 See the Mulan PSL v2 for more details. */
 
 #pragma once
+#include "execution_common.h"
 #include "execution_defs.h"
 #include "execution_manager.h"
 #include "executor_abstract.h"
@@ -36,11 +37,85 @@ class UpdateExecutor : public AbstractExecutor {
         conds_ = conds;
         rids_ = rids;
         context_ = context;
+        for (auto &set_clause : set_clauses_) {
+            auto col = tab_.get_col(set_clause.lhs.col_name);
+            if (col->type != set_clause.rhs.type) {
+                throw IncompatibleTypeError(coltype2str(col->type), coltype2str(set_clause.rhs.type));
+            }
+            if (set_clause.rhs.raw == nullptr) {
+                set_clause.rhs.init_raw(col->len);
+            }
+        }
     }
     std::unique_ptr<RmRecord> Next() override {
-        
+        bool mvcc = IsMvcc(context_);
+        bool occ = IsOcc(context_);
+        bool locking = IsLocking(context_);
+        if (locking) {
+            context_->lock_mgr_->lock_IX_on_table(context_->txn_, fh_->GetFd(), context_);
+        }
+        for (auto &rid : rids_) {
+            if (locking) {
+                context_->lock_mgr_->lock_exclusive_on_record(context_->txn_, rid, fh_->GetFd(), context_);
+            }
+            auto old_rec = occ ? OccReadTuple(fh_, rid, context_) : fh_->get_record(rid, context_);
+            if (old_rec == nullptr) {
+                continue;
+            }
+            RmRecord new_rec(*old_rec);
+            for (auto &set_clause : set_clauses_) {
+                auto col = tab_.get_col(set_clause.lhs.col_name);
+                memcpy(new_rec.data + col->offset, set_clause.rhs.raw->data, col->len);
+            }
+            if (mvcc) {
+                // MVCC下原地更新并生成撤销日志；旧索引项保留给更早的快照，只为变化了的键插入新索引项
+                if (!MvccWriteTuple(&tab_, fh_, rid, new_rec.data, context_)) {
+                    continue;
+                }
+                for (auto &index : tab_.indexes) {
+                    auto old_key = index_key(index, old_rec->data);
+                    auto new_key = index_key(index, new_rec.data);
+                    if (old_key != new_key) {
+                        auto ih = sm_manager_->ihs_.at(sm_manager_->get_ix_manager()->get_index_name(tab_name_, index.cols)).get();
+                        ih->insert_entry(new_key.data(), rid, context_->txn_);
+                    }
+                }
+                context_->txn_->append_write_record(new WriteRecord(WType::UPDATE_TUPLE, tab_name_, rid));
+                continue;
+            }
+            // OCC下更新缓冲到提交时写回，本事务插入的元组对其他事务不可见，直接原地更新
+            if (occ && OccWriteTuple(tab_name_, fh_, rid, new_rec.data, context_)) {
+                continue;
+            }
+            for (auto &index : tab_.indexes) {
+                auto ih = sm_manager_->ihs_.at(sm_manager_->get_ix_manager()->get_index_name(tab_name_, index.cols)).get();
+                ih->delete_entry(index_key(index, old_rec->data).data(), context_->txn_);
+            }
+            lsn_t undo_next_lsn = context_->txn_ != nullptr ? context_->txn_->get_prev_lsn() : INVALID_LSN;
+            fh_->update_record(rid, new_rec.data, context_);
+            for (auto &index : tab_.indexes) {
+                auto ih = sm_manager_->ihs_.at(sm_manager_->get_ix_manager()->get_index_name(tab_name_, index.cols)).get();
+                ih->insert_entry(index_key(index, new_rec.data).data(), rid, context_->txn_);
+            }
+            if (context_->txn_ != nullptr && !occ) {
+                auto write_record = new WriteRecord(WType::UPDATE_TUPLE, tab_name_, rid, *old_rec);
+                write_record->SetUndoNextLsn(undo_next_lsn);
+                context_->txn_->append_write_record(write_record);
+            }
+        }
         return nullptr;
     }
 
     Rid &rid() override { return _abstract_rid; }
+
+   private:
+    static std::vector<char> index_key(const IndexMeta &index, const char *data) {
+        std::vector<char> key(index.col_tot_len);
+        int offset = 0;
+        for (auto &col : index.cols) {
+            memcpy(key.data() + offset, data + col.offset, col.len);
+            offset += col.len;
+        }
+        return key;
+    }
 };
\ No newline at end of file
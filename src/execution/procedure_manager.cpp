@@ -0,0 +1,410 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "procedure_manager.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include "errors.h"
+
+// 参数声明的类型对应的列类型
+static ColType param_type(ast::SvType sv_type) {
+    switch (sv_type) {
+        case ast::SV_TYPE_INT: return TYPE_INT;
+        case ast::SV_TYPE_FLOAT: return TYPE_FLOAT;
+        case ast::SV_TYPE_STRING: return TYPE_STRING;
+        default: throw ProcedureError("unsupported parameter type");
+    }
+}
+
+/**
+ * @description: 打开数据库时加载保存的存储过程
+ * @param {function} parse 解析一条语句，返回语法树，解析失败时返回nullptr
+ */
+void ProcedureManager::load(const std::function<std::shared_ptr<ast::TreeNode>(const std::string &)> &parse) {
+    std::ifstream ifs(PROCEDURE_FILE_NAME);
+    if (!ifs.is_open()) {
+        return;
+    }
+    std::string source;
+    while (std::getline(ifs, source, '\0')) {
+        auto stmt = std::dynamic_pointer_cast<ast::CreateProcedure>(parse(source));
+        if (stmt == nullptr) {
+            throw InternalError("invalid procedure in " + PROCEDURE_FILE_NAME);
+        }
+        stmt->source = source;
+        std::unordered_set<std::string> defined;
+        for (auto &param : stmt->params) {
+            defined.insert(std::static_pointer_cast<ast::ColDef>(param)->col_name);
+        }
+        check_block(stmt->body, defined);
+        procedures_[stmt->proc_name] = stmt;
+    }
+}
+
+/**
+ * @description: 创建存储过程，检查过程体中的变量在使用之前都已经定义，并把未加表名、与变量同名的列替换为变量
+ * @param {shared_ptr<ast::CreateProcedure>} &stmt 创建语句，保存后不再修改
+ */
+void ProcedureManager::create_procedure(const std::shared_ptr<ast::CreateProcedure> &stmt) {
+    std::unordered_set<std::string> defined;
+    for (auto &param : stmt->params) {
+        auto &name = std::static_pointer_cast<ast::ColDef>(param)->col_name;
+        if (!defined.insert(name).second) {
+            throw ProcedureError("duplicate parameter " + name);
+        }
+    }
+    check_block(stmt->body, defined);
+
+    std::unique_lock lock(latch_);
+    if (procedures_.count(stmt->proc_name)) {
+        throw ProcedureExistsError(stmt->proc_name);
+    }
+    procedures_[stmt->proc_name] = stmt;
+    flush_procedures();
+}
+
+/**
+ * @description: 删除存储过程，正在执行的调用不受影响
+ * @param {string&} proc_name 过程名
+ */
+void ProcedureManager::drop_procedure(const std::string &proc_name) {
+    std::unique_lock lock(latch_);
+    if (procedures_.erase(proc_name) == 0) {
+        throw ProcedureNotFoundError(proc_name);
+    }
+    flush_procedures();
+}
+
+/**
+ * @description: 调用存储过程，过程体中的语句在调用语句的事务中依次执行，查询的结果依次返回给客户端
+ * @param {shared_ptr<ast::CallProcedure>} &stmt 调用语句，参数只能是常量
+ * @param {txn_id_t*} txn_id 当前事务ID
+ * @param {Context*} context 调用语句的上下文
+ */
+void ProcedureManager::call(const std::shared_ptr<ast::CallProcedure> &stmt, txn_id_t *txn_id, Context *context) {
+    std::shared_ptr<ast::CreateProcedure> proc;
+    {
+        std::shared_lock lock(latch_);
+        auto pos = procedures_.find(stmt->proc_name);
+        if (pos == procedures_.end()) {
+            throw ProcedureNotFoundError(stmt->proc_name);
+        }
+        proc = pos->second;
+    }
+    if (stmt->args.size() != proc->params.size()) {
+        throw ProcedureError(proc->proc_name + " expects " + std::to_string(proc->params.size()) + " arguments");
+    }
+    // 参数转换为声明的类型
+    Vars vars;
+    for (size_t i = 0; i < proc->params.size(); i++) {
+        auto param = std::static_pointer_cast<ast::ColDef>(proc->params[i]);
+        Value val = eval(stmt->args[i], vars);
+        ColType type = param_type(param->type_len->type);
+        if (type == TYPE_FLOAT && val.type == TYPE_INT) {
+            val.set_float(static_cast<float>(val.int_val));
+        } else if (type != val.type) {
+            throw IncompatibleTypeError(coltype2str(type), coltype2str(val.type));
+        } else if (type == TYPE_STRING && static_cast<int>(val.str_val.size()) > param->type_len->len) {
+            throw StringOverflowError();
+        }
+        vars[param->col_name] = val;
+    }
+
+    try {
+        execute_block(proc->body, vars, txn_id, context);
+    } catch (RMDBError &e) {
+        // 出错之前的语句已经修改了数据，回滚整个事务
+        std::cerr << e.what() << std::endl;
+        throw TransactionAbortException(context->txn_->get_transaction_id(), AbortReason::PROCEDURE_FAILED);
+    }
+}
+
+/**
+ * @description: 检查一段过程体，defined为此前已经定义的变量，执行顺序上赋值的变量在之后的语句中可以使用
+ */
+void ProcedureManager::check_block(std::vector<std::shared_ptr<ast::TreeNode>> &body,
+                                   std::unordered_set<std::string> &defined) {
+    for (auto &stmt : body) {
+        if (auto x = std::dynamic_pointer_cast<ast::InsertStmt>(stmt)) {
+            for (auto &val : x->vals) {
+                check_value(val, defined);
+            }
+        } else if (auto x = std::dynamic_pointer_cast<ast::UpdateStmt>(stmt)) {
+            for (auto &set_clause : x->set_clauses) {
+                check_value(set_clause->val, defined);
+            }
+            check_conds(x->conds, defined);
+        } else if (auto x = std::dynamic_pointer_cast<ast::DeleteStmt>(stmt)) {
+            check_conds(x->conds, defined);
+        } else if (auto x = std::dynamic_pointer_cast<ast::SelectStmt>(stmt)) {
+            check_conds(x->conds, defined);
+        } else if (auto x = std::dynamic_pointer_cast<ast::SelectInto>(stmt)) {
+            check_conds(x->select->conds, defined);
+            defined.insert(x->vars.begin(), x->vars.end());
+        } else if (auto x = std::dynamic_pointer_cast<ast::AssignStmt>(stmt)) {
+            check_value(x->val, defined);
+            defined.insert(x->var);
+        } else if (auto x = std::dynamic_pointer_cast<ast::ForLoop>(stmt)) {
+            check_conds(x->select->conds, defined);
+            defined.insert(x->vars.begin(), x->vars.end());
+            check_block(x->body, defined);
+        } else {
+            throw ProcedureError("unsupported statement in procedure");
+        }
+    }
+}
+
+// 检查值中用到的变量都已经定义，函数名和参数个数正确
+void ProcedureManager::check_value(const std::shared_ptr<ast::Value> &val,
+                                   const std::unordered_set<std::string> &defined) {
+    if (auto var = std::dynamic_pointer_cast<ast::VarRef>(val)) {
+        if (!defined.count(var->name)) {
+            throw ProcedureError("undefined variable " + var->name);
+        }
+    } else if (auto func = std::dynamic_pointer_cast<ast::FuncCall>(val)) {
+        if (func->func_name != "add" && func->func_name != "sub" && func->func_name != "mul") {
+            throw ProcedureError("unknown function " + func->func_name);
+        }
+        if (func->args.size() != 2) {
+            throw ProcedureError(func->func_name + " expects 2 arguments");
+        }
+        for (auto &arg : func->args) {
+            check_value(arg, defined);
+        }
+    }
+}
+
+// 条件中未加表名、与已定义变量同名的列替换为变量
+void ProcedureManager::check_conds(std::vector<std::shared_ptr<ast::BinaryExpr>> &conds,
+                                   const std::unordered_set<std::string> &defined) {
+    auto resolve = [&](std::shared_ptr<ast::Expr> &expr) {
+        auto col = std::dynamic_pointer_cast<ast::Col>(expr);
+        if (col != nullptr && col->tab_name.empty() && defined.count(col->col_name)) {
+            expr = std::make_shared<ast::VarRef>(col->col_name);
+        }
+    };
+    for (auto &cond : conds) {
+        resolve(cond->lhs);
+        resolve(cond->rhs);
+    }
+}
+
+/**
+ * @description: 依次执行一段过程体
+ */
+void ProcedureManager::execute_block(const std::vector<std::shared_ptr<ast::TreeNode>> &body, Vars &vars,
+                                     txn_id_t *txn_id, Context *context) {
+    for (auto &stmt : body) {
+        if (auto x = std::dynamic_pointer_cast<ast::SelectInto>(stmt)) {
+            auto rows = query_rows(x->select, vars, 1, context);
+            if (rows.empty()) {
+                throw ProcedureError("select into found no rows");
+            }
+            if (rows[0].size() != x->vars.size()) {
+                throw ProcedureError("select into expects " + std::to_string(rows[0].size()) + " variables");
+            }
+            for (size_t i = 0; i < x->vars.size(); i++) {
+                vars[x->vars[i]] = rows[0][i];
+            }
+        } else if (auto x = std::dynamic_pointer_cast<ast::AssignStmt>(stmt)) {
+            vars[x->var] = eval(x->val, vars);
+        } else if (auto x = std::dynamic_pointer_cast<ast::ForLoop>(stmt)) {
+            // 先读出所有行，循环体修改同一个表时不影响遍历
+            auto rows = query_rows(x->select, vars, SIZE_MAX, context);
+            for (auto &row : rows) {
+                if (row.size() != x->vars.size()) {
+                    throw ProcedureError("for loop expects " + std::to_string(row.size()) + " variables");
+                }
+                for (size_t i = 0; i < x->vars.size(); i++) {
+                    vars[x->vars[i]] = row[i];
+                }
+                execute_block(x->body, vars, txn_id, context);
+            }
+        } else {
+            run_stmt(bind_stmt(stmt, vars), txn_id, context);
+        }
+    }
+}
+
+/**
+ * @description: 分析、生成计划并执行一条已经替换了变量的语句。查询的结果先写入单独的缓冲区，
+ * 再追加到返回给客户端的结果中，结果放不下时截断
+ */
+void ProcedureManager::run_stmt(const std::shared_ptr<ast::TreeNode> &stmt, txn_id_t *txn_id, Context *context) {
+    std::shared_ptr<Query> query = analyze_->do_analyze(stmt);
+    std::shared_ptr<Plan> plan = optimizer_->plan_query(query, context);
+    if (std::dynamic_pointer_cast<ast::SelectStmt>(stmt) == nullptr) {
+        std::shared_ptr<PortalStmt> portal_stmt = portal_->start(plan, context);
+        portal_->run(portal_stmt, ql_manager_, txn_id, context);
+        portal_->drop(portal_stmt);
+        return;
+    }
+    std::unique_ptr<char[]> data_send(new char[BUFFER_LENGTH]);
+    int offset = 0;
+    Context select_context = *context;
+    select_context.data_send_ = data_send.get();
+    select_context.offset_ = &offset;
+    select_context.ellipsis_ = false;
+    std::shared_ptr<PortalStmt> portal_stmt = portal_->start(plan, &select_context);
+    portal_->run(portal_stmt, ql_manager_, txn_id, &select_context);
+    portal_->drop(portal_stmt);
+    int len = std::min(offset, BUFFER_LENGTH - 1 - *context->offset_);
+    memcpy(context->data_send_ + *context->offset_, data_send.get(), len);
+    *context->offset_ += len;
+}
+
+/**
+ * @description: 执行查询，返回最多max_rows行，每行为投影列的值
+ */
+std::vector<std::vector<Value>> ProcedureManager::query_rows(const std::shared_ptr<ast::SelectStmt> &select,
+                                                             const Vars &vars, size_t max_rows, Context *context) {
+    std::shared_ptr<Query> query = analyze_->do_analyze(bind_stmt(select, vars));
+    std::shared_ptr<Plan> plan = optimizer_->plan_query(query, context);
+    std::shared_ptr<PortalStmt> portal_stmt = portal_->start(plan, context);
+    auto &root = portal_stmt->root;
+    std::vector<std::vector<Value>> rows;
+    for (root->beginTuple(); !root->is_end() && rows.size() < max_rows; root->nextTuple()) {
+        auto record = root->Next();
+        std::vector<Value> row;
+        for (auto &col : root->cols()) {
+            Value val;
+            char *buf = record->data + col.offset;
+            if (col.type == TYPE_INT) {
+                val.set_int(*(int *)buf);
+            } else if (col.type == TYPE_FLOAT) {
+                val.set_float(*(float *)buf);
+            } else {
+                std::string str(buf, col.len);
+                str.resize(strlen(str.c_str()));
+                val.set_str(str);
+            }
+            row.push_back(val);
+        }
+        rows.push_back(std::move(row));
+    }
+    portal_->drop(portal_stmt);
+    return rows;
+}
+
+/**
+ * @description: 计算常量、变量或者函数的值，add/sub/mul的两个参数都是int时结果为int，否则为float
+ */
+Value ProcedureManager::eval(const std::shared_ptr<ast::Value> &val, const Vars &vars) {
+    Value res;
+    if (auto x = std::dynamic_pointer_cast<ast::IntLit>(val)) {
+        res.set_int(x->val);
+    } else if (auto x = std::dynamic_pointer_cast<ast::FloatLit>(val)) {
+        res.set_float(x->val);
+    } else if (auto x = std::dynamic_pointer_cast<ast::StringLit>(val)) {
+        res.set_str(x->val);
+    } else if (auto x = std::dynamic_pointer_cast<ast::VarRef>(val)) {
+        auto pos = vars.find(x->name);
+        if (pos == vars.end()) {
+            throw ProcedureError("undefined variable " + x->name);
+        }
+        res = pos->second;
+    } else if (auto x = std::dynamic_pointer_cast<ast::FuncCall>(val)) {
+        Value lhs = eval(x->args[0], vars);
+        Value rhs = eval(x->args[1], vars);
+        if (lhs.type == TYPE_STRING || rhs.type == TYPE_STRING) {
+            throw IncompatibleTypeError(coltype2str(lhs.type), coltype2str(rhs.type));
+        }
+        if (lhs.type == TYPE_INT && rhs.type == TYPE_INT) {
+            int a = lhs.int_val, b = rhs.int_val;
+            res.set_int(x->func_name == "add" ? a + b : (x->func_name == "sub" ? a - b : a * b));
+        } else {
+            float a = lhs.type == TYPE_INT ? lhs.int_val : lhs.float_val;
+            float b = rhs.type == TYPE_INT ? rhs.int_val : rhs.float_val;
+            res.set_float(x->func_name == "add" ? a + b : (x->func_name == "sub" ? a - b : a * b));
+        }
+    } else {
+        throw ProcedureError("unsupported value");
+    }
+    return res;
+}
+
+// 变量和函数替换为当前值对应的常量
+std::shared_ptr<ast::Value> ProcedureManager::bind_value(const std::shared_ptr<ast::Value> &val, const Vars &vars) {
+    if (std::dynamic_pointer_cast<ast::VarRef>(val) == nullptr && std::dynamic_pointer_cast<ast::FuncCall>(val) == nullptr) {
+        return val;
+    }
+    Value res = eval(val, vars);
+    if (res.type == TYPE_INT) {
+        return std::make_shared<ast::IntLit>(res.int_val);
+    } else if (res.type == TYPE_FLOAT) {
+        return std::make_shared<ast::FloatLit>(res.float_val);
+    }
+    return std::make_shared<ast::StringLit>(res.str_val);
+}
+
+std::vector<std::shared_ptr<ast::BinaryExpr>> ProcedureManager::bind_conds(
+    const std::vector<std::shared_ptr<ast::BinaryExpr>> &conds, const Vars &vars) {
+    auto bind_expr = [&](const std::shared_ptr<ast::Expr> &expr) -> std::shared_ptr<ast::Expr> {
+        if (auto val = std::dynamic_pointer_cast<ast::Value>(expr)) {
+            return bind_value(val, vars);
+        }
+        return expr;
+    };
+    std::vector<std::shared_ptr<ast::BinaryExpr>> res;
+    for (auto &cond : conds) {
+        res.push_back(std::make_shared<ast::BinaryExpr>(bind_expr(cond->lhs), cond->op, bind_expr(cond->rhs)));
+    }
+    return res;
+}
+
+/**
+ * @description: 复制一条DML语句，其中的变量替换为常量。分析器会修改语法树，保存的过程体不能直接交给它
+ */
+std::shared_ptr<ast::TreeNode> ProcedureManager::bind_stmt(const std::shared_ptr<ast::TreeNode> &stmt,
+                                                           const Vars &vars) {
+    if (auto x = std::dynamic_pointer_cast<ast::InsertStmt>(stmt)) {
+        std::vector<std::shared_ptr<ast::Value>> vals;
+        for (auto &val : x->vals) {
+            vals.push_back(bind_value(val, vars));
+        }
+        return std::make_shared<ast::InsertStmt>(x->tab_name, vals);
+    } else if (auto x = std::dynamic_pointer_cast<ast::UpdateStmt>(stmt)) {
+        std::vector<std::shared_ptr<ast::SetClause>> set_clauses;
+        for (auto &set_clause : x->set_clauses) {
+            set_clauses.push_back(
+                std::make_shared<ast::SetClause>(set_clause->col_name, bind_value(set_clause->val, vars)));
+        }
+        return std::make_shared<ast::UpdateStmt>(x->tab_name, set_clauses, bind_conds(x->conds, vars));
+    } else if (auto x = std::dynamic_pointer_cast<ast::DeleteStmt>(stmt)) {
+        return std::make_shared<ast::DeleteStmt>(x->tab_name, bind_conds(x->conds, vars));
+    } else if (auto x = std::dynamic_pointer_cast<ast::SelectStmt>(stmt)) {
+        return std::make_shared<ast::SelectStmt>(x->cols, x->tabs, bind_conds(x->conds, vars), x->order);
+    }
+    throw ProcedureError("unsupported statement in procedure");
+}
+
+/**
+ * @description: 把所有存储过程的原文写入PROCEDURE_FILE_NAME，每个以'\0'结尾。先写临时文件再重命名，
+ * 写到一半时发生故障不会丢失原来的存储过程
+ */
+void ProcedureManager::flush_procedures() {
+    std::string tmp_name = PROCEDURE_FILE_NAME + ".tmp";
+    {
+        std::ofstream ofs(tmp_name, std::ios::out | std::ios::trunc);
+        for (auto &[proc_name, proc] : procedures_) {
+            ofs << proc->source << '\0';
+        }
+        if (!ofs.good()) {
+            throw UnixError();
+        }
+    }
+    if (rename(tmp_name.c_str(), PROCEDURE_FILE_NAME.c_str()) < 0) {
+        throw UnixError();
+    }
+}
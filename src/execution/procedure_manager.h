@@ -0,0 +1,81 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "analyze/analyze.h"
+#include "execution_manager.h"
+#include "optimizer/optimizer.h"
+#include "portal.h"
+
+/* 存储过程：语句在创建时解析一次、检查变量，调用时在服务端依次执行，不需要每条语句一次网络往返和解析。
+ * 过程体由DML语句、select ... into、set变量和for循环组成，变量是参数或者在使用之前被赋值的名字，
+ * 未加表名的列名与已定义的变量同名时表示变量。调用时把变量替换为当前的值，再分析、生成计划并执行，
+ * 所有语句属于调用语句所在的事务；过程体中的语句出错时中止整个事务，不会只提交其中一部分修改。
+ * 存储过程的原文保存在PROCEDURE_FILE_NAME中，打开数据库时重新解析 */
+class ProcedureManager {
+   public:
+    ProcedureManager(Analyze *analyze, Optimizer *optimizer, Portal *portal, QlManager *ql_manager)
+        : analyze_(analyze), optimizer_(optimizer), portal_(portal), ql_manager_(ql_manager) {}
+
+    void load(const std::function<std::shared_ptr<ast::TreeNode>(const std::string &)> &parse);
+
+    void create_procedure(const std::shared_ptr<ast::CreateProcedure> &stmt);
+
+    void drop_procedure(const std::string &proc_name);
+
+    void call(const std::shared_ptr<ast::CallProcedure> &stmt, txn_id_t *txn_id, Context *context);
+
+   private:
+    using Vars = std::unordered_map<std::string, Value>;    // 变量名到当前值
+
+    void check_block(std::vector<std::shared_ptr<ast::TreeNode>> &body, std::unordered_set<std::string> &defined);
+
+    void check_value(const std::shared_ptr<ast::Value> &val, const std::unordered_set<std::string> &defined);
+
+    void check_conds(std::vector<std::shared_ptr<ast::BinaryExpr>> &conds,
+                     const std::unordered_set<std::string> &defined);
+
+    void execute_block(const std::vector<std::shared_ptr<ast::TreeNode>> &body, Vars &vars, txn_id_t *txn_id,
+                       Context *context);
+
+    void run_stmt(const std::shared_ptr<ast::TreeNode> &stmt, txn_id_t *txn_id, Context *context);
+
+    std::vector<std::vector<Value>> query_rows(const std::shared_ptr<ast::SelectStmt> &select, const Vars &vars,
+                                               size_t max_rows, Context *context);
+
+    Value eval(const std::shared_ptr<ast::Value> &val, const Vars &vars);
+
+    std::shared_ptr<ast::Value> bind_value(const std::shared_ptr<ast::Value> &val, const Vars &vars);
+
+    std::vector<std::shared_ptr<ast::BinaryExpr>> bind_conds(const std::vector<std::shared_ptr<ast::BinaryExpr>> &conds,
+                                                             const Vars &vars);
+
+    std::shared_ptr<ast::TreeNode> bind_stmt(const std::shared_ptr<ast::TreeNode> &stmt, const Vars &vars);
+
+    void flush_procedures();
+
+    Analyze *analyze_;
+    Optimizer *optimizer_;
+    Portal *portal_;
+    QlManager *ql_manager_;
+
+    std::shared_mutex latch_;   // 保护procedures_
+    std::map<std::string, std::shared_ptr<ast::CreateProcedure>> procedures_;  // 过程名到创建语句
+};
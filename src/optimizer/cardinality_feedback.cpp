@@ -0,0 +1,143 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "cardinality_feedback.h"
+
+#include <algorithm>
+
+/**
+ * @description: 查询签名对应的实际基数
+ * @return {bool} 命中返回true，并通过rows返回平滑后的基数
+ * @param {string} &key 谓词签名
+ * @param {double} *rows 输出参数
+ */
+bool CardinalityFeedback::lookup(const std::string &key, double *rows) {
+    std::scoped_lock lock{latch_};
+    auto it = entries_.find(key);
+    if (it == entries_.end()) {
+        return false;
+    }
+    lru_list_.splice(lru_list_.begin(), lru_list_, it->second.lru_pos);
+    *rows = it->second.rows;
+    return true;
+}
+
+/**
+ * @description: 记录一次执行中观测到的实际基数，与历史值做指数平滑，避免单次执行的抖动
+ * @param {string} &key 谓词签名
+ * @param {size_t} actual_rows 算子实际输出的元组数
+ */
+void CardinalityFeedback::record(const std::string &key, size_t actual_rows) {
+    std::scoped_lock lock{latch_};
+    auto it = entries_.find(key);
+    if (it != entries_.end()) {
+        Entry &entry = it->second;
+        entry.rows = CARDINALITY_FEEDBACK_ALPHA * actual_rows + (1 - CARDINALITY_FEEDBACK_ALPHA) * entry.rows;
+        lru_list_.splice(lru_list_.begin(), lru_list_, entry.lru_pos);
+        return;
+    }
+    if (entries_.size() >= capacity_ && !lru_list_.empty()) {
+        entries_.erase(lru_list_.back());
+        lru_list_.pop_back();
+    }
+    lru_list_.push_front(key);
+    entries_.emplace(key, Entry{static_cast<double>(actual_rows), lru_list_.begin()});
+}
+
+/**
+ * @description: 遍历执行完毕的计划树，把各节点回填的实际基数写入缓存
+ * @param {shared_ptr<Plan>} &plan 计划树的根节点
+ */
+void CardinalityFeedback::record_plan(const std::shared_ptr<Plan> &plan) {
+    if (plan == nullptr) {
+        return;
+    }
+    if (plan->has_actual_rows_ && !plan->feedback_key_.empty()) {
+        record(plan->feedback_key_, plan->actual_rows_);
+    }
+    if (auto x = std::dynamic_pointer_cast<JoinPlan>(plan)) {
+        record_plan(x->left_);
+        record_plan(x->right_);
+    } else if (auto x = std::dynamic_pointer_cast<ProjectionPlan>(plan)) {
+        record_plan(x->subplan_);
+    } else if (auto x = std::dynamic_pointer_cast<SortPlan>(plan)) {
+        record_plan(x->subplan_);
+    } else if (auto x = std::dynamic_pointer_cast<DMLPlan>(plan)) {
+        record_plan(x->subplan_);
+    }
+}
+
+size_t CardinalityFeedback::size() {
+    std::scoped_lock lock{latch_};
+    return entries_.size();
+}
+
+/**
+ * @description: 生成单表扫描的谓词签名：表名 + 排序后的条件，条件顺序不同的相同查询共享一个签名
+ */
+std::string CardinalityFeedback::scan_key(const std::string &tab_name, const std::vector<Condition> &conds) {
+    std::vector<std::string> cond_strs;
+    cond_strs.reserve(conds.size());
+    for (auto &cond : conds) {
+        cond_strs.push_back(cond_to_string(cond));
+    }
+    std::sort(cond_strs.begin(), cond_strs.end());
+    std::string key = "scan:" + tab_name;
+    for (auto &str : cond_strs) {
+        key += "|" + str;
+    }
+    return key;
+}
+
+/**
+ * @description: 生成连接的谓词签名，左右子树签名排序后拼接，交换内外表不改变签名
+ */
+std::string CardinalityFeedback::join_key(const std::string &left_key, const std::string &right_key,
+                                          const std::vector<Condition> &conds) {
+    if (left_key.empty() || right_key.empty()) {
+        return "";
+    }
+    std::vector<std::string> cond_strs;
+    cond_strs.reserve(conds.size());
+    for (auto &cond : conds) {
+        // 连接条件两侧的列交换后语义不变，取字典序较小的写法作为规范形式
+        Condition swapped = cond;
+        if (!cond.is_rhs_val) {
+            static const CompOp swap_op[] = {OP_EQ, OP_NE, OP_GT, OP_LT, OP_GE, OP_LE};
+            std::swap(swapped.lhs_col, swapped.rhs_col);
+            swapped.op = swap_op[cond.op];
+        }
+        cond_strs.push_back(std::min(cond_to_string(cond), cond_to_string(swapped)));
+    }
+    std::sort(cond_strs.begin(), cond_strs.end());
+    std::string key = "join:(" + std::min(left_key, right_key) + ")(" + std::max(left_key, right_key) + ")";
+    for (auto &str : cond_strs) {
+        key += "|" + str;
+    }
+    return key;
+}
+
+std::string CardinalityFeedback::cond_to_string(const Condition &cond) {
+    static const char *op_str[] = {"=", "<>", "<", ">", "<=", ">="};
+    std::string str = cond.lhs_col.tab_name + "." + cond.lhs_col.col_name + op_str[cond.op];
+    if (!cond.is_rhs_val) {
+        return str + cond.rhs_col.tab_name + "." + cond.rhs_col.col_name;
+    }
+    switch (cond.rhs_val.type) {
+        case TYPE_INT:
+            return str + std::to_string(cond.rhs_val.int_val);
+        case TYPE_FLOAT:
+            return str + std::to_string(cond.rhs_val.float_val);
+        case TYPE_STRING:
+            return str + "'" + cond.rhs_val.str_val + "'";
+        default:
+            return str;
+    }
+}
@@ -0,0 +1,64 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "common/common.h"
+#include "system/sm.h"
+#include "plan.h"
+
+static constexpr size_t CARDINALITY_FEEDBACK_SIZE = 4096;   // 反馈缓存最多保存的谓词签名数量
+static constexpr double CARDINALITY_FEEDBACK_ALPHA = 0.5;   // 新观测值在平滑后的基数中所占的权重
+
+/**
+ * @description: 基数反馈缓存
+ * 执行器在算子执行完毕后回填实际输出的元组数，执行结束后按谓词签名记录到缓存中；
+ * 优化器在估计算子基数时，如果签名命中则使用观测到的基数，而不是默认选择率。
+ * 缓存按LRU淘汰，多个连接线程共享，内部加锁。
+ */
+class CardinalityFeedback {
+   public:
+    explicit CardinalityFeedback(size_t capacity = CARDINALITY_FEEDBACK_SIZE) : capacity_(capacity) {}
+
+    ~CardinalityFeedback() = default;
+
+    bool lookup(const std::string &key, double *rows);
+
+    void record(const std::string &key, size_t actual_rows);
+
+    void record_plan(const std::shared_ptr<Plan> &plan);
+
+    size_t size();
+
+    static std::string scan_key(const std::string &tab_name, const std::vector<Condition> &conds);
+
+    static std::string join_key(const std::string &left_key, const std::string &right_key,
+                                const std::vector<Condition> &conds);
+
+   private:
+    static std::string cond_to_string(const Condition &cond);
+
+    struct Entry {
+        double rows;                                // 平滑后的实际基数
+        std::list<std::string>::iterator lru_pos;   // 在lru_list_中的位置
+    };
+
+    std::mutex latch_;
+    size_t capacity_;
+    std::list<std::string> lru_list_;               // 表头为最近使用的签名
+    std::unordered_map<std::string, Entry> entries_;
+};
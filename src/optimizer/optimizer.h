@@ -38,6 +38,33 @@ class Optimizer {
         } else if (auto x = std::dynamic_pointer_cast<ast::ShowTables>(query->parse)) {
             // show tables;
             return std::make_shared<OtherPlan>(T_ShowTable, std::string());
+        } else if (auto x = std::dynamic_pointer_cast<ast::ShowReplication>(query->parse)) {
+            // show replication;
+            return std::make_shared<OtherPlan>(T_ShowReplication, std::string());
+        } else if (auto x = std::dynamic_pointer_cast<ast::ShowSessions>(query->parse)) {
+            // show sessions;
+            return std::make_shared<OtherPlan>(T_ShowSessions, std::string());
+        } else if (auto x = std::dynamic_pointer_cast<ast::CancelStmt>(query->parse)) {
+            // cancel <session id>;
+            return std::make_shared<OtherPlan>(T_Cancel, std::to_string(x->session_id));
+        } else if (auto x = std::dynamic_pointer_cast<ast::AnalyzeStmt>(query->parse)) {
+            // analyze <table>;
+            return std::make_shared<OtherPlan>(T_Analyze, x->tab_name);
+        } else if (auto x = std::dynamic_pointer_cast<ast::BackupStmt>(query->parse)) {
+            // backup to '<dir>';
+            return std::make_shared<OtherPlan>(T_Backup, x->dir);
+        } else if (auto x = std::dynamic_pointer_cast<ast::CheckpointStmt>(query->parse)) {
+            // checkpoint;
+            return std::make_shared<OtherPlan>(T_Checkpoint, std::string());
+        } else if (auto x = std::dynamic_pointer_cast<ast::CreateProcedure>(query->parse)) {
+            // create procedure name (...) begin ... end;
+            return std::make_shared<ProcedurePlan>(T_CreateProcedure, x);
+        } else if (auto x = std::dynamic_pointer_cast<ast::DropProcedure>(query->parse)) {
+            // drop procedure name;
+            return std::make_shared<ProcedurePlan>(T_DropProcedure, x);
+        } else if (auto x = std::dynamic_pointer_cast<ast::CallProcedure>(query->parse)) {
+            // call name (...);
+            return std::make_shared<ProcedurePlan>(T_CallProcedure, x);
         } else if (auto x = std::dynamic_pointer_cast<ast::DescTable>(query->parse)) {
             // desc table;
             return std::make_shared<OtherPlan>(T_DescTable, x->tab_name);
@@ -55,7 +82,7 @@ class Optimizer {
             return std::make_shared<OtherPlan>(T_Transaction_rollback, std::string());
         } else if (auto x = std::dynamic_pointer_cast<ast::SetStmt>(query->parse)) {
             // Set Knob Plan
-            return std::make_shared<SetKnobPlan>(x->set_knob_type_, x->bool_val_);
+            return std::make_shared<SetKnobPlan>(x->set_knob_type_, x->bool_val_, x->int_val_);
         } else {
             return planner_->do_planner(query, context);
         }
@@ -23,6 +23,15 @@ typedef enum PlanTag{
     T_Invalid = 1,
     T_Help,
     T_ShowTable,
+    T_ShowReplication,
+    T_ShowSessions,
+    T_Cancel,
+    T_Analyze,
+    T_Backup,
+    T_Checkpoint,
+    T_CreateProcedure,
+    T_DropProcedure,
+    T_CallProcedure,
     T_DescTable,
     T_CreateTable,
     T_DropTable,
@@ -51,6 +60,12 @@ class Plan
 public:
     PlanTag tag;
     virtual ~Plan() = default;
+
+    // 基数反馈：优化器的估计值，以及执行器执行完毕后回填的实际输出元组数
+    std::string feedback_key_;          // 谓词签名，为空表示该节点不参与反馈
+    double est_rows_ = -1;              // 估计基数，-1表示未估计
+    size_t actual_rows_ = 0;            // 实际基数
+    bool has_actual_rows_ = false;      // 算子是否完整执行并回填了实际基数
 };
 
 class ScanPlan : public Plan
@@ -76,6 +91,7 @@ class ScanPlan : public Plan
         size_t len_;                               
         std::vector<Condition> fed_conds_;
         std::vector<std::string> index_col_names_;
+        bool always_false_ = false;     // analyze化简后where条件恒为假，扫描不返回任何记录
     
 };
 
@@ -173,7 +189,7 @@ class DDLPlan : public Plan
         std::vector<ColDef> cols_;
 };
 
-// help; show tables; desc tables; begin; abort; commit; rollback语句对应的plan
+// help; show tables; desc tables; begin; abort; commit; rollback; backup语句对应的plan，backup的备份目录存放在tab_name_中
 class OtherPlan : public Plan
 {
     public:
@@ -186,17 +202,32 @@ class OtherPlan : public Plan
         std::string tab_name_;
 };
 
+// 存储过程的创建、删除和调用，保存语法树，由ProcedureManager执行
+class ProcedurePlan : public Plan
+{
+    public:
+        ProcedurePlan(PlanTag tag, std::shared_ptr<ast::TreeNode> stmt)
+        {
+            Plan::tag = tag;
+            stmt_ = std::move(stmt);
+        }
+        ~ProcedurePlan(){}
+        std::shared_ptr<ast::TreeNode> stmt_;
+};
+
 // Set Knob Plan
 class SetKnobPlan : public Plan
 {
     public:
-        SetKnobPlan(ast::SetKnobType knob_type, bool bool_value) {
+        SetKnobPlan(ast::SetKnobType knob_type, bool bool_value, int int_value = 0) {
             Plan::tag = T_SetKnob;
             set_knob_type_ = knob_type;
             bool_value_ = bool_value;
+            int_value_ = int_value;
         }
     ast::SetKnobType set_knob_type_;
     bool bool_value_;
+    int int_value_;
 };
 
 class plannerInfo{
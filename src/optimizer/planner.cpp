@@ -25,6 +25,9 @@ See the Mulan PSL v2 for more details. */
 // 目前的索引匹配规则为：完全匹配索引字段，且全部为单点查询，不会自动调整where条件的顺序
 bool Planner::get_index_cols(std::string tab_name, std::vector<Condition> curr_conds, std::vector<std::string>& index_col_names) {
     index_col_names.clear();
+    if (!enable_index_scan) {
+        return false;
+    }
     for(auto& cond: curr_conds) {
         if(cond.is_rhs_val && cond.op == OP_EQ && cond.lhs_col.tab_name.compare(tab_name) == 0)
             index_col_names.push_back(cond.lhs_col.col_name);
@@ -34,6 +37,109 @@ bool Planner::get_index_cols(std::string tab_name, std::vector<Condition> curr_c
     return false;
 }
 
+/**
+ * @brief 默认选择率，没有执行反馈时使用（参考System R的取值）
+ *
+ * @param cond 条件
+ * @return double
+ */
+static double default_selectivity(const Condition &cond) {
+    switch (cond.op) {
+        case OP_EQ: return 0.1;
+        case OP_NE: return 0.9;
+        default: return 1.0 / 3;
+    }
+}
+
+/**
+ * @brief 估计表中的记录数：优先使用无条件扫描的执行反馈，其次使用块采样，最后按数据页容量估计
+ *
+ * @param tab_name 表名
+ * @return double
+ */
+double Planner::estimate_table_rows(const std::string &tab_name) {
+    double rows;
+    if (feedback_.lookup(CardinalityFeedback::scan_key(tab_name, {}), &rows)) {
+        return rows;
+    }
+    RmSampleStats stats;
+    if (sampler_.estimate(tab_name, {}, SAMPLE_PLAN_BUDGET, &stats)) {
+        return stats.est_records();
+    }
+    RmFileHdr hdr = sm_manager_->fhs_.at(tab_name)->get_file_hdr();
+    return static_cast<double>(std::max(hdr.num_pages - 1, 0)) * hdr.num_records_per_page;
+}
+
+/**
+ * @brief 为扫描算子生成谓词签名并估计基数，签名命中时直接使用观测到的基数，
+ *        否则在规划时间预算内对表做块采样，采样失败才使用默认选择率
+ *
+ * @param scan 扫描算子
+ */
+void Planner::estimate_scan(const std::shared_ptr<ScanPlan> &scan) {
+    if (scan->always_false_) {
+        scan->feedback_key_.clear();
+        scan->est_rows_ = 0;
+        return;
+    }
+    scan->feedback_key_ = CardinalityFeedback::scan_key(scan->tab_name_, scan->conds_);
+    if (feedback_.lookup(scan->feedback_key_, &scan->est_rows_)) {
+        return;
+    }
+    RmSampleStats stats;
+    if (!scan->conds_.empty() && sampler_.estimate(scan->tab_name_, scan->conds_, SAMPLE_PLAN_BUDGET, &stats)) {
+        scan->est_rows_ = stats.est_records() * stats.selectivity();
+        return;
+    }
+    double rows = estimate_table_rows(scan->tab_name_);
+    for (auto &cond : scan->conds_) {
+        rows *= default_selectivity(cond);
+    }
+    scan->est_rows_ = rows;
+}
+
+/**
+ * @brief 自底向上为计划树中的连接算子生成签名并估计基数
+ *
+ * @param plan 计划树
+ */
+void Planner::estimate_plan(const std::shared_ptr<Plan> &plan) {
+    if (auto x = std::dynamic_pointer_cast<ScanPlan>(plan)) {
+        if (x->est_rows_ < 0) {
+            estimate_scan(x);
+        }
+    } else if (auto x = std::dynamic_pointer_cast<JoinPlan>(plan)) {
+        estimate_plan(x->left_);
+        estimate_plan(x->right_);
+        x->feedback_key_ = CardinalityFeedback::join_key(x->left_->feedback_key_, x->right_->feedback_key_, x->conds_);
+        if (!x->feedback_key_.empty() && feedback_.lookup(x->feedback_key_, &x->est_rows_)) {
+            return;
+        }
+        double rows = x->left_->est_rows_ * x->right_->est_rows_;
+        for (auto &cond : x->conds_) {
+            rows *= default_selectivity(cond);
+        }
+        x->est_rows_ = rows;
+    } else if (auto x = std::dynamic_pointer_cast<SortPlan>(plan)) {
+        estimate_plan(x->subplan_);
+        x->est_rows_ = x->subplan_->est_rows_;
+    }
+}
+
+/**
+ * @brief where条件在analyze中被化简为恒假时，扫描算子不读取任何记录，也不需要使用索引
+ *
+ * @param query 查询
+ * @param plan 扫描算子
+ */
+static void mark_always_false(const std::shared_ptr<Query> &query, const std::shared_ptr<Plan> &plan) {
+    if (query->always_false) {
+        auto scan = std::static_pointer_cast<ScanPlan>(plan);
+        scan->tag = T_SeqScan;
+        scan->always_false_ = true;
+    }
+}
+
 /**
  * @brief 表算子条件谓词生成
  *
@@ -128,6 +234,7 @@ std::shared_ptr<Query> Planner::logical_optimization(std::shared_ptr<Query> quer
 std::shared_ptr<Plan> Planner::physical_optimization(std::shared_ptr<Query> query, Context *context)
 {
     std::shared_ptr<Plan> plan = make_one_rel(query);
+    estimate_plan(plan);
     
     // 其他物理优化
 
@@ -158,6 +265,8 @@ std::shared_ptr<Plan> Planner::make_one_rel(std::shared_ptr<Query> query)
             table_scan_executors[i] =
                 std::make_shared<ScanPlan>(T_IndexScan, sm_manager_, tables[i], curr_conds, index_col_names);
         }
+        mark_always_false(query, table_scan_executors[i]);
+        estimate_scan(std::static_pointer_cast<ScanPlan>(table_scan_executors[i]));
     }
     // 只有一个表，不需要join。
     if(tables.size() == 1)
@@ -185,6 +294,10 @@ std::shared_ptr<Plan> Planner::make_one_rel(std::shared_ptr<Query> query)
             std::shared_ptr<Plan> left , right;
             left = pop_scan(scantbl, it->lhs_col.tab_name, joined_tables, table_scan_executors);
             right = pop_scan(scantbl, it->rhs_col.tab_name, joined_tables, table_scan_executors);
+            // nested loop join以左儿子为外表，估计基数较小的一侧作为外表
+            if (left != nullptr && right != nullptr && left->est_rows_ > right->est_rows_) {
+                std::swap(left, right);
+            }
             std::vector<Condition> join_conds{*it};
             //建立join
             // 判断使用哪种join方式
@@ -353,6 +466,8 @@ std::shared_ptr<Plan> Planner::do_planner(std::shared_ptr<Query> query, Context
             table_scan_executors =
                 std::make_shared<ScanPlan>(T_IndexScan, sm_manager_, x->tab_name, query->conds, index_col_names);
         }
+        mark_always_false(query, table_scan_executors);
+        estimate_scan(std::static_pointer_cast<ScanPlan>(table_scan_executors));
 
         plannerRoot = std::make_shared<DMLPlan>(T_Delete, table_scan_executors, x->tab_name,  
                                                 std::vector<Value>(), query->conds, std::vector<SetClause>());
@@ -373,6 +488,8 @@ std::shared_ptr<Plan> Planner::do_planner(std::shared_ptr<Query> query, Context
             table_scan_executors =
                 std::make_shared<ScanPlan>(T_IndexScan, sm_manager_, x->tab_name, query->conds, index_col_names);
         }
+        mark_always_false(query, table_scan_executors);
+        estimate_scan(std::static_pointer_cast<ScanPlan>(table_scan_executors));
         plannerRoot = std::make_shared<DMLPlan>(T_Update, table_scan_executors, x->tab_name,
                                                      std::vector<Value>(), query->conds, 
                                                      query->set_clauses);
@@ -22,6 +22,8 @@ See the Mulan PSL v2 for more details. */
 #include "system/sm.h"
 #include "common/context.h"
 #include "plan.h"
+#include "cardinality_feedback.h"
+#include "selectivity_sampler.h"
 #include "parser/parser.h"
 #include "common/common.h"
 #include "analyze/analyze.h"
@@ -32,9 +34,13 @@ class Planner {
 
     bool enable_nestedloop_join = true;
     bool enable_sortmerge_join = false;
+    bool enable_index_scan = true;      // 只读副本上索引没有随日志重放更新，不能使用索引扫描
+
+    CardinalityFeedback feedback_;      // 执行反馈得到的实际基数，按谓词签名缓存
+    SelectivitySampler sampler_;        // 没有执行反馈时，通过块采样估计选择率
 
    public:
-    Planner(SmManager *sm_manager) : sm_manager_(sm_manager) {}
+    Planner(SmManager *sm_manager) : sm_manager_(sm_manager), sampler_(sm_manager) {}
 
 
     std::shared_ptr<Plan> do_planner(std::shared_ptr<Query> query, Context *context);
@@ -42,6 +48,12 @@ class Planner {
     void set_enable_nestedloop_join(bool set_val) { enable_nestedloop_join = set_val; }
     
     void set_enable_sortmerge_join(bool set_val) { enable_sortmerge_join = set_val; }
+
+    void set_enable_index_scan(bool set_val) { enable_index_scan = set_val; }
+
+    CardinalityFeedback *get_feedback() { return &feedback_; }
+
+    SelectivitySampler *get_sampler() { return &sampler_; }
     
    private:
     std::shared_ptr<Query> logical_optimization(std::shared_ptr<Query> query, Context *context);
@@ -57,6 +69,11 @@ class Planner {
     // int get_indexNo(std::string tab_name, std::vector<Condition> curr_conds);
     bool get_index_cols(std::string tab_name, std::vector<Condition> curr_conds, std::vector<std::string>& index_col_names);
 
+    // 基数估计
+    double estimate_table_rows(const std::string &tab_name);
+    void estimate_scan(const std::shared_ptr<ScanPlan> &scan);
+    void estimate_plan(const std::shared_ptr<Plan> &plan);
+
     ColType interp_sv_type(ast::SvType sv_type) {
         std::map<ast::SvType, ColType> m = {
             {ast::SV_TYPE_INT, TYPE_INT}, {ast::SV_TYPE_FLOAT, TYPE_FLOAT}, {ast::SV_TYPE_STRING, TYPE_STRING}};
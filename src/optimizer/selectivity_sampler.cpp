@@ -0,0 +1,136 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "selectivity_sampler.h"
+
+#include <algorithm>
+
+#include "execution/executor_abstract.h"
+
+/**
+ * @description: 估计谓词在表上的选择率，优先使用相同形状谓词的缓存结果，未命中时在时间预算内采样；
+ * 没有得到有效结果（例如空表）也缓存，表被修改之前不再重复采样
+ * @return {bool} 得到有效的采样结果返回true
+ * @param {string} &tab_name 表名
+ * @param {vector<Condition>} &conds 只涉及该表的条件，为空时只估计表的记录数
+ * @param {microseconds} budget 采样的时间预算
+ * @param {RmSampleStats} *stats 输出参数
+ */
+bool SelectivitySampler::estimate(const std::string &tab_name, const std::vector<Condition> &conds,
+                                  std::chrono::microseconds budget, RmSampleStats *stats) {
+    std::string key = shape_key(tab_name, conds);
+    {
+        std::scoped_lock lock{latch_};
+        auto tab_it = cache_.find(tab_name);
+        if (tab_it != cache_.end()) {
+            auto it = tab_it->second.stats.find(key);
+            if (it != tab_it->second.stats.end()) {
+                *stats = it->second;
+                return stats->valid();
+            }
+        }
+    }
+    *stats = do_sample(tab_name, conds, sample_fraction_, budget);
+    put(tab_name, key, *stats);
+    return stats->valid();
+}
+
+/**
+ * @description: ANALYZE入口，丢弃表的旧采样结果，以更大的采样比例和时间预算重新采样
+ * @return {RmSampleStats} 采样结果
+ */
+RmSampleStats SelectivitySampler::analyze(const std::string &tab_name, const std::vector<Condition> &conds) {
+    invalidate(tab_name);
+    RmSampleStats stats = do_sample(tab_name, conds, ANALYZE_PAGE_FRACTION, SAMPLE_ANALYZE_BUDGET);
+    put(tab_name, shape_key(tab_name, conds), stats);
+    return stats;
+}
+
+/**
+ * @description: 使某张表的所有采样结果失效
+ */
+void SelectivitySampler::invalidate(const std::string &tab_name) {
+    std::scoped_lock lock{latch_};
+    auto it = cache_.find(tab_name);
+    if (it != cache_.end()) {
+        num_entries_ -= it->second.stats.size();
+        cache_.erase(it);
+    }
+}
+
+/**
+ * @description: DML执行后累计表的修改量，超过采样时记录数的SAMPLE_STALE_FRACTION后该表的采样结果失效
+ * @param {string} &tab_name 表名
+ * @param {size_t} num_rows 插入、删除或更新的记录数
+ */
+void SelectivitySampler::note_modified(const std::string &tab_name, size_t num_rows) {
+    std::scoped_lock lock{latch_};
+    auto it = cache_.find(tab_name);
+    if (it == cache_.end()) {
+        return;
+    }
+    TableEntry &entry = it->second;
+    entry.modified_rows += num_rows;
+    if (entry.modified_rows > entry.num_records * SAMPLE_STALE_FRACTION) {
+        num_entries_ -= entry.stats.size();
+        cache_.erase(it);
+    }
+}
+
+/**
+ * @description: 生成谓词的形状签名，只包含列和比较运算符，常量替换为'?'，条件排序后拼接
+ */
+std::string SelectivitySampler::shape_key(const std::string &tab_name, const std::vector<Condition> &conds) {
+    static const char *op_str[] = {"=", "<>", "<", ">", "<=", ">="};
+    std::vector<std::string> cond_strs;
+    cond_strs.reserve(conds.size());
+    for (auto &cond : conds) {
+        std::string str = cond.lhs_col.col_name + op_str[cond.op];
+        str += cond.is_rhs_val ? "?" : cond.rhs_col.col_name;
+        cond_strs.push_back(std::move(str));
+    }
+    std::sort(cond_strs.begin(), cond_strs.end());
+    std::string key = tab_name;
+    for (auto &str : cond_strs) {
+        key += "|" + str;
+    }
+    return key;
+}
+
+RmSampleStats SelectivitySampler::do_sample(const std::string &tab_name, const std::vector<Condition> &conds,
+                                            double fraction, std::chrono::microseconds budget) {
+    auto fh_it = sm_manager_->fhs_.find(tab_name);
+    if (fh_it == sm_manager_->fhs_.end()) {
+        return RmSampleStats();
+    }
+    const std::vector<ColMeta> &cols = sm_manager_->db_.get_table(tab_name).cols;
+    RmSampler sampler(fh_it->second.get(), fraction, SAMPLE_MIN_PAGES);
+    if (conds.empty()) {
+        return sampler.sample(nullptr, budget);
+    }
+    return sampler.sample([&](const RmRecord &rec) { return AbstractExecutor::eval_conds(cols, conds, &rec); },
+                          budget);
+}
+
+void SelectivitySampler::put(const std::string &tab_name, const std::string &key, const RmSampleStats &stats) {
+    std::scoped_lock lock{latch_};
+    if (num_entries_ >= SAMPLE_CACHE_SIZE) {
+        cache_.clear();
+        num_entries_ = 0;
+    }
+    TableEntry &entry = cache_[tab_name];
+    if (entry.stats.empty()) {
+        entry.num_records = stats.est_records();
+    }
+    if (entry.stats.find(key) == entry.stats.end()) {
+        num_entries_++;
+    }
+    entry.stats[key] = stats;
+}
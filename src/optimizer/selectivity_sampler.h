@@ -0,0 +1,73 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "common/common.h"
+#include "record/rm.h"
+#include "system/sm.h"
+
+static constexpr double SAMPLE_PAGE_FRACTION = 0.02;          // 规划时采样的数据页比例
+static constexpr double ANALYZE_PAGE_FRACTION = 0.2;          // ANALYZE采样的数据页比例
+static constexpr int SAMPLE_MIN_PAGES = 16;                   // 最少采样的页面数
+static constexpr size_t SAMPLE_CACHE_SIZE = 4096;             // 采样结果缓存的最大条目数
+static constexpr double SAMPLE_STALE_FRACTION = 0.1;          // 采样后修改的记录数超过表记录数的这一比例时，采样结果失效
+static constexpr std::chrono::microseconds SAMPLE_PLAN_BUDGET{2000};        // 规划时单次采样的时间预算
+static constexpr std::chrono::microseconds SAMPLE_ANALYZE_BUDGET{5000000};  // ANALYZE单次采样的时间预算
+
+/**
+ * @description: 基于块采样的选择率估计
+ * 对没有统计信息的谓词，在表数据文件上随机采样部分页面，直接在采样记录上求谓词得到选择率；
+ * 结果按谓词的形状（列和比较运算符，不含常量）缓存，只有常量不同的谓词共用一次采样。
+ * 规划器在估计基数时以较小的时间预算调用estimate()，ANALYZE以更大的采样比例调用analyze()刷新缓存；
+ * DML执行后通过note_modified()累计表的修改量，修改量超过采样时记录数的一定比例、或者DDL改变表后，该表的缓存失效。
+ */
+class SelectivitySampler {
+   public:
+    explicit SelectivitySampler(SmManager *sm_manager) : sm_manager_(sm_manager) {}
+
+    void set_sample_fraction(double fraction) { sample_fraction_ = fraction; }
+
+    bool estimate(const std::string &tab_name, const std::vector<Condition> &conds,
+                  std::chrono::microseconds budget, RmSampleStats *stats);
+
+    RmSampleStats analyze(const std::string &tab_name, const std::vector<Condition> &conds = {});
+
+    void invalidate(const std::string &tab_name);
+
+    void note_modified(const std::string &tab_name, size_t num_rows);
+
+    static std::string shape_key(const std::string &tab_name, const std::vector<Condition> &conds);
+
+   private:
+    RmSampleStats do_sample(const std::string &tab_name, const std::vector<Condition> &conds, double fraction,
+                            std::chrono::microseconds budget);
+
+    void put(const std::string &tab_name, const std::string &key, const RmSampleStats &stats);
+
+    SmManager *sm_manager_;
+    double sample_fraction_ = SAMPLE_PAGE_FRACTION;
+    std::mutex latch_;
+    size_t num_entries_ = 0;
+
+    struct TableEntry {
+        double num_records = 0;     // 第一次采样时估计的表记录数
+        size_t modified_rows = 0;   // 采样之后DML修改的记录数
+        std::unordered_map<std::string, RmSampleStats> stats;   // 谓词形状 -> 采样结果
+    };
+    // 表名 -> 该表的采样结果，按表组织便于表数据变化后整体失效
+    std::unordered_map<std::string, TableEntry> cache_;
+};
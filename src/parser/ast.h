@@ -33,7 +33,7 @@ enum OrderByDir {
 };
 
 enum SetKnobType {
-    EnableNestLoop, EnableSortMerge
+    EnableNestLoop, EnableSortMerge, SynchronousCommit, StatementTimeout
 };
 
 // Base class for tree nodes
@@ -47,6 +47,37 @@ struct Help : public TreeNode {
 struct ShowTables : public TreeNode {
 };
 
+struct ShowReplication : public TreeNode {
+};
+
+struct ShowSessions : public TreeNode {
+};
+
+// cancel <session id>
+struct CancelStmt : public TreeNode {
+    int session_id;
+
+    CancelStmt(int session_id_) : session_id(session_id_) {}
+};
+
+// analyze <table>
+struct AnalyzeStmt : public TreeNode {
+    std::string tab_name;
+
+    AnalyzeStmt(std::string tab_name_) : tab_name(std::move(tab_name_)) {}
+};
+
+// backup to '<dir>'
+struct BackupStmt : public TreeNode {
+    std::string dir;
+
+    BackupStmt(std::string dir_) : dir(std::move(dir_)) {}
+};
+
+// checkpoint
+struct CheckpointStmt : public TreeNode {
+};
+
 struct TxnBegin : public TreeNode {
 };
 
@@ -143,6 +174,22 @@ struct BoolLit : public Value {
     BoolLit(bool val_) : val(val_) {}
 };
 
+// 存储过程中的变量，未加表名的列名与变量同名时也作为变量
+struct VarRef : public Value {
+    std::string name;
+
+    VarRef(std::string name_) : name(std::move(name_)) {}
+};
+
+// 存储过程中的内置函数add/sub/mul，参数为常量、变量或者函数
+struct FuncCall : public Value {
+    std::string func_name;
+    std::vector<std::shared_ptr<Value>> args;
+
+    FuncCall(std::string func_name_, std::vector<std::shared_ptr<Value>> args_) :
+            func_name(std::move(func_name_)), args(std::move(args_)) {}
+};
+
 struct Col : public Expr {
     std::string tab_name;
     std::string col_name;
@@ -160,11 +207,11 @@ struct SetClause : public TreeNode {
 };
 
 struct BinaryExpr : public TreeNode {
-    std::shared_ptr<Col> lhs;
+    std::shared_ptr<Expr> lhs;      // 列或常量，常量在左侧的条件由analyze规范化为列在左侧
     SvCompOp op;
     std::shared_ptr<Expr> rhs;
 
-    BinaryExpr(std::shared_ptr<Col> lhs_, SvCompOp op_, std::shared_ptr<Expr> rhs_) :
+    BinaryExpr(std::shared_ptr<Expr> lhs_, SvCompOp op_, std::shared_ptr<Expr> rhs_) :
             lhs(std::move(lhs_)), op(op_), rhs(std::move(rhs_)) {}
 };
 
@@ -235,13 +282,73 @@ struct SelectStmt : public TreeNode {
             }
 };
 
-// set enable_nestloop
+// 存储过程中的select ... into var [, var ...] from ...，把第一行结果赋给变量
+struct SelectInto : public TreeNode {
+    std::shared_ptr<SelectStmt> select;
+    std::vector<std::string> vars;
+
+    SelectInto(std::shared_ptr<SelectStmt> select_, std::vector<std::string> vars_) :
+            select(std::move(select_)), vars(std::move(vars_)) {}
+};
+
+// 存储过程中的set var = value
+struct AssignStmt : public TreeNode {
+    std::string var;
+    std::shared_ptr<Value> val;
+
+    AssignStmt(std::string var_, std::shared_ptr<Value> val_) : var(std::move(var_)), val(std::move(val_)) {}
+};
+
+// 存储过程中的for var [, var ...] in (select ...) begin ... end，对查询结果的每一行执行一次循环体
+struct ForLoop : public TreeNode {
+    std::vector<std::string> vars;
+    std::shared_ptr<SelectStmt> select;
+    std::vector<std::shared_ptr<TreeNode>> body;
+
+    ForLoop(std::vector<std::string> vars_, std::shared_ptr<SelectStmt> select_,
+            std::vector<std::shared_ptr<TreeNode>> body_) :
+            vars(std::move(vars_)), select(std::move(select_)), body(std::move(body_)) {}
+};
+
+// create procedure name (param type, ...) begin ... end
+struct CreateProcedure : public TreeNode {
+    std::string proc_name;
+    std::vector<std::shared_ptr<Field>> params;
+    std::vector<std::shared_ptr<TreeNode>> body;
+    std::string source;     // 语句原文，用于持久化
+
+    CreateProcedure(std::string proc_name_, std::vector<std::shared_ptr<Field>> params_,
+                    std::vector<std::shared_ptr<TreeNode>> body_) :
+            proc_name(std::move(proc_name_)), params(std::move(params_)), body(std::move(body_)) {}
+};
+
+// drop procedure name
+struct DropProcedure : public TreeNode {
+    std::string proc_name;
+
+    DropProcedure(std::string proc_name_) : proc_name(std::move(proc_name_)) {}
+};
+
+// call name (value, ...)
+struct CallProcedure : public TreeNode {
+    std::string proc_name;
+    std::vector<std::shared_ptr<Value>> args;
+
+    CallProcedure(std::string proc_name_, std::vector<std::shared_ptr<Value>> args_) :
+            proc_name(std::move(proc_name_)), args(std::move(args_)) {}
+};
+
+// set enable_nestloop / set synchronous_commit / set statement_timeout
 struct SetStmt : public TreeNode {
     SetKnobType set_knob_type_;
     bool bool_val_;
+    int int_val_ = 0;
 
     SetStmt(SetKnobType &type, bool bool_value) : 
         set_knob_type_(type), bool_val_(bool_value) { }
+
+    SetStmt(SetKnobType type, int int_value) :
+        set_knob_type_(type), bool_val_(false), int_val_(int_value) { }
 };
 
 // Semantic value
@@ -254,6 +361,7 @@ struct SemValue {
     std::vector<std::string> sv_strs;
 
     std::shared_ptr<TreeNode> sv_node;
+    std::vector<std::shared_ptr<TreeNode>> sv_nodes;
 
     SvCompOp sv_comp_op;
 
@@ -79,6 +79,21 @@ private:
             std::cout << "HELP\n";
         } else if (auto x = std::dynamic_pointer_cast<ShowTables>(node)) {
             std::cout << "SHOW_TABLES\n";
+        } else if (auto x = std::dynamic_pointer_cast<ShowReplication>(node)) {
+            std::cout << "SHOW_REPLICATION\n";
+        } else if (auto x = std::dynamic_pointer_cast<ShowSessions>(node)) {
+            std::cout << "SHOW_SESSIONS\n";
+        } else if (auto x = std::dynamic_pointer_cast<CancelStmt>(node)) {
+            std::cout << "CANCEL\n";
+            print_val(x->session_id, offset);
+        } else if (auto x = std::dynamic_pointer_cast<AnalyzeStmt>(node)) {
+            std::cout << "ANALYZE\n";
+            print_val(x->tab_name, offset);
+        } else if (auto x = std::dynamic_pointer_cast<BackupStmt>(node)) {
+            std::cout << "BACKUP\n";
+            print_val(x->dir, offset);
+        } else if (auto x = std::dynamic_pointer_cast<CheckpointStmt>(node)) {
+            std::cout << "CHECKPOINT\n";
         } else if (auto x = std::dynamic_pointer_cast<CreateTable>(node)) {
             std::cout << "CREATE_TABLE\n";
             print_val(x->tab_name, offset);
@@ -122,6 +137,13 @@ private:
         } else if (auto x = std::dynamic_pointer_cast<StringLit>(node)) {
             std::cout << "STRING_LIT\n";
             print_val(x->val, offset);
+        } else if (auto x = std::dynamic_pointer_cast<VarRef>(node)) {
+            std::cout << "VAR_REF\n";
+            print_val(x->name, offset);
+        } else if (auto x = std::dynamic_pointer_cast<FuncCall>(node)) {
+            std::cout << "FUNC_CALL\n";
+            print_val(x->func_name, offset);
+            print_node_list(x->args, offset);
         } else if (auto x = std::dynamic_pointer_cast<SetClause>(node)) {
             std::cout << "SET_CLAUSE\n";
             print_val(x->col_name, offset);
@@ -149,6 +171,31 @@ private:
             print_node_list(x->cols, offset);
             print_val_list(x->tabs, offset);
             print_node_list(x->conds, offset);
+        } else if (auto x = std::dynamic_pointer_cast<SelectInto>(node)) {
+            std::cout << "SELECT_INTO\n";
+            print_node(x->select, offset);
+            print_val_list(x->vars, offset);
+        } else if (auto x = std::dynamic_pointer_cast<AssignStmt>(node)) {
+            std::cout << "ASSIGN\n";
+            print_val(x->var, offset);
+            print_node(x->val, offset);
+        } else if (auto x = std::dynamic_pointer_cast<ForLoop>(node)) {
+            std::cout << "FOR\n";
+            print_val_list(x->vars, offset);
+            print_node(x->select, offset);
+            print_node_list(x->body, offset);
+        } else if (auto x = std::dynamic_pointer_cast<CreateProcedure>(node)) {
+            std::cout << "CREATE_PROCEDURE\n";
+            print_val(x->proc_name, offset);
+            print_node_list(x->params, offset);
+            print_node_list(x->body, offset);
+        } else if (auto x = std::dynamic_pointer_cast<DropProcedure>(node)) {
+            std::cout << "DROP_PROCEDURE\n";
+            print_val(x->proc_name, offset);
+        } else if (auto x = std::dynamic_pointer_cast<CallProcedure>(node)) {
+            std::cout << "CALL\n";
+            print_val(x->proc_name, offset);
+            print_node_list(x->args, offset);
         } else if (auto x = std::dynamic_pointer_cast<TxnBegin>(node)) {
             std::cout << "BEGIN\n";
         } else if (auto x = std::dynamic_pointer_cast<TxnCommit>(node)) {
@@ -157,6 +204,13 @@ private:
             std::cout << "ABORT\n";
         } else if (auto x = std::dynamic_pointer_cast<TxnRollback>(node)) {
             std::cout << "ROLLBACK\n";
+        } else if (auto x = std::dynamic_pointer_cast<SetStmt>(node)) {
+            std::cout << "SET\n";
+            print_val(x->set_knob_type_, offset);
+            print_val(x->bool_val_, offset);
+            if (x->set_knob_type_ == StatementTimeout) {
+                print_val(x->int_val_, offset);
+            }
         } else {
             assert(0);
         }
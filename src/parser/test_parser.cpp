@@ -16,6 +16,8 @@ See the Mulan PSL v2 for more details. */
 int main() {
     std::vector<std::string> sqls = {
         "show tables;",
+        "show replication;",
+        "backup to 'backup_dir';",
         "desc tb;",
         "create table tb (a int, b float, c char(4));",
         "drop table tb;",
@@ -26,10 +28,26 @@ int main() {
         "insert into tb values (1, 3.14, 'pi');",
         "delete from tb where a = 1;",
         "update tb set a = 1, b = 2.2, c = 'xyz' where x = 2 and y < 1.1 and z > 'abc';",
+        "set synchronous_commit = off;",
+        "set statement_timeout = 500;",
+        "show sessions;",
+        "cancel 3;",
         "select * from tb;",
         "select * from tb where x <> 2 and y >= 3. and z <= '123' and b < tb.a;",
         "select x.a, y.b from x, y where x.a = y.b and c = d;",
         "select x.a, y.b from x join y where x.a = y.b and c = d;",
+        "create procedure p (w int, name char(8)) begin "
+        "select d_next into next from d where d_w = w; "
+        "update d set d_next = add(next, 1) where d_w = w; "
+        "for i, q in (select i_id, qty from line where l_w = w) begin "
+        "insert into ol values (next, i, mul(q, 1.5), name); "
+        "end; "
+        "set total = sub(next, 1); "
+        "select * from ol where ol_o = total; "
+        "end;",
+        "call p (1, 'abc');",
+        "call q ();",
+        "drop procedure p;",
         "exit;",
         "help;",
         "",
@@ -67,12 +67,13 @@
 
 
 /* First part of user prologue.  */
-#line 1 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.y"
+#line 1 "/root/repo/src/parser/yacc.y"
 
 #include "ast.h"
 #include "yacc.tab.h"
 #include <iostream>
 #include <memory>
+#include <strings.h>
 
 int yylex(YYSTYPE *yylval, YYLTYPE *yylloc);
 
@@ -82,7 +83,7 @@ void yyerror(YYLTYPE *locp, const char* s) {
 
 using namespace ast;
 
-#line 86 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.tab.cpp"
+#line 87 "/root/repo/src/parser/yacc.tab.cpp"
 
 # ifndef YY_CAST
 #  ifdef __cplusplus
@@ -156,9 +157,9 @@ enum yysymbol_kind_t
   YYSYMBOL_VALUE_FLOAT = 43,               /* VALUE_FLOAT  */
   YYSYMBOL_VALUE_BOOL = 44,                /* VALUE_BOOL  */
   YYSYMBOL_45_ = 45,                       /* ';'  */
-  YYSYMBOL_46_ = 46,                       /* '='  */
-  YYSYMBOL_47_ = 47,                       /* '('  */
-  YYSYMBOL_48_ = 48,                       /* ')'  */
+  YYSYMBOL_46_ = 46,                       /* '('  */
+  YYSYMBOL_47_ = 47,                       /* ')'  */
+  YYSYMBOL_48_ = 48,                       /* '='  */
   YYSYMBOL_49_ = 49,                       /* ','  */
   YYSYMBOL_50_ = 50,                       /* '.'  */
   YYSYMBOL_51_ = 51,                       /* '<'  */
@@ -169,32 +170,39 @@ enum yysymbol_kind_t
   YYSYMBOL_stmt = 56,                      /* stmt  */
   YYSYMBOL_txnStmt = 57,                   /* txnStmt  */
   YYSYMBOL_dbStmt = 58,                    /* dbStmt  */
-  YYSYMBOL_setStmt = 59,                   /* setStmt  */
-  YYSYMBOL_ddl = 60,                       /* ddl  */
-  YYSYMBOL_dml = 61,                       /* dml  */
-  YYSYMBOL_fieldList = 62,                 /* fieldList  */
-  YYSYMBOL_colNameList = 63,               /* colNameList  */
-  YYSYMBOL_field = 64,                     /* field  */
-  YYSYMBOL_type = 65,                      /* type  */
-  YYSYMBOL_valueList = 66,                 /* valueList  */
-  YYSYMBOL_value = 67,                     /* value  */
-  YYSYMBOL_condition = 68,                 /* condition  */
-  YYSYMBOL_optWhereClause = 69,            /* optWhereClause  */
-  YYSYMBOL_whereClause = 70,               /* whereClause  */
-  YYSYMBOL_col = 71,                       /* col  */
-  YYSYMBOL_colList = 72,                   /* colList  */
-  YYSYMBOL_op = 73,                        /* op  */
-  YYSYMBOL_expr = 74,                      /* expr  */
-  YYSYMBOL_setClauses = 75,                /* setClauses  */
-  YYSYMBOL_setClause = 76,                 /* setClause  */
-  YYSYMBOL_selector = 77,                  /* selector  */
-  YYSYMBOL_tableList = 78,                 /* tableList  */
-  YYSYMBOL_opt_order_clause = 79,          /* opt_order_clause  */
-  YYSYMBOL_order_clause = 80,              /* order_clause  */
-  YYSYMBOL_opt_asc_desc = 81,              /* opt_asc_desc  */
-  YYSYMBOL_set_knob_type = 82,             /* set_knob_type  */
-  YYSYMBOL_tbName = 83,                    /* tbName  */
-  YYSYMBOL_colName = 84                    /* colName  */
+  YYSYMBOL_procBlock = 59,                 /* procBlock  */
+  YYSYMBOL_procStmts = 60,                 /* procStmts  */
+  YYSYMBOL_procStmt = 61,                  /* procStmt  */
+  YYSYMBOL_setStmt = 62,                   /* setStmt  */
+  YYSYMBOL_ddl = 63,                       /* ddl  */
+  YYSYMBOL_dml = 64,                       /* dml  */
+  YYSYMBOL_fieldList = 65,                 /* fieldList  */
+  YYSYMBOL_colNameList = 66,               /* colNameList  */
+  YYSYMBOL_field = 67,                     /* field  */
+  YYSYMBOL_type = 68,                      /* type  */
+  YYSYMBOL_optFieldList = 69,              /* optFieldList  */
+  YYSYMBOL_valueList = 70,                 /* valueList  */
+  YYSYMBOL_optValueList = 71,              /* optValueList  */
+  YYSYMBOL_procValue = 72,                 /* procValue  */
+  YYSYMBOL_value = 73,                     /* value  */
+  YYSYMBOL_condition = 74,                 /* condition  */
+  YYSYMBOL_optWhereClause = 75,            /* optWhereClause  */
+  YYSYMBOL_whereClause = 76,               /* whereClause  */
+  YYSYMBOL_col = 77,                       /* col  */
+  YYSYMBOL_colList = 78,                   /* colList  */
+  YYSYMBOL_op = 79,                        /* op  */
+  YYSYMBOL_expr = 80,                      /* expr  */
+  YYSYMBOL_setClauses = 81,                /* setClauses  */
+  YYSYMBOL_setClause = 82,                 /* setClause  */
+  YYSYMBOL_selector = 83,                  /* selector  */
+  YYSYMBOL_tableList = 84,                 /* tableList  */
+  YYSYMBOL_opt_order_clause = 85,          /* opt_order_clause  */
+  YYSYMBOL_order_clause = 86,              /* order_clause  */
+  YYSYMBOL_opt_asc_desc = 87,              /* opt_asc_desc  */
+  YYSYMBOL_set_knob_type = 88,             /* set_knob_type  */
+  YYSYMBOL_knob_value = 89,                /* knob_value  */
+  YYSYMBOL_tbName = 90,                    /* tbName  */
+  YYSYMBOL_colName = 91                    /* colName  */
 };
 typedef enum yysymbol_kind_t yysymbol_kind_t;
 
@@ -523,18 +531,18 @@ union yyalloc
 #endif /* !YYCOPY_NEEDED */
 
 /* YYFINAL -- State number of the termination state.  */
-#define YYFINAL  44
+#define YYFINAL  52
 /* YYLAST -- Last index in YYTABLE.  */
-#define YYLAST   118
+#define YYLAST   200
 
 /* YYNTOKENS -- Number of terminals.  */
 #define YYNTOKENS  54
 /* YYNNTS -- Number of nonterminals.  */
-#define YYNNTS  31
+#define YYNNTS  38
 /* YYNRULES -- Number of rules.  */
-#define YYNRULES  74
+#define YYNRULES  100
 /* YYNSTATES -- Number of states.  */
-#define YYNSTATES  135
+#define YYNSTATES  197
 
 /* YYMAXUTOK -- Last valid token kind.  */
 #define YYMAXUTOK   299
@@ -555,9 +563,9 @@ static const yytype_int8 yytranslate[] =
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
-      47,    48,    53,     2,    49,     2,    50,     2,     2,     2,
+      46,    47,    53,     2,    49,     2,    50,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,    45,
-      51,    46,    52,     2,     2,     2,     2,     2,     2,     2,
+      51,    48,    52,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
@@ -587,14 +595,17 @@ static const yytype_int8 yytranslate[] =
 /* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
 static const yytype_int16 yyrline[] =
 {
-       0,    58,    58,    63,    68,    73,    81,    82,    83,    84,
-      85,    89,    93,    97,   101,   108,   115,   122,   126,   130,
-     134,   138,   145,   149,   153,   157,   164,   168,   175,   179,
-     186,   193,   197,   201,   208,   212,   219,   223,   227,   231,
-     238,   245,   246,   253,   257,   264,   268,   275,   279,   286,
-     290,   294,   298,   302,   306,   313,   317,   324,   328,   335,
-     342,   346,   350,   354,   358,   365,   369,   373,   380,   381,
-     382,   386,   387,   390,   392
+       0,    61,    61,    66,    71,    76,    84,    85,    86,    87,
+      88,    92,    96,   100,   104,   111,   115,   126,   134,   142,
+     150,   158,   166,   174,   185,   196,   200,   207,   208,   212,
+     216,   227,   231,   240,   255,   259,   263,   267,   271,   278,
+     282,   286,   290,   297,   301,   308,   312,   319,   326,   330,
+     334,   341,   342,   346,   350,   357,   358,   362,   363,   367,
+     374,   378,   382,   386,   393,   400,   401,   408,   412,   419,
+     423,   430,   434,   441,   445,   449,   453,   457,   461,   468,
+     472,   479,   483,   490,   497,   501,   505,   509,   513,   520,
+     524,   528,   535,   536,   537,   541,   542,   546,   547,   560,
+     562
 };
 #endif
 
@@ -616,13 +627,15 @@ static const char *const yytname[] =
   "CHAR", "FLOAT", "INDEX", "AND", "JOIN", "EXIT", "HELP", "TXN_BEGIN",
   "TXN_COMMIT", "TXN_ABORT", "TXN_ROLLBACK", "ORDER_BY", "ENABLE_NESTLOOP",
   "ENABLE_SORTMERGE", "LEQ", "NEQ", "GEQ", "T_EOF", "IDENTIFIER",
-  "VALUE_STRING", "VALUE_INT", "VALUE_FLOAT", "VALUE_BOOL", "';'", "'='",
-  "'('", "')'", "','", "'.'", "'<'", "'>'", "'*'", "$accept", "start",
-  "stmt", "txnStmt", "dbStmt", "setStmt", "ddl", "dml", "fieldList",
-  "colNameList", "field", "type", "valueList", "value", "condition",
-  "optWhereClause", "whereClause", "col", "colList", "op", "expr",
-  "setClauses", "setClause", "selector", "tableList", "opt_order_clause",
-  "order_clause", "opt_asc_desc", "set_knob_type", "tbName", "colName", YY_NULLPTR
+  "VALUE_STRING", "VALUE_INT", "VALUE_FLOAT", "VALUE_BOOL", "';'", "'('",
+  "')'", "'='", "','", "'.'", "'<'", "'>'", "'*'", "$accept", "start",
+  "stmt", "txnStmt", "dbStmt", "procBlock", "procStmts", "procStmt",
+  "setStmt", "ddl", "dml", "fieldList", "colNameList", "field", "type",
+  "optFieldList", "valueList", "optValueList", "procValue", "value",
+  "condition", "optWhereClause", "whereClause", "col", "colList", "op",
+  "expr", "setClauses", "setClause", "selector", "tableList",
+  "opt_order_clause", "order_clause", "opt_asc_desc", "set_knob_type",
+  "knob_value", "tbName", "colName", YY_NULLPTR
 };
 
 static const char *
@@ -632,34 +645,40 @@ yysymbol_name (yysymbol_kind_t yysymbol)
 }
 #endif
 
-#define YYPACT_NINF (-80)
+#define YYPACT_NINF (-153)
 
 #define yypact_value_is_default(Yyn) \
   ((Yyn) == YYPACT_NINF)
 
-#define YYTABLE_NINF (-74)
+#define YYTABLE_NINF (-100)
 
 #define yytable_value_is_error(Yyn) \
   0
 
 /* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
    STATE-NUM.  */
-static const yytype_int8 yypact[] =
+static const yytype_int16 yypact[] =
 {
-      29,     2,    11,    15,   -26,     6,    38,   -26,    -8,   -38,
-     -80,   -80,   -80,   -80,   -80,   -80,   -80,    18,   -15,   -80,
-     -80,   -80,   -80,   -80,   -80,   -26,   -26,   -26,   -26,   -80,
-     -80,   -26,   -26,    34,   -80,   -80,     8,    45,   -80,   -80,
-      47,    54,    49,   -80,   -80,   -80,    46,    50,   -80,    51,
-      70,    77,    60,    58,    63,   -26,    60,    60,    60,    60,
-      57,    63,   -80,   -80,    -5,   -80,    59,   -80,   -80,    -6,
-     -80,   -80,    17,   -80,    48,    31,   -80,    41,    32,   -80,
-      81,    26,    60,   -80,    32,   -26,   -26,    92,   -80,    60,
-     -80,    61,   -80,   -80,   -80,    60,   -80,   -80,   -80,   -80,
-     -80,    43,   -80,    63,   -80,   -80,   -80,   -80,   -80,   -80,
-      44,   -80,   -80,   -80,   -80,    93,   -80,   -80,    68,   -80,
-     -80,    32,   -80,   -80,   -80,   -80,    63,    64,   -80,     5,
-     -80,   -80,   -80,   -80,   -80
+     122,     0,    13,    15,   -32,    18,    50,   -32,    11,    -5,
+    -153,  -153,  -153,  -153,  -153,  -153,  -153,    41,    84,    63,
+    -153,  -153,  -153,  -153,  -153,  -153,  -153,   -32,   -32,    79,
+     -32,   -32,    88,  -153,  -153,   -32,   -32,    92,  -153,  -153,
+      76,    98,    82,  -153,  -153,    95,   134,   105,  -153,    25,
+    -153,  -153,  -153,  -153,   102,   110,   111,  -153,   112,  -153,
+     148,   143,   123,    65,    74,   124,   -32,   123,  -153,    55,
+     123,   123,   123,   123,   119,    60,  -153,  -153,     5,  -153,
+     118,  -153,  -153,  -153,  -153,  -153,  -153,    12,  -153,  -153,
+     121,  -153,  -153,  -153,  -153,   120,   125,  -153,  -153,    73,
+    -153,    70,    86,  -153,   126,   127,    89,    55,  -153,  -153,
+     145,  -153,    38,   123,  -153,    55,   -32,   -32,   153,    55,
+      55,  -153,  -153,   123,  -153,   130,  -153,  -153,  -153,   123,
+     142,  -153,    90,    60,  -153,  -153,  -153,  -153,  -153,  -153,
+      60,  -153,  -153,  -153,  -153,   157,  -153,    96,  -153,  -153,
+     135,  -153,    24,  -153,  -153,  -153,  -153,   124,  -153,   131,
+     139,    -5,   123,    40,   137,  -153,    71,  -153,  -153,   132,
+      37,    29,   123,   138,  -153,  -153,  -153,  -153,    55,   123,
+     141,  -153,  -153,    -8,   164,   -32,    -5,    12,   172,   153,
+     -32,  -153,    12,   153,   144,   142,  -153
 };
 
 /* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
@@ -668,37 +687,43 @@ static const yytype_int8 yypact[] =
 static const yytype_int8 yydefact[] =
 {
        0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
-       4,     3,    11,    12,    13,    14,     5,     0,     0,     9,
-       6,    10,     7,     8,    15,     0,     0,     0,     0,    73,
-      19,     0,     0,     0,    71,    72,     0,    74,    60,    47,
-      61,     0,     0,    46,     1,     2,     0,     0,    18,     0,
-       0,    41,     0,     0,     0,     0,     0,     0,     0,     0,
-       0,     0,    23,    74,    41,    57,     0,    16,    48,    41,
-      62,    45,     0,    26,     0,     0,    28,     0,     0,    43,
-      42,     0,     0,    24,     0,     0,     0,    66,    17,     0,
-      31,     0,    33,    30,    20,     0,    21,    38,    36,    37,
-      39,     0,    34,     0,    53,    52,    54,    49,    50,    51,
-       0,    58,    59,    64,    63,     0,    25,    27,     0,    29,
-      22,     0,    44,    55,    56,    40,     0,     0,    35,    70,
-      65,    32,    69,    68,    67
+       4,     3,    11,    12,    13,    14,     5,    23,     0,     0,
+       9,     6,    10,     7,     8,    15,    16,     0,     0,     0,
+       0,     0,     0,    99,    36,     0,     0,     0,    95,    96,
+       0,     0,   100,    84,    71,    85,     0,     0,    70,    99,
+      21,    22,     1,     2,     0,     0,     0,    35,     0,    19,
+       0,    65,     0,     0,     0,     0,     0,     0,    17,    55,
+       0,     0,    51,     0,     0,     0,    40,   100,    65,    81,
+       0,    98,    33,    97,    32,    31,    72,    65,    86,    69,
+      58,    62,    60,    61,    63,    56,     0,    53,    57,     0,
+      43,     0,     0,    45,    52,     0,     0,     0,    79,    67,
+      66,    80,     0,     0,    41,     0,     0,     0,    90,     0,
+       0,    20,    34,     0,    48,     0,    50,    47,    37,     0,
+       0,    38,     0,     0,    77,    76,    78,    73,    74,    75,
+       0,    82,    83,    88,    87,     0,    42,     0,    54,    44,
+       0,    46,     0,    18,    39,    68,    64,     0,    59,     0,
+       0,     0,     0,     0,     0,    27,    94,    89,    49,     0,
+       0,     0,    24,     0,    25,    93,    92,    91,     0,     0,
+       0,    26,    29,     0,     0,     0,     0,    65,     0,    90,
+       0,    28,    65,    90,     0,     0,    30
 };
 
 /* YYPGOTO[NTERM-NUM].  */
-static const yytype_int8 yypgoto[] =
+static const yytype_int16 yypgoto[] =
 {
-     -80,   -80,   -80,   -80,   -80,   -80,   -80,   -80,   -80,    52,
-      24,   -80,   -80,   -79,    12,   -14,   -80,    -9,   -80,   -80,
-     -80,   -80,    36,   -80,   -80,   -80,   -80,   -80,   -80,    -3,
-     -49
+    -153,  -153,  -153,  -153,  -153,    -7,  -153,    26,  -153,  -153,
+     190,   128,   -53,    69,  -153,  -153,   -51,  -153,   -90,   -68,
+      61,   -77,  -153,   -63,  -153,  -153,    53,  -153,    83,  -152,
+    -103,   -72,  -153,  -153,  -153,   133,    -4,   -56
 };
 
 /* YYDEFGOTO[NTERM-NUM].  */
 static const yytype_uint8 yydefgoto[] =
 {
-       0,    17,    18,    19,    20,    21,    22,    23,    72,    75,
-      73,    93,   101,   102,    79,    62,    80,    81,    40,   110,
-     125,    64,    65,    41,    69,   116,   130,   134,    36,    42,
-      43
+       0,    18,    19,    20,    21,   153,   163,   164,    22,    23,
+     165,    99,   171,   100,   127,   105,    95,    96,    97,    98,
+     109,    76,   110,    44,    45,   140,   112,    78,    79,    46,
+      87,   146,   167,   177,    41,    84,    47,    48
 };
 
 /* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
@@ -706,34 +731,52 @@ static const yytype_uint8 yydefgoto[] =
    number is the opposite.  If YYTABLE_NINF, syntax error.  */
 static const yytype_int16 yytable[] =
 {
-      39,    30,    37,    66,    33,   112,    24,    71,    74,    76,
-      76,    61,    61,   132,    29,    38,    31,    25,    44,   133,
-      85,    27,    46,    47,    48,    49,    34,    35,    50,    51,
-      45,   123,     1,    66,     2,    26,     3,     4,     5,    28,
-      74,     6,   128,    86,    82,    68,   119,     7,     8,     9,
-      83,    32,    70,    52,    53,    87,    10,    11,    12,    13,
-      14,    15,   104,   105,   106,    88,    89,    55,    16,    90,
-      91,    92,   107,    97,    98,    99,   100,   108,   109,    94,
-      95,    60,   113,   114,    37,    97,    98,    99,   100,    96,
-      95,   120,   121,    57,    61,   -73,    54,    58,    59,    56,
-      63,   124,    67,    37,    78,    84,   103,   115,   118,   126,
-     127,    77,   131,   117,     0,   122,     0,   129,   111
+      34,   114,    86,    37,    25,   185,    80,   108,    33,   170,
+     118,    89,   111,    51,   101,   103,   101,   103,   102,    27,
+     106,    30,    75,    54,    55,   142,    57,    58,    35,    75,
+     148,    60,    61,     5,   188,    42,     6,    28,   116,    31,
+      26,   129,     7,   160,   161,    38,    39,   179,    43,     5,
+      66,    40,     6,    29,   113,    32,   132,    80,     7,   160,
+     161,   117,    88,    36,   162,   108,    68,   101,   147,   180,
+     111,    69,   108,   151,   134,   135,   136,   111,   129,   175,
+     172,    49,   187,    50,    52,   176,   137,   192,   182,   138,
+     139,   124,   125,   126,   166,    90,    91,    92,    93,    94,
+      42,    91,    92,    93,    94,    81,   103,    82,    53,    83,
+     189,    62,   143,   144,    81,   193,   103,   191,    83,    56,
+     122,   194,   123,   103,    63,     1,   183,     2,    59,     3,
+       4,     5,   -99,   128,     6,   129,   131,   154,   129,   120,
+       7,     8,     9,   158,    65,   120,    64,    66,    70,    10,
+      11,    12,    13,    14,    15,    67,    71,    72,    73,    74,
+      75,    16,    17,    77,    42,   107,   115,   119,   145,   120,
+     133,   152,   121,   157,   130,   123,   150,   159,   168,   169,
+     178,    88,   174,   181,   186,   190,    88,   184,   196,   173,
+      24,   195,   149,   156,   155,     0,   141,    85,     0,     0,
+     104
 };
 
-static const yytype_int8 yycheck[] =
+static const yytype_int16 yycheck[] =
 {
-       9,     4,    40,    52,     7,    84,     4,    56,    57,    58,
-      59,    17,    17,     8,    40,    53,    10,     6,     0,    14,
-      26,     6,    25,    26,    27,    28,    34,    35,    31,    32,
-      45,   110,     3,    82,     5,    24,     7,     8,     9,    24,
-      89,    12,   121,    49,    49,    54,    95,    18,    19,    20,
-      64,    13,    55,    19,    46,    69,    27,    28,    29,    30,
-      31,    32,    36,    37,    38,    48,    49,    13,    39,    21,
-      22,    23,    46,    41,    42,    43,    44,    51,    52,    48,
-      49,    11,    85,    86,    40,    41,    42,    43,    44,    48,
-      49,    48,    49,    47,    17,    50,    49,    47,    47,    50,
-      40,   110,    44,    40,    47,    46,    25,    15,    47,    16,
-      42,    59,    48,    89,    -1,   103,    -1,   126,    82
+       4,    78,    65,     7,     4,    13,    62,    75,    40,   161,
+      87,    67,    75,    17,    70,    71,    72,    73,    71,     6,
+      73,     6,    17,    27,    28,   115,    30,    31,    10,    17,
+     120,    35,    36,     9,   186,    40,    12,    24,    26,    24,
+      40,    49,    18,    19,    20,    34,    35,    10,    53,     9,
+      13,    40,    12,    40,    49,    40,   107,   113,    18,    19,
+      20,    49,    66,    13,    40,   133,    41,   123,   119,    40,
+     133,    46,   140,   129,    36,    37,    38,   140,    49,     8,
+      40,    40,   185,    42,     0,    14,    48,   190,   178,    51,
+      52,    21,    22,    23,   157,    40,    41,    42,    43,    44,
+      40,    41,    42,    43,    44,    40,   162,    42,    45,    44,
+     187,    19,   116,   117,    40,   192,   172,   189,    44,    40,
+      47,   193,    49,   179,    48,     3,   179,     5,    40,     7,
+       8,     9,    50,    47,    12,    49,    47,    47,    49,    49,
+      18,    19,    20,    47,    49,    49,    48,    13,    46,    27,
+      28,    29,    30,    31,    32,    50,    46,    46,    46,    11,
+      17,    39,    40,    40,    40,    46,    48,    46,    15,    49,
+      25,    29,    47,    16,    47,    49,    46,    42,    47,    40,
+      48,   185,    45,    45,    20,    13,   190,    46,   195,   163,
+       0,    47,   123,   140,   133,    -1,   113,    64,    -1,    -1,
+      72
 };
 
 /* YYSTOS[STATE-NUM] -- The symbol kind of the accessing symbol of
@@ -741,45 +784,57 @@ static const yytype_int8 yycheck[] =
 static const yytype_int8 yystos[] =
 {
        0,     3,     5,     7,     8,     9,    12,    18,    19,    20,
-      27,    28,    29,    30,    31,    32,    39,    55,    56,    57,
-      58,    59,    60,    61,     4,     6,    24,     6,    24,    40,
-      83,    10,    13,    83,    34,    35,    82,    40,    53,    71,
-      72,    77,    83,    84,     0,    45,    83,    83,    83,    83,
-      83,    83,    19,    46,    49,    13,    50,    47,    47,    47,
-      11,    17,    69,    40,    75,    76,    84,    44,    71,    78,
-      83,    84,    62,    64,    84,    63,    84,    63,    47,    68,
-      70,    71,    49,    69,    46,    26,    49,    69,    48,    49,
-      21,    22,    23,    65,    48,    49,    48,    41,    42,    43,
-      44,    66,    67,    25,    36,    37,    38,    46,    51,    52,
-      73,    76,    67,    83,    83,    15,    79,    64,    47,    84,
-      48,    49,    68,    67,    71,    74,    16,    42,    67,    71,
-      80,    48,     8,    14,    81
+      27,    28,    29,    30,    31,    32,    39,    40,    55,    56,
+      57,    58,    62,    63,    64,     4,    40,     6,    24,    40,
+       6,    24,    40,    40,    90,    10,    13,    90,    34,    35,
+      40,    88,    40,    53,    77,    78,    83,    90,    91,    40,
+      42,    90,     0,    45,    90,    90,    40,    90,    90,    40,
+      90,    90,    19,    48,    48,    49,    13,    50,    41,    46,
+      46,    46,    46,    46,    11,    17,    75,    40,    81,    82,
+      91,    40,    42,    44,    89,    89,    77,    84,    90,    91,
+      40,    41,    42,    43,    44,    70,    71,    72,    73,    65,
+      67,    91,    66,    91,    65,    69,    66,    46,    73,    74,
+      76,    77,    80,    49,    75,    48,    26,    49,    75,    46,
+      49,    47,    47,    49,    21,    22,    23,    68,    47,    49,
+      47,    47,    70,    25,    36,    37,    38,    48,    51,    52,
+      79,    82,    72,    90,    90,    15,    85,    70,    72,    67,
+      46,    91,    29,    59,    47,    74,    80,    16,    47,    42,
+      19,    20,    40,    60,    61,    64,    77,    86,    47,    40,
+      83,    66,    40,    61,    45,     8,    14,    87,    48,    10,
+      40,    45,    72,    66,    46,    13,    20,    84,    83,    75,
+      13,    85,    84,    75,    85,    47,    59
 };
 
 /* YYR1[RULE-NUM] -- Symbol kind of the left-hand side of rule RULE-NUM.  */
 static const yytype_int8 yyr1[] =
 {
        0,    54,    55,    55,    55,    55,    56,    56,    56,    56,
-      56,    57,    57,    57,    57,    58,    59,    60,    60,    60,
-      60,    60,    61,    61,    61,    61,    62,    62,    63,    63,
-      64,    65,    65,    65,    66,    66,    67,    67,    67,    67,
-      68,    69,    69,    70,    70,    71,    71,    72,    72,    73,
-      73,    73,    73,    73,    73,    74,    74,    75,    75,    76,
-      77,    77,    78,    78,    78,    79,    79,    80,    81,    81,
-      81,    82,    82,    83,    84
+      56,    57,    57,    57,    57,    58,    58,    58,    58,    58,
+      58,    58,    58,    58,    59,    60,    60,    61,    61,    61,
+      61,    62,    62,    62,    63,    63,    63,    63,    63,    64,
+      64,    64,    64,    65,    65,    66,    66,    67,    68,    68,
+      68,    69,    69,    70,    70,    71,    71,    72,    72,    72,
+      73,    73,    73,    73,    74,    75,    75,    76,    76,    77,
+      77,    78,    78,    79,    79,    79,    79,    79,    79,    80,
+      80,    81,    81,    82,    83,    83,    84,    84,    84,    85,
+      85,    86,    87,    87,    87,    88,    88,    89,    89,    90,
+      91
 };
 
 /* YYR2[RULE-NUM] -- Number of symbols on the right-hand side of rule RULE-NUM.  */
 static const yytype_int8 yyr2[] =
 {
        0,     2,     2,     1,     1,     1,     1,     1,     1,     1,
-       1,     1,     1,     1,     1,     2,     4,     6,     3,     2,
-       6,     6,     7,     4,     5,     6,     1,     3,     1,     3,
-       2,     1,     4,     1,     1,     3,     1,     1,     1,     1,
-       3,     0,     2,     1,     3,     3,     1,     1,     3,     1,
-       1,     1,     1,     1,     1,     1,     1,     1,     3,     3,
-       1,     1,     1,     3,     3,     3,     0,     2,     1,     1,
-       0,     1,     1,     1,     1
+       1,     1,     1,     1,     1,     2,     2,     3,     7,     3,
+       5,     2,     2,     1,     3,     2,     3,     1,     8,     4,
+      12,     4,     4,     4,     6,     3,     2,     6,     6,     7,
+       4,     5,     6,     1,     3,     1,     3,     2,     1,     4,
+       1,     0,     1,     1,     3,     0,     1,     1,     1,     4,
+       1,     1,     1,     1,     3,     0,     2,     1,     3,     3,
+       1,     1,     3,     1,     1,     1,     1,     1,     1,     1,
+       1,     1,     3,     3,     1,     1,     1,     3,     3,     3,
+       0,     2,     1,     1,     0,     1,     1,     1,     1,     1,
+       1
 };
 
 
@@ -1635,517 +1690,744 @@ yyreduce:
   switch (yyn)
     {
   case 2: /* start: stmt ';'  */
-#line 59 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.y"
+#line 62 "/root/repo/src/parser/yacc.y"
     {
         parse_tree = (yyvsp[-1].sv_node);
         YYACCEPT;
     }
-#line 1644 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.tab.cpp"
+#line 1699 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
   case 3: /* start: HELP  */
-#line 64 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.y"
+#line 67 "/root/repo/src/parser/yacc.y"
     {
         parse_tree = std::make_shared<Help>();
         YYACCEPT;
     }
-#line 1653 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.tab.cpp"
+#line 1708 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
   case 4: /* start: EXIT  */
-#line 69 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.y"
+#line 72 "/root/repo/src/parser/yacc.y"
     {
         parse_tree = nullptr;
         YYACCEPT;
     }
-#line 1662 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.tab.cpp"
+#line 1717 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
   case 5: /* start: T_EOF  */
-#line 74 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.y"
+#line 77 "/root/repo/src/parser/yacc.y"
     {
         parse_tree = nullptr;
         YYACCEPT;
     }
-#line 1671 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.tab.cpp"
+#line 1726 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
   case 11: /* txnStmt: TXN_BEGIN  */
-#line 90 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.y"
+#line 93 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_node) = std::make_shared<TxnBegin>();
     }
-#line 1679 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.tab.cpp"
+#line 1734 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
   case 12: /* txnStmt: TXN_COMMIT  */
-#line 94 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.y"
+#line 97 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_node) = std::make_shared<TxnCommit>();
     }
-#line 1687 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.tab.cpp"
+#line 1742 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
   case 13: /* txnStmt: TXN_ABORT  */
-#line 98 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.y"
+#line 101 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_node) = std::make_shared<TxnAbort>();
     }
-#line 1695 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.tab.cpp"
+#line 1750 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
   case 14: /* txnStmt: TXN_ROLLBACK  */
-#line 102 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.y"
+#line 105 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_node) = std::make_shared<TxnRollback>();
     }
-#line 1703 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.tab.cpp"
+#line 1758 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
   case 15: /* dbStmt: SHOW TABLES  */
-#line 109 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.y"
+#line 112 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_node) = std::make_shared<ShowTables>();
     }
-#line 1711 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.tab.cpp"
+#line 1766 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 16: /* setStmt: SET set_knob_type '=' VALUE_BOOL  */
-#line 116 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.y"
+  case 16: /* dbStmt: SHOW IDENTIFIER  */
+#line 116 "/root/repo/src/parser/yacc.y"
+    {
+        if (strcasecmp((yyvsp[0].sv_str).c_str(), "replication") == 0) {
+            (yyval.sv_node) = std::make_shared<ShowReplication>();
+        } else if (strcasecmp((yyvsp[0].sv_str).c_str(), "sessions") == 0) {
+            (yyval.sv_node) = std::make_shared<ShowSessions>();
+        } else {
+            yyerror(&(yylsp[0]), ("unrecognized SHOW target " + (yyvsp[0].sv_str)).c_str());
+            YYERROR;
+        }
+    }
+#line 1781 "/root/repo/src/parser/yacc.tab.cpp"
+    break;
+
+  case 17: /* dbStmt: IDENTIFIER IDENTIFIER VALUE_STRING  */
+#line 127 "/root/repo/src/parser/yacc.y"
+    {
+        if (strcasecmp((yyvsp[-2].sv_str).c_str(), "backup") != 0 || strcasecmp((yyvsp[-1].sv_str).c_str(), "to") != 0) {
+            yyerror(&(yylsp[-2]), ("unrecognized statement " + (yyvsp[-2].sv_str)).c_str());
+            YYERROR;
+        }
+        (yyval.sv_node) = std::make_shared<BackupStmt>((yyvsp[0].sv_str));
+    }
+#line 1793 "/root/repo/src/parser/yacc.tab.cpp"
+    break;
+
+  case 18: /* dbStmt: CREATE IDENTIFIER IDENTIFIER '(' optFieldList ')' procBlock  */
+#line 135 "/root/repo/src/parser/yacc.y"
+    {
+        if (strcasecmp((yyvsp[-5].sv_str).c_str(), "procedure") != 0) {
+            yyerror(&(yylsp[-5]), ("unrecognized CREATE target " + (yyvsp[-5].sv_str)).c_str());
+            YYERROR;
+        }
+        (yyval.sv_node) = std::make_shared<CreateProcedure>((yyvsp[-4].sv_str), (yyvsp[-2].sv_fields), (yyvsp[0].sv_nodes));
+    }
+#line 1805 "/root/repo/src/parser/yacc.tab.cpp"
+    break;
+
+  case 19: /* dbStmt: DROP IDENTIFIER IDENTIFIER  */
+#line 143 "/root/repo/src/parser/yacc.y"
+    {
+        if (strcasecmp((yyvsp[-1].sv_str).c_str(), "procedure") != 0) {
+            yyerror(&(yylsp[-1]), ("unrecognized DROP target " + (yyvsp[-1].sv_str)).c_str());
+            YYERROR;
+        }
+        (yyval.sv_node) = std::make_shared<DropProcedure>((yyvsp[0].sv_str));
+    }
+#line 1817 "/root/repo/src/parser/yacc.tab.cpp"
+    break;
+
+  case 20: /* dbStmt: IDENTIFIER IDENTIFIER '(' optValueList ')'  */
+#line 151 "/root/repo/src/parser/yacc.y"
+    {
+        if (strcasecmp((yyvsp[-4].sv_str).c_str(), "call") != 0) {
+            yyerror(&(yylsp[-4]), ("unrecognized statement " + (yyvsp[-4].sv_str)).c_str());
+            YYERROR;
+        }
+        (yyval.sv_node) = std::make_shared<CallProcedure>((yyvsp[-3].sv_str), (yyvsp[-1].sv_vals));
+    }
+#line 1829 "/root/repo/src/parser/yacc.tab.cpp"
+    break;
+
+  case 21: /* dbStmt: IDENTIFIER VALUE_INT  */
+#line 159 "/root/repo/src/parser/yacc.y"
+    {
+        if (strcasecmp((yyvsp[-1].sv_str).c_str(), "cancel") != 0) {
+            yyerror(&(yylsp[-1]), ("unrecognized statement " + (yyvsp[-1].sv_str)).c_str());
+            YYERROR;
+        }
+        (yyval.sv_node) = std::make_shared<CancelStmt>((yyvsp[0].sv_int));
+    }
+#line 1841 "/root/repo/src/parser/yacc.tab.cpp"
+    break;
+
+  case 22: /* dbStmt: IDENTIFIER tbName  */
+#line 167 "/root/repo/src/parser/yacc.y"
+    {
+        if (strcasecmp((yyvsp[-1].sv_str).c_str(), "analyze") != 0) {
+            yyerror(&(yylsp[-1]), ("unrecognized statement " + (yyvsp[-1].sv_str)).c_str());
+            YYERROR;
+        }
+        (yyval.sv_node) = std::make_shared<AnalyzeStmt>((yyvsp[0].sv_str));
+    }
+#line 1853 "/root/repo/src/parser/yacc.tab.cpp"
+    break;
+
+  case 23: /* dbStmt: IDENTIFIER  */
+#line 175 "/root/repo/src/parser/yacc.y"
+    {
+        if (strcasecmp((yyvsp[0].sv_str).c_str(), "checkpoint") != 0) {
+            yyerror(&(yylsp[0]), ("unrecognized statement " + (yyvsp[0].sv_str)).c_str());
+            YYERROR;
+        }
+        (yyval.sv_node) = std::make_shared<CheckpointStmt>();
+    }
+#line 1865 "/root/repo/src/parser/yacc.tab.cpp"
+    break;
+
+  case 24: /* procBlock: TXN_BEGIN procStmts IDENTIFIER  */
+#line 186 "/root/repo/src/parser/yacc.y"
+    {
+        if (strcasecmp((yyvsp[0].sv_str).c_str(), "end") != 0) {
+            yyerror(&(yylsp[0]), "expected END");
+            YYERROR;
+        }
+        (yyval.sv_nodes) = (yyvsp[-1].sv_nodes);
+    }
+#line 1877 "/root/repo/src/parser/yacc.tab.cpp"
+    break;
+
+  case 25: /* procStmts: procStmt ';'  */
+#line 197 "/root/repo/src/parser/yacc.y"
+    {
+        (yyval.sv_nodes) = std::vector<std::shared_ptr<TreeNode>>{(yyvsp[-1].sv_node)};
+    }
+#line 1885 "/root/repo/src/parser/yacc.tab.cpp"
+    break;
+
+  case 26: /* procStmts: procStmts procStmt ';'  */
+#line 201 "/root/repo/src/parser/yacc.y"
+    {
+        (yyval.sv_nodes).push_back((yyvsp[-1].sv_node));
+    }
+#line 1893 "/root/repo/src/parser/yacc.tab.cpp"
+    break;
+
+  case 28: /* procStmt: SELECT selector INTO colNameList FROM tableList optWhereClause opt_order_clause  */
+#line 209 "/root/repo/src/parser/yacc.y"
+    {
+        (yyval.sv_node) = std::make_shared<SelectInto>(std::make_shared<SelectStmt>((yyvsp[-6].sv_cols), (yyvsp[-2].sv_strs), (yyvsp[-1].sv_conds), (yyvsp[0].sv_orderby)), (yyvsp[-4].sv_strs));
+    }
+#line 1901 "/root/repo/src/parser/yacc.tab.cpp"
+    break;
+
+  case 29: /* procStmt: SET IDENTIFIER '=' procValue  */
+#line 213 "/root/repo/src/parser/yacc.y"
+    {
+        (yyval.sv_node) = std::make_shared<AssignStmt>((yyvsp[-2].sv_str), (yyvsp[0].sv_val));
+    }
+#line 1909 "/root/repo/src/parser/yacc.tab.cpp"
+    break;
+
+  case 30: /* procStmt: IDENTIFIER colNameList IDENTIFIER '(' SELECT selector FROM tableList optWhereClause opt_order_clause ')' procBlock  */
+#line 217 "/root/repo/src/parser/yacc.y"
+    {
+        if (strcasecmp((yyvsp[-11].sv_str).c_str(), "for") != 0 || strcasecmp((yyvsp[-9].sv_str).c_str(), "in") != 0) {
+            yyerror(&(yylsp[-11]), ("unrecognized procedure statement " + (yyvsp[-11].sv_str)).c_str());
+            YYERROR;
+        }
+        (yyval.sv_node) = std::make_shared<ForLoop>((yyvsp[-10].sv_strs), std::make_shared<SelectStmt>((yyvsp[-6].sv_cols), (yyvsp[-4].sv_strs), (yyvsp[-3].sv_conds), (yyvsp[-2].sv_orderby)), (yyvsp[0].sv_nodes));
+    }
+#line 1921 "/root/repo/src/parser/yacc.tab.cpp"
+    break;
+
+  case 31: /* setStmt: SET set_knob_type '=' knob_value  */
+#line 228 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_node) = std::make_shared<SetStmt>((yyvsp[-2].sv_setKnobType), (yyvsp[0].sv_bool));
     }
-#line 1719 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.tab.cpp"
+#line 1929 "/root/repo/src/parser/yacc.tab.cpp"
+    break;
+
+  case 32: /* setStmt: SET IDENTIFIER '=' knob_value  */
+#line 232 "/root/repo/src/parser/yacc.y"
+    {
+        if (strcasecmp((yyvsp[-2].sv_str).c_str(), "synchronous_commit") != 0) {
+            yyerror(&(yylsp[-2]), ("unrecognized boolean configuration parameter " + (yyvsp[-2].sv_str)).c_str());
+            YYERROR;
+        }
+        SetKnobType type = SynchronousCommit;
+        (yyval.sv_node) = std::make_shared<SetStmt>(type, (yyvsp[0].sv_bool));
+    }
+#line 1942 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 17: /* ddl: CREATE TABLE tbName '(' fieldList ')'  */
-#line 123 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.y"
+  case 33: /* setStmt: SET IDENTIFIER '=' VALUE_INT  */
+#line 241 "/root/repo/src/parser/yacc.y"
+    {
+        if (strcasecmp((yyvsp[-2].sv_str).c_str(), "statement_timeout") != 0) {
+            yyerror(&(yylsp[-2]), ("unrecognized integer configuration parameter " + (yyvsp[-2].sv_str)).c_str());
+            YYERROR;
+        }
+        if ((yyvsp[0].sv_int) < 0) {
+            yyerror(&(yylsp[0]), "statement_timeout must not be negative");
+            YYERROR;
+        }
+        (yyval.sv_node) = std::make_shared<SetStmt>(StatementTimeout, (yyvsp[0].sv_int));
+    }
+#line 1958 "/root/repo/src/parser/yacc.tab.cpp"
+    break;
+
+  case 34: /* ddl: CREATE TABLE tbName '(' fieldList ')'  */
+#line 256 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_node) = std::make_shared<CreateTable>((yyvsp[-3].sv_str), (yyvsp[-1].sv_fields));
     }
-#line 1727 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.tab.cpp"
+#line 1966 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 18: /* ddl: DROP TABLE tbName  */
-#line 127 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.y"
+  case 35: /* ddl: DROP TABLE tbName  */
+#line 260 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_node) = std::make_shared<DropTable>((yyvsp[0].sv_str));
     }
-#line 1735 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.tab.cpp"
+#line 1974 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 19: /* ddl: DESC tbName  */
-#line 131 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.y"
+  case 36: /* ddl: DESC tbName  */
+#line 264 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_node) = std::make_shared<DescTable>((yyvsp[0].sv_str));
     }
-#line 1743 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.tab.cpp"
+#line 1982 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 20: /* ddl: CREATE INDEX tbName '(' colNameList ')'  */
-#line 135 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.y"
+  case 37: /* ddl: CREATE INDEX tbName '(' colNameList ')'  */
+#line 268 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_node) = std::make_shared<CreateIndex>((yyvsp[-3].sv_str), (yyvsp[-1].sv_strs));
     }
-#line 1751 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.tab.cpp"
+#line 1990 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 21: /* ddl: DROP INDEX tbName '(' colNameList ')'  */
-#line 139 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.y"
+  case 38: /* ddl: DROP INDEX tbName '(' colNameList ')'  */
+#line 272 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_node) = std::make_shared<DropIndex>((yyvsp[-3].sv_str), (yyvsp[-1].sv_strs));
     }
-#line 1759 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.tab.cpp"
+#line 1998 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 22: /* dml: INSERT INTO tbName VALUES '(' valueList ')'  */
-#line 146 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.y"
+  case 39: /* dml: INSERT INTO tbName VALUES '(' valueList ')'  */
+#line 279 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_node) = std::make_shared<InsertStmt>((yyvsp[-4].sv_str), (yyvsp[-1].sv_vals));
     }
-#line 1767 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.tab.cpp"
+#line 2006 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 23: /* dml: DELETE FROM tbName optWhereClause  */
-#line 150 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.y"
+  case 40: /* dml: DELETE FROM tbName optWhereClause  */
+#line 283 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_node) = std::make_shared<DeleteStmt>((yyvsp[-1].sv_str), (yyvsp[0].sv_conds));
     }
-#line 1775 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.tab.cpp"
+#line 2014 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 24: /* dml: UPDATE tbName SET setClauses optWhereClause  */
-#line 154 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.y"
+  case 41: /* dml: UPDATE tbName SET setClauses optWhereClause  */
+#line 287 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_node) = std::make_shared<UpdateStmt>((yyvsp[-3].sv_str), (yyvsp[-1].sv_set_clauses), (yyvsp[0].sv_conds));
     }
-#line 1783 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.tab.cpp"
+#line 2022 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 25: /* dml: SELECT selector FROM tableList optWhereClause opt_order_clause  */
-#line 158 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.y"
+  case 42: /* dml: SELECT selector FROM tableList optWhereClause opt_order_clause  */
+#line 291 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_node) = std::make_shared<SelectStmt>((yyvsp[-4].sv_cols), (yyvsp[-2].sv_strs), (yyvsp[-1].sv_conds), (yyvsp[0].sv_orderby));
     }
-#line 1791 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.tab.cpp"
+#line 2030 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 26: /* fieldList: field  */
-#line 165 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.y"
+  case 43: /* fieldList: field  */
+#line 298 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_fields) = std::vector<std::shared_ptr<Field>>{(yyvsp[0].sv_field)};
     }
-#line 1799 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.tab.cpp"
+#line 2038 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 27: /* fieldList: fieldList ',' field  */
-#line 169 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.y"
+  case 44: /* fieldList: fieldList ',' field  */
+#line 302 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_fields).push_back((yyvsp[0].sv_field));
     }
-#line 1807 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.tab.cpp"
+#line 2046 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 28: /* colNameList: colName  */
-#line 176 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.y"
+  case 45: /* colNameList: colName  */
+#line 309 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_strs) = std::vector<std::string>{(yyvsp[0].sv_str)};
     }
-#line 1815 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.tab.cpp"
+#line 2054 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 29: /* colNameList: colNameList ',' colName  */
-#line 180 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.y"
+  case 46: /* colNameList: colNameList ',' colName  */
+#line 313 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_strs).push_back((yyvsp[0].sv_str));
     }
-#line 1823 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.tab.cpp"
+#line 2062 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 30: /* field: colName type  */
-#line 187 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.y"
+  case 47: /* field: colName type  */
+#line 320 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_field) = std::make_shared<ColDef>((yyvsp[-1].sv_str), (yyvsp[0].sv_type_len));
     }
-#line 1831 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.tab.cpp"
+#line 2070 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 31: /* type: INT  */
-#line 194 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.y"
+  case 48: /* type: INT  */
+#line 327 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_type_len) = std::make_shared<TypeLen>(SV_TYPE_INT, sizeof(int));
     }
-#line 1839 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.tab.cpp"
+#line 2078 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 32: /* type: CHAR '(' VALUE_INT ')'  */
-#line 198 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.y"
+  case 49: /* type: CHAR '(' VALUE_INT ')'  */
+#line 331 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_type_len) = std::make_shared<TypeLen>(SV_TYPE_STRING, (yyvsp[-1].sv_int));
     }
-#line 1847 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.tab.cpp"
+#line 2086 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 33: /* type: FLOAT  */
-#line 202 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.y"
+  case 50: /* type: FLOAT  */
+#line 335 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_type_len) = std::make_shared<TypeLen>(SV_TYPE_FLOAT, sizeof(float));
     }
-#line 1855 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.tab.cpp"
+#line 2094 "/root/repo/src/parser/yacc.tab.cpp"
+    break;
+
+  case 51: /* optFieldList: %empty  */
+#line 341 "/root/repo/src/parser/yacc.y"
+                      { /* ignore*/ }
+#line 2100 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 34: /* valueList: value  */
-#line 209 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.y"
+  case 53: /* valueList: procValue  */
+#line 347 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_vals) = std::vector<std::shared_ptr<Value>>{(yyvsp[0].sv_val)};
     }
-#line 1863 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.tab.cpp"
+#line 2108 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 35: /* valueList: valueList ',' value  */
-#line 213 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.y"
+  case 54: /* valueList: valueList ',' procValue  */
+#line 351 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_vals).push_back((yyvsp[0].sv_val));
     }
-#line 1871 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.tab.cpp"
+#line 2116 "/root/repo/src/parser/yacc.tab.cpp"
+    break;
+
+  case 55: /* optValueList: %empty  */
+#line 357 "/root/repo/src/parser/yacc.y"
+                      { /* ignore*/ }
+#line 2122 "/root/repo/src/parser/yacc.tab.cpp"
+    break;
+
+  case 58: /* procValue: IDENTIFIER  */
+#line 364 "/root/repo/src/parser/yacc.y"
+    {
+        (yyval.sv_val) = std::make_shared<VarRef>((yyvsp[0].sv_str));
+    }
+#line 2130 "/root/repo/src/parser/yacc.tab.cpp"
+    break;
+
+  case 59: /* procValue: IDENTIFIER '(' valueList ')'  */
+#line 368 "/root/repo/src/parser/yacc.y"
+    {
+        (yyval.sv_val) = std::make_shared<FuncCall>((yyvsp[-3].sv_str), (yyvsp[-1].sv_vals));
+    }
+#line 2138 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 36: /* value: VALUE_INT  */
-#line 220 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.y"
+  case 60: /* value: VALUE_INT  */
+#line 375 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_val) = std::make_shared<IntLit>((yyvsp[0].sv_int));
     }
-#line 1879 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.tab.cpp"
+#line 2146 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 37: /* value: VALUE_FLOAT  */
-#line 224 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.y"
+  case 61: /* value: VALUE_FLOAT  */
+#line 379 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_val) = std::make_shared<FloatLit>((yyvsp[0].sv_float));
     }
-#line 1887 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.tab.cpp"
+#line 2154 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 38: /* value: VALUE_STRING  */
-#line 228 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.y"
+  case 62: /* value: VALUE_STRING  */
+#line 383 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_val) = std::make_shared<StringLit>((yyvsp[0].sv_str));
     }
-#line 1895 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.tab.cpp"
+#line 2162 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 39: /* value: VALUE_BOOL  */
-#line 232 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.y"
+  case 63: /* value: VALUE_BOOL  */
+#line 387 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_val) = std::make_shared<BoolLit>((yyvsp[0].sv_bool));
     }
-#line 1903 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.tab.cpp"
+#line 2170 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 40: /* condition: col op expr  */
-#line 239 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.y"
+  case 64: /* condition: expr op expr  */
+#line 394 "/root/repo/src/parser/yacc.y"
     {
-        (yyval.sv_cond) = std::make_shared<BinaryExpr>((yyvsp[-2].sv_col), (yyvsp[-1].sv_comp_op), (yyvsp[0].sv_expr));
+        (yyval.sv_cond) = std::make_shared<BinaryExpr>((yyvsp[-2].sv_expr), (yyvsp[-1].sv_comp_op), (yyvsp[0].sv_expr));
     }
-#line 1911 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.tab.cpp"
+#line 2178 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 41: /* optWhereClause: %empty  */
-#line 245 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.y"
+  case 65: /* optWhereClause: %empty  */
+#line 400 "/root/repo/src/parser/yacc.y"
                       { /* ignore*/ }
-#line 1917 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.tab.cpp"
+#line 2184 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 42: /* optWhereClause: WHERE whereClause  */
-#line 247 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.y"
+  case 66: /* optWhereClause: WHERE whereClause  */
+#line 402 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_conds) = (yyvsp[0].sv_conds);
     }
-#line 1925 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.tab.cpp"
+#line 2192 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 43: /* whereClause: condition  */
-#line 254 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.y"
+  case 67: /* whereClause: condition  */
+#line 409 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_conds) = std::vector<std::shared_ptr<BinaryExpr>>{(yyvsp[0].sv_cond)};
     }
-#line 1933 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.tab.cpp"
+#line 2200 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 44: /* whereClause: whereClause AND condition  */
-#line 258 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.y"
+  case 68: /* whereClause: whereClause AND condition  */
+#line 413 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_conds).push_back((yyvsp[0].sv_cond));
     }
-#line 1941 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.tab.cpp"
+#line 2208 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 45: /* col: tbName '.' colName  */
-#line 265 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.y"
+  case 69: /* col: tbName '.' colName  */
+#line 420 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_col) = std::make_shared<Col>((yyvsp[-2].sv_str), (yyvsp[0].sv_str));
     }
-#line 1949 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.tab.cpp"
+#line 2216 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 46: /* col: colName  */
-#line 269 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.y"
+  case 70: /* col: colName  */
+#line 424 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_col) = std::make_shared<Col>("", (yyvsp[0].sv_str));
     }
-#line 1957 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.tab.cpp"
+#line 2224 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 47: /* colList: col  */
-#line 276 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.y"
+  case 71: /* colList: col  */
+#line 431 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_cols) = std::vector<std::shared_ptr<Col>>{(yyvsp[0].sv_col)};
     }
-#line 1965 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.tab.cpp"
+#line 2232 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 48: /* colList: colList ',' col  */
-#line 280 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.y"
+  case 72: /* colList: colList ',' col  */
+#line 435 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_cols).push_back((yyvsp[0].sv_col));
     }
-#line 1973 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.tab.cpp"
+#line 2240 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 49: /* op: '='  */
-#line 287 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.y"
+  case 73: /* op: '='  */
+#line 442 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_comp_op) = SV_OP_EQ;
     }
-#line 1981 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.tab.cpp"
+#line 2248 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 50: /* op: '<'  */
-#line 291 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.y"
+  case 74: /* op: '<'  */
+#line 446 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_comp_op) = SV_OP_LT;
     }
-#line 1989 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.tab.cpp"
+#line 2256 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 51: /* op: '>'  */
-#line 295 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.y"
+  case 75: /* op: '>'  */
+#line 450 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_comp_op) = SV_OP_GT;
     }
-#line 1997 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.tab.cpp"
+#line 2264 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 52: /* op: NEQ  */
-#line 299 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.y"
+  case 76: /* op: NEQ  */
+#line 454 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_comp_op) = SV_OP_NE;
     }
-#line 2005 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.tab.cpp"
+#line 2272 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 53: /* op: LEQ  */
-#line 303 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.y"
+  case 77: /* op: LEQ  */
+#line 458 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_comp_op) = SV_OP_LE;
     }
-#line 2013 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.tab.cpp"
+#line 2280 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 54: /* op: GEQ  */
-#line 307 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.y"
+  case 78: /* op: GEQ  */
+#line 462 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_comp_op) = SV_OP_GE;
     }
-#line 2021 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.tab.cpp"
+#line 2288 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 55: /* expr: value  */
-#line 314 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.y"
+  case 79: /* expr: value  */
+#line 469 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_expr) = std::static_pointer_cast<Expr>((yyvsp[0].sv_val));
     }
-#line 2029 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.tab.cpp"
+#line 2296 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 56: /* expr: col  */
-#line 318 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.y"
+  case 80: /* expr: col  */
+#line 473 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_expr) = std::static_pointer_cast<Expr>((yyvsp[0].sv_col));
     }
-#line 2037 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.tab.cpp"
+#line 2304 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 57: /* setClauses: setClause  */
-#line 325 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.y"
+  case 81: /* setClauses: setClause  */
+#line 480 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_set_clauses) = std::vector<std::shared_ptr<SetClause>>{(yyvsp[0].sv_set_clause)};
     }
-#line 2045 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.tab.cpp"
+#line 2312 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 58: /* setClauses: setClauses ',' setClause  */
-#line 329 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.y"
+  case 82: /* setClauses: setClauses ',' setClause  */
+#line 484 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_set_clauses).push_back((yyvsp[0].sv_set_clause));
     }
-#line 2053 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.tab.cpp"
+#line 2320 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 59: /* setClause: colName '=' value  */
-#line 336 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.y"
+  case 83: /* setClause: colName '=' procValue  */
+#line 491 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_set_clause) = std::make_shared<SetClause>((yyvsp[-2].sv_str), (yyvsp[0].sv_val));
     }
-#line 2061 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.tab.cpp"
+#line 2328 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 60: /* selector: '*'  */
-#line 343 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.y"
+  case 84: /* selector: '*'  */
+#line 498 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_cols) = {};
     }
-#line 2069 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.tab.cpp"
+#line 2336 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 62: /* tableList: tbName  */
-#line 351 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.y"
+  case 86: /* tableList: tbName  */
+#line 506 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_strs) = std::vector<std::string>{(yyvsp[0].sv_str)};
     }
-#line 2077 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.tab.cpp"
+#line 2344 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 63: /* tableList: tableList ',' tbName  */
-#line 355 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.y"
+  case 87: /* tableList: tableList ',' tbName  */
+#line 510 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_strs).push_back((yyvsp[0].sv_str));
     }
-#line 2085 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.tab.cpp"
+#line 2352 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 64: /* tableList: tableList JOIN tbName  */
-#line 359 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.y"
+  case 88: /* tableList: tableList JOIN tbName  */
+#line 514 "/root/repo/src/parser/yacc.y"
     {
         (yyval.sv_strs).push_back((yyvsp[0].sv_str));
     }
-#line 2093 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.tab.cpp"
+#line 2360 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 65: /* opt_order_clause: ORDER BY order_clause  */
-#line 366 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.y"
+  case 89: /* opt_order_clause: ORDER BY order_clause  */
+#line 521 "/root/repo/src/parser/yacc.y"
     { 
         (yyval.sv_orderby) = (yyvsp[0].sv_orderby); 
     }
-#line 2101 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.tab.cpp"
+#line 2368 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 66: /* opt_order_clause: %empty  */
-#line 369 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.y"
+  case 90: /* opt_order_clause: %empty  */
+#line 524 "/root/repo/src/parser/yacc.y"
                       { /* ignore*/ }
-#line 2107 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.tab.cpp"
+#line 2374 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 67: /* order_clause: col opt_asc_desc  */
-#line 374 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.y"
+  case 91: /* order_clause: col opt_asc_desc  */
+#line 529 "/root/repo/src/parser/yacc.y"
     { 
         (yyval.sv_orderby) = std::make_shared<OrderBy>((yyvsp[-1].sv_col), (yyvsp[0].sv_orderby_dir));
     }
-#line 2115 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.tab.cpp"
+#line 2382 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 68: /* opt_asc_desc: ASC  */
-#line 380 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.y"
+  case 92: /* opt_asc_desc: ASC  */
+#line 535 "/root/repo/src/parser/yacc.y"
                  { (yyval.sv_orderby_dir) = OrderBy_ASC;     }
-#line 2121 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.tab.cpp"
+#line 2388 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 69: /* opt_asc_desc: DESC  */
-#line 381 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.y"
+  case 93: /* opt_asc_desc: DESC  */
+#line 536 "/root/repo/src/parser/yacc.y"
                  { (yyval.sv_orderby_dir) = OrderBy_DESC;    }
-#line 2127 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.tab.cpp"
+#line 2394 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 70: /* opt_asc_desc: %empty  */
-#line 382 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.y"
+  case 94: /* opt_asc_desc: %empty  */
+#line 537 "/root/repo/src/parser/yacc.y"
             { (yyval.sv_orderby_dir) = OrderBy_DEFAULT; }
-#line 2133 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.tab.cpp"
+#line 2400 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 71: /* set_knob_type: ENABLE_NESTLOOP  */
-#line 386 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.y"
+  case 95: /* set_knob_type: ENABLE_NESTLOOP  */
+#line 541 "/root/repo/src/parser/yacc.y"
                     { (yyval.sv_setKnobType) = EnableNestLoop; }
-#line 2139 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.tab.cpp"
+#line 2406 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
-  case 72: /* set_knob_type: ENABLE_SORTMERGE  */
-#line 387 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.y"
+  case 96: /* set_knob_type: ENABLE_SORTMERGE  */
+#line 542 "/root/repo/src/parser/yacc.y"
                          { (yyval.sv_setKnobType) = EnableSortMerge; }
-#line 2145 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.tab.cpp"
+#line 2412 "/root/repo/src/parser/yacc.tab.cpp"
+    break;
+
+  case 98: /* knob_value: IDENTIFIER  */
+#line 548 "/root/repo/src/parser/yacc.y"
+    {
+        if (strcasecmp((yyvsp[0].sv_str).c_str(), "on") == 0) {
+            (yyval.sv_bool) = true;
+        } else if (strcasecmp((yyvsp[0].sv_str).c_str(), "off") == 0) {
+            (yyval.sv_bool) = false;
+        } else {
+            yyerror(&(yylsp[0]), ("invalid boolean value " + (yyvsp[0].sv_str)).c_str());
+            YYERROR;
+        }
+    }
+#line 2427 "/root/repo/src/parser/yacc.tab.cpp"
     break;
 
 
-#line 2149 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.tab.cpp"
+#line 2431 "/root/repo/src/parser/yacc.tab.cpp"
 
       default: break;
     }
@@ -2374,5 +2656,5 @@ yyreturnlab:
   return yyresult;
 }
 
-#line 393 "/mnt/d/phd1/database_competition/db2024/rmdb/src/parser/yacc.y"
+#line 563 "/root/repo/src/parser/yacc.y"
 
@@ -3,6 +3,7 @@
 #include "yacc.tab.h"
 #include <iostream>
 #include <memory>
+#include <strings.h>
 
 int yylex(YYSTYPE *yylval, YYLTYPE *yylloc);
 
@@ -33,14 +34,15 @@ WHERE UPDATE SET SELECT INT CHAR FLOAT INDEX AND JOIN EXIT HELP TXN_BEGIN TXN_CO
 %token <sv_bool> VALUE_BOOL
 
 // specify types for non-terminal symbol
-%type <sv_node> stmt dbStmt ddl dml txnStmt setStmt
+%type <sv_node> stmt dbStmt ddl dml txnStmt setStmt procStmt
+%type <sv_nodes> procBlock procStmts
 %type <sv_field> field
-%type <sv_fields> fieldList
+%type <sv_fields> fieldList optFieldList
 %type <sv_type_len> type
 %type <sv_comp_op> op
 %type <sv_expr> expr
-%type <sv_val> value
-%type <sv_vals> valueList
+%type <sv_val> value procValue
+%type <sv_vals> valueList optValueList
 %type <sv_str> tbName colName
 %type <sv_strs> tableList colNameList
 %type <sv_col> col
@@ -52,6 +54,7 @@ WHERE UPDATE SET SELECT INT CHAR FLOAT INDEX AND JOIN EXIT HELP TXN_BEGIN TXN_CO
 %type <sv_orderby>  order_clause opt_order_clause
 %type <sv_orderby_dir> opt_asc_desc
 %type <sv_setKnobType> set_knob_type
+%type <sv_bool> knob_value
 
 %%
 start:
@@ -109,13 +112,143 @@ dbStmt:
     {
         $$ = std::make_shared<ShowTables>();
     }
+    |   SHOW IDENTIFIER
+    {
+        if (strcasecmp($2.c_str(), "replication") == 0) {
+            $$ = std::make_shared<ShowReplication>();
+        } else if (strcasecmp($2.c_str(), "sessions") == 0) {
+            $$ = std::make_shared<ShowSessions>();
+        } else {
+            yyerror(&@2, ("unrecognized SHOW target " + $2).c_str());
+            YYERROR;
+        }
+    }
+    |   IDENTIFIER IDENTIFIER VALUE_STRING
+    {
+        if (strcasecmp($1.c_str(), "backup") != 0 || strcasecmp($2.c_str(), "to") != 0) {
+            yyerror(&@1, ("unrecognized statement " + $1).c_str());
+            YYERROR;
+        }
+        $$ = std::make_shared<BackupStmt>($3);
+    }
+    |   CREATE IDENTIFIER IDENTIFIER '(' optFieldList ')' procBlock
+    {
+        if (strcasecmp($2.c_str(), "procedure") != 0) {
+            yyerror(&@2, ("unrecognized CREATE target " + $2).c_str());
+            YYERROR;
+        }
+        $$ = std::make_shared<CreateProcedure>($3, $5, $7);
+    }
+    |   DROP IDENTIFIER IDENTIFIER
+    {
+        if (strcasecmp($2.c_str(), "procedure") != 0) {
+            yyerror(&@2, ("unrecognized DROP target " + $2).c_str());
+            YYERROR;
+        }
+        $$ = std::make_shared<DropProcedure>($3);
+    }
+    |   IDENTIFIER IDENTIFIER '(' optValueList ')'
+    {
+        if (strcasecmp($1.c_str(), "call") != 0) {
+            yyerror(&@1, ("unrecognized statement " + $1).c_str());
+            YYERROR;
+        }
+        $$ = std::make_shared<CallProcedure>($2, $4);
+    }
+    |   IDENTIFIER VALUE_INT
+    {
+        if (strcasecmp($1.c_str(), "cancel") != 0) {
+            yyerror(&@1, ("unrecognized statement " + $1).c_str());
+            YYERROR;
+        }
+        $$ = std::make_shared<CancelStmt>($2);
+    }
+    |   IDENTIFIER tbName
+    {
+        if (strcasecmp($1.c_str(), "analyze") != 0) {
+            yyerror(&@1, ("unrecognized statement " + $1).c_str());
+            YYERROR;
+        }
+        $$ = std::make_shared<AnalyzeStmt>($2);
+    }
+    |   IDENTIFIER
+    {
+        if (strcasecmp($1.c_str(), "checkpoint") != 0) {
+            yyerror(&@1, ("unrecognized statement " + $1).c_str());
+            YYERROR;
+        }
+        $$ = std::make_shared<CheckpointStmt>();
+    }
+    ;
+
+procBlock:
+        TXN_BEGIN procStmts IDENTIFIER
+    {
+        if (strcasecmp($3.c_str(), "end") != 0) {
+            yyerror(&@3, "expected END");
+            YYERROR;
+        }
+        $$ = $2;
+    }
+    ;
+
+procStmts:
+        procStmt ';'
+    {
+        $$ = std::vector<std::shared_ptr<TreeNode>>{$1};
+    }
+    |   procStmts procStmt ';'
+    {
+        $$.push_back($2);
+    }
+    ;
+
+procStmt:
+        dml
+    |   SELECT selector INTO colNameList FROM tableList optWhereClause opt_order_clause
+    {
+        $$ = std::make_shared<SelectInto>(std::make_shared<SelectStmt>($2, $6, $7, $8), $4);
+    }
+    |   SET IDENTIFIER '=' procValue
+    {
+        $$ = std::make_shared<AssignStmt>($2, $4);
+    }
+    |   IDENTIFIER colNameList IDENTIFIER '(' SELECT selector FROM tableList optWhereClause opt_order_clause ')' procBlock
+    {
+        if (strcasecmp($1.c_str(), "for") != 0 || strcasecmp($3.c_str(), "in") != 0) {
+            yyerror(&@1, ("unrecognized procedure statement " + $1).c_str());
+            YYERROR;
+        }
+        $$ = std::make_shared<ForLoop>($2, std::make_shared<SelectStmt>($6, $8, $9, $10), $12);
+    }
     ;
 
 setStmt:
-        SET set_knob_type '=' VALUE_BOOL
+        SET set_knob_type '=' knob_value
     {
         $$ = std::make_shared<SetStmt>($2, $4);
     }
+    |   SET IDENTIFIER '=' knob_value
+    {
+        if (strcasecmp($2.c_str(), "synchronous_commit") != 0) {
+            yyerror(&@2, ("unrecognized boolean configuration parameter " + $2).c_str());
+            YYERROR;
+        }
+        SetKnobType type = SynchronousCommit;
+        $$ = std::make_shared<SetStmt>(type, $4);
+    }
+    |   SET IDENTIFIER '=' VALUE_INT
+    {
+        if (strcasecmp($2.c_str(), "statement_timeout") != 0) {
+            yyerror(&@2, ("unrecognized integer configuration parameter " + $2).c_str());
+            YYERROR;
+        }
+        if ($4 < 0) {
+            yyerror(&@4, "statement_timeout must not be negative");
+            YYERROR;
+        }
+        $$ = std::make_shared<SetStmt>(StatementTimeout, $4);
+    }
     ;
 
 ddl:
@@ -204,17 +337,39 @@ type:
     }
     ;
 
+optFieldList:
+        /* epsilon */ { /* ignore*/ }
+    |   fieldList
+    ;
+
 valueList:
-        value
+        procValue
     {
         $$ = std::vector<std::shared_ptr<Value>>{$1};
     }
-    |   valueList ',' value
+    |   valueList ',' procValue
     {
         $$.push_back($3);
     }
     ;
 
+optValueList:
+        /* epsilon */ { /* ignore*/ }
+    |   valueList
+    ;
+
+procValue:
+        value
+    |   IDENTIFIER
+    {
+        $$ = std::make_shared<VarRef>($1);
+    }
+    |   IDENTIFIER '(' valueList ')'
+    {
+        $$ = std::make_shared<FuncCall>($1, $3);
+    }
+    ;
+
 value:
         VALUE_INT
     {
@@ -235,7 +390,7 @@ value:
     ;
 
 condition:
-        col op expr
+        expr op expr
     {
         $$ = std::make_shared<BinaryExpr>($1, $2, $3);
     }
@@ -332,7 +487,7 @@ setClauses:
     ;
 
 setClause:
-        colName '=' value
+        colName '=' procValue
     {
         $$ = std::make_shared<SetClause>($1, $3);
     }
@@ -387,6 +542,21 @@ set_knob_type:
     |   ENABLE_SORTMERGE { $$ = EnableSortMerge; }
     ;
 
+knob_value:
+        VALUE_BOOL
+    |   IDENTIFIER
+    {
+        if (strcasecmp($1.c_str(), "on") == 0) {
+            $$ = true;
+        } else if (strcasecmp($1.c_str(), "off") == 0) {
+            $$ = false;
+        } else {
+            yyerror(&@1, ("invalid boolean value " + $1).c_str());
+            YYERROR;
+        }
+    }
+    ;
+
 tbName: IDENTIFIER;
 
 colName: IDENTIFIER;
@@ -24,6 +24,8 @@ See the Mulan PSL v2 for more details. */
 #include "execution/executor_delete.h"
 #include "execution/execution_sort.h"
 #include "common/common.h"
+#include "optimizer/cardinality_feedback.h"
+#include "optimizer/selectivity_sampler.h"
 
 typedef enum portalTag{
     PORTAL_Invalid_Query = 0,
@@ -49,10 +51,12 @@ class Portal
 {
    private:
     SmManager *sm_manager_;
-    
+    CardinalityFeedback *feedback_;     // 执行结束后回填实际基数的反馈缓存，可以为空
+    SelectivitySampler *sampler_;       // DML执行结束后累计表的修改量，使过时的采样结果失效，可以为空
 
    public:
-    Portal(SmManager *sm_manager) : sm_manager_(sm_manager){}
+    Portal(SmManager *sm_manager, CardinalityFeedback *feedback = nullptr, SelectivitySampler *sampler = nullptr)
+        : sm_manager_(sm_manager), feedback_(feedback), sampler_(sampler) {}
     ~Portal(){}
 
     // 将查询执行计划转换成对应的算子树
@@ -61,6 +65,8 @@ class Portal
         // 这里可以将select进行拆分，例如：一个select，带有return的select等
         if (auto x = std::dynamic_pointer_cast<OtherPlan>(plan)) {
             return std::make_shared<PortalStmt>(PORTAL_CMD_UTILITY, std::vector<TabCol>(), std::unique_ptr<AbstractExecutor>(),plan);
+        } else if(auto x = std::dynamic_pointer_cast<ProcedurePlan>(plan)) {
+            return std::make_shared<PortalStmt>(PORTAL_CMD_UTILITY, std::vector<TabCol>(), std::unique_ptr<AbstractExecutor>(), plan);
         } else if(auto x = std::dynamic_pointer_cast<SetKnobPlan>(plan)) {
             return std::make_shared<PortalStmt>(PORTAL_CMD_UTILITY, std::vector<TabCol>(), std::unique_ptr<AbstractExecutor>(), plan); 
         } else if (auto x = std::dynamic_pointer_cast<DDLPlan>(plan)) {
@@ -149,18 +155,41 @@ class Portal
         }
     }
 
-    // 清空资源
-    void drop(){}
+    // 清空资源，并把本次执行中各算子的实际基数写入反馈缓存，DML修改的记录数计入表的修改量
+    void drop(std::shared_ptr<PortalStmt> portal) {
+        if (feedback_ != nullptr && portal != nullptr) {
+            feedback_->record_plan(portal->plan);
+        }
+        if (sampler_ != nullptr && portal != nullptr) {
+            if (auto x = std::dynamic_pointer_cast<DMLPlan>(portal->plan)) {
+                if (x->tag == T_Insert) {
+                    sampler_->note_modified(x->tab_name_, 1);
+                } else if ((x->tag == T_Update || x->tag == T_Delete) && x->subplan_->has_actual_rows_) {
+                    sampler_->note_modified(x->tab_name_, x->subplan_->actual_rows_);
+                }
+            }
+        }
+    }
 
 
     std::unique_ptr<AbstractExecutor> convert_plan_executor(std::shared_ptr<Plan> plan, Context *context)
+    {
+        std::unique_ptr<AbstractExecutor> executor = convert_plan_node(plan, context);
+        if (executor != nullptr) {
+            executor->plan_ = plan;
+        }
+        return executor;
+    }
+
+    std::unique_ptr<AbstractExecutor> convert_plan_node(std::shared_ptr<Plan> plan, Context *context)
     {
         if(auto x = std::dynamic_pointer_cast<ProjectionPlan>(plan)){
             return std::make_unique<ProjectionExecutor>(convert_plan_executor(x->subplan_, context), 
                                                         x->sel_cols_);
         } else if(auto x = std::dynamic_pointer_cast<ScanPlan>(plan)) {
             if(x->tag == T_SeqScan) {
-                return std::make_unique<SeqScanExecutor>(sm_manager_, x->tab_name_, x->conds_, context);
+                return std::make_unique<SeqScanExecutor>(sm_manager_, x->tab_name_, x->conds_, context,
+                                                         x->always_false_);
             }
             else {
                 return std::make_unique<IndexScanExecutor>(sm_manager_, x->tab_name_, x->conds_, x->index_col_names_, context);
@@ -170,7 +199,7 @@ class Portal
             std::unique_ptr<AbstractExecutor> right = convert_plan_executor(x->right_, context);
             std::unique_ptr<AbstractExecutor> join = std::make_unique<NestedLoopJoinExecutor>(
                                 std::move(left), 
-                                std::move(right), std::move(x->conds_));
+                                std::move(right), std::move(x->conds_), context);
             return join;
         } else if(auto x = std::dynamic_pointer_cast<SortPlan>(plan)) {
             return std::make_unique<SortExecutor>(convert_plan_executor(x->subplan_, context), 
@@ -11,5 +11,6 @@ See the Mulan PSL v2 for more details. */
 #pragma once
 
 #include "rm_scan.h"
+#include "rm_sampler.h"
 #include "rm_manager.h"
 #include "rm_defs.h"
@@ -36,6 +36,7 @@ struct RmFileHdr {
     int num_records_per_page;   // 每个页面最多能存储的元组个数
     int first_free_page_no;     // 文件中当前第一个包含空闲空间的页面号（初始化为-1）
     int bitmap_size;            // 每个页面bitmap大小
+    int page_lsn_size;          // 页面开头页面LSN的字节数，页面LSN为4字节时创建的文件为0
 };
 
 /* 表数据文件中每个页面的页头，记录每个页面的元信息 */
@@ -92,6 +93,7 @@ struct RmRecord {
         }
         data = new char[size];
         memcpy(data, data_ + sizeof(int), size);
+        allocated_ = true;
     }
 
     ~RmRecord() {
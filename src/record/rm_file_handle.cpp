@@ -10,13 +10,24 @@ See the Mulan PSL v2 for more details. */
 
 #include "rm_file_handle.h"
 
+#include "transaction/transaction_manager.h"
+
 /**
  * @description: 获取当前表中记录号为rid的记录
  * @param {Rid&} rid 记录号，指定记录的位置
- * @param {Context*} context
- * @return {unique_ptr<RmRecord>} rid对应的记录对象指针
+ * @param {Context*} context 为空时读取页面上的内容，不考虑只读副本上未提交的修改
+ * @return {unique_ptr<RmRecord>} rid对应的记录对象指针，只读副本上记录被未完成的事务插入时返回空指针
  */
 std::unique_ptr<RmRecord> RmFileHandle::get_record(const Rid& rid, Context* context) const {
+    // 只读副本上被未完成的事务修改过的记录，读到的是第一个修改它的事务之前的内容
+    if (context != nullptr && !pending_tuples_.empty()) {
+        auto iter = pending_tuples_.find({rid.page_no, rid.slot_no});
+        if (iter != pending_tuples_.end()) {
+            auto& before = iter->second.front().before;
+            return before == nullptr ? nullptr : std::make_unique<RmRecord>(*before);
+        }
+    }
+
     // 1. 获取指定记录所在的page handle
     // 2. 初始化一个指向RmRecord的指针（赋值其内部的data和size）
 
@@ -39,7 +50,9 @@ std::unique_ptr<RmRecord> RmFileHandle::get_record(const Rid& rid, Context* cont
     // 2. 初始化一个指向RmRecord的指针
     auto record = std::make_unique<RmRecord>(file_hdr_.record_size);
     char* slot_location = ph.get_slot(rid.slot_no);
+    ph.page->RLatch();
     memcpy(record->data, slot_location, file_hdr_.record_size);
+    ph.page->RUnlatch();
     // record->size 已经在构造时设置
 
     // Unpin the page
@@ -48,6 +61,75 @@ std::unique_ptr<RmRecord> RmFileHandle::get_record(const Rid& rid, Context* cont
     return record;
 }
 
+/**
+ * @description: 获取记录号上当前的内容，不考虑只读副本上未提交的修改
+ * @return {unique_ptr<RmRecord>} 记录的内容，记录不存在或者页面还没有分配时返回空指针
+ * @param {Rid&} rid 记录号
+ */
+std::unique_ptr<RmRecord> RmFileHandle::get_tuple_image(const Rid& rid) const {
+    if (rid.page_no >= file_hdr_.num_pages || !is_record(rid)) {
+        return nullptr;
+    }
+    return get_record(rid, nullptr);
+}
+
+/**
+ * @description: 只读副本重放一个事务对记录的第一次修改之前，记下记录原来的内容，事务结束之前读取到的都是它
+ * @param {Rid&} rid 记录号
+ * @param {txn_id_t} txn_id 修改记录的事务
+ * @param {shared_ptr<RmRecord>} before 修改之前的内容，记录原来不存在时为空
+ */
+void RmFileHandle::add_pending_tuple(const Rid& rid, txn_id_t txn_id, std::shared_ptr<RmRecord> before) {
+    pending_tuples_[{rid.page_no, rid.slot_no}].push_back({txn_id, std::move(before)});
+}
+
+/**
+ * @description: 判断事务是否已经修改过这条记录
+ */
+bool RmFileHandle::has_pending_tuple(const Rid& rid, txn_id_t txn_id) const {
+    auto iter = pending_tuples_.find({rid.page_no, rid.slot_no});
+    if (iter == pending_tuples_.end()) {
+        return false;
+    }
+    return std::any_of(iter->second.begin(), iter->second.end(),
+                       [&](const RmPendingTuple& tuple) { return tuple.txn_id == txn_id; });
+}
+
+/**
+ * @description: 事务提交或回滚之后，它对记录的修改对读取可见
+ */
+void RmFileHandle::remove_pending_tuple(const Rid& rid, txn_id_t txn_id) {
+    auto iter = pending_tuples_.find({rid.page_no, rid.slot_no});
+    if (iter == pending_tuples_.end()) {
+        return;
+    }
+    auto& tuples = iter->second;
+    tuples.erase(std::remove_if(tuples.begin(), tuples.end(),
+                                [&](const RmPendingTuple& tuple) { return tuple.txn_id == txn_id; }),
+                 tuples.end());
+    if (tuples.empty()) {
+        pending_tuples_.erase(iter);
+    }
+}
+
+/**
+ * @description: 页面上slot_no之后下一个可以读取的位置：存放了记录，或者只读副本上的记录被未完成的事务删除
+ * @return {int} 下一个位置，没有时返回每页的记录数
+ * @param {RmPageHandle&} page_handle 页面
+ * @param {int} slot_no 从它之后开始查找，-1表示从头开始
+ */
+int RmFileHandle::next_slot(const RmPageHandle& page_handle, int slot_no) const {
+    int next = Bitmap::next_bit(true, page_handle.bitmap, file_hdr_.num_records_per_page, slot_no);
+    if (!pending_tuples_.empty()) {
+        int page_no = page_handle.page->get_page_id().page_no;
+        auto iter = pending_tuples_.upper_bound({page_no, slot_no});
+        if (iter != pending_tuples_.end() && iter->first.first == page_no) {
+            next = std::min(next, iter->first.second);
+        }
+    }
+    return next;
+}
+
 /**
  * @description: 在当前表中插入一条记录，不指定插入位置
  * @param {char*} buf 要插入的记录的数据
@@ -55,6 +137,19 @@ std::unique_ptr<RmRecord> RmFileHandle::get_record(const Rid& rid, Context* cont
  * @return {Rid} 插入的记录的记录号（位置）
  */
 Rid RmFileHandle::insert_record(char* buf, Context* context) {
+    return insert_record(buf, TupleMeta{0, false}, context);
+}
+
+/**
+ * @description: 在当前表中插入一条记录，并同时写入该记录的元组元信息
+ * MVCC下新插入的元组时间戳为插入事务的临时时间戳，记录和元信息在同一次页面写锁内写入，读者不会看到没有元信息的记录
+ * @param {char*} buf 要插入的记录的数据
+ * @param {TupleMeta&} meta 元组元信息
+ * @param {Context*} context
+ * @return {Rid} 插入的记录的记录号（位置）
+ */
+Rid RmFileHandle::insert_record(char* buf, const TupleMeta& meta, Context* context) {
+    std::scoped_lock lock{latch_};
     // 1. 获取当前未满的page handle
     // 2. 在page handle中找到空闲slot位置
     // 3. 将buf复制到空闲slot位置
@@ -77,11 +172,20 @@ Rid RmFileHandle::insert_record(char* buf, Context* context) {
 
     // 3. 将buf复制到空闲slot位置
     char* slot_location = ph.get_slot(slot_no);
+    ph.page->WLatch();
     memcpy(slot_location, buf, file_hdr_.record_size);
+    ph.set_meta(slot_no, meta);
 
     // 4. 更新page_handle.page_hdr中的数据结构和bitmap
     Bitmap::set(ph.bitmap, slot_no);
     ph.page_hdr->num_records++;
+    if (is_logged(context)) {
+        RmRecord insert_value(file_hdr_.record_size, buf);
+        InsertLogRecord log_record(context->txn_->get_transaction_id(), insert_value,
+                                   Rid{ph.page->get_page_id().page_no, slot_no}, file_name_);
+        append_log(ph.page, &log_record, context);
+    }
+    ph.page->WUnlatch();
     buffer_pool_manager_->mark_dirty(ph.page);
 
     // 注意考虑插入一条记录后页面已满的情况，需要更新file_hdr_.first_free_page_no
@@ -120,6 +224,8 @@ void RmFileHandle::insert_record(const Rid& rid, char* buf) {
 
     // 检查槽位是否已经是set状态，如果是，说明是覆盖或者需要特殊处理
     // 对于恢复或回滚，可能就是期望覆盖一个已删除的标记或写入一个之前的值
+    std::scoped_lock lock{latch_};
+    ph.page->WLatch();
     bool was_set = Bitmap::is_set(ph.bitmap, rid.slot_no);
 
     char* slot_location = ph.get_slot(rid.slot_no);
@@ -128,10 +234,12 @@ void RmFileHandle::insert_record(const Rid& rid, char* buf) {
     if (!was_set) { // 如果之前槽位是空的 (0), 现在填入记录
         Bitmap::set(ph.bitmap, rid.slot_no);
         ph.page_hdr->num_records++;
+        ph.set_meta(rid.slot_no, TupleMeta{0, false});
     } else {
         // 如果槽位已经是 set (1), 再次 set 没影响。num_records 不增加。
         Bitmap::set(ph.bitmap, rid.slot_no); // 确保它是set状态
     }
+    ph.page->WUnlatch();
     buffer_pool_manager_->mark_dirty(ph.page);
 
     buffer_pool_manager_->unpin_page(ph.page->get_page_id(), true); // Page was modified
@@ -154,7 +262,10 @@ void RmFileHandle::delete_record(const Rid& rid, Context* context) {
         throw RMDBError("Invalid slot number for delete: " + std::to_string(rid.slot_no));
     }
 
+    std::scoped_lock lock{latch_};
+    ph.page->WLatch();
     if (!Bitmap::is_set(ph.bitmap, rid.slot_no)) {
+        ph.page->WUnlatch();
         buffer_pool_manager_->unpin_page(ph.page->get_page_id(), false); // No modification
         throw RecordNotFoundError(rid.page_no, rid.slot_no);
     }
@@ -164,6 +275,12 @@ void RmFileHandle::delete_record(const Rid& rid, Context* context) {
 
     Bitmap::reset(ph.bitmap, rid.slot_no);
     ph.page_hdr->num_records--;
+    if (is_logged(context)) {
+        RmRecord delete_value(file_hdr_.record_size, ph.get_slot(rid.slot_no));
+        DeleteLogRecord log_record(context->txn_->get_transaction_id(), delete_value, rid, file_name_);
+        append_log(ph.page, &log_record, context);
+    }
+    ph.page->WUnlatch();
     buffer_pool_manager_->mark_dirty(ph.page);
 
     // 注意考虑删除一条记录后页面从未满变满（不可能），或从满变未满的情况
@@ -194,19 +311,257 @@ void RmFileHandle::update_record(const Rid& rid, char* buf, Context* context) {
         throw RMDBError("Invalid slot number for update: " + std::to_string(rid.slot_no));
     }
 
+    ph.page->WLatch();
     if (!Bitmap::is_set(ph.bitmap, rid.slot_no)) {
+        ph.page->WUnlatch();
         buffer_pool_manager_->unpin_page(ph.page->get_page_id(), false); // No modification
         throw RecordNotFoundError(rid.page_no, rid.slot_no);
     }
 
     // 2. 更新记录
     char* slot_location = ph.get_slot(rid.slot_no);
+    if (is_logged(context)) {
+        UpdateLogRecord log_record(context->txn_->get_transaction_id(), slot_location, buf, file_hdr_.record_size, rid,
+                                   table_id_);
+        append_log(ph.page, &log_record, context);
+    }
     memcpy(slot_location, buf, file_hdr_.record_size);
+    ph.page->WUnlatch();
     buffer_pool_manager_->mark_dirty(ph.page);
 
     buffer_pool_manager_->unpin_page(ph.page->get_page_id(), true); // Page was modified
 }
 
+/**
+ * @description: 回滚事务对记录号为rid的记录的一次修改，把该位置恢复为前像，并写入补偿日志
+ * @param {Rid&} rid 记录号
+ * @param {char*} buf 记录的前像，为空表示回滚插入、删除该位置上的记录
+ * @param {lsn_t} undo_next_lsn 被回滚的日志的prev_lsn，写入补偿日志
+ * @param {Context*} context 回滚的事务和日志管理器
+ */
+void RmFileHandle::rollback_tuple(const Rid& rid, const char* buf, lsn_t undo_next_lsn, Context* context) {
+    RmPageHandle ph = fetch_page_handle(rid.page_no);
+    if (rid.slot_no < 0 || rid.slot_no >= file_hdr_.num_records_per_page) {
+        buffer_pool_manager_->unpin_page(ph.page->get_page_id(), false);
+        throw RMDBError("Invalid slot number for rollback: " + std::to_string(rid.slot_no));
+    }
+    std::scoped_lock lock{latch_};
+    ph.page->WLatch();
+    bool was_set = Bitmap::is_set(ph.bitmap, rid.slot_no);
+    bool was_full = (ph.page_hdr->num_records == file_hdr_.num_records_per_page);
+    set_slot(ph, rid.slot_no, buf);
+    if (is_logged(context)) {
+        LogType redo_type = buf == nullptr ? LogType::DELETE : (was_set ? LogType::UPDATE : LogType::INSERT);
+        CompensationLogRecord log_record(context->txn_->get_transaction_id(), redo_type, buf, file_hdr_.record_size,
+                                         rid, file_name_, undo_next_lsn);
+        append_log(ph.page, &log_record, context);
+    }
+    ph.page->WUnlatch();
+    buffer_pool_manager_->mark_dirty(ph.page);
+    update_free_list(ph, was_full);
+    buffer_pool_manager_->unpin_page(ph.page->get_page_id(), true);
+}
+
+/**
+ * @description: 故障恢复时重做一次对记录号为rid的记录的修改，页面的LSN不小于日志号时说明修改已经在页面上
+ * 空闲页链表在恢复结束后由rebuild_free_list统一重建。修改只涉及页面本身，可以与其他页面的重做并发执行
+ * @return {bool} 是否重做了修改
+ * @param {Rid&} rid 记录号
+ * @param {char*} buf 修改后的记录，为空表示删除该位置上的记录
+ * @param {lsn_t} lsn 日志号
+ */
+bool RmFileHandle::redo_tuple(const Rid& rid, const char* buf, lsn_t lsn) {
+    return redo(rid, lsn, [&](RmPageHandle& ph) { set_slot(ph, rid.slot_no, buf); });
+}
+
+/**
+ * @description: 故障恢复时重做一条更新日志，只把记录中发生变化的字节改为后像
+ * @return {bool} 是否重做了修改
+ * @param {UpdateLogRecord&} log_record 更新日志
+ */
+bool RmFileHandle::redo_update(const UpdateLogRecord& log_record) {
+    const Rid& rid = log_record.rid_;
+    return redo(rid, log_record.lsn_, [&](RmPageHandle& ph) { log_record.redo(ph.get_slot(rid.slot_no)); });
+}
+
+/**
+ * @description: 页面的LSN小于日志号时在页面写锁内重做修改，并把页面的LSN设为日志号
+ * @return {bool} 是否重做了修改
+ * @param {Rid&} rid 被修改的记录号
+ * @param {lsn_t} lsn 日志号
+ * @param {function<void(RmPageHandle&)>} &apply 在页面上重做修改
+ */
+bool RmFileHandle::redo(const Rid& rid, lsn_t lsn, const std::function<void(RmPageHandle&)>& apply) {
+    {
+        // 故障前新分配、还没有写回磁盘的页面；只在扩展文件时持有latch_，不同页面可以并行重做
+        std::scoped_lock lock{latch_};
+        while (rid.page_no >= file_hdr_.num_pages) {
+            RmPageHandle new_ph = create_new_page_handle();
+            buffer_pool_manager_->unpin_page(new_ph.page->get_page_id(), true);
+        }
+    }
+    RmPageHandle ph = fetch_page_handle(rid.page_no);
+    ph.page->WLatch();
+    bool redo = ph.page->get_page_lsn() < lsn;
+    if (redo) {
+        apply(ph);
+        ph.page->set_page_lsn(lsn);
+        BufferPoolManager::mark_dirty(ph.page, lsn);
+    }
+    ph.page->WUnlatch();
+    buffer_pool_manager_->unpin_page(ph.page->get_page_id(), redo);
+    return redo;
+}
+
+/**
+ * @description: 根据每个页面的记录数重建空闲页链表，用于故障恢复之后，文件头中的链表可能与页面不一致
+ */
+void RmFileHandle::rebuild_free_list() {
+    std::scoped_lock lock{latch_};
+    file_hdr_.first_free_page_no = RM_NO_PAGE;
+    for (int page_no = file_hdr_.num_pages - 1; page_no >= RM_FIRST_RECORD_PAGE; page_no--) {
+        RmPageHandle ph = fetch_page_handle(page_no);
+        if (ph.page_hdr->num_records < file_hdr_.num_records_per_page) {
+            ph.page_hdr->next_free_page_no = file_hdr_.first_free_page_no;
+            file_hdr_.first_free_page_no = page_no;
+        }
+        buffer_pool_manager_->unpin_page(ph.page->get_page_id(), true);
+    }
+    disk_manager_->write_page(fd_, RM_FILE_HDR_PAGE, reinterpret_cast<char*>(&file_hdr_), sizeof(file_hdr_));
+}
+
+/**
+ * @description: 把slot设置为记录buf，buf为空时删除slot上的记录，并维护页面的记录数，调用者持有页面写锁
+ * @param {RmPageHandle&} ph 页面句柄
+ * @param {int} slot_no slot编号
+ * @param {char*} buf 记录数据
+ */
+void RmFileHandle::set_slot(RmPageHandle& ph, int slot_no, const char* buf) {
+    bool was_set = Bitmap::is_set(ph.bitmap, slot_no);
+    if (buf == nullptr) {
+        if (was_set) {
+            Bitmap::reset(ph.bitmap, slot_no);
+            ph.page_hdr->num_records--;
+        }
+        return;
+    }
+    memcpy(ph.get_slot(slot_no), buf, file_hdr_.record_size);
+    if (!was_set) {
+        Bitmap::set(ph.bitmap, slot_no);
+        ph.page_hdr->num_records++;
+        ph.set_meta(slot_no, TupleMeta{0, false});
+    }
+}
+
+/**
+ * @description: 页面的记录数变化后维护空闲页链表，调用者持有latch_
+ * @param {RmPageHandle&} ph 页面句柄
+ * @param {bool} was_full 修改之前页面是否已满
+ */
+void RmFileHandle::update_free_list(RmPageHandle& ph, bool was_full) {
+    bool is_full = (ph.page_hdr->num_records == file_hdr_.num_records_per_page);
+    if (was_full && !is_full) {
+        release_page_handle(ph);
+    } else if (!was_full && is_full && file_hdr_.first_free_page_no == ph.page->get_page_id().page_no) {
+        file_hdr_.first_free_page_no = ph.page_hdr->next_free_page_no;
+        disk_manager_->write_page(fd_, RM_FILE_HDR_PAGE, reinterpret_cast<char*>(&file_hdr_), sizeof(file_hdr_));
+    }
+}
+
+/**
+ * @description: 是否为本次修改写日志。目前只有两阶段封锁下的修改写日志，
+ * MVCC和OCC的元组还依赖内存中的版本信息，不支持故障恢复
+ * @param {Context*} context
+ */
+bool RmFileHandle::is_logged(Context* context) {
+    if (context == nullptr || context->log_mgr_ == nullptr || context->txn_ == nullptr || !enable_logging) {
+        return false;
+    }
+    return context->txn_mgr_ == nullptr ||
+           context->txn_mgr_->get_concurrency_mode() == ConcurrencyMode::TWO_PHASE_LOCKING;
+}
+
+/**
+ * @description: 在页面写锁内为页面修改追加日志，使同一页面上修改的顺序与日志的顺序一致。
+ * 先设置页面的recLSN再追加日志，检查点开始之前写入的修改，检查点获取脏页表时一定能看到
+ * @param {Page*} page 被修改的页面
+ * @param {LogRecord*} log_record 日志记录
+ * @param {Context*} context
+ */
+void RmFileHandle::append_log(Page* page, LogRecord* log_record, Context* context) {
+    BufferPoolManager::mark_dirty(page, context->log_mgr_->get_buffer_start_lsn());
+    Transaction* txn = context->txn_;
+    log_record->prev_lsn_ = txn->get_prev_lsn();
+    lsn_t lsn = context->log_mgr_->add_log_to_buffer(log_record);
+    txn->set_prev_lsn(lsn);
+    page->set_page_lsn(lsn);
+}
+
+/**
+ * @description: 在页面读锁内读取记录号为rid的元组及其元信息，MVCC读者在reader中一并读取版本链的表头，保证两者一致
+ * @param {Rid&} rid 记录号
+ * @param {RmTupleReader&} reader 读取回调
+ */
+void RmFileHandle::read_tuple(const Rid& rid, const RmTupleReader& reader) const {
+    RmPageHandle ph = fetch_page_handle(rid.page_no);
+    if (rid.slot_no < 0 || rid.slot_no >= file_hdr_.num_records_per_page) {
+        buffer_pool_manager_->unpin_page(ph.page->get_page_id(), false);
+        throw RMDBError("Invalid slot number: " + std::to_string(rid.slot_no));
+    }
+    ph.page->RLatch();
+    if (!Bitmap::is_set(ph.bitmap, rid.slot_no)) {
+        ph.page->RUnlatch();
+        buffer_pool_manager_->unpin_page(ph.page->get_page_id(), false);
+        throw RecordNotFoundError(rid.page_no, rid.slot_no);
+    }
+    try {
+        reader(ph.get_meta(rid.slot_no), ph.get_slot(rid.slot_no));
+    } catch (...) {
+        ph.page->RUnlatch();
+        buffer_pool_manager_->unpin_page(ph.page->get_page_id(), false);
+        throw;
+    }
+    ph.page->RUnlatch();
+    buffer_pool_manager_->unpin_page(ph.page->get_page_id(), false);
+}
+
+/**
+ * @description: 在页面写锁内原地修改记录号为rid的元组及其元信息
+ * MVCC写者在writer中完成写写冲突检测、生成撤销日志、更新版本链和修改元组，整个过程对读者是原子的
+ * @param {Rid&} rid 记录号
+ * @param {RmTupleWriter&} writer 修改回调，返回true表示修改了页面；抛出异常时页面保持writer修改前的状态由调用者保证
+ */
+void RmFileHandle::write_tuple(const Rid& rid, const RmTupleWriter& writer) {
+    RmPageHandle ph = fetch_page_handle(rid.page_no);
+    if (rid.slot_no < 0 || rid.slot_no >= file_hdr_.num_records_per_page) {
+        buffer_pool_manager_->unpin_page(ph.page->get_page_id(), false);
+        throw RMDBError("Invalid slot number: " + std::to_string(rid.slot_no));
+    }
+    ph.page->WLatch();
+    if (!Bitmap::is_set(ph.bitmap, rid.slot_no)) {
+        ph.page->WUnlatch();
+        buffer_pool_manager_->unpin_page(ph.page->get_page_id(), false);
+        throw RecordNotFoundError(rid.page_no, rid.slot_no);
+    }
+    bool modified = false;
+    try {
+        TupleMeta meta = ph.get_meta(rid.slot_no);
+        modified = writer(meta, ph.get_slot(rid.slot_no));
+        if (modified) {
+            ph.set_meta(rid.slot_no, meta);
+        }
+    } catch (...) {
+        ph.page->WUnlatch();
+        buffer_pool_manager_->unpin_page(ph.page->get_page_id(), false);
+        throw;
+    }
+    ph.page->WUnlatch();
+    if (modified) {
+        buffer_pool_manager_->mark_dirty(ph.page);
+    }
+    buffer_pool_manager_->unpin_page(ph.page->get_page_id(), modified);
+}
+
 /**
  * 以下函数为辅助函数，仅提供参考，可以选择完成如下函数，也可以删除如下函数，在单元测试中不涉及如下函数接口的直接调用
 */
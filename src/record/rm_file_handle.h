@@ -12,7 +12,15 @@ See the Mulan PSL v2 for more details. */
 
 #include <assert.h>
 
+#include <algorithm>
+#include <atomic>
+
+#include <functional>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
 
 #include "bitmap.h"
 #include "common/context.h"
@@ -27,29 +35,61 @@ struct RmPageHandle {
     RmPageHdr *page_hdr;        // page->data的第一部分，存储页面元信息，指针指向首地址，长度为sizeof(RmPageHdr)
     char *bitmap;               // page->data的第二部分，存储页面的bitmap，指针指向首地址，长度为file_hdr->bitmap_size
     char *slots;                // page->data的第三部分，存储表的记录，指针指向首地址，每个slot的长度为file_hdr->record_size
+    char *metas;                // page->data的第四部分，存储每个slot的TupleMeta，长度为num_records_per_page * sizeof(TupleMeta)
 
     RmPageHandle(const RmFileHdr *fhdr_, Page *page_) : file_hdr(fhdr_), page(page_) {
         page_hdr = reinterpret_cast<RmPageHdr *>(page->get_data() + page->OFFSET_PAGE_HDR);
         bitmap = page->get_data() + sizeof(RmPageHdr) + page->OFFSET_PAGE_HDR;
         slots = bitmap + file_hdr->bitmap_size;
+        metas = slots + file_hdr->num_records_per_page * file_hdr->record_size;
     }
 
     // 返回指定slot_no的slot存储收地址
     char* get_slot(int slot_no) const {
         return slots + slot_no * file_hdr->record_size;  // slots的首地址 + slot个数 * 每个slot的大小(每个record的大小)
     }
+
+    // 返回指定slot_no的元组元信息，页面内不保证对齐，按字节拷贝读写
+    TupleMeta get_meta(int slot_no) const {
+        TupleMeta meta;
+        memcpy(&meta, metas + slot_no * sizeof(TupleMeta), sizeof(TupleMeta));
+        return meta;
+    }
+
+    void set_meta(int slot_no, const TupleMeta &meta) {
+        memcpy(metas + slot_no * sizeof(TupleMeta), &meta, sizeof(TupleMeta));
+    }
+};
+
+/* 在页面写锁内修改元组的回调：参数为slot中的元组元信息和记录数据，返回值表示是否修改了页面 */
+using RmTupleWriter = std::function<bool(TupleMeta &meta, char *data)>;
+/* 在页面读锁内读取元组的回调 */
+using RmTupleReader = std::function<void(const TupleMeta &meta, const char *data)>;
+
+/* 只读副本上未完成的事务修改过的记录：修改它的事务，以及事务第一次修改之前记录的内容（前像），记录原来不存在时为空 */
+struct RmPendingTuple {
+    txn_id_t txn_id;
+    std::shared_ptr<RmRecord> before;
 };
 
 /* 每个RmFileHandle对应一个表的数据文件，里面有多个page，每个page的数据封装在RmPageHandle中 */
 class RmFileHandle {      
     friend class RmScan;    
     friend class RmManager;
+    friend class RmSampler;
 
    private:
     DiskManager *disk_manager_;
     BufferPoolManager *buffer_pool_manager_;
     int fd_;        // 打开文件后产生的文件句柄
+    std::string file_name_;     // 表数据文件的名称，即表名，写入日志
+    int table_id_ = -1;         // 表的编号，写入更新日志
     RmFileHdr file_hdr_;    // 文件头，维护当前表文件的元数据
+    std::mutex latch_;      // 保护file_hdr_中的空闲页链表，插入和删除记录时需要持有
+    std::atomic<uint64_t> insert_version_{0};
+    // 只读副本上未完成的事务修改过的记录，按(page_no, slot_no)排序，同一记录上按修改的顺序排列。
+    // 只在副本的重放线程中修改，读取和修改由副本的重放锁互斥
+    std::map<std::pair<int, int>, std::vector<RmPendingTuple>> pending_tuples_;
 
    public:
     RmFileHandle(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, int fd)
@@ -58,6 +98,9 @@ class RmFileHandle {
         // 这里实际就是初始化file_hdr，只不过是从磁盘中读出进行初始化
         // init file_hdr_
         disk_manager_->read_page(fd, RM_FILE_HDR_PAGE, (char *)&file_hdr_, sizeof(file_hdr_));
+        // 文件头只在关闭文件和空闲链表变化时写回，故障后可能落后于已经写回磁盘的页面
+        file_name_ = disk_manager_->get_file_name(fd);
+        file_hdr_.num_pages = std::max(file_hdr_.num_pages, disk_manager_->get_file_size(file_name_) / PAGE_SIZE);
         // disk_manager管理的fd对应的文件中，设置从file_hdr_.num_pages开始分配page_no
         disk_manager_->set_fd2pageno(fd, file_hdr_.num_pages);
     }
@@ -65,6 +108,13 @@ class RmFileHandle {
     RmFileHdr get_file_hdr() const { return file_hdr_; } 
     int GetFd() { return fd_; }
 
+    int get_table_id() const { return table_id_; }
+    void set_table_id(int table_id) { table_id_ = table_id; }
+
+    /* OCC下表的插入版本，每次插入新元组前递增，扫描过该表的事务在提交时据此检测幻读 */
+    uint64_t get_insert_version() const { return insert_version_; }
+    uint64_t bump_insert_version() { return insert_version_.fetch_add(1); }
+
     /* 判断指定位置上是否已经存在一条记录，通过Bitmap来判断 */
     bool is_record(const Rid &rid) const {
         RmPageHandle page_handle = fetch_page_handle(rid.page_no);
@@ -73,14 +123,38 @@ class RmFileHandle {
 
     std::unique_ptr<RmRecord> get_record(const Rid &rid, Context *context) const;
 
+    std::unique_ptr<RmRecord> get_tuple_image(const Rid &rid) const;
+
+    void add_pending_tuple(const Rid &rid, txn_id_t txn_id, std::shared_ptr<RmRecord> before);
+
+    bool has_pending_tuple(const Rid &rid, txn_id_t txn_id) const;
+
+    void remove_pending_tuple(const Rid &rid, txn_id_t txn_id);
+
+    int next_slot(const RmPageHandle &page_handle, int slot_no) const;
+
     Rid insert_record(char *buf, Context *context);
 
+    Rid insert_record(char *buf, const TupleMeta &meta, Context *context);
+
     void insert_record(const Rid &rid, char *buf);
 
+    void read_tuple(const Rid &rid, const RmTupleReader &reader) const;
+
+    void write_tuple(const Rid &rid, const RmTupleWriter &writer);
+
     void delete_record(const Rid &rid, Context *context);
 
     void update_record(const Rid &rid, char *buf, Context *context);
 
+    void rollback_tuple(const Rid &rid, const char *buf, lsn_t undo_next_lsn, Context *context);
+
+    bool redo_tuple(const Rid &rid, const char *buf, lsn_t lsn);
+
+    bool redo_update(const UpdateLogRecord &log_record);
+
+    void rebuild_free_list();
+
     RmPageHandle create_new_page_handle();
 
     RmPageHandle fetch_page_handle(int page_no) const;
@@ -89,4 +163,14 @@ class RmFileHandle {
     RmPageHandle create_page_handle();
 
     void release_page_handle(RmPageHandle &page_handle);
+
+    bool redo(const Rid &rid, lsn_t lsn, const std::function<void(RmPageHandle &)> &apply);
+
+    void set_slot(RmPageHandle &page_handle, int slot_no, const char *buf);
+
+    void update_free_list(RmPageHandle &page_handle, bool was_full);
+
+    static bool is_logged(Context *context);
+
+    void append_log(Page *page, LogRecord *log_record, Context *context);
 };
\ No newline at end of file
@@ -26,6 +26,18 @@ class RmManager {
     RmManager(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager)
         : disk_manager_(disk_manager), buffer_pool_manager_(buffer_pool_manager) {}
 
+    /**
+     * @description: 记录大小为record_size时每个页面的slot数量
+     * We have: sizeof(hdr) + (n + 7) / 8 + n * (record_size + sizeof(TupleMeta)) <= PAGE_SIZE
+     * 每个slot额外保存一个TupleMeta（MVCC的版本时间戳和删除标记）
+     */
+    static int records_per_page(int record_size) {
+        // 公式中用文件头的大小为页面LSN和页头预留空间
+        static_assert(sizeof(RmFileHdr) >= Page::OFFSET_PAGE_HDR + sizeof(RmPageHdr), "page header does not fit");
+        int slot_size = record_size + (int)sizeof(TupleMeta);
+        return (BITMAP_WIDTH * (PAGE_SIZE - 1 - (int)sizeof(RmFileHdr)) + 1) / (1 + slot_size * BITMAP_WIDTH);
+    }
+
     /**
      * @description: 创建表的数据文件并初始化相关信息
      * @param {string&} filename 要创建的文件名称
@@ -43,10 +55,9 @@ class RmManager {
         file_hdr.record_size = record_size;
         file_hdr.num_pages = 1;
         file_hdr.first_free_page_no = RM_NO_PAGE;
-        // We have: sizeof(hdr) + (n + 7) / 8 + n * record_size <= PAGE_SIZE
-        file_hdr.num_records_per_page =
-            (BITMAP_WIDTH * (PAGE_SIZE - 1 - (int)sizeof(RmFileHdr)) + 1) / (1 + record_size * BITMAP_WIDTH);
+        file_hdr.num_records_per_page = records_per_page(record_size);
         file_hdr.bitmap_size = (file_hdr.num_records_per_page + BITMAP_WIDTH - 1) / BITMAP_WIDTH;
+        file_hdr.page_lsn_size = sizeof(lsn_t);
 
         // 将file header写入磁盘文件（名为file name，文件描述符为fd）中的第0页
         // head page直接写入磁盘，没有经过缓冲区的NewPage，那么也就不需要FlushPage
@@ -67,8 +78,20 @@ class RmManager {
      * @return {unique_ptr<RmFileHandle>} 文件句柄的指针
      */
     std::unique_ptr<RmFileHandle> open_file(const std::string& filename) {
+        // 文件头比现在短的旧文件（还没有插入过记录时只有文件头）读不出完整的文件头
+        if (disk_manager_->get_file_size(filename) < static_cast<int>(sizeof(RmFileHdr))) {
+            throw IncompatibleFileFormatError(filename);
+        }
         int fd = disk_manager_->open_file(filename);
-        return std::make_unique<RmFileHandle>(disk_manager_, buffer_pool_manager_, fd);
+        auto file_handle = std::make_unique<RmFileHandle>(disk_manager_, buffer_pool_manager_, fd);
+        // 页面中加入TupleMeta之前创建的文件每页的slot更多，按现在的布局读取会越过页面末尾；
+        // 页面LSN加宽到8字节之前创建的文件页头位置不同
+        if (file_handle->file_hdr_.num_records_per_page != records_per_page(file_handle->file_hdr_.record_size) ||
+            file_handle->file_hdr_.page_lsn_size != static_cast<int>(sizeof(lsn_t))) {
+            disk_manager_->close_file(fd);
+            throw IncompatibleFileFormatError(filename);
+        }
+        return file_handle;
     }
     /**
      * @description: 关闭表的数据文件
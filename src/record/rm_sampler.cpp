@@ -0,0 +1,69 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "rm_sampler.h"
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+
+#include "rm_file_handle.h"
+
+/**
+ * @description: 随机采样数据页，对采样页中的每条记录求谓词
+ * @return {RmSampleStats} 采样结果，超时时返回已采样部分的结果
+ * @param {RecordPredicate} &pred 谓词，为空时只统计记录数
+ * @param {microseconds} budget 时间预算，每采样一个页面检查一次
+ */
+RmSampleStats RmSampler::sample(const RecordPredicate &pred, std::chrono::microseconds budget) {
+    RmSampleStats stats;
+    RmFileHdr hdr = file_handle_->get_file_hdr();
+    stats.total_pages = hdr.num_pages - RM_FIRST_RECORD_PAGE;
+    if (stats.total_pages <= 0) {
+        return stats;
+    }
+
+    int num_samples = static_cast<int>(stats.total_pages * fraction_);
+    num_samples = std::min(std::max(num_samples, min_pages_), stats.total_pages);
+
+    // 随机选取num_samples个不重复的页面，按页号排序后读取，使磁盘访问尽量顺序
+    std::vector<page_id_t> page_nos(stats.total_pages);
+    std::iota(page_nos.begin(), page_nos.end(), RM_FIRST_RECORD_PAGE);
+    std::vector<page_id_t> samples;
+    samples.reserve(num_samples);
+    std::sample(page_nos.begin(), page_nos.end(), std::back_inserter(samples), num_samples,
+                std::mt19937{std::random_device{}()});
+
+    auto deadline = std::chrono::steady_clock::now() + budget;
+    Page page;
+    RmPageHandle ph(&hdr, &page);
+    RmRecord rec;
+    rec.size = hdr.record_size;
+    for (page_id_t page_no : samples) {
+        if (stats.sampled_pages > 0 && std::chrono::steady_clock::now() > deadline) {
+            break;
+        }
+        if (!file_handle_->buffer_pool_manager_->copy_page({file_handle_->fd_, page_no}, page.get_data())) {
+            continue;
+        }
+        stats.sampled_pages++;
+        for (int slot_no = Bitmap::first_bit(true, ph.bitmap, hdr.num_records_per_page);
+             slot_no < hdr.num_records_per_page;
+             slot_no = Bitmap::next_bit(true, ph.bitmap, hdr.num_records_per_page, slot_no)) {
+            stats.sampled_records++;
+            rec.data = ph.get_slot(slot_no);
+            if (pred == nullptr || pred(rec)) {
+                stats.matched_records++;
+            }
+        }
+    }
+    rec.data = nullptr;
+    return stats;
+}
@@ -0,0 +1,57 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <chrono>
+#include <functional>
+
+#include "rm_defs.h"
+
+class RmFileHandle;
+
+/* 一次块采样的结果 */
+struct RmSampleStats {
+    int total_pages = 0;            // 表中数据页的数量
+    int sampled_pages = 0;          // 实际采样的数据页数量
+    size_t sampled_records = 0;     // 采样页中的记录数
+    size_t matched_records = 0;     // 采样页中满足谓词的记录数
+
+    bool valid() const { return sampled_pages > 0; }
+
+    // 按采样页的平均记录数估计全表记录数
+    double est_records() const {
+        return sampled_pages == 0 ? 0 : static_cast<double>(sampled_records) * total_pages / sampled_pages;
+    }
+
+    double selectivity() const {
+        return sampled_records == 0 ? 0 : static_cast<double>(matched_records) / sampled_records;
+    }
+};
+
+/**
+ * @description: 表数据文件的块采样
+ * 随机选取一定比例的数据页，通过BufferPoolManager::copy_page读取：已在缓冲池中的页面在页面读锁内拷贝，
+ * 不会读到修改了一半的页面；不在缓冲池中的页面直接从磁盘读取，不占用帧，因此采样不会把热点页面挤出缓冲池。
+ */
+class RmSampler {
+   public:
+    using RecordPredicate = std::function<bool(const RmRecord &rec)>;
+
+    RmSampler(const RmFileHandle *file_handle, double fraction, int min_pages = 1)
+        : file_handle_(file_handle), fraction_(fraction), min_pages_(min_pages) {}
+
+    RmSampleStats sample(const RecordPredicate &pred, std::chrono::microseconds budget);
+
+   private:
+    const RmFileHandle *file_handle_;
+    double fraction_;               // 采样的数据页比例，取值(0, 1]
+    int min_pages_;                 // 最少采样的页面数，小表时可以直接全表采样
+};
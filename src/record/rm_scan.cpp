@@ -45,8 +45,8 @@ void RmScan::next() {
 
     while (rid_.page_no < hdr.num_pages && rid_.page_no >= RM_FIRST_RECORD_PAGE) {
         RmPageHandle ph = file_handle_->fetch_page_handle(rid_.page_no); // Page is pinned
-        // 在当前页的 bitmap 中查找下一个为 'true' (已设置) 的位
-        int next_slot = Bitmap::next_bit(true, ph.bitmap, hdr.num_records_per_page, rid_.slot_no);
+        // 在当前页的 bitmap 中查找下一个为 'true' (已设置) 的位，只读副本上还包括被未完成的事务删除的记录
+        int next_slot = file_handle_->next_slot(ph, rid_.slot_no);
 
         if (next_slot < hdr.num_records_per_page) {
             // 在当前页面找到了下一个记录
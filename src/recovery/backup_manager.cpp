@@ -0,0 +1,213 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "backup_manager.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include "errors.h"
+
+namespace {
+
+/* 把内容写入文件并持久化，文件已存在时覆盖 */
+void write_file(const std::string &name, const char *data, size_t size) {
+    int fd = ::open(name.c_str(), O_CREAT | O_WRONLY | O_TRUNC, 0600);
+    if (fd < 0) {
+        throw UnixError();
+    }
+    bool ok = ::write(fd, data, size) == static_cast<ssize_t>(size) && fdatasync(fd) == 0;
+    ::close(fd);
+    if (!ok) {
+        throw UnixError();
+    }
+}
+
+/* 把目录同步到磁盘，目录中新建或重命名的文件在故障后仍然存在 */
+void sync_dir(const std::string &dir) {
+    int fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+    if (fd < 0) {
+        throw UnixError();
+    }
+    int ret = fsync(fd);
+    ::close(fd);
+    if (ret < 0) {
+        throw UnixError();
+    }
+}
+
+}  // namespace
+
+/**
+ * @description: 把当前数据库在线备份到目录dir中，备份期间其他事务可以继续读写。
+ * 1. 做一次检查点，此后检查点保留从它恢复需要的日志
+ * 2. 拷贝元数据和存储过程，通过缓冲池逐页拷贝表和索引的文件
+ * 3. 持久化日志，拷贝从检查点需要的最早日志到已经持久化的日志末尾，拷贝的页面上的修改都在这段日志中
+ * 4. 最后写入指向该检查点的主记录，没有主记录的备份是不完整的
+ * 与故障恢复相同，备份只包括两阶段封锁下写日志的表的修改；备份期间拒绝DDL，
+ * 拷贝的元数据、存储过程与拷贝的数据文件对应同一组表和索引
+ * @return {BackupStatus} 备份的日志范围和拷贝的数据量
+ * @param {string&} dir 备份目录，不能已经存在；相对路径相对于启动服务端的目录
+ */
+BackupStatus BackupManager::backup(const std::string &dir) {
+    std::unique_lock<std::mutex> lock(backup_latch_, std::try_to_lock);
+    if (!lock.owns_lock()) {
+        throw BackupError("another backup is in progress");
+    }
+    if (dir.empty()) {
+        throw BackupError("backup directory is empty");
+    }
+    // 打开数据库后当前目录是数据库目录
+    std::string path = dir[0] == '/' ? dir : "../" + dir;
+    if (mkdir(path.c_str(), 0755) < 0) {
+        throw BackupError(dir + ": " + strerror(errno));
+    }
+    start_time_ = std::chrono::steady_clock::now();
+    bytes_copied_ = 0;
+    // 检查点完成之前保留所有日志，之后只保留从它恢复需要的日志
+    retained_lsn_ = 0;
+    sm_manager_->begin_backup();
+    try {
+        // 1. 检查点
+        lsn_t log_start_lsn;
+        lsn_t checkpoint_lsn = checkpoint_manager_->checkpoint(false, &log_start_lsn);
+        retained_lsn_ = log_start_lsn;
+
+        // 2. 元数据和数据文件，各页面可能是不同时刻的状态，由之后拷贝的日志重做到一致
+        std::ifstream meta(DB_META_NAME);
+        std::stringstream meta_data;
+        meta_data << meta.rdbuf();
+        std::string meta_str = meta_data.str();
+        write_file(path + "/" + DB_META_NAME, meta_str.data(), meta_str.size());
+        std::ifstream proc(PROCEDURE_FILE_NAME);
+        if (proc.is_open()) {
+            std::stringstream proc_data;
+            proc_data << proc.rdbuf();
+            std::string proc_str = proc_data.str();
+            write_file(path + "/" + PROCEDURE_FILE_NAME, proc_str.data(), proc_str.size());
+        }
+        std::vector<int> fds;
+        for (auto &[tab_name, fh] : sm_manager_->fhs_) {
+            fds.push_back(fh->GetFd());
+        }
+        for (auto &[ix_name, ih] : sm_manager_->ihs_) {
+            fds.push_back(ih->get_fd());
+        }
+        size_t data_bytes = 0;
+        for (int fd : fds) {
+            data_bytes += copy_file(fd, path);
+        }
+
+        // 3. 拷贝的页面上的修改在页面写锁内追加了日志，持久化之后都不晚于end_lsn
+        log_manager_->flush_log_to_disk();
+        lsn_t end_lsn = log_manager_->get_persist_lsn() + 1;
+        size_t log_bytes = copy_log(log_start_lsn, end_lsn, path);
+
+        // 4. 数据和日志都持久化之后再写主记录
+        sync_dir(path);
+        disk_manager_->write_master_record(checkpoint_lsn, log_start_lsn, path);
+        sync_dir(path);
+        retained_lsn_ = INVALID_LSN;
+        sm_manager_->end_backup();
+
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time_).count();
+        return {{"backup_dir", dir},
+                {"checkpoint_lsn", std::to_string(checkpoint_lsn)},
+                {"start_lsn", std::to_string(log_start_lsn)},
+                {"end_lsn", std::to_string(end_lsn)},
+                {"data_bytes", std::to_string(data_bytes)},
+                {"log_bytes", std::to_string(log_bytes)},
+                {"seconds", std::to_string(seconds)}};
+    } catch (RMDBError &) {
+        retained_lsn_ = INVALID_LSN;
+        sm_manager_->end_backup();
+        throw;
+    }
+}
+
+/**
+ * @description: 通过缓冲池逐页拷贝一个表或索引的文件到备份目录，每一页都是某一时刻完整的页面。
+ * 只拷贝开始时已经分配的页面，之后分配的页面由重做扩展；从未写回磁盘、也不在缓冲池中的页面跳过
+ * @return {size_t} 拷贝的字节数
+ * @param {int} fd 文件句柄
+ * @param {string&} dir 备份目录
+ */
+size_t BackupManager::copy_file(int fd, const std::string &dir) {
+    std::string name = disk_manager_->get_file_name(fd);
+    int file_size = disk_manager_->get_file_size(name);
+    int num_pages = std::max(disk_manager_->get_fd2pageno(fd), (file_size + PAGE_SIZE - 1) / PAGE_SIZE);
+    int dst_fd = ::open((dir + "/" + name).c_str(), O_CREAT | O_WRONLY | O_TRUNC, 0600);
+    if (dst_fd < 0) {
+        throw UnixError();
+    }
+    size_t bytes = 0;
+    char buf[PAGE_SIZE];
+    for (int page_no = 0; page_no < num_pages; page_no++) {
+        // 文件头页只写入了文件头，文件的最后一页可能不完整
+        memset(buf, 0, PAGE_SIZE);
+        int num_bytes = std::clamp(file_size - page_no * PAGE_SIZE, 1, PAGE_SIZE);
+        if (!buffer_pool_manager_->copy_page({fd, page_no}, buf, num_bytes)) {
+            continue;
+        }
+        if (pwrite(dst_fd, buf, PAGE_SIZE, static_cast<off_t>(page_no) * PAGE_SIZE) != PAGE_SIZE) {
+            ::close(dst_fd);
+            throw UnixError();
+        }
+        bytes += PAGE_SIZE;
+        throttle(PAGE_SIZE);
+    }
+    int ret = fsync(dst_fd);
+    ::close(dst_fd);
+    if (ret < 0) {
+        throw UnixError();
+    }
+    return bytes;
+}
+
+/**
+ * @description: 拷贝[start_lsn, end_lsn)的日志到备份目录中的日志段，日志号不变
+ * @return {size_t} 拷贝的字节数
+ * @param {lsn_t} start_lsn 拷贝的第一个字节的日志号
+ * @param {lsn_t} end_lsn 拷贝的日志的末尾
+ * @param {string&} dir 备份目录
+ */
+size_t BackupManager::copy_log(lsn_t start_lsn, lsn_t end_lsn, const std::string &dir) {
+    std::vector<char> buffer(LOG_BUFFER_SIZE);
+    lsn_t lsn = start_lsn;
+    while (lsn < end_lsn) {
+        int len = disk_manager_->read_log(buffer.data(), static_cast<int>(std::min<lsn_t>(end_lsn - lsn, LOG_BUFFER_SIZE)), lsn);
+        if (len <= 0) {
+            throw BackupError("log at lsn " + std::to_string(lsn) + " is missing");
+        }
+        disk_manager_->write_log_to(dir, buffer.data(), len, lsn);
+        lsn += len;
+        throttle(len);
+    }
+    return end_lsn - start_lsn;
+}
+
+/**
+ * @description: 限制备份的I/O速率，拷贝的数据量超过按BACKUP_MAX_BYTES_PER_SEC计算的配额时等待
+ * @param {size_t} bytes 刚刚拷贝的字节数
+ */
+void BackupManager::throttle(size_t bytes) {
+    bytes_copied_ += bytes;
+    auto due = start_time_ + std::chrono::microseconds(bytes_copied_ * 1000000 / BACKUP_MAX_BYTES_PER_SEC);
+    if (due > std::chrono::steady_clock::now()) {
+        std::this_thread::sleep_until(due);
+    }
+}
@@ -0,0 +1,67 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "checkpoint_manager.h"
+#include "log_manager.h"
+#include "system/sm_manager.h"
+
+/* 备份结果，每一项为名称和值 */
+using BackupStatus = std::vector<std::pair<std::string, std::string>>;
+
+/* 在线备份：不停止写入，把数据库拷贝到另一个目录，得到一个可以直接打开的一致快照。
+ * 先做一次检查点，再通过缓冲池逐页拷贝数据文件（模糊拷贝，各页面是不同时刻的状态），
+ * 最后拷贝从检查点需要的最早日志到拷贝结束时已经持久化的日志，并写入指向该检查点的主记录。
+ * 打开备份时的故障恢复重做这段日志、回滚备份结束时未完成的事务，得到备份结束时已提交的状态。
+ * 拷贝期间检查点保留这段日志；数据和日志的拷贝按BACKUP_MAX_BYTES_PER_SEC限速，减少对前台事务的影响 */
+class BackupManager {
+   public:
+    BackupManager(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, SmManager *sm_manager,
+                  LogManager *log_manager, CheckpointManager *checkpoint_manager)
+        : disk_manager_(disk_manager),
+          buffer_pool_manager_(buffer_pool_manager),
+          sm_manager_(sm_manager),
+          log_manager_(log_manager),
+          checkpoint_manager_(checkpoint_manager) {}
+
+    BackupStatus backup(const std::string &dir);
+
+    /**
+     * @description: 正在进行的备份需要保留的最早的日志，作为检查点的日志保留条件
+     * @return {lsn_t} 需要保留的最早的日志号，没有正在进行的备份时返回INVALID_LSN
+     */
+    lsn_t get_retained_lsn() { return retained_lsn_; }
+
+   private:
+    size_t copy_file(int fd, const std::string &dir);
+
+    size_t copy_log(lsn_t start_lsn, lsn_t end_lsn, const std::string &dir);
+
+    void throttle(size_t bytes);
+
+    DiskManager *disk_manager_;
+    BufferPoolManager *buffer_pool_manager_;
+    SmManager *sm_manager_;
+    LogManager *log_manager_;
+    CheckpointManager *checkpoint_manager_;
+
+    std::mutex backup_latch_;                           // 同一时刻只进行一个备份
+    std::atomic<lsn_t> retained_lsn_{INVALID_LSN};      // 正在进行的备份需要保留的最早的日志
+    std::chrono::steady_clock::time_point start_time_;  // 本次备份开始的时间，用于限速
+    size_t bytes_copied_ = 0;                           // 本次备份已经拷贝的字节数
+};
@@ -0,0 +1,113 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "checkpoint_manager.h"
+
+#include <algorithm>
+#include <iostream>
+#include <limits>
+
+/**
+ * @description: 做一次模糊检查点
+ * 1. 写回recLSN早于上一个检查点的脏页，经过两个检查点仍未写回的页面不会拖住日志截断
+ * 2. 追加检查点开始日志，获取活跃事务表和脏页表，追加带有这两张表的检查点结束日志并持久化
+ * 3. 把写回的数据页同步到磁盘，原子地写入主记录，释放恢复不再需要的日志
+ * @return {lsn_t} 检查点开始日志的日志号
+ * @param {bool} flush_all 是否写回所有脏页，关闭数据库时使用，此后恢复不需要重做
+ * @param {lsn_t*} log_start_lsn 不为空时返回从这个检查点恢复需要的最早的日志号，不包括其他日志保留条件
+ */
+lsn_t CheckpointManager::checkpoint(bool flush_all, lsn_t *log_start_lsn) {
+    std::scoped_lock lock{checkpoint_latch_};
+    // 1. 写回较早变脏的页面
+    buffer_pool_manager_->flush_pages_before(flush_all ? std::numeric_limits<lsn_t>::max() : last_checkpoint_lsn_);
+
+    // 2. 开始日志之后才获取两张表：此后修改的页面的recLSN、开始的事务的第一条日志都不早于开始日志
+    CheckpointBeginLogRecord begin_record;
+    lsn_t begin_lsn = log_manager_->add_log_to_buffer(&begin_record);
+    std::vector<CheckpointTxnEntry> active_txns = txn_manager_->get_active_transactions();
+    std::vector<CheckpointPageEntry> dirty_pages;
+    for (auto &[page_id, rec_lsn] : buffer_pool_manager_->get_dirty_pages()) {
+        dirty_pages.push_back({disk_manager_->get_file_name(page_id.fd), page_id.page_no, rec_lsn});
+    }
+    CheckpointEndLogRecord end_record(active_txns, dirty_pages);
+    lsn_t end_lsn = log_manager_->add_log_to_buffer(&end_record);
+    log_manager_->wait_for_flush(end_lsn);
+
+    // 3. 恢复需要的最早的日志：活跃事务的第一条日志（撤销）和脏页的recLSN（重做）
+    lsn_t start_lsn = begin_lsn;
+    for (auto &txn : active_txns) {
+        start_lsn = std::min(start_lsn, txn.first_lsn);
+    }
+    for (auto &page : dirty_pages) {
+        start_lsn = std::min(start_lsn, page.rec_lsn);
+    }
+    if (log_start_lsn != nullptr) {
+        *log_start_lsn = start_lsn;
+    }
+    lsn_t retained_start_lsn = start_lsn;
+    for (auto &log_retention : log_retentions_) {
+        lsn_t retained_lsn = log_retention();
+        if (retained_lsn != INVALID_LSN) {
+            retained_start_lsn = std::min(retained_start_lsn, retained_lsn);
+        }
+    }
+    // 主记录指向的检查点之前写回的页面必须已经持久化，否则恢复时找不到重做它们所需的日志
+    disk_manager_->sync_data();
+    disk_manager_->write_master_record(begin_lsn, retained_start_lsn);
+    disk_manager_->discard_log(retained_start_lsn);
+    last_checkpoint_lsn_ = begin_lsn;
+    return begin_lsn;
+}
+
+/**
+ * @description: 启动后台检查点线程，每隔CHECKPOINT_INTERVAL做一次检查点
+ */
+void CheckpointManager::start() {
+    std::scoped_lock lock{latch_};
+    if (running_) {
+        return;
+    }
+    running_ = true;
+    thread_ = std::thread(&CheckpointManager::run, this);
+}
+
+/**
+ * @description: 停止后台检查点线程，正在进行的检查点会先完成
+ */
+void CheckpointManager::stop() {
+    {
+        std::scoped_lock lock{latch_};
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+    }
+    cv_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void CheckpointManager::run() {
+    std::unique_lock<std::mutex> lock(latch_);
+    while (running_) {
+        cv_.wait_for(lock, CHECKPOINT_INTERVAL, [&] { return !running_; });
+        if (!running_) {
+            break;
+        }
+        lock.unlock();
+        try {
+            checkpoint();
+        } catch (RMDBError &e) {
+            std::cerr << "checkpoint failed: " << e.what() << std::endl;
+        }
+        lock.lock();
+    }
+}
@@ -0,0 +1,70 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "log_manager.h"
+#include "storage/buffer_pool_manager.h"
+#include "transaction/transaction_manager.h"
+
+/* 检查点管理器，周期性地做模糊检查点（fuzzy checkpoint）
+ * 检查点不阻塞事务：先写回上一个检查点之前就已变脏的页面，然后在检查点开始日志和结束日志之间
+ * 记录当时的活跃事务表和脏页表，结束日志持久化、数据页同步到磁盘之后再原子地更新主记录。
+ * 故障恢复时只需要从主记录中的检查点开始分析，活跃事务的第一条日志和脏页的recLSN都早于的日志可以丢弃。
+ */
+class CheckpointManager {
+   public:
+    CheckpointManager(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, LogManager *log_manager,
+                      TransactionManager *txn_manager)
+        : disk_manager_(disk_manager),
+          buffer_pool_manager_(buffer_pool_manager),
+          log_manager_(log_manager),
+          txn_manager_(txn_manager) {}
+
+    ~CheckpointManager() { stop(); }
+
+    lsn_t checkpoint(bool flush_all = false, lsn_t *log_start_lsn = nullptr);
+
+    void start();
+
+    void stop();
+
+    lsn_t get_last_checkpoint_lsn() { return last_checkpoint_lsn_; }
+
+    /**
+     * @description: 添加检查点之外还需要保留的日志，例如只读副本还没有重放的日志、正在进行的备份需要的日志，
+     * 在启动后台检查点线程之前添加
+     * @param {function<lsn_t()>} retention 返回需要保留的最早的日志号，不需要保留时返回INVALID_LSN
+     */
+    void add_log_retention(std::function<lsn_t()> retention) { log_retentions_.push_back(std::move(retention)); }
+
+   private:
+    void run();
+
+    DiskManager *disk_manager_;
+    BufferPoolManager *buffer_pool_manager_;
+    LogManager *log_manager_;
+    TransactionManager *txn_manager_;
+
+    std::mutex checkpoint_latch_;               // 串行化检查点
+    lsn_t last_checkpoint_lsn_ = INVALID_LSN;   // 最近一个完成的检查点的开始日志的日志号
+    std::vector<std::function<lsn_t()>> log_retentions_;    // 检查点之外需要保留的最早的日志号
+
+    std::mutex latch_;                          // 保护running_
+    std::condition_variable cv_;
+    bool running_ = false;
+    std::thread thread_;                        // 后台检查点线程
+};
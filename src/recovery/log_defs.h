@@ -18,6 +18,18 @@ See the Mulan PSL v2 for more details. */
 #include <chrono>
 
 static constexpr std::chrono::duration<int64_t> FLUSH_TIMEOUT = std::chrono::seconds(3);
+// interval between two fuzzy checkpoints taken by the background checkpointer
+static constexpr std::chrono::duration<int64_t> CHECKPOINT_INTERVAL = std::chrono::seconds(10);
+// max time the log flusher waits to gather more commits into one group
+static constexpr std::chrono::microseconds GROUP_COMMIT_DELAY = std::chrono::microseconds(200);
+// max time a replication sender waits for new durable log before sending a keepalive to the replica
+static constexpr std::chrono::milliseconds REPLICATION_KEEPALIVE_INTERVAL = std::chrono::milliseconds(100);
+// interval between two attempts of a replica to connect to the primary
+static constexpr std::chrono::milliseconds REPLICATION_RETRY_INTERVAL = std::chrono::milliseconds(1000);
+// max bytes of log in one replication message
+static constexpr int REPLICATION_MAX_MESSAGE = LOG_BUFFER_SIZE;
+// unchanged bytes between two changed ranges of a record up to which an update log merges them into one range
+static constexpr int UPDATE_RANGE_MERGE_GAP = 1;
 // the offset of log_type_ in log header
 static constexpr int OFFSET_LOG_TYPE = 0;
 // the offset of lsn_ in log header
@@ -28,8 +40,10 @@ static constexpr int OFFSET_LOG_TOT_LEN = OFFSET_LSN + sizeof(lsn_t);
 static constexpr int OFFSET_LOG_TID = OFFSET_LOG_TOT_LEN + sizeof(uint32_t);
 // the offset of prev_lsn_ in log header
 static constexpr int OFFSET_PREV_LSN = OFFSET_LOG_TID + sizeof(txn_id_t);
+// the offset of the CRC32C of the log record, which covers every byte of the record except itself
+static constexpr int OFFSET_LOG_CRC = OFFSET_PREV_LSN + sizeof(lsn_t);
 // offset of log data
-static constexpr int OFFSET_LOG_DATA = OFFSET_PREV_LSN + sizeof(lsn_t);
+static constexpr int OFFSET_LOG_DATA = OFFSET_LOG_CRC + sizeof(uint32_t);
 // sizeof log_header
 static constexpr int LOG_HEADER_SIZE = OFFSET_LOG_DATA;
 
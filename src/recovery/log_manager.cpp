@@ -8,8 +8,22 @@ EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
 MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
 See the Mulan PSL v2 for more details. */
 
+#include <algorithm>
 #include <cstring>
 #include "log_manager.h"
+#include "errors.h"
+
+std::atomic<bool> enable_logging(true);
+std::chrono::duration<int64_t> log_timeout = FLUSH_TIMEOUT;
+
+LogManager::LogManager(DiskManager* disk_manager) {
+    disk_manager_ = disk_manager;
+    for (auto &buffer : buffers_) {
+        buffer.data_ = std::make_unique<char[]>(LOG_BUFFER_SIZE);
+    }
+    // 初始时由0号缓冲区接收日志
+    buffers_[0].free_ = false;
+}
 
 /**
  * @description: 添加日志记录到日志缓冲区中，并返回日志记录号
@@ -17,12 +31,289 @@ See the Mulan PSL v2 for more details. */
  * @return {lsn_t} 返回该日志的日志记录号
  */
 lsn_t LogManager::add_log_to_buffer(LogRecord* log_record) {
-  
+    uint32_t len = log_record->log_tot_len_;
+    if (len > LOG_BUFFER_SIZE) {
+        throw InternalError("log record is larger than the log buffer");
+    }
+    while (true) {
+        // 当前缓冲区已满、正在切换时不再预留，避免已预留字节数无限增长
+        if (state_offset(state_.load()) > LOG_BUFFER_SIZE) {
+            std::unique_lock<std::mutex> lock(switch_latch_);
+            switch_cv_.wait(lock, [&] { return state_offset(state_.load()) <= LOG_BUFFER_SIZE; });
+            continue;
+        }
+        // 一次原子加法预留空间，日志号是缓冲区的起始日志号加上预留的位置，也就是日志在日志文件中的偏移量。
+        // 预留成功时缓冲区要等本线程拷贝完成才会刷盘、重新使用，起始日志号不会变化
+        uint64_t state = state_.fetch_add(len);
+        uint64_t offset = state_offset(state);
+        int index = state_index(state);
+        if (offset + len <= LOG_BUFFER_SIZE) {
+            lsn_t lsn = buffers_[index].start_lsn_ + static_cast<lsn_t>(offset);
+            log_record->lsn_ = lsn;
+            char* dest = buffers_[index].data_.get() + offset;
+            log_record->serialize(dest);
+            set_log_record_crc(dest);
+            if (log_record->log_type_ == LogType::commit) {
+                lsn_t last_commit_lsn = last_commit_lsn_;
+                while (last_commit_lsn < lsn && !last_commit_lsn_.compare_exchange_weak(last_commit_lsn, lsn)) {
+                }
+            }
+            buffers_[index].written_.fetch_add(len, std::memory_order_release);
+            return lsn;
+        }
+        if (offset <= LOG_BUFFER_SIZE) {
+            // 第一个越过缓冲区末尾的预留，由本线程切换缓冲区，缓冲区的有效内容到offset为止，下一个缓冲区从本条日志的日志号开始
+            switch_buffer(index, static_cast<uint32_t>(offset), buffers_[index].start_lsn_ + static_cast<lsn_t>(offset));
+        }
+    }
+}
+
+/**
+ * @description: 把写满的缓冲区交给刷盘，并切换到下一个缓冲区；下一个缓冲区还未刷盘时帮助刷盘
+ * @param {int} index 写满的缓冲区
+ * @param {uint32_t} end 缓冲区的有效字节数
+ * @param {lsn_t} next_lsn 下一个缓冲区中第一条日志的日志号
+ */
+void LogManager::switch_buffer(int index, uint32_t end, lsn_t next_lsn) {
+    int next = (index + 1) % LOG_BUFFER_NUM;
+    while (true) {
+        {
+            std::scoped_lock lock{switch_latch_};
+            if (buffers_[next].free_) {
+                seal(index, end, next_lsn);
+                switch_cv_.notify_all();
+                return;
+            }
+        }
+        std::scoped_lock flush_lock{flush_latch_};
+        write_sealed_buffers();
+    }
+}
+
+/**
+ * @description: 刷盘时把未写满的当前缓冲区切换出去
+ * @return {bool} 下一个缓冲区还未刷盘、无法切换时返回false
+ */
+bool LogManager::seal_current_buffer() {
+    std::scoped_lock lock{switch_latch_};
+    uint64_t state = state_.load();
+    int index = state_index(state);
+    int next = (index + 1) % LOG_BUFFER_NUM;
+    if (!buffers_[next].free_) {
+        return false;
+    }
+    buffers_[next].written_ = 0;
+    lsn_t start_lsn = buffers_[index].start_lsn_;
+    while (true) {
+        uint64_t offset = state_offset(state);
+        if (offset == 0 || offset > LOG_BUFFER_SIZE) {
+            // 缓冲区为空，或者已写满、由追加日志的线程负责切换
+            return true;
+        }
+        // 切换之前发布下一个缓冲区的起始日志号，切换后在下一个缓冲区中预留的线程一定能读到
+        buffers_[next].start_lsn_ = start_lsn + static_cast<lsn_t>(offset);
+        if (state_.compare_exchange_weak(state, make_state(next))) {
+            buffers_[next].free_ = false;
+            buffers_[index].size_ = static_cast<uint32_t>(offset);
+            buffers_[index].last_lsn_ = start_lsn + static_cast<lsn_t>(offset) - 1;
+            sealed_.push_back(index);
+            return true;
+        }
+    }
+}
+
+/**
+ * @description: 切换到下一个缓冲区，调用者持有switch_latch_，并且下一个缓冲区空闲
+ * 越过末尾的预留失败后会重试，它们没有分配日志号，下一个缓冲区的日志号从next_lsn开始，与文件偏移量保持一致
+ * @param {int} index 当前缓冲区
+ * @param {uint32_t} end 当前缓冲区的有效字节数
+ * @param {lsn_t} next_lsn 下一个缓冲区中第一条日志的日志号
+ */
+void LogManager::seal(int index, uint32_t end, lsn_t next_lsn) {
+    int next = (index + 1) % LOG_BUFFER_NUM;
+    buffers_[next].written_ = 0;
+    buffers_[next].free_ = false;
+    buffers_[index].size_ = end;
+    buffers_[index].last_lsn_ = next_lsn - 1;
+    sealed_.push_back(index);
+    buffers_[next].start_lsn_ = next_lsn;
+    // 当前缓冲区已满，此时只有失败的预留会修改状态字，可以直接覆盖
+    state_.store(make_state(next));
+}
+
+/**
+ * @description: 按顺序把已切换出去的缓冲区写入日志段，调用者持有flush_latch_
+ * @return {lsn_t} 写入的最后一条日志的日志号，没有写入时返回INVALID_LSN
+ */
+lsn_t LogManager::write_sealed_buffers() {
+    lsn_t last_lsn = INVALID_LSN;
+    while (true) {
+        int index;
+        {
+            std::scoped_lock lock{switch_latch_};
+            if (sealed_.empty()) {
+                break;
+            }
+            index = sealed_.front();
+        }
+        LogBufferSlot &buffer = buffers_[index];
+        // 等待预留了空间的线程拷贝完成
+        while (buffer.written_.load(std::memory_order_acquire) != buffer.size_) {
+            std::this_thread::yield();
+        }
+        if (buffer.size_ > 0) {
+            // 缓冲区中最后一条日志结束于last_lsn_，日志号就是日志的位置
+            disk_manager_->write_log(buffer.data_.get(), buffer.size_, buffer.last_lsn_ + 1 - buffer.size_);
+        }
+        last_lsn = buffer.last_lsn_;
+        std::scoped_lock lock{switch_latch_};
+        sealed_.pop_front();
+        buffer.free_ = true;
+    }
+    return last_lsn;
 }
 
 /**
- * @description: 把日志缓冲区的内容刷到磁盘中，由于目前只设置了一个缓冲区，因此需要阻塞其他日志操作
+ * @description: 把日志缓冲区的内容刷到磁盘中：先切换出当前缓冲区，再把所有待刷盘的缓冲区写入文件并同步一次。
+ * 刷盘期间其他线程继续向新的当前缓冲区追加日志
  */
 void LogManager::flush_log_to_disk() {
+    std::scoped_lock flush_lock{flush_latch_};
+    lsn_t flush_lsn = write_sealed_buffers();
+    if (!seal_current_buffer()) {
+        flush_lsn = std::max(flush_lsn, write_sealed_buffers());
+        seal_current_buffer();
+    }
+    flush_lsn = std::max(flush_lsn, write_sealed_buffers());
+    if (flush_lsn == INVALID_LSN || flush_lsn <= persist_lsn_) {
+        return;
+    }
+    disk_manager_->sync_log();
+
+    std::scoped_lock group_lock{group_latch_};
+    persist_lsn_ = flush_lsn;
+    persist_cv_.notify_all();
+}
 
+/**
+ * @description: 设置下一条日志的日志号，故障恢复之后、追加任何日志之前调用，使日志号与日志文件的偏移量一致
+ * @param {lsn_t} next_lsn 下一条日志的日志号，即日志文件中有效日志的长度
+ */
+void LogManager::set_next_lsn(lsn_t next_lsn) {
+    std::scoped_lock lock{switch_latch_};
+    int index = state_index(state_.load());
+    buffers_[index].start_lsn_ = next_lsn;
+    state_.store(make_state(index));
+    persist_lsn_ = next_lsn - 1;
+}
+
+/**
+ * @description: 当前缓冲区中第一条日志的日志号，此后追加的日志的日志号都不小于它，用作页面的recLSN
+ * 缓冲区的起始日志号在它成为当前缓冲区之前设置，读取前后当前缓冲区的编号不变时，读到的就是当前缓冲区的起始日志号，
+ * 而不是之后重新使用这个缓冲区时设置的更大的值
+ * @return {lsn_t} 当前缓冲区的起始日志号
+ */
+lsn_t LogManager::get_buffer_start_lsn() {
+    uint64_t state = state_.load();
+    while (true) {
+        lsn_t start_lsn = buffers_[state_index(state)].start_lsn_;
+        uint64_t next_state = state_.load();
+        if (state_index(next_state) == state_index(state)) {
+            return start_lsn;
+        }
+        state = next_state;
+    }
+}
+
+/**
+ * @description: 等待日志号不超过lsn的日志持久化，用于事务提交
+ * 刷盘线程运行时由它为一组等待的事务统一刷盘，否则由调用者自己刷盘
+ * @param {lsn_t} lsn 需要持久化的日志号
+ */
+void LogManager::wait_for_flush(lsn_t lsn) {
+    if (persist_lsn_ >= lsn) {
+        return;
+    }
+    std::unique_lock<std::mutex> lock(group_latch_);
+    if (flusher_running_) {
+        flush_request_lsn_ = std::max(flush_request_lsn_, lsn);
+        num_waiters_++;
+        flush_cv_.notify_one();
+        persist_cv_.wait(lock, [&] { return persist_lsn_ >= lsn || !flusher_running_; });
+        num_waiters_--;
+        if (persist_lsn_ >= lsn) {
+            return;
+        }
+    }
+    lock.unlock();
+    // 日志所在的缓冲区可能正在被其他线程切换，本轮刷盘不一定包含它
+    while (persist_lsn_ < lsn) {
+        flush_log_to_disk();
+    }
+}
+
+/**
+ * @description: 等待日志持久化到lsn，自己不刷盘，用于向只读副本发送新持久化的日志
+ * @return {bool} 超时之前日志号不超过lsn的日志是否已经持久化
+ * @param {lsn_t} lsn 等待持久化的日志号
+ * @param {milliseconds} timeout 最长等待时间
+ */
+bool LogManager::wait_for_persist(lsn_t lsn, std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(group_latch_);
+    return persist_cv_.wait_for(lock, timeout, [&] { return persist_lsn_ >= lsn; });
+}
+
+/**
+ * @description: 启动后台刷盘线程
+ */
+void LogManager::start_flusher() {
+    std::scoped_lock lock{group_latch_};
+    if (flusher_running_) {
+        return;
+    }
+    flusher_running_ = true;
+    flusher_ = std::thread(&LogManager::run_flusher, this);
+}
+
+/**
+ * @description: 停止后台刷盘线程，并把缓冲区中剩余的日志刷盘
+ */
+void LogManager::stop_flusher() {
+    {
+        std::scoped_lock lock{group_latch_};
+        if (!flusher_running_) {
+            return;
+        }
+        flusher_running_ = false;
+    }
+    flush_cv_.notify_all();
+    persist_cv_.notify_all();
+    if (flusher_.joinable()) {
+        flusher_.join();
+    }
+    flush_log_to_disk();
+}
+
+/**
+ * @description: 刷盘线程：有事务等待提交时刷盘，否则每隔log_timeout刷盘一次。
+ * 上一组不止一个事务时说明并发较高，先等待至多GROUP_COMMIT_DELAY，让更多的提交进入同一组
+ */
+void LogManager::run_flusher() {
+    std::unique_lock<std::mutex> lock(group_latch_);
+    while (flusher_running_) {
+        flush_cv_.wait_for(lock, log_timeout,
+                           [&] { return !flusher_running_ || flush_request_lsn_ > persist_lsn_; });
+        if (!flusher_running_) {
+            break;
+        }
+        if (flush_request_lsn_ > persist_lsn_ && last_group_size_ > 1) {
+            flush_cv_.wait_for(lock, GROUP_COMMIT_DELAY,
+                               [&] { return !flusher_running_ || num_waiters_ >= last_group_size_; });
+        }
+        size_t group_size = num_waiters_;
+        lock.unlock();
+        flush_log_to_disk();
+        lock.lock();
+        last_group_size_ = group_size;
+    }
 }
@@ -10,11 +10,18 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
 #include <mutex>
+#include <string>
+#include <thread>
 #include <vector>
 #include <iostream>
 #include "log_defs.h"
 #include "common/config.h"
+#include "common/crc32c.h"
 #include "record/rm_defs.h"
 
 /* 日志记录对应操作的类型 */
@@ -24,7 +31,10 @@ enum LogType: int {
     DELETE,
     begin,
     commit,
-    ABORT
+    ABORT,
+    CLR,
+    CKPT_BEGIN,
+    CKPT_END
 };
 static std::string LogTypeStr[] = {
     "UPDATE",
@@ -32,9 +42,92 @@ static std::string LogTypeStr[] = {
     "DELETE",
     "BEGIN",
     "COMMIT",
-    "ABORT"
+    "ABORT",
+    "CLR",
+    "CKPT_BEGIN",
+    "CKPT_END"
 };
 
+/* 日志中的表名称：长度和内容，返回占用的字节数 */
+inline int serialize_table_name(char* dest, const std::string& table_name) {
+    size_t size = table_name.size();
+    memcpy(dest, &size, sizeof(size_t));
+    memcpy(dest + sizeof(size_t), table_name.data(), size);
+    return sizeof(size_t) + size;
+}
+
+inline int deserialize_table_name(const char* src, std::string& table_name) {
+    size_t size = *reinterpret_cast<const size_t*>(src);
+    table_name.assign(src + sizeof(size_t), size);
+    return sizeof(size_t) + size;
+}
+
+/* 无符号整数的变长编码（LEB128）：每个字节存7位，最高位表示后面还有字节，小于128的数只占1个字节 */
+inline int varint_size(uint32_t value) {
+    int size = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        size++;
+    }
+    return size;
+}
+
+inline int encode_varint(char* dest, uint32_t value) {
+    int size = 0;
+    while (value >= 0x80) {
+        dest[size++] = static_cast<char>((value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+    dest[size++] = static_cast<char>(value);
+    return size;
+}
+
+inline int decode_varint(const char* src, uint32_t& value) {
+    value = 0;
+    int size = 0;
+    for (int shift = 0; shift < 32; shift += 7) {
+        uint8_t byte = static_cast<uint8_t>(src[size++]);
+        value |= static_cast<uint32_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            break;
+        }
+    }
+    return size;
+}
+
+/* 日志记录的校验和，跳过校验和字段本身 */
+inline uint32_t log_record_crc(const char* src, uint32_t tot_len) {
+    uint32_t crc = crc32c::value(src, OFFSET_LOG_CRC);
+    return crc32c::extend(crc, src + OFFSET_LOG_DATA, tot_len - OFFSET_LOG_DATA);
+}
+
+/* 在序列化后的日志记录中填入校验和 */
+inline void set_log_record_crc(char* dest) {
+    uint32_t tot_len = *reinterpret_cast<const uint32_t*>(dest + OFFSET_LOG_TOT_LEN);
+    uint32_t crc = log_record_crc(dest, tot_len);
+    memcpy(dest + OFFSET_LOG_CRC, &crc, sizeof(uint32_t));
+}
+
+/**
+ * @description: 检查src中日志号为lsn的日志记录是否完整：长度合法、日志号与位置一致、校验和正确。
+ * 故障时没有写完整的日志、日志段中之前留下的旧日志都无法通过检查
+ * @return {bool} 日志记录是否完整
+ * @param {char*} src 日志记录
+ * @param {int} size src中可以读取的字节数
+ * @param {lsn_t} lsn 日志记录应当具有的日志号
+ */
+inline bool check_log_record(const char* src, int size, lsn_t lsn) {
+    if (size < LOG_HEADER_SIZE) {
+        return false;
+    }
+    uint32_t tot_len = *reinterpret_cast<const uint32_t*>(src + OFFSET_LOG_TOT_LEN);
+    if (tot_len < LOG_HEADER_SIZE || tot_len > static_cast<uint32_t>(size) ||
+        *reinterpret_cast<const lsn_t*>(src + OFFSET_LSN) != lsn) {
+        return false;
+    }
+    return *reinterpret_cast<const uint32_t*>(src + OFFSET_LOG_CRC) == log_record_crc(src, tot_len);
+}
+
 class LogRecord {
 public:
     LogType log_type_;         /* 日志对应操作的类型 */
@@ -43,6 +136,8 @@ public:
     txn_id_t log_tid_;         /* 创建当前日志的事务ID */
     lsn_t prev_lsn_;           /* 事务创建的前一条日志记录的lsn，用于undo */
 
+    virtual ~LogRecord() = default;
+
     // 把日志记录序列化到dest中
     virtual void serialize (char* dest) const {
         memcpy(dest + OFFSET_LOG_TYPE, &log_type_, sizeof(LogType));
@@ -64,10 +159,10 @@ public:
         std::cout << "log type in father_function: " << LogTypeStr[log_type_] << "\n";
         printf("Print Log Record:\n");
         printf("log_type_: %s\n", LogTypeStr[log_type_].c_str());
-        printf("lsn: %d\n", lsn_);
+        printf("lsn: %lld\n", static_cast<long long>(lsn_));
         printf("log_tot_len: %d\n", log_tot_len_);
         printf("log_tid: %d\n", log_tid_);
-        printf("prev_lsn: %d\n", prev_lsn_);
+        printf("prev_lsn: %lld\n", static_cast<long long>(prev_lsn_));
     }
 };
 
@@ -98,17 +193,61 @@ public:
 };
 
 /**
- * TODO: commit操作的日志记录
+ * commit操作的日志记录
 */
 class CommitLogRecord: public LogRecord {
-
+public:
+    CommitLogRecord() {
+        log_type_ = LogType::commit;
+        lsn_ = INVALID_LSN;
+        log_tot_len_ = LOG_HEADER_SIZE;
+        log_tid_ = INVALID_TXN_ID;
+        prev_lsn_ = INVALID_LSN;
+    }
+    CommitLogRecord(txn_id_t txn_id) : CommitLogRecord() {
+        log_tid_ = txn_id;
+    }
+    // 序列化Commit日志记录到dest中
+    void serialize(char* dest) const override {
+        LogRecord::serialize(dest);
+    }
+    // 从src中反序列化出一条Commit日志记录
+    void deserialize(const char* src) override {
+        LogRecord::deserialize(src);
+    }
+    virtual void format_print() override {
+        std::cout << "log type in son_function: " << LogTypeStr[log_type_] << "\n";
+        LogRecord::format_print();
+    }
 };
 
 /**
- * TODO: abort操作的日志记录
+ * abort操作的日志记录
 */
 class AbortLogRecord: public LogRecord {
-
+public:
+    AbortLogRecord() {
+        log_type_ = LogType::ABORT;
+        lsn_ = INVALID_LSN;
+        log_tot_len_ = LOG_HEADER_SIZE;
+        log_tid_ = INVALID_TXN_ID;
+        prev_lsn_ = INVALID_LSN;
+    }
+    AbortLogRecord(txn_id_t txn_id) : AbortLogRecord() {
+        log_tid_ = txn_id;
+    }
+    // 序列化Abort日志记录到dest中
+    void serialize(char* dest) const override {
+        LogRecord::serialize(dest);
+    }
+    // 从src中反序列化出一条Abort日志记录
+    void deserialize(const char* src) override {
+        LogRecord::deserialize(src);
+    }
+    virtual void format_print() override {
+        std::cout << "log type in son_function: " << LogTypeStr[log_type_] << "\n";
+        LogRecord::format_print();
+    }
 };
 
 class InsertLogRecord: public LogRecord {
@@ -119,9 +258,8 @@ public:
         log_tot_len_ = LOG_HEADER_SIZE;
         log_tid_ = INVALID_TXN_ID;
         prev_lsn_ = INVALID_LSN;
-        table_name_ = nullptr;
     }
-    InsertLogRecord(txn_id_t txn_id, RmRecord& insert_value, Rid& rid, std::string table_name) 
+    InsertLogRecord(txn_id_t txn_id, RmRecord& insert_value, const Rid& rid, const std::string& table_name) 
         : InsertLogRecord() {
         log_tid_ = txn_id;
         insert_value_ = insert_value;
@@ -129,10 +267,8 @@ public:
         log_tot_len_ += sizeof(int);
         log_tot_len_ += insert_value_.size;
         log_tot_len_ += sizeof(Rid);
-        table_name_size_ = table_name.length();
-        table_name_ = new char[table_name_size_];
-        memcpy(table_name_, table_name.c_str(), table_name_size_);
-        log_tot_len_ += sizeof(size_t) + table_name_size_;
+        table_name_ = table_name;
+        log_tot_len_ += sizeof(size_t) + table_name_.size();
     }
 
     // 把insert日志记录序列化到dest中
@@ -145,9 +281,7 @@ public:
         offset += insert_value_.size;
         memcpy(dest + offset, &rid_, sizeof(Rid));
         offset += sizeof(Rid);
-        memcpy(dest + offset, &table_name_size_, sizeof(size_t));
-        offset += sizeof(size_t);
-        memcpy(dest + offset, table_name_, table_name_size_);
+        serialize_table_name(dest + offset, table_name_);
     }
     // 从src中反序列化出一条Insert日志记录
     void deserialize(const char* src) override {
@@ -156,40 +290,423 @@ public:
         int offset = OFFSET_LOG_DATA + insert_value_.size + sizeof(int);
         rid_ = *reinterpret_cast<const Rid*>(src + offset);
         offset += sizeof(Rid);
-        table_name_size_ = *reinterpret_cast<const size_t*>(src + offset);
-        offset += sizeof(size_t);
-        table_name_ = new char[table_name_size_];
-        memcpy(table_name_, src + offset, table_name_size_);
+        deserialize_table_name(src + offset, table_name_);
     }
     void format_print() override {
         printf("insert record\n");
         LogRecord::format_print();
         printf("insert_value: %s\n", insert_value_.data);
         printf("insert rid: %d, %d\n", rid_.page_no, rid_.slot_no);
-        printf("table name: %s\n", table_name_);
+        printf("table name: %s\n", table_name_.c_str());
     }
 
     RmRecord insert_value_;     // 插入的记录
     Rid rid_;                   // 记录插入的位置
-    char* table_name_;          // 插入记录的表名称
-    size_t table_name_size_;    // 表名称的大小
+    std::string table_name_;    // 插入记录的表名称
 };
 
 /**
- * TODO: delete操作的日志记录
+ * delete操作的日志记录，保存被删除记录的前像用于undo
 */
 class DeleteLogRecord: public LogRecord {
+public:
+    DeleteLogRecord() {
+        log_type_ = LogType::DELETE;
+        lsn_ = INVALID_LSN;
+        log_tot_len_ = LOG_HEADER_SIZE;
+        log_tid_ = INVALID_TXN_ID;
+        prev_lsn_ = INVALID_LSN;
+    }
+    DeleteLogRecord(txn_id_t txn_id, RmRecord& delete_value, const Rid& rid, const std::string& table_name)
+        : DeleteLogRecord() {
+        log_tid_ = txn_id;
+        delete_value_ = delete_value;
+        rid_ = rid;
+        table_name_ = table_name;
+        log_tot_len_ += sizeof(int) + delete_value_.size + sizeof(Rid) + sizeof(size_t) + table_name_.size();
+    }
 
+    // 把delete日志记录序列化到dest中
+    void serialize(char* dest) const override {
+        LogRecord::serialize(dest);
+        int offset = OFFSET_LOG_DATA;
+        memcpy(dest + offset, &delete_value_.size, sizeof(int));
+        offset += sizeof(int);
+        memcpy(dest + offset, delete_value_.data, delete_value_.size);
+        offset += delete_value_.size;
+        memcpy(dest + offset, &rid_, sizeof(Rid));
+        offset += sizeof(Rid);
+        serialize_table_name(dest + offset, table_name_);
+    }
+    // 从src中反序列化出一条Delete日志记录
+    void deserialize(const char* src) override {
+        LogRecord::deserialize(src);
+        delete_value_.Deserialize(src + OFFSET_LOG_DATA);
+        int offset = OFFSET_LOG_DATA + delete_value_.size + sizeof(int);
+        rid_ = *reinterpret_cast<const Rid*>(src + offset);
+        offset += sizeof(Rid);
+        deserialize_table_name(src + offset, table_name_);
+    }
+    void format_print() override {
+        printf("delete record\n");
+        LogRecord::format_print();
+        printf("delete rid: %d, %d\n", rid_.page_no, rid_.slot_no);
+        printf("table name: %s\n", table_name_.c_str());
+    }
+
+    RmRecord delete_value_;     // 被删除的记录
+    Rid rid_;                   // 被删除记录的位置
+    std::string table_name_;    // 被删除记录的表名称
 };
 
 /**
- * TODO: update操作的日志记录
+ * update操作的日志记录，保存记录的前像和后像，分别用于undo和redo
 */
+/**
+ * 更新日志记录，只记录发生变化的字节区间及其前像和后像，相邻的变化区间之间相同的字节不超过UPDATE_RANGE_MERGE_GAP时合并。
+ * 表用编号而不是名称引用；日志头之后的字段都用变长整数编码：
+ * 表编号、页号、槽号、区间数，每个区间为与上一个区间末尾的距离、长度、前像、后像
+ */
 class UpdateLogRecord: public LogRecord {
+public:
+    /* 记录中发生变化的一段字节 */
+    struct UpdateRange {
+        int offset;             // 在记录中的偏移量
+        std::string before;     // 更新前的内容
+        std::string after;      // 更新后的内容
+    };
+
+    UpdateLogRecord() {
+        log_type_ = LogType::UPDATE;
+        lsn_ = INVALID_LSN;
+        log_tot_len_ = LOG_HEADER_SIZE;
+        log_tid_ = INVALID_TXN_ID;
+        prev_lsn_ = INVALID_LSN;
+    }
+    UpdateLogRecord(txn_id_t txn_id, const char* old_value, const char* new_value, int value_size, const Rid& rid,
+                    int table_id)
+        : UpdateLogRecord() {
+        log_tid_ = txn_id;
+        rid_ = rid;
+        table_id_ = table_id;
+        // 当前区间为[begin, end)
+        int begin = -1;
+        int end = -1;
+        for (int i = 0; i < value_size; i++) {
+            if (old_value[i] == new_value[i]) {
+                continue;
+            }
+            if (begin >= 0 && i - end <= UPDATE_RANGE_MERGE_GAP) {
+                end = i + 1;
+                continue;
+            }
+            if (begin >= 0) {
+                add_range(old_value, new_value, begin, end);
+            }
+            begin = i;
+            end = i + 1;
+        }
+        if (begin >= 0) {
+            add_range(old_value, new_value, begin, end);
+        }
+        log_tot_len_ += varint_size(table_id_) + varint_size(rid_.page_no) + varint_size(rid_.slot_no) +
+                        varint_size(ranges_.size());
+        int prev_end = 0;
+        for (auto& range : ranges_) {
+            log_tot_len_ += varint_size(range.offset - prev_end) + varint_size(range.after.size()) +
+                            range.before.size() + range.after.size();
+            prev_end = range.offset + range.after.size();
+        }
+    }
 
+    // 把update日志记录序列化到dest中
+    void serialize(char* dest) const override {
+        LogRecord::serialize(dest);
+        int offset = OFFSET_LOG_DATA;
+        offset += encode_varint(dest + offset, table_id_);
+        offset += encode_varint(dest + offset, rid_.page_no);
+        offset += encode_varint(dest + offset, rid_.slot_no);
+        offset += encode_varint(dest + offset, ranges_.size());
+        int prev_end = 0;
+        for (auto& range : ranges_) {
+            offset += encode_varint(dest + offset, range.offset - prev_end);
+            offset += encode_varint(dest + offset, range.after.size());
+            memcpy(dest + offset, range.before.data(), range.before.size());
+            offset += range.before.size();
+            memcpy(dest + offset, range.after.data(), range.after.size());
+            offset += range.after.size();
+            prev_end = range.offset + range.after.size();
+        }
+    }
+    // 从src中反序列化出一条Update日志记录
+    void deserialize(const char* src) override {
+        LogRecord::deserialize(src);
+        int offset = OFFSET_LOG_DATA;
+        uint32_t value;
+        offset += decode_varint(src + offset, value);
+        table_id_ = value;
+        offset += decode_varint(src + offset, value);
+        rid_.page_no = value;
+        offset += decode_varint(src + offset, value);
+        rid_.slot_no = value;
+        uint32_t num_ranges;
+        offset += decode_varint(src + offset, num_ranges);
+        ranges_.clear();
+        int prev_end = 0;
+        for (uint32_t i = 0; i < num_ranges; i++) {
+            uint32_t gap;
+            uint32_t len;
+            offset += decode_varint(src + offset, gap);
+            offset += decode_varint(src + offset, len);
+            UpdateRange range;
+            range.offset = prev_end + gap;
+            range.before.assign(src + offset, len);
+            offset += len;
+            range.after.assign(src + offset, len);
+            offset += len;
+            prev_end = range.offset + len;
+            ranges_.push_back(std::move(range));
+        }
+    }
+    void format_print() override {
+        printf("update record\n");
+        LogRecord::format_print();
+        printf("update rid: %d, %d\n", rid_.page_no, rid_.slot_no);
+        printf("table id: %d, changed ranges: %zu\n", table_id_, ranges_.size());
+    }
+
+    /* 把记录更新为后像，用于redo */
+    void redo(char* data) const {
+        for (auto& range : ranges_) {
+            memcpy(data + range.offset, range.after.data(), range.after.size());
+        }
+    }
+
+    /* 把记录恢复为前像，用于undo */
+    void undo(char* data) const {
+        for (auto& range : ranges_) {
+            memcpy(data + range.offset, range.before.data(), range.before.size());
+        }
+    }
+
+    std::vector<UpdateRange> ranges_;   // 发生变化的字节区间，按偏移量递增
+    Rid rid_;                           // 被更新记录的位置
+    int table_id_ = -1;                 // 被更新记录的表编号
+
+private:
+    void add_range(const char* old_value, const char* new_value, int begin, int end) {
+        ranges_.push_back({begin, std::string(old_value + begin, end - begin), std::string(new_value + begin, end - begin)});
+    }
 };
 
-/* 日志缓冲区，只有一个buffer，因此需要阻塞地去把日志写入缓冲区中 */
+/**
+ * 补偿日志记录（CLR），回滚一条insert/delete/update时写入，只redo不undo。
+ * redo_type_为补偿操作本身的类型：DELETE表示删除该位置上的记录，INSERT和UPDATE表示把该位置上的记录恢复为value_；
+ * undo_next_lsn_为被补偿日志的prev_lsn_，回滚在故障后继续进行时从这里接着undo
+*/
+class CompensationLogRecord: public LogRecord {
+public:
+    CompensationLogRecord() {
+        log_type_ = LogType::CLR;
+        lsn_ = INVALID_LSN;
+        log_tot_len_ = LOG_HEADER_SIZE;
+        log_tid_ = INVALID_TXN_ID;
+        prev_lsn_ = INVALID_LSN;
+        value_.size = 0;
+        value_.data = nullptr;
+    }
+    CompensationLogRecord(txn_id_t txn_id, LogType redo_type, const char* value, int value_size, const Rid& rid,
+                          const std::string& table_name, lsn_t undo_next_lsn)
+        : CompensationLogRecord() {
+        log_tid_ = txn_id;
+        redo_type_ = redo_type;
+        if (value != nullptr) {
+            value_ = RmRecord(value_size, const_cast<char*>(value));
+        }
+        rid_ = rid;
+        table_name_ = table_name;
+        undo_next_lsn_ = undo_next_lsn;
+        log_tot_len_ += sizeof(LogType) + sizeof(lsn_t) + sizeof(int) + value_.size + sizeof(Rid) +
+                        sizeof(size_t) + table_name_.size();
+    }
+
+    // 把补偿日志记录序列化到dest中
+    void serialize(char* dest) const override {
+        LogRecord::serialize(dest);
+        int offset = OFFSET_LOG_DATA;
+        memcpy(dest + offset, &redo_type_, sizeof(LogType));
+        offset += sizeof(LogType);
+        memcpy(dest + offset, &undo_next_lsn_, sizeof(lsn_t));
+        offset += sizeof(lsn_t);
+        memcpy(dest + offset, &value_.size, sizeof(int));
+        offset += sizeof(int);
+        if (value_.size > 0) {
+            memcpy(dest + offset, value_.data, value_.size);
+        }
+        offset += value_.size;
+        memcpy(dest + offset, &rid_, sizeof(Rid));
+        offset += sizeof(Rid);
+        serialize_table_name(dest + offset, table_name_);
+    }
+    // 从src中反序列化出一条补偿日志记录
+    void deserialize(const char* src) override {
+        LogRecord::deserialize(src);
+        int offset = OFFSET_LOG_DATA;
+        redo_type_ = *reinterpret_cast<const LogType*>(src + offset);
+        offset += sizeof(LogType);
+        undo_next_lsn_ = *reinterpret_cast<const lsn_t*>(src + offset);
+        offset += sizeof(lsn_t);
+        value_.Deserialize(src + offset);
+        offset += sizeof(int) + value_.size;
+        rid_ = *reinterpret_cast<const Rid*>(src + offset);
+        offset += sizeof(Rid);
+        deserialize_table_name(src + offset, table_name_);
+    }
+    void format_print() override {
+        printf("compensation record\n");
+        LogRecord::format_print();
+        printf("redo type: %s\n", LogTypeStr[redo_type_].c_str());
+        printf("undo_next_lsn: %lld\n", static_cast<long long>(undo_next_lsn_));
+        printf("rid: %d, %d\n", rid_.page_no, rid_.slot_no);
+        printf("table name: %s\n", table_name_.c_str());
+    }
+
+    LogType redo_type_ = LogType::DELETE;   // 补偿操作的类型
+    lsn_t undo_next_lsn_ = INVALID_LSN;     // 下一条需要undo的日志
+    RmRecord value_;                        // 恢复后的记录，删除时为空
+    Rid rid_;                               // 记录的位置
+    std::string table_name_;                // 记录所在的表名称
+};
+
+/**
+ * 检查点开始的日志记录，主记录指向它，故障恢复的analyze阶段从这里开始扫描日志
+*/
+class CheckpointBeginLogRecord: public LogRecord {
+public:
+    CheckpointBeginLogRecord() {
+        log_type_ = LogType::CKPT_BEGIN;
+        lsn_ = INVALID_LSN;
+        log_tot_len_ = LOG_HEADER_SIZE;
+        log_tid_ = INVALID_TXN_ID;
+        prev_lsn_ = INVALID_LSN;
+    }
+    void serialize(char* dest) const override {
+        LogRecord::serialize(dest);
+    }
+    void deserialize(const char* src) override {
+        LogRecord::deserialize(src);
+    }
+};
+
+/* 检查点中活跃事务表的表项 */
+struct CheckpointTxnEntry {
+    txn_id_t txn_id;
+    lsn_t last_lsn;     // 事务最后一条日志，undo从这里开始
+    lsn_t first_lsn;    // 事务第一条日志，截断日志时需要保留
+};
+
+/* 检查点中脏页表的表项 */
+struct CheckpointPageEntry {
+    std::string table_name;
+    int page_no;
+    lsn_t rec_lsn;      // 最早的一条还没有写回到磁盘的页面修改的日志号
+};
+
+/**
+ * 检查点结束的日志记录，保存检查点开始之后获取的活跃事务表和脏页表。
+ * 获取期间系统照常运行，两张表与检查点开始之后的日志一起才能得到故障时的状态
+*/
+class CheckpointEndLogRecord: public LogRecord {
+public:
+    CheckpointEndLogRecord() {
+        log_type_ = LogType::CKPT_END;
+        lsn_ = INVALID_LSN;
+        log_tot_len_ = LOG_HEADER_SIZE;
+        log_tid_ = INVALID_TXN_ID;
+        prev_lsn_ = INVALID_LSN;
+    }
+    CheckpointEndLogRecord(std::vector<CheckpointTxnEntry> active_txns, std::vector<CheckpointPageEntry> dirty_pages)
+        : CheckpointEndLogRecord() {
+        active_txns_ = std::move(active_txns);
+        dirty_pages_ = std::move(dirty_pages);
+        log_tot_len_ += sizeof(size_t) + active_txns_.size() * sizeof(CheckpointTxnEntry) + sizeof(size_t);
+        for (auto& page : dirty_pages_) {
+            log_tot_len_ += sizeof(size_t) + page.table_name.size() + sizeof(int) + sizeof(lsn_t);
+        }
+    }
+
+    void serialize(char* dest) const override {
+        LogRecord::serialize(dest);
+        int offset = OFFSET_LOG_DATA;
+        size_t num_txns = active_txns_.size();
+        memcpy(dest + offset, &num_txns, sizeof(size_t));
+        offset += sizeof(size_t);
+        memcpy(dest + offset, active_txns_.data(), num_txns * sizeof(CheckpointTxnEntry));
+        offset += num_txns * sizeof(CheckpointTxnEntry);
+        size_t num_pages = dirty_pages_.size();
+        memcpy(dest + offset, &num_pages, sizeof(size_t));
+        offset += sizeof(size_t);
+        for (auto& page : dirty_pages_) {
+            offset += serialize_table_name(dest + offset, page.table_name);
+            memcpy(dest + offset, &page.page_no, sizeof(int));
+            offset += sizeof(int);
+            memcpy(dest + offset, &page.rec_lsn, sizeof(lsn_t));
+            offset += sizeof(lsn_t);
+        }
+    }
+    void deserialize(const char* src) override {
+        LogRecord::deserialize(src);
+        int offset = OFFSET_LOG_DATA;
+        size_t num_txns = *reinterpret_cast<const size_t*>(src + offset);
+        offset += sizeof(size_t);
+        active_txns_.resize(num_txns);
+        memcpy(active_txns_.data(), src + offset, num_txns * sizeof(CheckpointTxnEntry));
+        offset += num_txns * sizeof(CheckpointTxnEntry);
+        size_t num_pages = *reinterpret_cast<const size_t*>(src + offset);
+        offset += sizeof(size_t);
+        dirty_pages_.resize(num_pages);
+        for (auto& page : dirty_pages_) {
+            offset += deserialize_table_name(src + offset, page.table_name);
+            page.page_no = *reinterpret_cast<const int*>(src + offset);
+            offset += sizeof(int);
+            page.rec_lsn = *reinterpret_cast<const lsn_t*>(src + offset);
+            offset += sizeof(lsn_t);
+        }
+    }
+    void format_print() override {
+        printf("checkpoint end record\n");
+        LogRecord::format_print();
+        printf("active txns: %zu, dirty pages: %zu\n", active_txns_.size(), dirty_pages_.size());
+    }
+
+    std::vector<CheckpointTxnEntry> active_txns_;   // 活跃事务表（ATT）
+    std::vector<CheckpointPageEntry> dirty_pages_;  // 脏页表（DPT）
+};
+
+/**
+ * @description: 从src中反序列化出一条日志记录，根据日志类型创建对应的对象
+ * @return {unique_ptr<LogRecord>} 日志记录
+ * @param {char*} src 日志记录的起始位置
+ */
+inline std::unique_ptr<LogRecord> deserialize_log_record(const char* src) {
+    std::unique_ptr<LogRecord> log_record;
+    switch (*reinterpret_cast<const LogType*>(src + OFFSET_LOG_TYPE)) {
+        case LogType::UPDATE: log_record = std::make_unique<UpdateLogRecord>(); break;
+        case LogType::INSERT: log_record = std::make_unique<InsertLogRecord>(); break;
+        case LogType::DELETE: log_record = std::make_unique<DeleteLogRecord>(); break;
+        case LogType::begin: log_record = std::make_unique<BeginLogRecord>(); break;
+        case LogType::commit: log_record = std::make_unique<CommitLogRecord>(); break;
+        case LogType::ABORT: log_record = std::make_unique<AbortLogRecord>(); break;
+        case LogType::CLR: log_record = std::make_unique<CompensationLogRecord>(); break;
+        case LogType::CKPT_BEGIN: log_record = std::make_unique<CheckpointBeginLogRecord>(); break;
+        case LogType::CKPT_END: log_record = std::make_unique<CheckpointEndLogRecord>(); break;
+        default: return nullptr;
+    }
+    log_record->deserialize(src);
+    return log_record;
+}
+
+/* 日志缓冲区，故障恢复时用于读入日志 */
 
 class LogBuffer {
 public:
@@ -208,20 +725,83 @@ public:
     int offset_;    // 写入log的offset
 };
 
-/* 日志管理器，负责把日志写入日志缓冲区，以及把日志缓冲区中的内容写入磁盘中 */
+/* 日志管理器，负责把日志写入日志缓冲区，以及把日志缓冲区中的内容写入磁盘中
+ * 共有LOG_BUFFER_NUM个缓冲区，同一时刻只有一个缓冲区接收日志，其余的正在刷盘或空闲。
+ * 追加日志时用一次原子加法在当前缓冲区中预留空间并分配日志号，各线程并行地把日志拷贝到自己预留的位置；
+ * 预留越过缓冲区末尾的第一个线程负责切换到下一个空闲缓冲区，写满的缓冲区交给刷盘，
+ * 刷盘期间其他缓冲区可以继续接收日志 */
 class LogManager {
 public:
-    LogManager(DiskManager* disk_manager) { disk_manager_ = disk_manager; }
+    LogManager(DiskManager* disk_manager);
+
+    ~LogManager() { stop_flusher(); }
     
     lsn_t add_log_to_buffer(LogRecord* log_record);
     void flush_log_to_disk();
 
-    LogBuffer* get_log_buffer() { return &log_buffer_; }
+    void wait_for_flush(lsn_t lsn);
+
+    bool wait_for_persist(lsn_t lsn, std::chrono::milliseconds timeout);
+
+    void start_flusher();
+
+    void stop_flusher();
+
+    lsn_t get_persist_lsn() { return persist_lsn_; }
+
+    lsn_t get_last_commit_lsn() { return last_commit_lsn_; }
+
+    void set_next_lsn(lsn_t next_lsn);
+
+    lsn_t get_buffer_start_lsn();
 
 private:    
-    std::atomic<lsn_t> global_lsn_{0};  // 全局lsn，递增，用于为每条记录分发lsn
-    std::mutex latch_;                  // 用于对log_buffer_的互斥访问
-    LogBuffer log_buffer_;              // 日志缓冲区
-    lsn_t persist_lsn_;                 // 记录已经持久化到磁盘中的最后一条日志的日志号
+    /* 缓冲区状态字：最高两位为当前缓冲区编号，低62位为当前缓冲区中已预留的字节数。
+     * 日志号不放在状态字中，而是当前缓冲区的起始日志号加上预留的位置，日志号的范围不受状态字的位数限制 */
+    static constexpr int STATE_INDEX_SHIFT = 62;
+    static constexpr uint64_t STATE_OFFSET_MASK = (1ULL << STATE_INDEX_SHIFT) - 1;
+    static_assert(LOG_BUFFER_NUM >= 2 && LOG_BUFFER_NUM <= 4, "buffer index takes two bits of the state");
+
+    static uint64_t state_offset(uint64_t state) { return state & STATE_OFFSET_MASK; }
+    static int state_index(uint64_t state) { return static_cast<int>(state >> STATE_INDEX_SHIFT); }
+    static uint64_t make_state(int index) { return static_cast<uint64_t>(index) << STATE_INDEX_SHIFT; }
+
+    struct LogBufferSlot {
+        std::unique_ptr<char[]> data_;
+        std::atomic<lsn_t> start_lsn_{0};   // 缓冲区中第一条日志的日志号，在缓冲区成为当前缓冲区之前设置
+        std::atomic<uint32_t> written_{0};  // 已经拷贝完成的字节数
+        uint32_t size_ = 0;                 // 切换时确定的有效字节数
+        lsn_t last_lsn_ = INVALID_LSN;      // 缓冲区中最后一条日志的日志号
+        bool free_ = true;                  // 已刷盘、可以重新使用，switch_latch_保护
+    };
+
+    void switch_buffer(int index, uint32_t end, lsn_t next_lsn);
+
+    bool seal_current_buffer();
+
+    void seal(int index, uint32_t end, lsn_t next_lsn);
+
+    lsn_t write_sealed_buffers();
+
+    void run_flusher();
+
+    std::atomic<uint64_t> state_{0};    // 缓冲区状态字，分配日志号和预留空间
+    LogBufferSlot buffers_[LOG_BUFFER_NUM];
+    std::mutex switch_latch_;           // 保护缓冲区的切换、sealed_以及各缓冲区的free_
+    std::condition_variable switch_cv_; // 缓冲区切换后唤醒等待的追加者
+    std::deque<int> sealed_;            // 等待刷盘的缓冲区，按日志号顺序排列
+    std::atomic<lsn_t> last_commit_lsn_{INVALID_LSN};   // 最后一条提交日志的日志号
+    std::atomic<lsn_t> persist_lsn_{INVALID_LSN};   // 记录已经持久化到磁盘中的最后一条日志的日志号
+    std::mutex flush_latch_;            // 串行化刷盘，保证日志按日志号顺序写入文件；先于switch_latch_获取
     DiskManager* disk_manager_;
+
+    /* 组提交：提交的事务登记自己的提交日志号后等待，由后台刷盘线程为一组事务写日志并只同步一次 */
+    std::mutex group_latch_;            // 保护以下变量
+    std::condition_variable flush_cv_;  // 唤醒刷盘线程
+    std::condition_variable persist_cv_;    // persist_lsn_推进后唤醒等待的事务
+    lsn_t flush_request_lsn_ = INVALID_LSN; // 等待持久化的最大日志号
+    size_t num_waiters_ = 0;            // 正在等待持久化的事务数量
+    size_t last_group_size_ = 0;        // 上一次刷盘时等待的事务数量
+    bool flusher_running_ = false;
+    std::thread flusher_;               // 后台刷盘线程
 }; 
@@ -10,23 +10,459 @@ See the Mulan PSL v2 for more details. */
 
 #include "log_recovery.h"
 
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <limits>
+#include <thread>
+#include <tuple>
+
+#include "record/rm_file_handle.h"
+
+namespace {
+
+/* 重做线程池，每个线程有自己的任务队列，任务是同一页面上按日志号排序的一组日志。
+ * 同一页面的任务总是提交到同一个队列，因此同一页面的日志按顺序重做，不同页面之间没有顺序要求 */
+class RedoWorkerPool {
+public:
+    explicit RedoWorkerPool(int num_workers) : workers_(num_workers) {
+        for (auto& worker : workers_) {
+            worker.thread_ = std::thread(&RedoWorkerPool::run, this, &worker);
+        }
+    }
+
+    ~RedoWorkerPool() { stop(); }
+
+    /**
+     * @description: 提交一个页面的重做任务，队列中待重做的日志过多时等待，限制读入内存的日志量
+     * @param {int} worker_id 处理该页面的线程
+     * @param {RedoLogsInPage} redo_logs 该页面上需要重做的日志
+     */
+    void submit(int worker_id, RedoLogsInPage redo_logs) {
+        Worker& worker = workers_[worker_id];
+        std::unique_lock<std::mutex> lock(worker.latch_);
+        worker.cv_.wait(lock, [&] { return worker.num_logs_ < REDO_BATCH_RECORDS * 4; });
+        worker.num_logs_ += redo_logs.redo_logs_.size();
+        worker.tasks_.push_back(std::move(redo_logs));
+        worker.cv_.notify_all();
+    }
+
+    /**
+     * @description: 等待所有任务完成并停止线程，重做线程出错时抛出第一个异常
+     */
+    void finish() {
+        stop();
+        if (error_ != nullptr) {
+            std::exception_ptr error = error_;
+            error_ = nullptr;
+            std::rethrow_exception(error);
+        }
+    }
+
+private:
+    void stop() {
+        for (auto& worker : workers_) {
+            {
+                std::scoped_lock lock{worker.latch_};
+                worker.done_ = true;
+            }
+            worker.cv_.notify_all();
+        }
+        for (auto& worker : workers_) {
+            if (worker.thread_.joinable()) {
+                worker.thread_.join();
+            }
+        }
+    }
+
+    struct Worker {
+        std::thread thread_;
+        std::mutex latch_;
+        std::condition_variable cv_;
+        std::deque<RedoLogsInPage> tasks_;
+        size_t num_logs_ = 0;           // 队列中待重做的日志数量
+        bool done_ = false;             // 不会再提交新的任务
+    };
+
+    void run(Worker* worker) {
+        while (true) {
+            RedoLogsInPage task;
+            {
+                std::unique_lock<std::mutex> lock(worker->latch_);
+                worker->cv_.wait(lock, [&] { return !worker->tasks_.empty() || worker->done_; });
+                if (worker->tasks_.empty()) {
+                    return;
+                }
+                task = std::move(worker->tasks_.front());
+                worker->tasks_.pop_front();
+            }
+            try {
+                for (auto& log_record : task.redo_logs_) {
+                    RecoveryManager::redo_log_record(task.table_file_, *log_record);
+                }
+            } catch (...) {
+                std::scoped_lock lock{error_latch_};
+                if (error_ == nullptr) {
+                    error_ = std::current_exception();
+                }
+            }
+            std::scoped_lock lock{worker->latch_};
+            worker->num_logs_ -= task.redo_logs_.size();
+            worker->cv_.notify_all();
+        }
+    }
+
+    std::vector<Worker> workers_;
+    std::mutex error_latch_;
+    std::exception_ptr error_ = nullptr;
+};
+
+}  // namespace
+
 /**
  * @description: analyze阶段，需要获得脏页表（DPT）和未完成的事务列表（ATT）
+ * 从主记录中仍然有效的最小日志号开始扫描：检查点时的活跃事务的全部日志、脏页上未写回的修改都不早于它，
+ * 因此扫描得到的两张表已经包含检查点结束日志中的两张表；再合并检查点的脏页表，保留更早的recLSN。
+ * 扫描到第一条不完整（长度、日志号或校验和不正确）的日志为止，截断其后的内容，后续的日志从这里继续追加
  */
 void RecoveryManager::analyze() {
- 
+    lsn_t checkpoint_lsn = INVALID_LSN;
+    if (!disk_manager_->read_master_record(checkpoint_lsn, log_start_lsn_)) {
+        log_start_lsn_ = 0;
+    }
+    for (auto& [tab_name, fh] : sm_manager_->fhs_) {
+        table_files_[fh->get_table_id()] = fh.get();
+    }
+    log_end_lsn_ = scan_log(log_start_lsn_, [&](std::unique_ptr<LogRecord>& record) {
+        LogRecord& log_record = *record;
+        if (log_record.log_tid_ != INVALID_TXN_ID) {
+            max_txn_id_ = std::max(max_txn_id_, log_record.log_tid_);
+        }
+        TupleChange change;
+        if (get_tuple_change(log_record, change) && change.fh != nullptr) {
+            dirty_pages_.emplace(PageId{change.fh->GetFd(), change.rid.page_no}, log_record.lsn_);
+        }
+        switch (log_record.log_type_) {
+            case LogType::commit:
+            case LogType::ABORT:
+                active_txns_.erase(log_record.log_tid_);
+                break;
+            case LogType::CKPT_BEGIN:
+                break;
+            case LogType::CKPT_END: {
+                auto& rec = static_cast<CheckpointEndLogRecord&>(log_record);
+                for (auto& page : rec.dirty_pages_) {
+                    RmFileHandle* fh = get_file_handle(page.table_name);
+                    if (fh == nullptr) {
+                        continue;
+                    }
+                    auto [iter, inserted] = dirty_pages_.emplace(PageId{fh->GetFd(), page.page_no}, page.rec_lsn);
+                    if (!inserted) {
+                        iter->second = std::min(iter->second, page.rec_lsn);
+                    }
+                }
+            } break;
+            default:
+                active_txns_[log_record.log_tid_] = log_record.lsn_;
+                break;
+        }
+    });
+    disk_manager_->truncate_log(log_end_lsn_);
+    log_manager_->set_next_lsn(log_end_lsn_);
 }
 
 /**
  * @description: 重做所有未落盘的操作
+ * 从脏页表中最小的recLSN开始重复历史，包括未完成事务的修改和补偿日志；
+ * 页面不在脏页表中、日志早于页面的recLSN或者页面的LSN不小于日志号时，修改已经在磁盘上。
+ * 当前线程顺序读取日志，把需要重做的日志按页面分组后交给重做线程，同一页面总是由同一个线程按日志号顺序重做；
+ * 页面第一次出现在一组日志中时提示操作系统预读，重做线程处理到它时通常已经在内存中
  */
 void RecoveryManager::redo() {
+    if (dirty_pages_.empty()) {
+        return;
+    }
+    lsn_t redo_lsn = log_end_lsn_;
+    for (auto& [page, rec_lsn] : dirty_pages_) {
+        redo_lsn = std::min(redo_lsn, rec_lsn);
+    }
+    redo_lsn = std::max(redo_lsn, log_start_lsn_);
 
+    int num_workers = redo_threads_ > 0
+                          ? redo_threads_
+                          : std::clamp(static_cast<int>(std::thread::hardware_concurrency()), 1, REDO_MAX_THREADS);
+    RedoWorkerPool pool(num_workers);
+    stats_.redo_threads = num_workers;
+    std::unordered_set<PageId> redo_pages;
+    std::unordered_map<PageId, RedoLogsInPage> batch;
+    size_t batch_size = 0;
+    auto dispatch = [&]() {
+        for (auto& [page_id, redo_logs] : batch) {
+            pool.submit(std::hash<PageId>()(page_id) % num_workers, std::move(redo_logs));
+        }
+        batch.clear();
+        batch_size = 0;
+    };
+    scan_log(redo_lsn, [&](std::unique_ptr<LogRecord>& log_record) {
+        TupleChange change;
+        if (!get_tuple_change(*log_record, change) || change.fh == nullptr) {
+            return;
+        }
+        PageId page_id{change.fh->GetFd(), change.rid.page_no};
+        auto iter = dirty_pages_.find(page_id);
+        if (iter == dirty_pages_.end() || log_record->lsn_ < iter->second) {
+            return;
+        }
+        auto [page_iter, inserted] = batch.try_emplace(page_id);
+        if (inserted) {
+            page_iter->second.table_file_ = change.fh;
+            disk_manager_->prefetch_page(page_id.fd, page_id.page_no);
+        }
+        page_iter->second.redo_logs_.push_back(std::move(log_record));
+        stats_.redo_records++;
+        redo_pages.insert(page_id);
+        if (++batch_size >= REDO_BATCH_RECORDS) {
+            dispatch();
+        }
+    });
+    dispatch();
+    pool.finish();
+    stats_.redo_pages = redo_pages.size();
 }
 
 /**
  * @description: 回滚未完成的事务
+ * 每次撤销所有未完成事务中日志号最大的一条日志，并写补偿日志；遇到补偿日志时跳到它的undo_next_lsn，
+ * 已经补偿过的修改不会被重复撤销。事务的日志全部撤销后写中止日志。
+ * 最后把日志和所有脏页写回磁盘，并根据页面重建空闲页链表
  */
 void RecoveryManager::undo() {
+    std::map<txn_id_t, std::unique_ptr<Transaction>> txns;
+    std::map<lsn_t, txn_id_t> to_undo;
+    stats_.undo_txns = active_txns_.size();
+    for (auto& [txn_id, last_lsn] : active_txns_) {
+        auto txn = std::make_unique<Transaction>(txn_id);
+        txn->set_prev_lsn(last_lsn);
+        txns.emplace(txn_id, std::move(txn));
+        to_undo.emplace(last_lsn, txn_id);
+    }
+    while (!to_undo.empty()) {
+        auto [lsn, txn_id] = *to_undo.rbegin();
+        to_undo.erase(lsn);
+        Transaction* txn = txns.at(txn_id).get();
+        Context context(nullptr, log_manager_, txn);
+        auto log_record = read_log_record(lsn);
+        lsn_t next_lsn = INVALID_LSN;
+        if (log_record != nullptr) {
+            next_lsn = log_record->prev_lsn_;
+            TupleChange change;
+            if (log_record->log_type_ == LogType::CLR) {
+                next_lsn = static_cast<CompensationLogRecord&>(*log_record).undo_next_lsn_;
+            } else if (get_tuple_change(*log_record, change) && change.fh != nullptr) {
+                // 撤销时写回修改前的记录，更新日志只有变化的字节，在当前记录上恢复这些字节的前像
+                RmFileHandle* fh = change.fh;
+                std::unique_ptr<RmRecord> old_value;
+                const char* undo_value = nullptr;
+                if (log_record->log_type_ == LogType::DELETE) {
+                    undo_value = static_cast<DeleteLogRecord&>(*log_record).delete_value_.data;
+                } else if (log_record->log_type_ == LogType::UPDATE) {
+                    old_value = fh->get_record(change.rid, nullptr);
+                    static_cast<UpdateLogRecord&>(*log_record).undo(old_value->data);
+                    undo_value = old_value->data;
+                }
+                fh->rollback_tuple(change.rid, undo_value, log_record->prev_lsn_, &context);
+            }
+        }
+        // 早于log_start_lsn_的日志只可能是事务开始日志，已经被截断
+        if (next_lsn == INVALID_LSN || next_lsn < log_start_lsn_) {
+            AbortLogRecord abort_record(txn_id);
+            abort_record.prev_lsn_ = txn->get_prev_lsn();
+            txn->set_prev_lsn(log_manager_->add_log_to_buffer(&abort_record));
+            continue;
+        }
+        to_undo.emplace(next_lsn, txn_id);
+    }
+    log_manager_->flush_log_to_disk();
+    buffer_pool_manager_->flush_pages_before(std::numeric_limits<lsn_t>::max());
+    if (!dirty_pages_.empty() || !active_txns_.empty()) {
+        for (auto& [tab_name, fh] : sm_manager_->fhs_) {
+            fh->rebuild_free_list();
+        }
+    }
+    active_txns_.clear();
+    dirty_pages_.clear();
+}
+
+/**
+ * @description: 恢复出未完成的事务修改过的记录在修改之前的内容，只读副本不回滚这些事务，而是在它们结束之前读取修改之前的内容。
+ * 与撤销相同，沿prev_lsn链从后向前处理每个未完成的事务，遇到补偿日志时跳到它的undo_next_lsn，
+ * 但是不修改页面：从记录当前的内容开始，在副本上依次撤销事务对它的修改，得到事务第一次修改之前的内容
+ * @return {unordered_map<txn_id_t, PendingTxn>} 未完成的事务及其修改过的记录
+ */
+std::unordered_map<txn_id_t, RecoveryManager::PendingTxn> RecoveryManager::get_pending_txns() {
+    std::unordered_map<txn_id_t, PendingTxn> txns;
+    for (auto& [txn_id, last_lsn] : active_txns_) {
+        PendingTxn& txn = txns[txn_id];
+        std::map<std::tuple<RmFileHandle*, int, int>, size_t> tuple_index;
+        lsn_t lsn = last_lsn;
+        while (lsn != INVALID_LSN && lsn >= log_start_lsn_) {
+            auto log_record = read_log_record(lsn);
+            if (log_record == nullptr) {
+                break;
+            }
+            txn.first_lsn = lsn;
+            lsn = log_record->prev_lsn_;
+            TupleChange change;
+            if (log_record->log_type_ == LogType::CLR) {
+                lsn = static_cast<CompensationLogRecord&>(*log_record).undo_next_lsn_;
+                continue;
+            }
+            if (!get_tuple_change(*log_record, change) || change.fh == nullptr) {
+                continue;
+            }
+            auto [iter, inserted] =
+                tuple_index.emplace(std::make_tuple(change.fh, change.rid.page_no, change.rid.slot_no), txn.tuples.size());
+            if (inserted) {
+                txn.tuples.push_back({change.fh, change.rid, INVALID_LSN, change.fh->get_tuple_image(change.rid)});
+            }
+            PendingTuple& tuple = txn.tuples[iter->second];
+            tuple.lsn = log_record->lsn_;
+            if (log_record->log_type_ == LogType::INSERT) {
+                tuple.before = nullptr;
+            } else if (log_record->log_type_ == LogType::DELETE) {
+                tuple.before = std::make_shared<RmRecord>(static_cast<DeleteLogRecord&>(*log_record).delete_value_);
+            } else if (log_record->log_type_ == LogType::UPDATE && tuple.before != nullptr) {
+                static_cast<UpdateLogRecord&>(*log_record).undo(tuple.before->data);
+            }
+        }
+    }
+    return txns;
+}
+
+/**
+ * @description: 在表上重做一条数据修改日志或补偿日志，页面的LSN不小于日志号时不重做
+ * @param {RmFileHandle*} fh 被修改的表
+ * @param {LogRecord&} log_record 日志记录
+ */
+void RecoveryManager::redo_log_record(RmFileHandle* fh, LogRecord& log_record) {
+    switch (log_record.log_type_) {
+        case LogType::INSERT: {
+            auto& rec = static_cast<InsertLogRecord&>(log_record);
+            fh->redo_tuple(rec.rid_, rec.insert_value_.data, rec.lsn_);
+        } break;
+        case LogType::DELETE: {
+            auto& rec = static_cast<DeleteLogRecord&>(log_record);
+            fh->redo_tuple(rec.rid_, nullptr, rec.lsn_);
+        } break;
+        case LogType::UPDATE:
+            fh->redo_update(static_cast<UpdateLogRecord&>(log_record));
+            break;
+        case LogType::CLR: {
+            auto& rec = static_cast<CompensationLogRecord&>(log_record);
+            fh->redo_tuple(rec.rid_, rec.redo_type_ == LogType::DELETE ? nullptr : rec.value_.data, rec.lsn_);
+        } break;
+        default:
+            break;
+    }
+}
+
+/**
+ * @description: 从start_lsn开始顺序读取日志，对每条完整的日志调用func
+ * 日志长度不合法、超出文件末尾或者日志号与偏移量不一致时，说明是故障时没有写完整的日志，扫描到此为止
+ * @return {lsn_t} 最后一条完整日志之后的偏移量
+ * @param {lsn_t} start_lsn 开始扫描的日志号
+ * @param {function<void(unique_ptr<LogRecord>&)>} &func 对每条日志调用的函数，可以取走日志对象
+ */
+lsn_t RecoveryManager::scan_log(lsn_t start_lsn, const std::function<void(std::unique_ptr<LogRecord>&)>& func) {
+    lsn_t lsn = start_lsn;
+    while (true) {
+        // 每次从下一条日志开始读入一个缓冲区，缓冲区末尾不完整的日志在下一轮重新读入
+        int size = disk_manager_->read_log(buffer_.buffer_, LOG_BUFFER_SIZE, lsn);
+        if (size < LOG_HEADER_SIZE) {
+            return lsn;
+        }
+        int offset = 0;
+        while (offset + LOG_HEADER_SIZE <= size) {
+            const char* src = buffer_.buffer_ + offset;
+            uint32_t tot_len = *reinterpret_cast<const uint32_t*>(src + OFFSET_LOG_TOT_LEN);
+            if (tot_len < LOG_HEADER_SIZE || tot_len > LOG_BUFFER_SIZE ||
+                *reinterpret_cast<const lsn_t*>(src + OFFSET_LSN) != lsn) {
+                return lsn;
+            }
+            if (offset + static_cast<int>(tot_len) > size) {
+                break;
+            }
+            // 校验和不正确说明这条日志没有写完整，之后的内容都不可信
+            if (!check_log_record(src, tot_len, lsn)) {
+                return lsn;
+            }
+            auto log_record = deserialize_log_record(src);
+            if (log_record == nullptr) {
+                return lsn;
+            }
+            func(log_record);
+            offset += tot_len;
+            lsn += tot_len;
+        }
+        if (size < LOG_BUFFER_SIZE || offset == 0) {
+            // 已经读到最后一个日志段的末尾，剩余的内容不是完整的日志
+            return lsn;
+        }
+    }
+}
+
+/**
+ * @description: 读取日志号为lsn的日志
+ * @return {unique_ptr<LogRecord>} 日志记录，lsn不是一条完整日志的起始位置时返回空指针
+ * @param {lsn_t} lsn 日志号
+ */
+std::unique_ptr<LogRecord> RecoveryManager::read_log_record(lsn_t lsn) {
+    if (lsn < log_start_lsn_ || lsn + LOG_HEADER_SIZE > log_end_lsn_) {
+        return nullptr;
+    }
+    int size = disk_manager_->read_log(buffer_.buffer_, static_cast<int>(std::min<lsn_t>(LOG_BUFFER_SIZE, log_end_lsn_ - lsn)), lsn);
+    if (!check_log_record(buffer_.buffer_, size, lsn)) {
+        return nullptr;
+    }
+    return deserialize_log_record(buffer_.buffer_);
+}
 
-}
\ No newline at end of file
+/**
+ * @description: 获取数据修改日志或补偿日志修改的记录
+ * @return {bool} 是否为数据修改日志或补偿日志
+ * @param {LogRecord&} log_record 日志记录
+ * @param {TupleChange&} change 被修改的表和记录号，表已经被删除时表为空
+ */
+bool RecoveryManager::get_tuple_change(LogRecord& log_record, TupleChange& change) {
+    switch (log_record.log_type_) {
+        case LogType::INSERT: {
+            auto& rec = static_cast<InsertLogRecord&>(log_record);
+            change = {get_file_handle(rec.table_name_), rec.rid_};
+        } break;
+        case LogType::DELETE: {
+            auto& rec = static_cast<DeleteLogRecord&>(log_record);
+            change = {get_file_handle(rec.table_name_), rec.rid_};
+        } break;
+        case LogType::UPDATE: {
+            auto& rec = static_cast<UpdateLogRecord&>(log_record);
+            auto iter = table_files_.find(rec.table_id_);
+            change = {iter == table_files_.end() ? nullptr : iter->second, rec.rid_};
+        } break;
+        case LogType::CLR: {
+            auto& rec = static_cast<CompensationLogRecord&>(log_record);
+            change = {get_file_handle(rec.table_name_), rec.rid_};
+        } break;
+        default:
+            return false;
+    }
+    return true;
+}
+
+/**
+ * @description: 获取表的文件句柄，表已经被删除时返回空指针，对它的修改不需要恢复
+ */
+RmFileHandle* RecoveryManager::get_file_handle(const std::string& tab_name) {
+    auto iter = sm_manager_->fhs_.find(tab_name);
+    return iter == sm_manager_->fhs_.end() ? nullptr : iter->second.get();
+}
@@ -10,8 +10,11 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include <functional>
 #include <map>
+#include <memory>
 #include <unordered_map>
+#include <unordered_set>
 #include "log_manager.h"
 #include "storage/disk_manager.h"
 #include "system/sm_manager.h"
@@ -20,23 +23,100 @@ class RedoLogsInPage {
 public:
     RedoLogsInPage() { table_file_ = nullptr; }
     RmFileHandle* table_file_;
-    std::vector<lsn_t> redo_logs_;   // 在该page上需要redo的操作的lsn
+    std::vector<std::unique_ptr<LogRecord>> redo_logs_;   // 在该page上需要redo的日志，按lsn递增
 };
 
+/* 故障恢复管理器，按ARIES的分析、重做、撤销三个阶段恢复数据库
+ * 日志号就是日志在日志文件中的偏移量，主记录保存最近一个检查点的开始日志和仍然有效的最小日志号，
+ * 分析阶段从该日志号开始扫描，得到活跃事务表、脏页表和日志的有效长度；
+ * 重做阶段按页面的LSN重复历史；撤销阶段沿prev_lsn链回滚未完成的事务，回滚时写补偿日志。
+ * 索引的修改目前没有日志，恢复只涉及表中的记录。
+ */
 class RecoveryManager {
 public:
-    RecoveryManager(DiskManager* disk_manager, BufferPoolManager* buffer_pool_manager, SmManager* sm_manager) {
+    RecoveryManager(DiskManager* disk_manager, BufferPoolManager* buffer_pool_manager, SmManager* sm_manager,
+                    LogManager* log_manager) {
         disk_manager_ = disk_manager;
         buffer_pool_manager_ = buffer_pool_manager;
         sm_manager_ = sm_manager;
+        log_manager_ = log_manager;
     }
 
     void analyze();
     void redo();
     void undo();
+
+    /**
+     * @description: 日志中出现过的最大事务ID，恢复之后新分配的事务ID从它的下一个开始
+     * @return {txn_id_t} 最大事务ID，日志中没有事务时返回INVALID_TXN_ID
+     */
+    txn_id_t get_max_txn_id() { return max_txn_id_; }
+
+    lsn_t get_log_start_lsn() { return log_start_lsn_; }
+
+    lsn_t get_log_end_lsn() { return log_end_lsn_; }
+
+    /* 一次恢复的统计，启动时输出 */
+    struct RecoveryStats {
+        size_t redo_records = 0;    // 交给重做线程的日志数
+        size_t redo_pages = 0;      // 重做涉及的页面数
+        int redo_threads = 0;       // 重做线程数，没有需要重做的页面时为0
+        size_t undo_txns = 0;       // 回滚的未完成事务数
+    };
+
+    const RecoveryStats& get_stats() { return stats_; }
+
+    /**
+     * @description: 指定重做线程数，没有指定时按CPU核数，最多REDO_MAX_THREADS个
+     * @param {int} num_threads 重做线程数
+     */
+    void set_redo_threads(int num_threads) { redo_threads_ = num_threads; }
+
+    /* 数据修改日志或补偿日志修改的记录 */
+    struct TupleChange {
+        RmFileHandle* fh;   // 记录所在的表，表已经被删除时为空
+        Rid rid;
+    };
+
+    bool get_tuple_change(LogRecord& log_record, TupleChange& change);
+
+    static void redo_log_record(RmFileHandle* fh, LogRecord& log_record);
+
+    /* 未完成的事务修改过的一条记录，以及事务第一次修改它之前的内容 */
+    struct PendingTuple {
+        RmFileHandle* fh;
+        Rid rid;
+        lsn_t lsn;                          // 事务第一次修改这条记录的日志号
+        std::shared_ptr<RmRecord> before;   // 修改之前的内容，记录原来不存在时为空
+    };
+
+    /* 未完成的事务 */
+    struct PendingTxn {
+        lsn_t first_lsn = INVALID_LSN;      // 事务仍然保留的第一条日志
+        std::vector<PendingTuple> tuples;
+    };
+
+    std::unordered_map<txn_id_t, PendingTxn> get_pending_txns();
+
 private:
+    lsn_t scan_log(lsn_t start_lsn, const std::function<void(std::unique_ptr<LogRecord>&)>& func);
+
+    std::unique_ptr<LogRecord> read_log_record(lsn_t lsn);
+
+    RmFileHandle* get_file_handle(const std::string& tab_name);
+
     LogBuffer buffer_;                                              // 读入日志
     DiskManager* disk_manager_;                                     // 用来读写文件
     BufferPoolManager* buffer_pool_manager_;                        // 对页面进行读写
     SmManager* sm_manager_;                                         // 访问数据库元数据
-};
\ No newline at end of file
+    LogManager* log_manager_;                                       // 撤销时写补偿日志
+
+    lsn_t log_start_lsn_ = 0;                                       // 仍然有效的最小日志号，更早的日志已被截断
+    lsn_t log_end_lsn_ = 0;                                         // 日志的有效长度，之后的内容是故障时没有写完整的日志
+    std::unordered_map<txn_id_t, lsn_t> active_txns_;               // 活跃事务表（ATT）：未完成的事务及其最后一条日志
+    std::unordered_map<PageId, lsn_t> dirty_pages_;                 // 脏页表（DPT）：页面及其recLSN
+    std::unordered_map<int, RmFileHandle*> table_files_;            // 表编号到表的映射，更新日志用表编号引用表
+    txn_id_t max_txn_id_ = INVALID_TXN_ID;
+    RecoveryStats stats_;
+    int redo_threads_ = 0;                                          // 指定的重做线程数，为0时按CPU核数
+};
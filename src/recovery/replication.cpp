@@ -0,0 +1,552 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "replication.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <limits>
+
+#include "errors.h"
+#include "record/rm_file_handle.h"
+
+namespace {
+
+int64_t now_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+bool send_all(int fd, const void *data, size_t len) {
+    const char *ptr = static_cast<const char *>(data);
+    while (len > 0) {
+        ssize_t ret = send(fd, ptr, len, MSG_NOSIGNAL);
+        if (ret < 0 && errno == EINTR) {
+            continue;
+        }
+        if (ret <= 0) {
+            return false;
+        }
+        ptr += ret;
+        len -= ret;
+    }
+    return true;
+}
+
+bool recv_all(int fd, void *data, size_t len) {
+    char *ptr = static_cast<char *>(data);
+    while (len > 0) {
+        ssize_t ret = recv(fd, ptr, len, 0);
+        if (ret < 0 && errno == EINTR) {
+            continue;
+        }
+        if (ret <= 0) {
+            return false;
+        }
+        ptr += ret;
+        len -= ret;
+    }
+    return true;
+}
+
+}  // namespace
+
+/**
+ * @description: 在本机的复制端口上监听副本的连接
+ * @param {int} port 复制端口
+ */
+void ReplicationSender::start(int port) {
+    listen_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd_ < 0) {
+        throw UnixError();
+    }
+    int val = 1;
+    setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &val, sizeof(val));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    if (bind(listen_fd_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0 || listen(listen_fd_, 4) < 0) {
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+        throw UnixError();
+    }
+    running_ = true;
+    listener_ = std::thread(&ReplicationSender::run_listener, this);
+}
+
+/**
+ * @description: 停止监听，断开所有副本的连接
+ */
+void ReplicationSender::stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+    if (listener_.joinable()) {
+        listener_.join();
+    }
+    ::close(listen_fd_);
+    listen_fd_ = -1;
+    std::list<std::unique_ptr<Replica>> replicas;
+    {
+        std::scoped_lock lock{latch_};
+        replicas.swap(replicas_);
+    }
+    for (auto &replica : replicas) {
+        shutdown(replica->fd, SHUT_RDWR);
+    }
+    for (auto &replica : replicas) {
+        if (replica->thread.joinable()) {
+            replica->thread.join();
+        }
+        ::close(replica->fd);
+    }
+}
+
+/**
+ * @description: 已连接的副本重启时需要的最早的日志，检查点不能丢弃它之后的日志
+ * @return {lsn_t} 最早的日志号，没有副本连接时返回INVALID_LSN
+ */
+lsn_t ReplicationSender::get_retained_lsn() {
+    std::scoped_lock lock{latch_};
+    lsn_t retained_lsn = INVALID_LSN;
+    for (auto &replica : replicas_) {
+        lsn_t restart_lsn = replica->restart_lsn;
+        if (replica->done || restart_lsn == INVALID_LSN) {
+            continue;
+        }
+        retained_lsn = retained_lsn == INVALID_LSN ? restart_lsn : std::min(retained_lsn, restart_lsn);
+    }
+    return retained_lsn;
+}
+
+/**
+ * @description: 主库的复制状态：已经持久化的日志的末尾，以及每个副本发送和重放的位置、落后的字节数
+ */
+ReplicationStatus ReplicationSender::get_status() {
+    lsn_t durable_lsn = log_manager_->get_persist_lsn() + 1;
+    ReplicationStatus status = {{"role", "primary"}, {"durable_lsn", std::to_string(durable_lsn)}};
+    std::scoped_lock lock{latch_};
+    int num_replicas = 0;
+    for (auto &replica : replicas_) {
+        if (replica->done) {
+            continue;
+        }
+        std::string prefix = "replica_" + std::to_string(++num_replicas) + "_";
+        lsn_t applied_lsn = replica->applied_lsn;
+        status.emplace_back(prefix + "sent_lsn", std::to_string(replica->sent_lsn));
+        status.emplace_back(prefix + "applied_lsn", std::to_string(applied_lsn));
+        status.emplace_back(prefix + "lag_bytes", std::to_string(std::max<lsn_t>(0, durable_lsn - applied_lsn)));
+    }
+    status.emplace_back("replicas", std::to_string(num_replicas));
+    return status;
+}
+
+/**
+ * @description: 接受副本的连接，为每个副本启动一个发送线程，并回收已经断开的副本
+ */
+void ReplicationSender::run_listener() {
+    while (running_) {
+        pollfd pfd{listen_fd_, POLLIN, 0};
+        int ret = poll(&pfd, 1, REPLICATION_KEEPALIVE_INTERVAL.count());
+        {
+            std::scoped_lock lock{latch_};
+            for (auto iter = replicas_.begin(); iter != replicas_.end();) {
+                if (!(*iter)->done) {
+                    ++iter;
+                    continue;
+                }
+                (*iter)->thread.join();
+                ::close((*iter)->fd);
+                iter = replicas_.erase(iter);
+            }
+        }
+        if (ret <= 0) {
+            continue;
+        }
+        int fd = accept(listen_fd_, nullptr, nullptr);
+        if (fd < 0) {
+            continue;
+        }
+        int val = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &val, sizeof(val));
+        std::scoped_lock lock{latch_};
+        auto &replica = replicas_.emplace_back(std::make_unique<Replica>());
+        replica->fd = fd;
+        replica->thread = std::thread(&ReplicationSender::run_sender, this, replica.get());
+    }
+}
+
+/**
+ * @description: 向一个副本发送日志：副本先发送开始复制的位置，之后按顺序发送已经持久化的日志，
+ * 没有新的日志时每隔REPLICATION_KEEPALIVE_INTERVAL发送一次心跳，同时接收副本重放的进度
+ * @param {Replica*} replica 副本
+ */
+void ReplicationSender::run_sender(Replica *replica) {
+    int fd = replica->fd;
+    ReplicationFeedback feedback;
+    if (!recv_all(fd, &feedback, sizeof(feedback))) {
+        replica->done = true;
+        return;
+    }
+    replica->applied_lsn = feedback.applied_lsn;
+    replica->restart_lsn = feedback.restart_lsn;
+    lsn_t send_lsn = feedback.applied_lsn;
+    std::cout << "replica connected, streaming log from lsn " << send_lsn << std::endl;
+
+    std::vector<char> buffer(REPLICATION_MAX_MESSAGE);
+    size_t feedback_len = 0;
+    while (running_) {
+        lsn_t end_lsn = log_manager_->get_persist_lsn() + 1;
+        if (send_lsn > end_lsn) {
+            send_error(fd, "replica is ahead of the primary at lsn " + std::to_string(send_lsn));
+            break;
+        }
+        ReplicationMessageHeader header{ReplicationMessageType::KEEPALIVE, send_lsn, 0, end_lsn, 0};
+        if (send_lsn < end_lsn) {
+            int len = disk_manager_->read_log(
+                buffer.data(), static_cast<int>(std::min<lsn_t>(end_lsn - send_lsn, REPLICATION_MAX_MESSAGE)), send_lsn);
+            if (len <= 0) {
+                send_error(fd, "requested log at lsn " + std::to_string(send_lsn) + " has been removed");
+                break;
+            }
+            header.type = ReplicationMessageType::DATA;
+            header.len = len;
+        } else if (log_manager_->wait_for_persist(send_lsn, REPLICATION_KEEPALIVE_INTERVAL)) {
+            continue;
+        }
+        header.send_time_us = now_us();
+        if (!send_all(fd, &header, sizeof(header)) || !send_all(fd, buffer.data(), header.len)) {
+            break;
+        }
+        send_lsn += header.len;
+        replica->sent_lsn = send_lsn;
+
+        // 接收副本发来的进度，不等待
+        bool closed = false;
+        while (true) {
+            ssize_t ret = recv(fd, reinterpret_cast<char *>(&feedback) + feedback_len, sizeof(feedback) - feedback_len,
+                               MSG_DONTWAIT);
+            if (ret < 0 && errno == EINTR) {
+                continue;
+            }
+            if (ret <= 0) {
+                closed = ret == 0 || (errno != EAGAIN && errno != EWOULDBLOCK);
+                break;
+            }
+            feedback_len += ret;
+            if (feedback_len == sizeof(feedback)) {
+                replica->applied_lsn = feedback.applied_lsn;
+                replica->restart_lsn = feedback.restart_lsn;
+                feedback_len = 0;
+            }
+        }
+        if (closed) {
+            break;
+        }
+    }
+    std::cout << "replica disconnected at lsn " << send_lsn << std::endl;
+    replica->done = true;
+}
+
+/**
+ * @description: 通知副本无法继续复制的原因
+ */
+bool ReplicationSender::send_error(int fd, const std::string &message) {
+    std::cerr << "replication: " << message << std::endl;
+    ReplicationMessageHeader header{ReplicationMessageType::ERROR, INVALID_LSN, static_cast<uint32_t>(message.size()),
+                                    log_manager_->get_persist_lsn() + 1, now_us()};
+    return send_all(fd, &header, sizeof(header)) && send_all(fd, message.data(), message.size());
+}
+
+/**
+ * @description: 副本启动时，在分析和重做本地日志之后调用：从本地日志的末尾继续接收，
+ * 并为未完成的事务修改过的记录恢复修改之前的内容，同一记录上按修改的顺序排列
+ */
+void ReplicaApplier::init() {
+    received_lsn_ = recovery_->get_log_end_lsn();
+    applied_lsn_ = recovery_->get_log_end_lsn();
+    restart_lsn_ = recovery_->get_log_start_lsn();
+    std::vector<std::pair<txn_id_t, RecoveryManager::PendingTuple *>> tuples;
+    auto pending_txns = recovery_->get_pending_txns();
+    for (auto &[txn_id, pending_txn] : pending_txns) {
+        ReplicaTxn &txn = txns_[txn_id];
+        txn.first_lsn = pending_txn.first_lsn == INVALID_LSN ? restart_lsn_.load() : pending_txn.first_lsn;
+        for (auto &tuple : pending_txn.tuples) {
+            txn.tuples.emplace_back(tuple.fh, tuple.rid);
+            tuples.emplace_back(txn_id, &tuple);
+        }
+    }
+    std::sort(tuples.begin(), tuples.end(), [](auto &a, auto &b) { return a.second->lsn < b.second->lsn; });
+    for (auto &[txn_id, tuple] : tuples) {
+        tuple->fh->add_pending_tuple(tuple->rid, txn_id, tuple->before);
+    }
+}
+
+/**
+ * @description: 启动接收和重放日志的线程
+ * @param {int} primary_port 主库在本机上的复制端口
+ */
+void ReplicaApplier::start(int primary_port) {
+    running_ = true;
+    thread_ = std::thread(&ReplicaApplier::run, this, primary_port);
+}
+
+/**
+ * @description: 断开与主库的连接，等待正在重放的日志完成
+ */
+void ReplicaApplier::stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+    {
+        std::scoped_lock lock{latch_};
+        if (fd_ != -1) {
+            shutdown(fd_, SHUT_RDWR);
+        }
+    }
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+/**
+ * @description: 副本的检查点：写回所有脏页，主记录指向已经重放的位置，
+ * 重启时从未完成的事务的第一条日志开始分析，更早的本地日志可以丢弃
+ */
+void ReplicaApplier::checkpoint() {
+    std::unique_lock lock{apply_latch_};
+    buffer_pool_manager_->flush_pages_before(std::numeric_limits<lsn_t>::max());
+    disk_manager_->sync_data();
+    lsn_t restart_lsn = applied_lsn_;
+    for (auto &[txn_id, txn] : txns_) {
+        restart_lsn = std::min(restart_lsn, txn.first_lsn);
+    }
+    disk_manager_->write_master_record(applied_lsn_, restart_lsn);
+    disk_manager_->discard_log(restart_lsn);
+    restart_lsn_ = restart_lsn;
+}
+
+/**
+ * @description: 副本的复制状态，lag_bytes是主库已经持久化、副本还没有重放的日志量，
+ * lag_ms是最近一条消息从主库发送到副本重放完成的时间
+ */
+ReplicationStatus ReplicaApplier::get_status() {
+    lsn_t primary_lsn = primary_lsn_;
+    lsn_t applied_lsn = applied_lsn_;
+    ReplicationStatus status = {
+        {"role", "replica"},
+        {"connected", connected_ ? "yes" : "no"},
+        {"primary_lsn", std::to_string(primary_lsn)},
+        {"received_lsn", std::to_string(received_lsn_)},
+        {"applied_lsn", std::to_string(applied_lsn)},
+        {"lag_bytes", std::to_string(primary_lsn == INVALID_LSN ? 0 : std::max<lsn_t>(0, primary_lsn - applied_lsn))},
+        {"lag_ms", std::to_string(lag_us_ / 1000.0)},
+    };
+    std::scoped_lock lock{latch_};
+    if (!last_error_.empty()) {
+        status.emplace_back("last_error", last_error_);
+    }
+    return status;
+}
+
+/**
+ * @description: 连接主库并接收日志，连接断开后每隔REPLICATION_RETRY_INTERVAL重新连接
+ * @param {int} primary_port 主库的复制端口
+ */
+void ReplicaApplier::run(int primary_port) {
+    while (running_) {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = htons(primary_port);
+        if (fd >= 0 && connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == 0) {
+            int val = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &val, sizeof(val));
+            {
+                std::scoped_lock lock{latch_};
+                fd_ = fd;
+            }
+            connected_ = true;
+            receive(fd);
+            connected_ = false;
+            std::scoped_lock lock{latch_};
+            fd_ = -1;
+        } else {
+            std::scoped_lock lock{latch_};
+            last_error_ = std::string("cannot connect to the primary: ") + strerror(errno);
+        }
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        auto retry_time = std::chrono::steady_clock::now() + REPLICATION_RETRY_INTERVAL;
+        while (running_ && std::chrono::steady_clock::now() < retry_time) {
+            std::this_thread::sleep_for(REPLICATION_KEEPALIVE_INTERVAL);
+        }
+    }
+}
+
+/**
+ * @description: 从本地日志的末尾开始接收日志，直到连接断开或出错。收到的日志先写入本地日志段并持久化，
+ * 再把其中完整的日志交给重放；每隔CHECKPOINT_INTERVAL做一次检查点
+ * @param {int} fd 与主库的连接
+ */
+void ReplicaApplier::receive(int fd) {
+    auto fail = [&](const std::string &message) {
+        std::cerr << "replication: " << message << std::endl;
+        std::scoped_lock lock{latch_};
+        last_error_ = message;
+    };
+    // 上次连接时没有接收完整的日志，从已经重放的位置重新接收
+    pending_log_.clear();
+    received_lsn_ = applied_lsn_.load();
+    if (!send_feedback(fd)) {
+        return;
+    }
+    auto last_checkpoint = std::chrono::steady_clock::now();
+    std::vector<char> data;
+    while (running_) {
+        pollfd pfd{fd, POLLIN, 0};
+        int ret = poll(&pfd, 1, REPLICATION_KEEPALIVE_INTERVAL.count());
+        if (std::chrono::steady_clock::now() - last_checkpoint >= CHECKPOINT_INTERVAL) {
+            checkpoint();
+            last_checkpoint = std::chrono::steady_clock::now();
+        }
+        if (ret < 0 && errno != EINTR) {
+            return;
+        }
+        if (ret <= 0) {
+            continue;
+        }
+        ReplicationMessageHeader header;
+        if (!recv_all(fd, &header, sizeof(header))) {
+            fail("connection to the primary is closed");
+            return;
+        }
+        data.resize(header.len);
+        if (header.len > 0 && !recv_all(fd, data.data(), header.len)) {
+            fail("connection to the primary is closed");
+            return;
+        }
+        primary_lsn_ = header.end_lsn;
+        if (header.type == ReplicationMessageType::ERROR) {
+            fail(std::string(data.begin(), data.end()));
+            return;
+        }
+        if (header.type == ReplicationMessageType::DATA) {
+            if (header.lsn != received_lsn_) {
+                fail("unexpected log at lsn " + std::to_string(header.lsn));
+                return;
+            }
+            // 本地日志先持久化，重放后写回的页面不会早于它们的日志
+            disk_manager_->write_log(data.data(), header.len, header.lsn);
+            disk_manager_->sync_log();
+            received_lsn_ = header.lsn + header.len;
+            pending_log_.append(data.data(), header.len);
+
+            std::vector<std::unique_ptr<LogRecord>> log_records;
+            size_t offset = 0;
+            lsn_t lsn = applied_lsn_;
+            while (offset + LOG_HEADER_SIZE <= pending_log_.size()) {
+                const char *src = pending_log_.data() + offset;
+                uint32_t tot_len = *reinterpret_cast<const uint32_t *>(src + OFFSET_LOG_TOT_LEN);
+                if (tot_len >= LOG_HEADER_SIZE && offset + tot_len > pending_log_.size()) {
+                    break;
+                }
+                std::unique_ptr<LogRecord> log_record;
+                if (tot_len >= LOG_HEADER_SIZE && tot_len <= LOG_BUFFER_SIZE && check_log_record(src, tot_len, lsn)) {
+                    log_record = deserialize_log_record(src);
+                }
+                if (log_record == nullptr) {
+                    // 之后的内容不可信，断开连接，重新连接后从已经重放的位置重新接收
+                    if (!log_records.empty()) {
+                        apply(log_records);
+                    }
+                    fail("invalid log record at lsn " + std::to_string(lsn));
+                    return;
+                }
+                log_records.push_back(std::move(log_record));
+                offset += tot_len;
+                lsn += tot_len;
+            }
+            pending_log_.erase(0, offset);
+            if (!log_records.empty()) {
+                apply(log_records);
+            }
+        }
+        lag_us_ = now_us() - header.send_time_us;
+        if (!send_feedback(fd)) {
+            return;
+        }
+    }
+}
+
+/**
+ * @description: 按日志号顺序重放一批完整的日志。事务第一次修改一条记录之前记下它原来的内容，
+ * 事务提交或回滚时去掉这些内容，之后的查询读到事务的修改（回滚时是补偿日志恢复的内容）
+ * @param {vector<unique_ptr<LogRecord>>} &log_records 日志，第一条从applied_lsn_开始
+ */
+void ReplicaApplier::apply(std::vector<std::unique_ptr<LogRecord>> &log_records) {
+    std::unique_lock lock{apply_latch_};
+    for (auto &record : log_records) {
+        LogRecord &log_record = *record;
+        txn_id_t txn_id = log_record.log_tid_;
+        switch (log_record.log_type_) {
+            case LogType::begin:
+                txns_.try_emplace(txn_id, ReplicaTxn{log_record.lsn_, {}});
+                break;
+            case LogType::commit:
+            case LogType::ABORT: {
+                auto iter = txns_.find(txn_id);
+                if (iter != txns_.end()) {
+                    for (auto &[fh, rid] : iter->second.tuples) {
+                        fh->remove_pending_tuple(rid, txn_id);
+                    }
+                    txns_.erase(iter);
+                }
+            } break;
+            case LogType::CKPT_BEGIN:
+            case LogType::CKPT_END:
+                break;
+            default: {
+                RecoveryManager::TupleChange change;
+                if (!recovery_->get_tuple_change(log_record, change) || change.fh == nullptr) {
+                    break;
+                }
+                ReplicaTxn &txn = txns_.try_emplace(txn_id, ReplicaTxn{log_record.lsn_, {}}).first->second;
+                // 补偿日志撤销的是事务之前的修改，记录原来的内容已经记下
+                if (log_record.log_type_ != LogType::CLR && !change.fh->has_pending_tuple(change.rid, txn_id)) {
+                    change.fh->add_pending_tuple(change.rid, txn_id, change.fh->get_tuple_image(change.rid));
+                    txn.tuples.emplace_back(change.fh, change.rid);
+                }
+                RecoveryManager::redo_log_record(change.fh, log_record);
+            } break;
+        }
+        applied_lsn_ = log_record.lsn_ + static_cast<lsn_t>(log_record.log_tot_len_);
+    }
+}
+
+/**
+ * @description: 向主库发送重放的进度
+ */
+bool ReplicaApplier::send_feedback(int fd) {
+    ReplicationFeedback feedback{applied_lsn_, restart_lsn_};
+    return send_all(fd, &feedback, sizeof(feedback));
+}
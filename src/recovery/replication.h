@@ -0,0 +1,151 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "log_manager.h"
+#include "log_recovery.h"
+
+/* 复制状态，每一项为名称和值 */
+using ReplicationStatus = std::vector<std::pair<std::string, std::string>>;
+
+/* 复制连接上主库发给副本的消息类型 */
+enum class ReplicationMessageType : uint32_t { DATA = 1, KEEPALIVE, ERROR };
+
+/* 主库发给副本的消息头，DATA消息之后是从lsn开始的len字节日志，ERROR消息之后是len字节的错误信息 */
+struct ReplicationMessageHeader {
+    ReplicationMessageType type;
+    lsn_t lsn;              // DATA消息中第一个字节的日志号
+    uint32_t len;
+    lsn_t end_lsn;          // 发送时主库已经持久化的日志的末尾
+    int64_t send_time_us;   // 发送时间（微秒），副本据此计算复制延迟
+};
+
+/* 副本发给主库的消息，连接建立时发送的applied_lsn是开始复制的位置，之后每次重放日志后发送一次 */
+struct ReplicationFeedback {
+    lsn_t applied_lsn;      // 副本已经重放的日志的末尾
+    lsn_t restart_lsn;      // 副本重启时需要的最早的日志，主库需要保留此后的日志
+};
+
+/* 主库的日志发送端：在复制端口上监听，每个副本一个发送线程，从副本请求的位置开始按顺序发送已经持久化的日志。
+ * 只发送已经持久化的日志，副本重放的修改不会因为主库故障而丢失；
+ * 副本连接期间，检查点保留副本重启所需的日志 */
+class ReplicationSender {
+   public:
+    ReplicationSender(DiskManager *disk_manager, LogManager *log_manager)
+        : disk_manager_(disk_manager), log_manager_(log_manager) {}
+
+    ~ReplicationSender() { stop(); }
+
+    void start(int port);
+
+    void stop();
+
+    lsn_t get_retained_lsn();
+
+    ReplicationStatus get_status();
+
+   private:
+    /* 一个已连接的副本 */
+    struct Replica {
+        int fd;
+        std::thread thread;
+        std::atomic<lsn_t> sent_lsn{INVALID_LSN};       // 已经发送的日志的末尾
+        std::atomic<lsn_t> applied_lsn{INVALID_LSN};    // 副本已经重放的日志的末尾
+        std::atomic<lsn_t> restart_lsn{INVALID_LSN};    // 副本重启需要的最早的日志
+        std::atomic<bool> done{false};                  // 连接已经断开，等待回收
+    };
+
+    void run_listener();
+
+    void run_sender(Replica *replica);
+
+    bool send_error(int fd, const std::string &message);
+
+    DiskManager *disk_manager_;
+    LogManager *log_manager_;
+
+    int listen_fd_ = -1;
+    std::atomic<bool> running_{false};
+    std::thread listener_;                              // 接受副本连接的线程
+    std::mutex latch_;                                  // 保护replicas_
+    std::list<std::unique_ptr<Replica>> replicas_;
+};
+
+/* 只读副本的日志接收端：连接主库的复制端口，把收到的日志写入本地日志段并持久化之后再重放，
+ * 本地的日志和主库的日志号相同，副本重启时像故障恢复一样分析和重做本地的日志，然后从本地日志的末尾继续接收。
+ * 重放按日志号顺序进行，每批日志在重放锁的写锁内重放，查询语句持有读锁，因此读到的是两批日志之间的状态；
+ * 未完成的事务修改过的记录在表中保留修改之前的内容（见RmFileHandle::add_pending_tuple），
+ * 查询只能看到已经提交的事务的修改。索引的修改没有日志，副本上不使用索引扫描。 */
+class ReplicaApplier {
+   public:
+    ReplicaApplier(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, RecoveryManager *recovery)
+        : disk_manager_(disk_manager), buffer_pool_manager_(buffer_pool_manager), recovery_(recovery) {}
+
+    ~ReplicaApplier() { stop(); }
+
+    void init();
+
+    void start(int primary_port);
+
+    void stop();
+
+    void checkpoint();
+
+    std::shared_mutex &get_apply_latch() { return apply_latch_; }
+
+    ReplicationStatus get_status();
+
+   private:
+    /* 主库上未完成的事务 */
+    struct ReplicaTxn {
+        lsn_t first_lsn;                                        // 本地保留的事务的第一条日志
+        std::vector<std::pair<RmFileHandle *, Rid>> tuples;     // 事务修改过的记录
+    };
+
+    void run(int primary_port);
+
+    void receive(int fd);
+
+    void apply(std::vector<std::unique_ptr<LogRecord>> &log_records);
+
+    bool send_feedback(int fd);
+
+    DiskManager *disk_manager_;
+    BufferPoolManager *buffer_pool_manager_;
+    RecoveryManager *recovery_;
+
+    std::shared_mutex apply_latch_;                         // 重放持有写锁，查询持有读锁
+    std::unordered_map<txn_id_t, ReplicaTxn> txns_;         // 未完成的事务，只在重放锁内访问
+    std::string pending_log_;                               // 已经接收、还不是完整日志的内容
+    std::atomic<lsn_t> received_lsn_{0};                    // 本地日志的末尾
+    std::atomic<lsn_t> applied_lsn_{0};                     // 已经重放的日志的末尾
+    std::atomic<lsn_t> restart_lsn_{0};                     // 副本重启需要的最早的日志
+    std::atomic<lsn_t> primary_lsn_{INVALID_LSN};           // 主库最近一次发送时已经持久化的日志的末尾
+    std::atomic<int64_t> lag_us_{0};                        // 最近一条消息从主库发送到重放完成的时间
+    std::atomic<bool> connected_{false};
+    std::string last_error_;                                // 最近一次复制出错的原因，latch_保护
+
+    std::mutex latch_;                                      // 保护fd_和last_error_
+    int fd_ = -1;                                           // 与主库的连接
+    std::atomic<bool> running_{false};
+    std::thread thread_;                                    // 接收和重放日志的线程
+};
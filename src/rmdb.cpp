@@ -11,23 +11,37 @@ See the Mulan PSL v2 for more details. */
 #include <netinet/in.h>
 #include <readline/history.h>
 #include <readline/readline.h>
-#include <setjmp.h>
 #include <signal.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/resource.h>
 #include <unistd.h>
 #include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <shared_mutex>
+#include <thread>
+#include <unordered_set>
 
 #include "errors.h"
 #include "optimizer/optimizer.h"
 #include "recovery/log_recovery.h"
+#include "recovery/backup_manager.h"
+#include "recovery/checkpoint_manager.h"
+#include "recovery/replication.h"
 #include "optimizer/plan.h"
 #include "optimizer/planner.h"
 #include "portal.h"
 #include "analyze/analyze.h"
+#include "execution/procedure_manager.h"
 
 #define SOCK_PORT 8765
-#define MAX_CONN_LIMIT 8
 
-static bool should_exit = false;
+static volatile sig_atomic_t should_exit = false;
+static int server_port = SOCK_PORT;         // 接受客户端连接的端口
+static int replication_port = 0;            // 主库接受副本连接的复制端口，为0时不开启复制
+static int primary_port = 0;                // 只读副本连接的主库的复制端口，为0时不是副本
 
 // 构建全局所需的管理器对象
 auto disk_manager = std::make_unique<DiskManager>();
@@ -39,20 +53,31 @@ auto lock_manager = std::make_unique<LockManager>();
 auto txn_manager = std::make_unique<TransactionManager>(lock_manager.get(), sm_manager.get());
 auto planner = std::make_unique<Planner>(sm_manager.get());
 auto optimizer = std::make_unique<Optimizer>(sm_manager.get(), planner.get());
-auto ql_manager = std::make_unique<QlManager>(sm_manager.get(), txn_manager.get(), nullptr);
+auto ql_manager = std::make_unique<QlManager>(sm_manager.get(), txn_manager.get(), planner.get());
 auto log_manager = std::make_unique<LogManager>(disk_manager.get());
-auto recovery = std::make_unique<RecoveryManager>(disk_manager.get(), buffer_pool_manager.get(), sm_manager.get());
-auto portal = std::make_unique<Portal>(sm_manager.get());
+auto recovery = std::make_unique<RecoveryManager>(disk_manager.get(), buffer_pool_manager.get(), sm_manager.get(),
+                                                  log_manager.get());
+auto checkpoint_manager = std::make_unique<CheckpointManager>(disk_manager.get(), buffer_pool_manager.get(),
+                                                              log_manager.get(), txn_manager.get());
+auto portal = std::make_unique<Portal>(sm_manager.get(), planner->get_feedback(), planner->get_sampler());
 auto analyze = std::make_unique<Analyze>(sm_manager.get());
+auto replication_sender = std::make_unique<ReplicationSender>(disk_manager.get(), log_manager.get());
+auto replica = std::make_unique<ReplicaApplier>(disk_manager.get(), buffer_pool_manager.get(), recovery.get());
+auto backup_manager = std::make_unique<BackupManager>(disk_manager.get(), buffer_pool_manager.get(), sm_manager.get(),
+                                                      log_manager.get(), checkpoint_manager.get());
+auto procedure_manager = std::make_unique<ProcedureManager>(analyze.get(), optimizer.get(), portal.get(), ql_manager.get());
 pthread_mutex_t *buffer_mutex;
 pthread_mutex_t *sockfd_mutex;
 
-static jmp_buf jmpbuf;
+static int exit_event_fd = -1;  // 收到SIGINT后唤醒事件循环
 void sigint_handler(int signo) {
     should_exit = true;
     log_manager->flush_log_to_disk();
     std::cout << "The Server receive Crtl+C, will been closed\n";
-    longjmp(jmpbuf, 1);
+    if (exit_event_fd != -1) {
+        uint64_t one = 1;
+        [[maybe_unused]] ssize_t ret = write(exit_event_fd, &one, sizeof(one));
+    }
 }
 
 // 判断当前正在执行的是显式事务还是单条SQL语句的事务，并更新事务ID
@@ -64,145 +89,533 @@ void SetTransaction(txn_id_t *txn_id, Context *context) {
         *txn_id = context->txn_->get_transaction_id();
         context->txn_->set_txn_mode(false);
     }
+    // 事务按提交时会话的设置决定是否等待提交日志持久化
+    context->txn_->set_synchronous_commit(context->session_->synchronous_commit_);
 }
 
-void *client_handler(void *sock_fd) {
-    int fd = *((int *)sock_fd);
-    pthread_mutex_unlock(sockfd_mutex);
+// 只读副本上只能执行查询和不修改数据的命令
+bool is_read_only(const std::shared_ptr<Plan> &plan) {
+    if (auto x = std::dynamic_pointer_cast<DMLPlan>(plan)) {
+        return x->tag == T_select;
+    }
+    // 存储过程的定义保存在本地，调用可能修改数据
+    return std::dynamic_pointer_cast<DDLPlan>(plan) == nullptr && std::dynamic_pointer_cast<ProcedurePlan>(plan) == nullptr;
+}
 
-    int i_recvBytes;
-    // 接收客户端发送的请求
-    char data_recv[BUFFER_LENGTH];
-    // 需要返回给客户端的结果
-    char *data_send = new char[BUFFER_LENGTH];
+/**
+ * @description: 回滚被中止的事务，并把abort信息返回给客户端、写入output.txt文件中
+ */
+void abort_transaction(TransactionAbortException &e, Context *context, txn_id_t *txn_id) {
+    std::string str = "abort\n";
+    memcpy(context->data_send_, str.c_str(), str.length());
+    context->data_send_[str.length()] = '\0';
+    *context->offset_ = str.length();
+
+    // 回滚事务
+    txn_manager->abort(context->txn_, log_manager.get());
+    context->txn_ = nullptr;
+    *txn_id = INVALID_TXN_ID;
+    std::cout << e.GetInfo() << std::endl;
+
+    std::fstream outfile;
+    outfile.open("output.txt", std::ios::out | std::ios::app);
+    outfile << str;
+    outfile.close();
+}
+
+/* 客户端使用的协议，由连接上收到的第一个字节决定 */
+enum class Protocol { UNKNOWN, LEGACY, FRAMED };
+
+/* 执行一条语句的结果 */
+enum class RequestResult { DONE, ABORTED, EXIT };
+
+/* 一个客户端连接的会话状态，与处理它的线程无关：会话可读或可写时由任意一个空闲的工作线程处理它 */
+struct Session {
+    int fd;
+    int id;                                // 会话ID，cancel语句通过它指定会话
+    txn_id_t txn_id = INVALID_TXN_ID;      // 客户端当前正在执行的事务ID
+    SessionVars vars;                      // 当前连接的会话设置
+    Protocol protocol = Protocol::UNKNOWN;  // 连接使用的协议
+    std::string recv_buf;                  // 已经收到、还没有处理的数据
+    std::string send_buf;                  // 已经产生、还没有发送给客户端的结果
+    std::atomic<bool> cancel{false};       // 其他会话请求取消正在执行的语句，执行器定期检查
+    std::atomic<int64_t> statement_start{0};  // 正在执行的语句开始的时间（steady_clock的微秒数），空闲时为0
+};
+
+static int epoll_fd = -1;                       // 监听端口和所有客户端连接的epoll实例
+static std::mutex session_latch;                // 保护sessions
+static std::unordered_set<Session *> sessions;  // 所有打开的会话
+static int next_session_id = 1;                 // 下一个会话的ID，只由事件循环线程分配
+static std::mutex work_latch;                   // 保护work_queue、workers_running和线程计数
+static std::condition_variable work_cv;
+static std::condition_variable workers_exit_cv; // 工作线程全部退出时通知
+static std::deque<Session *> work_queue;        // 已经可读、等待工作线程处理的会话
+static bool workers_running = false;
+static int num_workers = 0;                     // 工作线程的数量
+static int blocked_workers = 0;                 // 阻塞等待锁的工作线程数量
+
+/**
+ * @description: 尽量发送会话积压的结果，连接是非阻塞的，发送缓冲区满时把剩下的部分留在send_buf中，
+ * 由工作线程注册EPOLLOUT，连接可写时再继续发送，不在这里等待
+ * @return {bool} 返回false表示连接已经断开
+ * @param {Session*} session 要发送结果的会话
+ */
+bool send_pending(Session *session) {
+    size_t sent = 0;
+    while (sent < session->send_buf.size()) {
+        ssize_t ret = send(session->fd, session->send_buf.data() + sent, session->send_buf.size() - sent, MSG_NOSIGNAL);
+        if (ret > 0) {
+            sent += ret;
+        } else if (ret < 0 && errno == EINTR) {
+            continue;
+        } else if (ret < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        } else {
+            return false;
+        }
+    }
+    session->send_buf.erase(0, sent);
+    return true;
+}
+
+/**
+ * @description: 执行会话的一条语句，把以'\0'结尾的结果追加到reply
+ * @return {RequestResult} 语句执行完成、所在的事务被中止，或者客户端退出
+ * @param {Session*} session 会话
+ * @param {string&} request 语句，不包括结尾的'\0'
+ * @param {char*} data_send 工作线程的结果缓冲区，长度为BUFFER_LENGTH
+ * @param {string&} reply 需要返回给客户端的数据
+ */
+RequestResult execute_request(Session *session, const std::string &request, char *data_send, std::string &reply) {
+    int fd = session->fd;
+    txn_id_t &txn_id = session->txn_id;
     // 需要返回给客户端的结果的长度
     int offset = 0;
-    // 记录客户端当前正在执行的事务ID
-    txn_id_t txn_id = INVALID_TXN_ID;
+    bool aborted = false;
 
-    std::string output = "establish client connection, sockfd: " + std::to_string(fd) + "\n";
-    std::cout << output;
+    if (request == "exit") {
+        std::cout << "Client exit." << std::endl;
+        return RequestResult::EXIT;
+    }
+    if (request == "crash") {
+        std::cout << "Server crash" << std::endl;
+        exit(1);
+    }
 
-    while (true) {
-        std::cout << "Waiting for request..." << std::endl;
-        memset(data_recv, 0, BUFFER_LENGTH);
+    std::cout << "Read from client " << fd << ": " << request << std::endl;
+
+    memset(data_send, '\0', BUFFER_LENGTH);
+
+    // 开启事务，初始化系统所需的上下文信息（包括事务对象指针、锁管理器指针、日志管理器指针、存放结果的buffer、记录结果长度的变量）
+    Context *context = new Context(lock_manager.get(), log_manager.get(), nullptr, data_send, &offset);
+    context->txn_mgr_ = txn_manager.get();
+    context->session_ = &session->vars;
+    // 开始执行之前到达的取消请求不影响这条语句；超时从语句开始执行时计算
+    session->cancel = false;
+    auto start_time = std::chrono::steady_clock::now();
+    session->statement_start =
+        std::chrono::duration_cast<std::chrono::microseconds>(start_time.time_since_epoch()).count();
+    context->cancel_ = &session->cancel;
+    if (session->vars.statement_timeout_ > 0) {
+        context->deadline_ = start_time + std::chrono::milliseconds(session->vars.statement_timeout_);
+    }
+    // 只读副本上语句执行期间持有重放锁的读锁，读到的是两批日志之间的状态
+    std::shared_lock<std::shared_mutex> apply_lock;
+    if (primary_port != 0) {
+        apply_lock = std::shared_lock<std::shared_mutex>(replica->get_apply_latch());
+    }
+    // 语句执行期间进入纪元，期间访问到的事务对象（包括其他事务的撤销日志）不会被垃圾回收释放
+    txn_manager->get_epoch_manager()->enter();
+    SetTransaction(&txn_id, context);
+
+    // 用于判断是否已经调用了yy_delete_buffer来删除buf
+    bool finish_analyze = false;
+    pthread_mutex_lock(buffer_mutex);
+    YY_BUFFER_STATE buf = yy_scan_string(request.c_str());
+    if (yyparse() == 0) {
+        if (ast::parse_tree != nullptr) {
+            // 保存存储过程的原文，打开数据库时重新解析
+            if (auto x = std::dynamic_pointer_cast<ast::CreateProcedure>(ast::parse_tree)) {
+                x->source = request;
+            }
+            try {
+                // analyze and rewrite
+                std::shared_ptr<Query> query = analyze->do_analyze(ast::parse_tree);
+                yy_delete_buffer(buf);
+                finish_analyze = true;
+                pthread_mutex_unlock(buffer_mutex);
+                // 优化器
+                std::shared_ptr<Plan> plan = optimizer->plan_query(query, context);
+                if (primary_port != 0 && !is_read_only(plan)) {
+                    throw ReadOnlyReplicaError();
+                }
+                // portal
+                std::shared_ptr<PortalStmt> portalStmt = portal->start(plan, context);
+                portal->run(portalStmt, ql_manager.get(), &txn_id, context);
+                portal->drop(portalStmt);
+            } catch (TransactionAbortException &e) {
+                // 事务需要回滚，需要把abort信息返回给客户端并写入output.txt文件中
+                abort_transaction(e, context, &txn_id);
+                aborted = true;
+            } catch (RMDBError &e) {
+                // 遇到异常，需要打印failure到output.txt文件中，并发异常信息返回给客户端
+                std::cerr << e.what() << std::endl;
+
+                memcpy(data_send, e.what(), e.get_msg_len());
+                data_send[e.get_msg_len()] = '\n';
+                data_send[e.get_msg_len() + 1] = '\0';
+                offset = e.get_msg_len() + 1;
+
+                // 将报错信息写入output.txt
+                std::fstream outfile;
+                outfile.open("output.txt",std::ios::out | std::ios::app);
+                outfile << "failure\n";
+                outfile.close();
+            }
+        }
+    }
+    if(finish_analyze == false) {
+        yy_delete_buffer(buf);
+        pthread_mutex_unlock(buffer_mutex);
+    }
+    // 如果是单挑语句，需要按照一个完整的事务来执行，所以执行完当前语句后，自动提交事务
+    // 显式提交或回滚后context->txn_被置空，事务对象可能已被垃圾回收释放
+    // OCC下提交时可能验证失败，需要在返回结果之前提交
+    if(context->txn_ != nullptr && context->txn_->get_txn_mode() == false)
+    {
+        try {
+            txn_manager->commit(context->txn_, context->log_mgr_);
+        } catch (TransactionAbortException &e) {
+            abort_transaction(e, context, &txn_id);
+            aborted = true;
+        }
+        txn_id = INVALID_TXN_ID;
+    }
+    if (apply_lock.owns_lock()) {
+        apply_lock.unlock();
+    }
+    txn_manager->get_epoch_manager()->exit();
+    delete context;
+    session->statement_start = 0;
+    // future TODO: 格式化 sql_handler.result, 传给客户端
+    // send result with fixed format, use protobuf in the future
+    reply.append(data_send, offset);
+    reply.push_back('\0');
+    return aborted ? RequestResult::ABORTED : RequestResult::DONE;
+}
 
-        i_recvBytes = read(fd, data_recv, BUFFER_LENGTH);
+/**
+ * @description: 旧协议：每条语句以'\0'结尾，客户端可以不等结果连续发送多条语句
+ * @return {bool} 是否继续处理这个会话，客户端退出时返回false
+ * @param {Session*} session 会话
+ * @param {char*} data_send 工作线程的结果缓冲区
+ * @param {string&} reply 需要返回给客户端的数据
+ */
+bool process_statements(Session *session, char *data_send, std::string &reply) {
+    std::string &buf = session->recv_buf;
+    size_t pos = 0, end;
+    bool keep = true;
+    while (keep && (end = buf.find('\0', pos)) != std::string::npos) {
+        keep = execute_request(session, buf.substr(pos, end - pos), data_send, reply) != RequestResult::EXIT;
+        pos = end + 1;
+    }
+    buf.erase(0, pos);
+    if (buf.size() > static_cast<size_t>(SERVER_MAX_REQUEST_LENGTH)) {
+        std::cout << "Request from client " << session->fd << " is too long" << std::endl;
+        return false;
+    }
+    return keep;
+}
 
-        if (i_recvBytes == 0) {
-            std::cout << "Maybe the client has closed" << std::endl;
+/**
+ * @description: 分帧协议：每一帧是4字节大端序的长度和一批以'\0'分隔的语句，客户端可以不等结果连续发送多帧。
+ * 每一帧返回一帧结果，依次是各条语句以'\0'结尾的结果。一批语句中有事务被中止时，不再执行后面的语句，
+ * 它们的结果都是abort，避免显式事务中被中止之后的语句作为单条语句的事务提交
+ * @return {bool} 是否继续处理这个会话，客户端退出时返回false
+ * @param {Session*} session 会话
+ * @param {char*} data_send 工作线程的结果缓冲区
+ * @param {string&} reply 需要返回给客户端的数据
+ */
+bool process_frames(Session *session, char *data_send, std::string &reply) {
+    std::string &buf = session->recv_buf;
+    size_t pos = 0;
+    bool keep = true;
+    while (keep && buf.size() - pos >= FRAME_HEADER_SIZE) {
+        uint32_t len;
+        memcpy(&len, buf.data() + pos, FRAME_HEADER_SIZE);
+        len = ntohl(len);
+        if (len > static_cast<uint32_t>(SERVER_MAX_REQUEST_LENGTH)) {
+            std::cout << "Frame from client " << session->fd << " is too long" << std::endl;
+            return false;
+        }
+        if (buf.size() - pos - FRAME_HEADER_SIZE < len) {
             break;
         }
-        if (i_recvBytes == -1) {
+        std::string batch = buf.substr(pos + FRAME_HEADER_SIZE, len);
+        pos += FRAME_HEADER_SIZE + len;
+
+        // 先占住帧头的位置，执行完这一批语句后再填入结果的长度
+        size_t header = reply.size();
+        reply.append(FRAME_HEADER_SIZE, '\0');
+        bool aborted = false;
+        size_t begin = 0;
+        while (begin < batch.size()) {
+            size_t end = std::min(batch.find('\0', begin), batch.size());
+            if (aborted) {
+                reply.append("abort\n");
+                reply.push_back('\0');
+            } else {
+                RequestResult result = execute_request(session, batch.substr(begin, end - begin), data_send, reply);
+                aborted = result == RequestResult::ABORTED;
+                if (result == RequestResult::EXIT) {
+                    keep = false;
+                    break;
+                }
+            }
+            begin = end + 1;
+        }
+        uint32_t reply_len = htonl(static_cast<uint32_t>(reply.size() - header - FRAME_HEADER_SIZE));
+        memcpy(&reply[header], &reply_len, FRAME_HEADER_SIZE);
+    }
+    buf.erase(0, pos);
+    return keep;
+}
+
+/**
+ * @description: 读出会话上所有已经到达的数据，依次执行其中完整的请求，所有结果一次发送。
+ * 上一次的结果还没有发送完时先发送它，发送不完就不读取新的请求，客户端不读结果时请求留在内核缓冲区中
+ * @return {bool} 是否继续处理这个会话，客户端退出或连接断开时返回false
+ * @param {Session*} session 可读或可写的会话
+ * @param {char*} data_send 工作线程的结果缓冲区
+ */
+bool process_session(Session *session, char *data_send) {
+    if (!send_pending(session)) {
+        return false;
+    }
+    if (!session->send_buf.empty()) {
+        return true;
+    }
+    bool open = true;
+    char data_recv[BUFFER_LENGTH];
+    while (true) {
+        ssize_t i_recvBytes = read(session->fd, data_recv, BUFFER_LENGTH);
+        if (i_recvBytes > 0) {
+            session->recv_buf.append(data_recv, i_recvBytes);
+        } else if (i_recvBytes == 0) {
+            std::cout << "Maybe the client has closed" << std::endl;
+            open = false;
+            break;
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            break;
+        } else if (errno != EINTR) {
             std::cout << "Client read error!" << std::endl;
+            open = false;
             break;
         }
-        
-        printf("i_recvBytes: %d \n ", i_recvBytes);
+    }
+    // 分帧协议的连接以FRAME_PROTOCOL_MAGIC开始，SQL语句不会以它的第一个字节开始
+    if (session->protocol == Protocol::UNKNOWN && !session->recv_buf.empty()) {
+        if (session->recv_buf[0] != FRAME_PROTOCOL_MAGIC[0]) {
+            session->protocol = Protocol::LEGACY;
+        } else if (session->recv_buf.size() >= sizeof(FRAME_PROTOCOL_MAGIC) - 1) {
+            if (session->recv_buf.compare(0, sizeof(FRAME_PROTOCOL_MAGIC) - 1, FRAME_PROTOCOL_MAGIC) != 0) {
+                std::cout << "Unknown protocol from client " << session->fd << std::endl;
+                return false;
+            }
+            session->protocol = Protocol::FRAMED;
+            session->recv_buf.erase(0, sizeof(FRAME_PROTOCOL_MAGIC) - 1);
+        }
+    }
+    bool keep = true;
+    if (session->protocol == Protocol::LEGACY) {
+        keep = process_statements(session, data_send, session->send_buf);
+    } else if (session->protocol == Protocol::FRAMED) {
+        keep = process_frames(session, data_send, session->send_buf);
+    }
+    if (!send_pending(session)) {
+        return false;
+    }
+    // 客户端关闭写端之后仍然把积压的结果发送完，发送完之后再次读到连接关闭
+    return keep && (open || !session->send_buf.empty());
+}
 
-        if (strcmp(data_recv, "exit") == 0) {
-            std::cout << "Client exit." << std::endl;
-            break;
+/**
+ * @description: 关闭会话，回滚客户端断开时还没有结束的显式事务，释放它持有的锁
+ * @param {Session*} session 要关闭的会话
+ */
+void close_session(Session *session) {
+    if (session->txn_id != INVALID_TXN_ID) {
+        txn_manager->get_epoch_manager()->enter();
+        Transaction *txn = txn_manager->get_transaction(session->txn_id);
+        if (txn != nullptr && txn->get_state() != TransactionState::COMMITTED &&
+            txn->get_state() != TransactionState::ABORTED) {
+            txn_manager->abort(txn, log_manager.get());
         }
-        if (strcmp(data_recv, "crash") == 0) {
-            std::cout << "Server crash" << std::endl;
-            exit(1);
+        txn_manager->get_epoch_manager()->exit();
+    }
+    std::cout << "Terminating current client_connection..." << std::endl;
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, session->fd, nullptr);
+    close(session->fd);  // close a file descriptor.
+    {
+        std::scoped_lock lock{session_latch};
+        sessions.erase(session);
+    }
+    delete session;
+}
+
+/**
+ * @description: 所有会话的状态，按会话ID排序，正在执行的语句显示已经执行的时间
+ * @return {vector} 每一项为会话ID和状态（空闲或者正在执行）
+ * @param {SessionVars*} current 执行show sessions的会话，在状态中标出
+ */
+std::vector<std::pair<std::string, std::string>> sessions_status(const SessionVars *current) {
+    int64_t now = std::chrono::duration_cast<std::chrono::microseconds>(
+                      std::chrono::steady_clock::now().time_since_epoch()).count();
+    std::map<int, std::pair<std::string, std::string>> status;
+    std::scoped_lock lock{session_latch};
+    for (auto session : sessions) {
+        int64_t start = session->statement_start;
+        std::string name = std::to_string(session->id);
+        if (&session->vars == current) {
+            name += " (current)";
         }
+        status[session->id] = {name, start == 0 ? "idle" : "active " + std::to_string((now - start) / 1000) + "ms"};
+    }
+    std::vector<std::pair<std::string, std::string>> result;
+    for (auto &[id, item] : status) {
+        result.push_back(item);
+    }
+    return result;
+}
 
-        std::cout << "Read from client " << fd << ": " << data_recv << std::endl;
-
-        memset(data_send, '\0', BUFFER_LENGTH);
-        offset = 0;
-
-        // 开启事务，初始化系统所需的上下文信息（包括事务对象指针、锁管理器指针、日志管理器指针、存放结果的buffer、记录结果长度的变量）
-        Context *context = new Context(lock_manager.get(), log_manager.get(), nullptr, data_send, &offset);
-        SetTransaction(&txn_id, context);
-
-        // 用于判断是否已经调用了yy_delete_buffer来删除buf
-        bool finish_analyze = false;
-        pthread_mutex_lock(buffer_mutex);
-        YY_BUFFER_STATE buf = yy_scan_string(data_recv);
-        if (yyparse() == 0) {
-            if (ast::parse_tree != nullptr) {
-                try {
-                    // analyze and rewrite
-                    std::shared_ptr<Query> query = analyze->do_analyze(ast::parse_tree);
-                    yy_delete_buffer(buf);
-                    finish_analyze = true;
-                    pthread_mutex_unlock(buffer_mutex);
-                    // 优化器
-                    std::shared_ptr<Plan> plan = optimizer->plan_query(query, context);
-                    // portal
-                    std::shared_ptr<PortalStmt> portalStmt = portal->start(plan, context);
-                    portal->run(portalStmt, ql_manager.get(), &txn_id, context);
-                    portal->drop();
-                } catch (TransactionAbortException &e) {
-                    // 事务需要回滚，需要把abort信息返回给客户端并写入output.txt文件中
-                    std::string str = "abort\n";
-                    memcpy(data_send, str.c_str(), str.length());
-                    data_send[str.length()] = '\0';
-                    offset = str.length();
-
-                    // 回滚事务
-                    txn_manager->abort(context->txn_, log_manager.get());
-                    std::cout << e.GetInfo() << std::endl;
-
-                    std::fstream outfile;
-                    outfile.open("output.txt", std::ios::out | std::ios::app);
-                    outfile << str;
-                    outfile.close();
-                } catch (RMDBError &e) {
-                    // 遇到异常，需要打印failure到output.txt文件中，并发异常信息返回给客户端
-                    std::cerr << e.what() << std::endl;
-
-                    memcpy(data_send, e.what(), e.get_msg_len());
-                    data_send[e.get_msg_len()] = '\n';
-                    data_send[e.get_msg_len() + 1] = '\0';
-                    offset = e.get_msg_len() + 1;
-
-                    // 将报错信息写入output.txt
-                    std::fstream outfile;
-                    outfile.open("output.txt",std::ios::out | std::ios::app);
-                    outfile << "failure\n";
-                    outfile.close();
-                }
+/**
+ * @description: 取消会话正在执行的语句，语句的执行器在下一次检查时中止它所在的事务；会话空闲时没有影响
+ * @param {int} session_id 会话ID
+ */
+void cancel_session(int session_id) {
+    std::scoped_lock lock{session_latch};
+    for (auto session : sessions) {
+        if (session->id == session_id) {
+            if (session->statement_start != 0) {
+                session->cancel = true;
             }
+            return;
         }
-        if(finish_analyze == false) {
-            yy_delete_buffer(buf);
-            pthread_mutex_unlock(buffer_mutex);
+    }
+    throw SessionNotFoundError(session_id);
+}
+
+void worker_loop();
+
+/* 没有阻塞的工作线程多于SERVER_WORKER_THREADS，调用者持有work_latch */
+bool surplus_workers() { return num_workers - blocked_workers > SERVER_WORKER_THREADS; }
+
+/* 启动一个工作线程，调用者持有work_latch；新线程继承调用者屏蔽SIGINT的信号掩码 */
+void spawn_worker() {
+    num_workers++;
+    std::thread(worker_loop).detach();
+}
+
+/**
+ * @description: 工作线程阻塞等待锁之前调用，没有阻塞的工作线程不足SERVER_WORKER_THREADS时补充一个，
+ * 持有锁的事务的提交和其他会话的请求不会因为线程池被等待者占满而无法执行
+ */
+void begin_lock_wait() {
+    std::scoped_lock lock{work_latch};
+    blocked_workers++;
+    if (workers_running && num_workers - blocked_workers < SERVER_WORKER_THREADS) {
+        spawn_worker();
+    }
+}
+
+/* 工作线程结束锁等待后调用，多出的空闲线程在处理完当前请求后退出 */
+void end_lock_wait() {
+    std::scoped_lock lock{work_latch};
+    blocked_workers--;
+    if (surplus_workers()) {
+        work_cv.notify_one();
+    }
+}
+
+/**
+ * @description: 工作线程，依次处理可读的会话。会话以EPOLLONESHOT注册，同一时刻只有一个工作线程处理它，
+ * 处理完之后重新注册，结果没有发送完的会话等待可写，空闲的会话和不读取结果的会话都不占用线程
+ */
+void worker_loop() {
+    std::unique_ptr<char[]> data_send(new char[BUFFER_LENGTH]);
+    while (true) {
+        Session *session;
+        {
+            std::unique_lock<std::mutex> lock(work_latch);
+            work_cv.wait(lock, [] { return !work_queue.empty() || !workers_running || surplus_workers(); });
+            if (!workers_running || surplus_workers()) {
+                num_workers--;
+                workers_exit_cv.notify_all();
+                break;
+            }
+            session = work_queue.front();
+            work_queue.pop_front();
         }
-        // future TODO: 格式化 sql_handler.result, 传给客户端
-        // send result with fixed format, use protobuf in the future
-        if (write(fd, data_send, offset + 1) == -1) {
-            break;
+        if (!process_session(session, data_send.get())) {
+            close_session(session);
+            continue;
+        }
+        epoll_event event{};
+        event.events = session->send_buf.empty() ? EPOLLIN | EPOLLRDHUP | EPOLLONESHOT : EPOLLOUT | EPOLLONESHOT;
+        event.data.ptr = session;
+        epoll_ctl(epoll_fd, EPOLL_CTL_MOD, session->fd, &event);
+    }
+}
+
+/**
+ * @description: 接受所有等待中的连接，为每个连接创建会话并注册到epoll
+ * @param {int} sockfd_server 监听的套接字
+ */
+void accept_connections(int sockfd_server) {
+    while (true) {
+        int sockfd = accept4(sockfd_server, nullptr, nullptr, SOCK_NONBLOCK);
+        if (sockfd == -1) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                std::cout << "Accept error!" << std::endl;
+            }
+            if (errno == EINTR) {
+                continue;
+            }
+            return;
         }
-        // 如果是单挑语句，需要按照一个完整的事务来执行，所以执行完当前语句后，自动提交事务
-        if(context->txn_->get_txn_mode() == false)
+        auto session = new Session{sockfd, next_session_id++};
         {
-            txn_manager->commit(context->txn_, context->log_mgr_);
+            std::scoped_lock lock{session_latch};
+            sessions.insert(session);
+        }
+        std::cout << "establish client connection, sockfd: " + std::to_string(sockfd) + "\n";
+        epoll_event event{};
+        event.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+        event.data.ptr = session;
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, sockfd, &event) == -1) {
+            close_session(session);
         }
     }
-
-    // Clear
-    std::cout << "Terminating current client_connection..." << std::endl;
-    close(fd);           // close a file descriptor.
-    pthread_exit(NULL);  // terminate calling thread!
 }
 
 void start_server() {
     // init mutex
     buffer_mutex = (pthread_mutex_t *)malloc(sizeof(pthread_mutex_t));
-    sockfd_mutex = (pthread_mutex_t *)malloc(sizeof(pthread_mutex_t));
     pthread_mutex_init(buffer_mutex, nullptr);
-    pthread_mutex_init(sockfd_mutex, nullptr);
+
+    // 每个连接占用一个文件描述符，把软限制提高到硬限制
+    rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
 
     int sockfd_server;
     int fd_temp;
     struct sockaddr_in s_addr_in {};
 
     // 初始化连接
-    sockfd_server = socket(AF_INET, SOCK_STREAM, 0);  // ipv4,TCP
+    sockfd_server = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);  // ipv4,TCP
     assert(sockfd_server != -1);
     int val = 1;
     setsockopt(sockfd_server, SOL_SOCKET, SO_REUSEADDR, &val, sizeof(val));
@@ -211,60 +624,180 @@ void start_server() {
     memset(&s_addr_in, 0, sizeof(s_addr_in));
     s_addr_in.sin_family = AF_INET;
     s_addr_in.sin_addr.s_addr = htonl(INADDR_ANY);
-    s_addr_in.sin_port = htons(SOCK_PORT);
+    s_addr_in.sin_port = htons(server_port);
     fd_temp = bind(sockfd_server, (struct sockaddr *)(&s_addr_in), sizeof(s_addr_in));
     if (fd_temp == -1) {
         std::cout << "Bind error!" << std::endl;
         exit(1);
     }
 
-    fd_temp = listen(sockfd_server, MAX_CONN_LIMIT);
+    fd_temp = listen(sockfd_server, SOMAXCONN);
     if (fd_temp == -1) {
         std::cout << "Listen error!" << std::endl;
         exit(1);
     }
 
-    while (!should_exit) {
-        std::cout << "Waiting for new connection..." << std::endl;
-        pthread_t thread_id;
-        struct sockaddr_in s_addr_client {};
-        int client_length = sizeof(s_addr_client);
-
-        if (setjmp(jmpbuf)) {
-            std::cout << "Break from Server Listen Loop\n";
-            break;
+    // 监听端口和SIGINT的通知以data.ptr为nullptr和&exit_event_fd区分，其余为会话
+    epoll_fd = epoll_create1(0);
+    exit_event_fd = eventfd(0, EFD_NONBLOCK);
+    assert(epoll_fd != -1 && exit_event_fd != -1);
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.ptr = nullptr;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, sockfd_server, &event);
+    event.data.ptr = &exit_event_fd;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, exit_event_fd, &event);
+
+    // SERVER_WORKER_THREADS个工作线程，阻塞等待锁的线程由新线程补充；屏蔽SIGINT，信号只由事件循环所在的主线程处理
+    lock_manager->set_wait_hooks(begin_lock_wait, end_lock_wait);
+    sigset_t sigint_set, old_set;
+    sigemptyset(&sigint_set);
+    sigaddset(&sigint_set, SIGINT);
+    pthread_sigmask(SIG_BLOCK, &sigint_set, &old_set);
+    {
+        std::scoped_lock lock{work_latch};
+        workers_running = true;
+        for (int i = 0; i < SERVER_WORKER_THREADS; i++) {
+            spawn_worker();
         }
+    }
+    pthread_sigmask(SIG_SETMASK, &old_set, nullptr);
 
-        // Block here. Until server accepts a new connection.
-        pthread_mutex_lock(sockfd_mutex);
-        int sockfd = accept(sockfd_server, (struct sockaddr *)(&s_addr_client), (socklen_t *)(&client_length));
-        if (sockfd == -1) {
-            std::cout << "Accept error!" << std::endl;
-            continue;  // ignore current socket ,continue while loop.
+    std::cout << "Waiting for new connection..." << std::endl;
+    epoll_event events[SERVER_MAX_EVENTS];
+    while (!should_exit) {
+        int num_events = epoll_wait(epoll_fd, events, SERVER_MAX_EVENTS, -1);
+        if (num_events == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::cout << "Epoll error!" << std::endl;
+            break;
         }
-        
-        // 和客户端建立连接，并开启一个线程负责处理客户端请求
-        if (pthread_create(&thread_id, nullptr, &client_handler, (void *)(&sockfd)) != 0) {
-            std::cout << "Create thread fail!" << std::endl;
-            break;  // break while loop
+        for (int i = 0; i < num_events; i++) {
+            if (events[i].data.ptr == nullptr) {
+                accept_connections(sockfd_server);
+            } else if (events[i].data.ptr == &exit_event_fd) {
+                std::cout << "Break from Server Listen Loop\n";
+                should_exit = true;
+            } else {
+                // 可读或者对端关闭的会话交给工作线程，读到0字节时关闭
+                std::scoped_lock lock{work_latch};
+                work_queue.push_back(static_cast<Session *>(events[i].data.ptr));
+                work_cv.notify_one();
+            }
         }
-
     }
 
     // Clear
     std::cout << " Try to close all client-connection.\n";
+    {
+        std::unique_lock<std::mutex> lock(work_latch);
+        workers_running = false;
+        work_queue.clear();
+        work_cv.notify_all();
+        workers_exit_cv.wait(lock, [] { return num_workers == 0; });
+    }
+    for (Session *session : sessions) {
+        close(session->fd);
+        delete session;
+    }
+    sessions.clear();
     int ret = shutdown(sockfd_server, SHUT_WR);  // shut down the all or part of a full-duplex connection.
     if(ret == -1) { printf("%s\n", strerror(errno)); }
 //    assert(ret != -1);
+    close(sockfd_server);
+    close(epoll_fd);
+    close(exit_event_fd);
+
+    txn_manager->StopGarbageCollector();
+    lock_manager->stop_deadlock_detection();
+    replica->stop();
+    replication_sender->stop();
+    // 关闭前做一次写回所有脏页的检查点，下次启动时不需要重做
+    checkpoint_manager->stop();
+    if (enable_logging) {
+        checkpoint_manager->checkpoint(true);
+    }
+    if (primary_port != 0) {
+        replica->checkpoint();
+    }
+    log_manager->stop_flusher();
     sm_manager->close_db();
     std::cout << " DB has been closed.\n";
     std::cout << "Server shuts down." << std::endl;
 }
 
+// 解析--name=N形式的整数选项，N的范围是[1, max_value]，不是该选项时返回false
+bool parse_int_option(const std::string &option, const std::string &name, long max_value, int &value) {
+    std::string prefix = "--" + name + "=";
+    if (option.compare(0, prefix.size(), prefix) != 0) {
+        return false;
+    }
+    std::string str = option.substr(prefix.size());
+    char *end = nullptr;
+    long parsed = strtol(str.c_str(), &end, 10);
+    if (str.empty() || *end != '\0' || parsed <= 0 || parsed > max_value) {
+        std::cerr << "Invalid value: " << option << std::endl;
+        exit(1);
+    }
+    value = static_cast<int>(parsed);
+    return true;
+}
+
 int main(int argc, char **argv) {
-    if (argc != 2) {
-        // 需要指定数据库名称
-        std::cerr << "Usage: " << argv[0] << " <database>" << std::endl;
+    if (argc < 2) {
+        // 需要指定数据库名称，可选指定并发控制算法（默认两阶段封锁）和两阶段封锁下的死锁处理策略（默认no-wait），
+        // 客户端端口，主库的复制端口，或者作为只读副本连接的主库的复制端口；--unlogged关闭预写日志；
+        // --redo-threads指定故障恢复时的重做线程数（默认为CPU核数）
+        std::cerr << "Usage: " << argv[0]
+                  << " <database> [2pl|mvcc|occ] [no_wait|wait_die|detect] [--port=N] [--replication-port=N]"
+                     " [--replica-of=N] [--unlogged] [--redo-threads=N]"
+                  << std::endl;
+        exit(1);
+    }
+    for (int i = 2; i < argc; i++) {
+        std::string option = argv[i];
+        int redo_threads = 0;
+        if (parse_int_option(option, "port", 65535, server_port) ||
+            parse_int_option(option, "replication-port", 65535, replication_port) ||
+            parse_int_option(option, "replica-of", 65535, primary_port)) {
+            continue;
+        }
+        if (parse_int_option(option, "redo-threads", REDO_MAX_THREADS, redo_threads)) {
+            recovery->set_redo_threads(redo_threads);
+            continue;
+        }
+        if (option == "mvcc") {
+            txn_manager->set_concurrency_mode(ConcurrencyMode::MVCC);
+        } else if (option == "occ") {
+            txn_manager->set_concurrency_mode(ConcurrencyMode::OCC);
+        } else if (option == "wait_die") {
+            lock_manager->set_deadlock_policy(DeadlockPolicy::WAIT_DIE);
+        } else if (option == "detect") {
+            lock_manager->set_deadlock_policy(DeadlockPolicy::DETECTION);
+        } else if (option == "--unlogged") {
+            enable_logging = false;
+        } else if (option != "2pl" && option != "no_wait") {
+            std::cerr << "Unknown option: " << option << std::endl;
+            exit(1);
+        }
+    }
+    // MVCC和OCC的修改不写日志，故障后会丢失已经提交的事务，只有显式关闭日志时才能使用
+    if (txn_manager->get_concurrency_mode() != ConcurrencyMode::TWO_PHASE_LOCKING && enable_logging) {
+        std::cerr << "mvcc and occ do not write the log, so committed transactions are lost in a crash; "
+                     "start with --unlogged to run without durability"
+                  << std::endl;
+        exit(1);
+    }
+    if (!enable_logging && replication_port != 0) {
+        std::cerr << "Replication ships the log and cannot be used with --unlogged" << std::endl;
+        exit(1);
+    }
+    // 只有两阶段封锁下的修改写日志，副本也不能再向其他副本发送日志
+    if (primary_port != 0 &&
+        (txn_manager->get_concurrency_mode() != ConcurrencyMode::TWO_PHASE_LOCKING || replication_port != 0)) {
+        std::cerr << "A replica only supports 2pl and cannot accept replicas itself" << std::endl;
         exit(1);
     }
 
@@ -290,10 +823,83 @@ int main(int argc, char **argv) {
         // Open database
         sm_manager->open_db(db_name);
 
-        // recovery database
-        recovery->analyze();
-        recovery->redo();
-        recovery->undo();
+        if (primary_port != 0) {
+            // 只读副本自己不写日志，本地的日志都来自主库；重启时重做本地的日志，未完成的事务不回滚，
+            // 而是由副本隐藏它们的修改，之后从本地日志的末尾继续接收
+            enable_logging = false;
+            planner->set_enable_index_scan(false);
+            recovery->analyze();
+            recovery->redo();
+            replica->init();
+            ql_manager->set_replication_status([] { return replica->get_status(); });
+        } else {
+            // 数据页写回磁盘之前，先把日志持久化到页面的LSN
+            if (enable_logging) {
+                buffer_pool_manager->set_log_flusher([](lsn_t lsn) { log_manager->wait_for_flush(lsn); },
+                                                     [] { return log_manager->get_persist_lsn(); });
+            }
+
+            // recovery database
+            recovery->analyze();
+            recovery->redo();
+            recovery->undo();
+            if (recovery->get_max_txn_id() != INVALID_TXN_ID) {
+                txn_manager->set_next_txn_id(recovery->get_max_txn_id() + 1);
+            }
+            auto &stats = recovery->get_stats();
+            std::cout << "Recovery: log [" << recovery->get_log_start_lsn() << ", " << recovery->get_log_end_lsn()
+                      << "), redo " << stats.redo_records << " records on " << stats.redo_pages << " pages with "
+                      << stats.redo_threads << " threads, rolled back " << stats.undo_txns << " transactions"
+                      << std::endl;
+        }
+
+        // 加载保存的存储过程，此时还没有开始接受连接，可以直接使用解析器
+        ql_manager->set_procedure_manager(procedure_manager.get());
+        ql_manager->set_session_admin(sessions_status, cancel_session);
+        procedure_manager->load([](const std::string &source) {
+            std::shared_ptr<ast::TreeNode> tree;
+            YY_BUFFER_STATE buf = yy_scan_string(source.c_str());
+            if (yyparse() == 0) {
+                tree = ast::parse_tree;
+            }
+            yy_delete_buffer(buf);
+            return tree;
+        });
+
+        // 后台刷盘线程，为提交的事务组提交日志；恢复完成后先做一次检查点，再周期性地做检查点
+        // 开启复制时，已连接的副本重启需要的日志不会被检查点丢弃；正在进行的备份需要的日志同样保留
+        if (replication_port != 0) {
+            checkpoint_manager->add_log_retention([] { return replication_sender->get_retained_lsn(); });
+            ql_manager->set_replication_status([] { return replication_sender->get_status(); });
+        }
+        // 只有两阶段封锁下的修改写日志，备份依靠日志把模糊拷贝的页面恢复到一致
+        if (enable_logging && txn_manager->get_concurrency_mode() == ConcurrencyMode::TWO_PHASE_LOCKING) {
+            checkpoint_manager->add_log_retention([] { return backup_manager->get_retained_lsn(); });
+            ql_manager->set_backup([](const std::string &dir) { return backup_manager->backup(dir); });
+        }
+        if (enable_logging) {
+            log_manager->start_flusher();
+            checkpoint_manager->checkpoint();
+            checkpoint_manager->start();
+            // checkpoint语句写回所有脏页，此后恢复只需要从该检查点开始
+            ql_manager->set_checkpoint([]() -> std::vector<std::pair<std::string, std::string>> {
+                lsn_t log_start_lsn;
+                lsn_t checkpoint_lsn = checkpoint_manager->checkpoint(true, &log_start_lsn);
+                return {{"checkpoint_lsn", std::to_string(checkpoint_lsn)},
+                        {"log_start_lsn", std::to_string(log_start_lsn)}};
+            });
+        }
+        if (replication_port != 0) {
+            replication_sender->start(replication_port);
+        }
+        if (primary_port != 0) {
+            replica->start(primary_port);
+        }
+        // 后台回收旧版本和已结束的事务
+        txn_manager->StartGarbageCollector();
+        if (lock_manager->get_deadlock_policy() == DeadlockPolicy::DETECTION) {
+            lock_manager->start_deadlock_detection();
+        }
         
         // 开启服务端，开始接受客户端连接
         start_server();
@@ -47,8 +47,7 @@ void BufferPoolManager::update_page(Page *page, PageId new_page_id, frame_id_t n
     PageId old_page_id = page->get_page_id();
     if (old_page_id.page_no != INVALID_PAGE_ID) { // 检查旧page_id是否有效
         if (page->is_dirty()) {
-            disk_manager_->write_page(old_page_id.fd, old_page_id.page_no, page->get_data(), PAGE_SIZE);
-            page->is_dirty_ = false;
+            write_back(page);
         }
         // 从页表中移除旧页面的映射
         page_table_.erase(old_page_id);
@@ -87,25 +86,31 @@ Page* BufferPoolManager::fetch_page(PageId page_id) {
     // 3.     调用disk_manager_的read_page读取目标页到frame
     // 4.     固定目标页，更新pin_count_
     // 5.     返回目标页
-    std::scoped_lock lock{latch_};
-
-    // 1. 从page_table_中搜寻目标页
-    auto it = page_table_.find(page_id);
-    if (it != page_table_.end()) {
-        // 1.1 目标页在缓冲池中
-        frame_id_t frame_id = it->second;
-        Page* page = &pages_[frame_id];
-        page->pin_count_++;
-        // 如果页面之前是unpinned状态（pin_count从0变为1后大于0，或者之前就是大于0），
-        // 它可能在replacer中。现在它被pin了，应该从replacer中移除。
-        replacer_->pin(frame_id); // 确保它不在可替换列表中
-        return page;
-    }
+    std::unique_lock<std::mutex> lock{latch_};
 
-    // 1.2 目标页不在缓冲池中，需要从磁盘加载
     frame_id_t victim_frame_id;
-    if (!find_victim_page(&victim_frame_id)) {
-        return nullptr; // 没有可用的frame
+    while (true) {
+        // 1. 从page_table_中搜寻目标页
+        auto it = page_table_.find(page_id);
+        if (it != page_table_.end()) {
+            // 1.1 目标页在缓冲池中
+            frame_id_t frame_id = it->second;
+            Page* page = &pages_[frame_id];
+            page->pin_count_++;
+            // 如果页面之前是unpinned状态（pin_count从0变为1后大于0，或者之前就是大于0），
+            // 它可能在replacer中。现在它被pin了，应该从replacer中移除。
+            replacer_->pin(frame_id); // 确保它不在可替换列表中
+            return page;
+        }
+
+        // 1.2 目标页不在缓冲池中，需要从磁盘加载
+        if (!find_victim_page(&victim_frame_id)) {
+            return nullptr; // 没有可用的frame
+        }
+        // 等待淘汰页的日志刷盘时释放过latch_，目标页可能已经被其他线程调入，重新查找
+        if (force_victim_log(lock, victim_frame_id)) {
+            break;
+        }
     }
 
     Page* victim_page = &pages_[victim_frame_id];
@@ -130,6 +135,40 @@ Page* BufferPoolManager::fetch_page(PageId page_id) {
     return victim_page;
 }
 
+/**
+ * @description: 读取页面的一致副本，用于在线备份和采样，不把页面调入缓冲池，不会淘汰其他页面。
+ *              页面在缓冲池中时固定页面，在页面读锁内拷贝帧中的数据，不会读到修改了一半的页面；
+ *              否则持有latch_从磁盘读取，页面只在latch_内写回，不会读到写了一半的页面。
+ * @return {bool} 读取成功返回true，页面既不在缓冲池中也不在磁盘上时返回false
+ * @param {PageId} page_id 目标页的PageId
+ * @param {char*} buf 目标缓冲区，长度至少为PAGE_SIZE
+ * @param {int} num_bytes 页面不在缓冲池中时从磁盘读取的字节数，文件的最后一页可能不完整
+ */
+bool BufferPoolManager::copy_page(PageId page_id, char *buf, int num_bytes) {
+    Page* page;
+    {
+        std::scoped_lock lock{latch_};
+        auto it = page_table_.find(page_id);
+        if (it == page_table_.end()) {
+            try {
+                disk_manager_->read_page(page_id.fd, page_id.page_no, buf, num_bytes);
+            } catch (RMDBError &e) {
+                return false;
+            }
+            return true;
+        }
+        // 固定页面后释放latch_再加页面读锁，与flush_pages_before的加锁顺序一致
+        page = &pages_[it->second];
+        page->pin_count_++;
+        replacer_->pin(it->second);
+    }
+    page->RLatch();
+    memcpy(buf, page->get_data(), PAGE_SIZE);
+    page->RUnlatch();
+    unpin_page(page_id, false);
+    return true;
+}
+
 /**
  * @description: 取消固定pin_count>0的在缓冲池中的page
  * @return {bool} 如果目标页的pin_count<=0则返回false，否则返回true
@@ -195,24 +234,31 @@ bool BufferPoolManager::flush_page(PageId page_id) {
     // 2. 无论P是否为脏都将其写回磁盘。
     // 3. 更新P的is_dirty_
    
-    std::scoped_lock lock{latch_};
-
-    // 1. 查找页表,尝试获取目标页P
-    auto it = page_table_.find(page_id);
-    if (it == page_table_.end()) {
-        // 1.1 目标页P没有被page_table_记录 ，返回false
-        return false;
+    std::unique_lock<std::mutex> lock{latch_};
+
+    Page* page;
+    while (true) {
+        // 1. 查找页表,尝试获取目标页P
+        auto it = page_table_.find(page_id);
+        if (it == page_table_.end()) {
+            // 1.1 目标页P没有被page_table_记录 ，返回false
+            return false;
+        }
+        page = &pages_[it->second];
+        // 释放latch_等待日志刷盘，之后页面可能已经被淘汰，重新查找
+        lsn_t lsn = unflushed_lsn(page);
+        if (lsn == INVALID_LSN) {
+            break;
+        }
+        lock.unlock();
+        flush_log_(lsn);
+        lock.lock();
     }
 
-    frame_id_t frame_id = it->second;
-    Page* page = &pages_[frame_id];
-
     // 2. 无论P是否为脏都将其写回磁盘。
     //    实际上，如果不是脏的，写回是可选的优化，但题目说“无论...都将其写回”
-    disk_manager_->write_page(page->id_.fd, page->id_.page_no, page->get_data(), PAGE_SIZE);
-
     // 3. 更新P的is_dirty_
-    page->is_dirty_ = false; // 写回后不再是脏页
+    write_back(page);
 
     return true;
 }
@@ -228,13 +274,15 @@ Page* BufferPoolManager::new_page(PageId* page_id) {
     // 3.   将frame的数据写回磁盘
     // 4.   固定frame，更新pin_count_
     // 5.   返回获得的page
-    std::scoped_lock lock{latch_};
+    std::unique_lock<std::mutex> lock{latch_};
 
     // 1. 获得一个可用的frame
     frame_id_t victim_frame_id;
-    if (!find_victim_page(&victim_frame_id)) {
-        return nullptr; // 无法获得可用frame
-    }
+    do {
+        if (!find_victim_page(&victim_frame_id)) {
+            return nullptr; // 无法获得可用frame
+        }
+    } while (!force_victim_log(lock, victim_frame_id));
 
     Page* new_frame_page = &pages_[victim_frame_id];
 
@@ -273,27 +321,38 @@ bool BufferPoolManager::delete_page(PageId page_id) {
     // 2.   若目标页的pin_count不为0，则返回false
     // 3.   将目标页数据写回磁盘，从页表中删除目标页，重置其元数据，将其加入free_list_，返回true
     
-    std::scoped_lock lock{latch_};
-
-    // 1. 在page_table_中查找目标页
-    auto it = page_table_.find(page_id);
-    if (it == page_table_.end()) {
-        return true; // 若不存在返回true
-    }
+    std::unique_lock<std::mutex> lock{latch_};
+
+    frame_id_t frame_id;
+    Page* page;
+    while (true) {
+        // 1. 在page_table_中查找目标页
+        auto it = page_table_.find(page_id);
+        if (it == page_table_.end()) {
+            return true; // 若不存在返回true
+        }
 
-    frame_id_t frame_id = it->second;
-    Page* page = &pages_[frame_id];
+        frame_id = it->second;
+        page = &pages_[frame_id];
 
-    // 2. 若目标页的pin_count不为0，则返回false
-    if (page->pin_count_ > 0) {
-        return false;
+        // 2. 若目标页的pin_count不为0，则返回false
+        if (page->pin_count_ > 0) {
+            return false;
+        }
+        // 释放latch_等待日志刷盘，之后页面可能已经被固定或淘汰，重新检查
+        lsn_t lsn = unflushed_lsn(page);
+        if (lsn == INVALID_LSN) {
+            break;
+        }
+        lock.unlock();
+        flush_log_(lsn);
+        lock.lock();
     }
 
     // 3. 页面可以被删除
     // 3a. 将目标页数据写回磁盘 (如果脏)
     if (page->is_dirty()) {
-        disk_manager_->write_page(page->id_.fd, page->id_.page_no, page->get_data(), PAGE_SIZE);
-        page->is_dirty_ = false; // 写回后不再是脏页
+        write_back(page);
     }
 
     // 从页表中删除目标页
@@ -321,7 +380,23 @@ bool BufferPoolManager::delete_page(PageId page_id) {
  * @param {int} fd 文件句柄
  */
 void BufferPoolManager::flush_all_pages(int fd) {
-    std::scoped_lock lock{latch_};
+    std::unique_lock<std::mutex> lock{latch_};
+
+    // 先释放latch_把日志持久化到这些脏页中最大的页面LSN，等待期间页面可能被修改，重新检查
+    while (true) {
+        lsn_t lsn = INVALID_LSN;
+        for (auto const& [page_id, frame_id] : page_table_) {
+            if (page_id.fd == fd) {
+                lsn = std::max(lsn, unflushed_lsn(&pages_[frame_id]));
+            }
+        }
+        if (lsn == INVALID_LSN) {
+            break;
+        }
+        lock.unlock();
+        flush_log_(lsn);
+        lock.lock();
+    }
 
     for (auto const& [pageid_in_table, frameid_in_table] : page_table_) {
         if (pageid_in_table.fd == fd) {
@@ -330,9 +405,105 @@ void BufferPoolManager::flush_all_pages(int fd) {
             // flush_all_pages 通常意味着持久化所有更改。
             // 因此，只刷新脏页是合理的优化。如果要求所有页都刷新，则去掉if。
             if (page->is_dirty()) {
-                disk_manager_->write_page(page->id_.fd, page->id_.page_no, page->get_data(), PAGE_SIZE);
-                page->is_dirty_ = false; // 写回后不再是脏页
+                write_back(page);
             }
         }
     }
+}
+
+/**
+ * @description: 获取缓冲池的脏页表，只包含有recLSN、即被带日志的操作修改过的页面，用于检查点
+ * @return {vector<pair<PageId, lsn_t>>} 脏页及其recLSN
+ */
+std::vector<std::pair<PageId, lsn_t>> BufferPoolManager::get_dirty_pages() {
+    std::scoped_lock lock{latch_};
+    std::vector<std::pair<PageId, lsn_t>> dirty_pages;
+    for (auto const& [page_id, frame_id] : page_table_) {
+        lsn_t rec_lsn = pages_[frame_id].get_rec_lsn();
+        if (rec_lsn != INVALID_LSN) {
+            dirty_pages.emplace_back(page_id, rec_lsn);
+        }
+    }
+    return dirty_pages;
+}
+
+/**
+ * @description: 写回recLSN早于lsn的脏页，推进最小的recLSN，使检查点之前的日志可以被截断。
+ * 逐个页面固定后在页面读锁内写回，不阻塞其他页面的访问
+ * @return {size_t} 写回的页面数量
+ * @param {lsn_t} lsn 写回recLSN小于lsn的页面
+ */
+size_t BufferPoolManager::flush_pages_before(lsn_t lsn) {
+    std::vector<PageId> page_ids;
+    for (auto &[page_id, rec_lsn] : get_dirty_pages()) {
+        if (rec_lsn < lsn) {
+            page_ids.push_back(page_id);
+        }
+    }
+    size_t num_flushed = 0;
+    for (auto &page_id : page_ids) {
+        Page* page = fetch_page(page_id);
+        if (page == nullptr) {
+            continue;
+        }
+        page->RLatch();
+        // 页面读锁阻止修改，不持有latch_地把日志持久化到页面的LSN
+        lsn_t unflushed = unflushed_lsn(page);
+        if (unflushed != INVALID_LSN) {
+            flush_log_(unflushed);
+        }
+        {
+            std::scoped_lock lock{latch_};
+            if (page->is_dirty()) {
+                write_back(page);
+                num_flushed++;
+            }
+        }
+        page->RUnlatch();
+        unpin_page(page_id, false);
+    }
+    return num_flushed;
+}
+
+/**
+ * @description: 把页面写回磁盘并清除脏页标记和recLSN，调用者持有latch_，并且已经把日志持久化到页面的LSN（WAL）
+ * @param {Page*} page 写回的页面
+ */
+void BufferPoolManager::write_back(Page* page) {
+    page->rec_lsn_ = INVALID_LSN;
+    disk_manager_->write_page(page->id_.fd, page->id_.page_no, page->get_data(), PAGE_SIZE);
+    page->is_dirty_ = false;
+}
+
+/**
+ * @description: 页面写回之前需要持久化的日志号
+ * @return {lsn_t} 页面被带日志的操作修改过、并且页面的LSN还没有持久化时返回页面的LSN，否则返回INVALID_LSN
+ * @param {Page*} page 要写回的页面
+ */
+lsn_t BufferPoolManager::unflushed_lsn(Page* page) {
+    if (!flush_log_ || page->get_rec_lsn() == INVALID_LSN) {
+        return INVALID_LSN;
+    }
+    lsn_t lsn = page->get_page_lsn();
+    return lsn > persist_lsn_() ? lsn : INVALID_LSN;
+}
+
+/**
+ * @description: 淘汰脏页之前把日志持久化到页面的LSN（WAL），调用者持有latch_，帧已经从free_list_或replacer中取出。
+ * 日志还没有持久化时把帧放回replacer，释放latch_等待日志刷盘，一次刷盘不会阻塞整个缓冲池；
+ * 等待期间帧可能被其他线程固定或淘汰，返回后调用者重新查找
+ * @return {bool} 日志已经持久化、可以直接淘汰时返回true，释放过latch_时返回false
+ * @param {unique_lock<mutex>&} lock 持有的latch_
+ * @param {frame_id_t} frame_id 要淘汰的帧
+ */
+bool BufferPoolManager::force_victim_log(std::unique_lock<std::mutex>& lock, frame_id_t frame_id) {
+    lsn_t lsn = unflushed_lsn(&pages_[frame_id]);
+    if (lsn == INVALID_LSN) {
+        return true;
+    }
+    replacer_->unpin(frame_id);
+    lock.unlock();
+    flush_log_(lsn);
+    lock.lock();
+    return false;
 }
\ No newline at end of file
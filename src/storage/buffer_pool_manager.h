@@ -13,6 +13,7 @@ See the Mulan PSL v2 for more details. */
 #include <unistd.h>
 
 #include <cassert>
+#include <functional>
 #include <list>
 #include <unordered_map>
 #include <vector>
@@ -32,6 +33,8 @@ class BufferPoolManager {
     DiskManager *disk_manager_;
     Replacer *replacer_;    // buffer_pool的置换策略，当前赛题中为LRU置换策略
     std::mutex latch_;      // 用于共享数据结构的并发控制
+    std::function<void(lsn_t)> flush_log_;  // 写回脏页之前把日志持久化到页面的LSN，未设置时不等待
+    std::function<lsn_t()> persist_lsn_;    // 已经持久化的最大日志号
 
    public:
     BufferPoolManager(size_t pool_size, DiskManager *disk_manager)
@@ -63,6 +66,27 @@ class BufferPoolManager {
      */
     static void mark_dirty(Page* page) { page->is_dirty_ = true; }
 
+    /**
+     * @description: 将目标页面标记为脏页，并在页面的recLSN为空时设置recLSN，调用者持有页面写锁
+     * @param {Page*} page 脏页
+     * @param {lsn_t} rec_lsn 本次修改的日志号的下界
+     */
+    static void mark_dirty(Page* page, lsn_t rec_lsn) {
+        page->is_dirty_ = true;
+        lsn_t expected = INVALID_LSN;
+        page->rec_lsn_.compare_exchange_strong(expected, rec_lsn);
+    }
+
+    /**
+     * @description: 设置写回脏页之前持久化日志的函数（WAL），由日志管理器提供
+     * @param {function<void(lsn_t)>} flush_log 把日志号不超过参数的日志持久化
+     * @param {function<lsn_t()>} persist_lsn 返回已经持久化的最大日志号
+     */
+    void set_log_flusher(std::function<void(lsn_t)> flush_log, std::function<lsn_t()> persist_lsn) {
+        flush_log_ = std::move(flush_log);
+        persist_lsn_ = std::move(persist_lsn);
+    }
+
    public: 
     Page* fetch_page(PageId page_id);
 
@@ -76,7 +100,19 @@ class BufferPoolManager {
 
     void flush_all_pages(int fd);
 
+    bool copy_page(PageId page_id, char *buf, int num_bytes = PAGE_SIZE);
+
+    std::vector<std::pair<PageId, lsn_t>> get_dirty_pages();
+
+    size_t flush_pages_before(lsn_t lsn);
+
    private:
+    void write_back(Page* page);
+
+    lsn_t unflushed_lsn(Page* page);
+
+    bool force_victim_log(std::unique_lock<std::mutex>& lock, frame_id_t frame_id);
+
     bool find_victim_page(frame_id_t* frame_id);
 
     void update_page(Page* page, PageId new_page_id, frame_id_t new_frame_id);
@@ -15,9 +15,13 @@ See the Mulan PSL v2 for more details. */
 #include <sys/stat.h>  // for stat
 #include <unistd.h>    // for lseek
 #include <fcntl.h>     // for open flags like O_CREAT, O_RDWR
+#include <dirent.h>    // for listing log segments
+
+#include <algorithm>
 
 #include "defs.h"
 #include "common/config.h"
+#include "common/crc32c.h"
 #include "errors.h"
 
 DiskManager::DiskManager() { memset(fd2pageno_, 0, MAX_FD * (sizeof(std::atomic<page_id_t>) / sizeof(char))); }
@@ -34,14 +38,11 @@ void DiskManager::write_page(int fd, page_id_t page_no, const char *offset, int
     // 2.调用write()函数
     // 注意write返回值与num_bytes不等时 throw InternalError("DiskManager::write_page Error");
     // 1. lseek()定位到文件头，通过(fd,page_no)可以定位指定页面及其在磁盘文件中的偏移量
+    // 检查点线程与其他线程会同时写同一个文件，用pwrite避免lseek和write之间的竞争
     off_t seek_offset = static_cast<off_t>(page_no) * PAGE_SIZE;
-    if (::lseek(fd, seek_offset, SEEK_SET) == -1) {
-        // lseek 失败
-        throw UnixError();
-    }
 
     // 2. 调用write()函数
-    ssize_t bytes_written = ::write(fd, offset, num_bytes);
+    ssize_t bytes_written = ::pwrite(fd, offset, num_bytes, seek_offset);
 
     if (bytes_written == -1) {
         // write 系统调用本身失败
@@ -66,13 +67,9 @@ void DiskManager::read_page(int fd, page_id_t page_no, char *offset, int num_byt
     // 注意read返回值与num_bytes不等时，throw InternalError("DiskManager::read_page Error");
     // 1. lseek()定位到文件头，通过(fd,page_no)可以定位指定页面及其在磁盘文件中的偏移量
     off_t seek_offset = static_cast<off_t>(page_no) * PAGE_SIZE;
-    if (::lseek(fd, seek_offset, SEEK_SET) == -1) {
-        // lseek 失败
-        throw UnixError();
-    }
 
     // 2. 调用read()函数
-    ssize_t bytes_read = ::read(fd, offset, num_bytes);
+    ssize_t bytes_read = ::pread(fd, offset, num_bytes, seek_offset);
 
     if (bytes_read == -1) {
         // read 系统调用本身失败
@@ -84,6 +81,16 @@ void DiskManager::read_page(int fd, page_id_t page_no, char *offset, int num_byt
     }
 }
 
+/**
+ * @description: 提示操作系统预读指定页面，不等待读取完成，故障恢复时为即将重做的页面使用
+ * @param {int} fd 磁盘文件的文件句柄
+ * @param {page_id_t} page_no 指定的页面编号
+ */
+void DiskManager::prefetch_page(int fd, page_id_t page_no) {
+    // 预读只是提示，失败时不影响正确性
+    posix_fadvise(fd, static_cast<off_t>(page_no) * PAGE_SIZE, PAGE_SIZE, POSIX_FADV_WILLNEED);
+}
+
 /**
  * @description: 分配一个新的页号
  * @return {page_id_t} 分配的新页号
@@ -289,45 +296,407 @@ int DiskManager::get_file_fd(const std::string &file_name) {
 
 
 /**
- * @description:  读取日志文件内容
- * @return {int} 返回读取的数据量，若为-1说明读取数据的起始位置超过了文件大小
- * @param {char} *log_data 读取内容到log_data中
- * @param {int} size 读取的数据量大小
- * @param {int} offset 读取的内容在文件中的位置
+ * @description: 日志段文件的名称，日志段编号为日志号除以LOG_SEGMENT_SIZE
+ * @return {string} 日志段文件名
+ * @param {int} segment_no 日志段编号
  */
-int DiskManager::read_log(char *log_data, int size, int offset) {
-    // read log file from the previous end
-    if (log_fd_ == -1) {
-        log_fd_ = open_file(LOG_FILE_NAME);
+std::string DiskManager::get_log_segment_name(int segment_no) {
+    char suffix[16];
+    snprintf(suffix, sizeof(suffix), ".%08d", segment_no);
+    return LOG_FILE_NAME + suffix;
+}
+
+/**
+ * @description: 列出当前目录下所有日志段的编号，按编号递增
+ * @return {vector<int>} 日志段编号
+ */
+std::vector<int> DiskManager::list_log_segments() {
+    std::vector<int> segments;
+    DIR *dir = opendir(".");
+    if (dir == nullptr) {
+        throw UnixError();
     }
-    int file_size = get_file_size(LOG_FILE_NAME);
-    if (offset > file_size) {
-        return -1;
+    std::string prefix = LOG_FILE_NAME + ".";
+    while (struct dirent *entry = readdir(dir)) {
+        std::string name = entry->d_name;
+        if (name.size() == prefix.size() + 8 && name.compare(0, prefix.size(), prefix) == 0 &&
+            std::all_of(name.begin() + prefix.size(), name.end(), ::isdigit)) {
+            segments.push_back(std::stoi(name.substr(prefix.size())));
+        }
     }
+    closedir(dir);
+    std::sort(segments.begin(), segments.end());
+    return segments;
+}
 
-    size = std::min(size, file_size - offset);
-    if(size == 0) return 0;
-    lseek(log_fd_, offset, SEEK_SET);
-    ssize_t bytes_read = read(log_fd_, log_data, size);
-    assert(bytes_read == size);
+/**
+ * @description: 把当前目录同步到磁盘，创建、重命名或删除日志段之后调用，保证故障后日志段的文件名仍然有效
+ */
+void DiskManager::sync_dir() {
+    int fd = ::open(".", O_RDONLY | O_DIRECTORY);
+    if (fd < 0) {
+        throw UnixError();
+    }
+    int ret = fsync(fd);
+    ::close(fd);
+    if (ret < 0) {
+        throw UnixError();
+    }
+}
+
+/**
+ * @description: 写入日志段头，记录日志段编号和大小，并持久化
+ * @param {int} fd 日志段的文件句柄
+ * @param {int} segment_no 日志段编号
+ */
+void DiskManager::write_log_segment_header(int fd, int segment_no) {
+    LogSegmentHeader header{LOG_SEGMENT_MAGIC, segment_no, LOG_SEGMENT_SIZE, 0};
+    header.crc = crc32c::value(reinterpret_cast<const char *>(&header), offsetof(LogSegmentHeader, crc));
+    if (pwrite(fd, &header, sizeof(header), 0) != sizeof(header) || fdatasync(fd) < 0) {
+        throw UnixError();
+    }
+}
+
+/**
+ * @description: 检查日志段头是否属于编号为segment_no的日志段。重命名回收的日志段在写入新的段头之前，
+ * 以及段头没有写完整的日志段都不能读取
+ * @return {bool} 段头是否有效
+ * @param {int} fd 日志段的文件句柄
+ * @param {int} segment_no 日志段编号
+ */
+bool DiskManager::check_log_segment_header(int fd, int segment_no) {
+    LogSegmentHeader header;
+    if (pread(fd, &header, sizeof(header), 0) != sizeof(header)) {
+        return false;
+    }
+    return header.magic == LOG_SEGMENT_MAGIC && header.segment_no == segment_no &&
+           header.segment_size == LOG_SEGMENT_SIZE &&
+           header.crc == crc32c::value(reinterpret_cast<const char *>(&header), offsetof(LogSegmentHeader, crc));
+}
+
+/**
+ * @description: 切换写入的日志段，调用者持有log_latch_。写满的日志段先持久化再关闭；
+ * 新的日志段不存在时创建并预先分配段头和LOG_SEGMENT_SIZE的空间，此后写入不改变文件大小，fdatasync不需要同步文件的元数据。
+ * 段头无效时（新建或回收的日志段）写入新的段头
+ * @param {int} segment_no 要写入的日志段编号
+ */
+void DiskManager::open_log_segment(int segment_no) {
+    if (log_fd_ != -1) {
+        if (fdatasync(log_fd_) < 0) {
+            throw UnixError();
+        }
+        ::close(log_fd_);
+        log_fd_ = -1;
+    }
+    std::string name = get_log_segment_name(segment_no);
+    bool exists = is_file(name);
+    int fd = ::open(name.c_str(), O_RDWR | O_CREAT, 0600);
+    if (fd < 0) {
+        throw UnixError();
+    }
+    if (!exists) {
+        // 文件系统不支持fallocate时退化为设置文件大小
+        if (fallocate(fd, 0, 0, LOG_SEGMENT_FILE_SIZE) < 0 &&
+            (errno != EOPNOTSUPP || ftruncate(fd, LOG_SEGMENT_FILE_SIZE) < 0)) {
+            ::close(fd);
+            throw UnixError();
+        }
+        if (fsync(fd) < 0) {
+            ::close(fd);
+            throw UnixError();
+        }
+        sync_dir();
+    }
+    if (!check_log_segment_header(fd, segment_no)) {
+        write_log_segment_header(fd, segment_no);
+    }
+    log_fd_ = fd;
+    log_segment_no_ = segment_no;
+}
+
+/**
+ * @description:  读取日志文件内容，日志号为offset的日志位于第offset / LOG_SEGMENT_SIZE个日志段中，读取可以跨越多个日志段
+ * @return {int} 返回读取的数据量，日志段不存在或段头无效时读到它之前为止
+ * @param {char} *log_data 读取内容到log_data中
+ * @param {int} size 读取的数据量大小
+ * @param {lsn_t} offset 读取的内容的日志号
+ */
+int DiskManager::read_log(char *log_data, int size, lsn_t offset) {
+    std::scoped_lock lock{log_latch_};
+    int bytes_read = 0;
+    while (bytes_read < size) {
+        int segment_no = static_cast<int>(offset / LOG_SEGMENT_SIZE);
+        int segment_offset = static_cast<int>(offset % LOG_SEGMENT_SIZE);
+        int len = std::min(size - bytes_read, LOG_SEGMENT_SIZE - segment_offset);
+        int fd = segment_no == log_segment_no_ ? log_fd_ : ::open(get_log_segment_name(segment_no).c_str(), O_RDONLY);
+        if (fd < 0) {
+            break;
+        }
+        if (fd != log_fd_ && !check_log_segment_header(fd, segment_no)) {
+            ::close(fd);
+            break;
+        }
+        ssize_t ret = pread(fd, log_data + bytes_read, len, LOG_SEGMENT_HEADER_SIZE + segment_offset);
+        if (fd != log_fd_) {
+            ::close(fd);
+        }
+        if (ret <= 0) {
+            break;
+        }
+        bytes_read += ret;
+        offset += ret;
+        if (ret < len) {
+            break;
+        }
+    }
     return bytes_read;
 }
 
 
 /**
- * @description: 写日志内容
+ * @description: 写日志内容，日志号就是日志在日志中的位置，写入可以跨越日志段
  * @param {char} *log_data 要写入的日志内容
  * @param {int} size 要写入的内容大小
+ * @param {lsn_t} offset 写入的第一个字节的日志号
  */
-void DiskManager::write_log(char *log_data, int size) {
+void DiskManager::write_log(char *log_data, int size, lsn_t offset) {
+    std::scoped_lock lock{log_latch_};
+    while (size > 0) {
+        int segment_no = static_cast<int>(offset / LOG_SEGMENT_SIZE);
+        int segment_offset = static_cast<int>(offset % LOG_SEGMENT_SIZE);
+        int len = std::min(size, LOG_SEGMENT_SIZE - segment_offset);
+        if (segment_no != log_segment_no_) {
+            open_log_segment(segment_no);
+        }
+        if (pwrite(log_fd_, log_data, len, LOG_SEGMENT_HEADER_SIZE + segment_offset) != len) {
+            throw UnixError();
+        }
+        log_data += len;
+        offset += len;
+        size -= len;
+    }
+    log_end_ = std::max(log_end_, offset);
+}
+
+/**
+ * @description: 把日志内容写入另一个目录中的日志段并持久化，用于备份。日志段不存在时创建并写入段头，
+ * 日志段中没有写入的部分为0，恢复时不会被当作有效的日志
+ * @param {string&} dir 日志段所在的目录
+ * @param {char} *log_data 要写入的日志内容
+ * @param {int} size 要写入的内容大小
+ * @param {lsn_t} offset 写入的第一个字节的日志号
+ */
+void DiskManager::write_log_to(const std::string &dir, const char *log_data, int size, lsn_t offset) {
+    while (size > 0) {
+        int segment_no = static_cast<int>(offset / LOG_SEGMENT_SIZE);
+        int segment_offset = static_cast<int>(offset % LOG_SEGMENT_SIZE);
+        int len = std::min(size, LOG_SEGMENT_SIZE - segment_offset);
+        std::string name = dir + "/" + get_log_segment_name(segment_no);
+        bool exists = is_file(name);
+        int fd = ::open(name.c_str(), O_RDWR | O_CREAT, 0600);
+        if (fd < 0) {
+            throw UnixError();
+        }
+        if (!exists && ftruncate(fd, LOG_SEGMENT_FILE_SIZE) < 0) {
+            ::close(fd);
+            throw UnixError();
+        }
+        if (!exists) {
+            write_log_segment_header(fd, segment_no);
+        }
+        bool ok = pwrite(fd, log_data, len, LOG_SEGMENT_HEADER_SIZE + segment_offset) == len && fdatasync(fd) == 0;
+        ::close(fd);
+        if (!ok) {
+            throw UnixError();
+        }
+        log_data += len;
+        offset += len;
+        size -= len;
+    }
+}
+
+/**
+ * @description: 把已写入的日志内容持久化到磁盘中，写满的日志段在切换时已经持久化，只需要同步当前日志段的数据
+ */
+void DiskManager::sync_log() {
+    std::scoped_lock lock{log_latch_};
     if (log_fd_ == -1) {
-        log_fd_ = open_file(LOG_FILE_NAME);
+        return;
+    }
+    if (fdatasync(log_fd_) < 0) {
+        throw UnixError();
+    }
+}
+
+/**
+ * @description: 丢弃size之后故障时没有写完整的日志：清零所在日志段的剩余部分，删除之后的日志段。
+ * 之后的内容可能是故障前写入但没有持久化的日志，日志号与位置一致，不清除的话再次故障时会被误认为有效
+ * @param {lsn_t} size 有效日志的长度
+ */
+void DiskManager::truncate_log(lsn_t size) {
+    std::scoped_lock lock{log_latch_};
+    int segment_no = static_cast<int>(size / LOG_SEGMENT_SIZE);
+    for (int no : list_log_segments()) {
+        if (no > segment_no) {
+            if (no == log_segment_no_) {
+                ::close(log_fd_);
+                log_fd_ = -1;
+                log_segment_no_ = -1;
+            }
+            unlink(get_log_segment_name(no).c_str());
+        }
+    }
+    std::string name = get_log_segment_name(segment_no);
+    if (is_file(name)) {
+        int fd = ::open(name.c_str(), O_RDWR);
+        if (fd < 0) {
+            throw UnixError();
+        }
+        int offset = LOG_SEGMENT_HEADER_SIZE + static_cast<int>(size % LOG_SEGMENT_SIZE);
+        int len = LOG_SEGMENT_FILE_SIZE - offset;
+        // 文件系统不支持时写入0
+        if (fallocate(fd, FALLOC_FL_ZERO_RANGE | FALLOC_FL_KEEP_SIZE, offset, len) < 0) {
+            std::vector<char> zeros(std::min(len, LOG_BUFFER_SIZE));
+            for (int pos = offset; pos < LOG_SEGMENT_FILE_SIZE; pos += zeros.size()) {
+                int bytes = std::min(static_cast<int>(zeros.size()), LOG_SEGMENT_FILE_SIZE - pos);
+                if (pwrite(fd, zeros.data(), bytes, pos) != bytes) {
+                    ::close(fd);
+                    throw UnixError();
+                }
+            }
+        }
+        int ret = fdatasync(fd);
+        ::close(fd);
+        if (ret < 0) {
+            throw UnixError();
+        }
+    }
+    sync_dir();
+    log_end_ = size;
+}
+
+/**
+ * @description: 回收offset之前的日志：完全位于offset之前的日志段重命名为之后的日志段重复使用，
+ * 已预留的日志段超过LOG_RECYCLE_SEGMENTS个时直接删除。重命名后的日志段的段头编号与文件名不一致，在重新写入段头之前不会被读取
+ * @param {lsn_t} offset 需要保留的第一条日志的日志号
+ */
+void DiskManager::discard_log(lsn_t offset) {
+    std::scoped_lock lock{log_latch_};
+    std::vector<int> segments = list_log_segments();
+    if (segments.empty()) {
+        return;
+    }
+    int next_no = segments.back() + 1;
+    int num_spare = std::count_if(segments.begin(), segments.end(),
+                                  [&](int no) { return no > std::max(log_segment_no_, static_cast<int>(log_end_ / LOG_SEGMENT_SIZE)); });
+    bool changed = false;
+    for (int no : segments) {
+        if ((static_cast<lsn_t>(no) + 1) * LOG_SEGMENT_SIZE > offset || no == log_segment_no_) {
+            break;
+        }
+        std::string name = get_log_segment_name(no);
+        if (num_spare < LOG_RECYCLE_SEGMENTS) {
+            if (rename(name.c_str(), get_log_segment_name(next_no++).c_str()) < 0) {
+                throw UnixError();
+            }
+            num_spare++;
+        } else if (unlink(name.c_str()) < 0) {
+            throw UnixError();
+        }
+        changed = true;
+    }
+    if (changed) {
+        sync_dir();
+    }
+}
+
+/**
+ * @description: 持久化并关闭正在写入的日志段，关闭数据库时调用
+ */
+void DiskManager::close_log() {
+    std::scoped_lock lock{log_latch_};
+    if (log_fd_ != -1) {
+        int ret = fdatasync(log_fd_);
+        ::close(log_fd_);
+        log_fd_ = -1;
+        log_segment_no_ = -1;
+        if (ret < 0) {
+            throw UnixError();
+        }
+    }
+    log_end_ = 0;
+}
+
+/**
+ * @description: 删除所有日志段
+ */
+void DiskManager::destroy_log() {
+    close_log();
+    std::scoped_lock lock{log_latch_};
+    for (int no : list_log_segments()) {
+        unlink(get_log_segment_name(no).c_str());
     }
+    log_end_ = 0;
+}
 
-    // write from the file_end
-    lseek(log_fd_, 0, SEEK_END);
-    ssize_t bytes_write = write(log_fd_, log_data, size);
-    if (bytes_write != size) {
+/**
+ * @description: 把已经写回的数据页同步到磁盘，截断日志之前调用，数据文件与日志文件都在当前数据库目录所在的文件系统中
+ */
+void DiskManager::sync_data() {
+    int fd = ::open(".", O_RDONLY | O_DIRECTORY);
+    if (fd < 0) {
         throw UnixError();
     }
-}
\ No newline at end of file
+    int ret = syncfs(fd);
+    ::close(fd);
+    if (ret < 0) {
+        throw UnixError();
+    }
+}
+
+/**
+ * @description: 原子地写入主记录
+ * @param {lsn_t} checkpoint_lsn 最近一个完成的检查点的开始日志的日志号，分析阶段从这里开始查找检查点结束日志
+ * @param {lsn_t} log_start_lsn 日志中仍然有效的最小日志号，更早的日志已被截断，撤销阶段不会越过它
+ * @param {string&} dir 主记录所在的目录，默认为当前数据库目录，备份时写入备份目录
+ */
+void DiskManager::write_master_record(lsn_t checkpoint_lsn, lsn_t log_start_lsn, const std::string &dir) {
+    std::string name = dir + "/" + MASTER_RECORD_NAME;
+    std::string tmp_name = name + ".tmp";
+    int fd = ::open(tmp_name.c_str(), O_CREAT | O_WRONLY | O_TRUNC, 0600);
+    if (fd < 0) {
+        throw UnixError();
+    }
+    lsn_t record[2] = {checkpoint_lsn, log_start_lsn};
+    if (::write(fd, record, sizeof(record)) != sizeof(record) || fdatasync(fd) < 0) {
+        ::close(fd);
+        throw UnixError();
+    }
+    ::close(fd);
+    // 先写临时文件再重命名，故障时主记录要么是旧的，要么是新的
+    if (rename(tmp_name.c_str(), name.c_str()) < 0) {
+        throw UnixError();
+    }
+}
+
+/**
+ * @description: 读取主记录
+ * @return {bool} 主记录是否存在，还没有完成过检查点时返回false
+ * @param {lsn_t&} checkpoint_lsn 最近一个完成的检查点的开始日志的日志号
+ * @param {lsn_t&} log_start_lsn 日志中仍然有效的最小日志号
+ */
+bool DiskManager::read_master_record(lsn_t &checkpoint_lsn, lsn_t &log_start_lsn) {
+    int fd = ::open(MASTER_RECORD_NAME.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    lsn_t record[2];
+    bool ok = ::read(fd, record, sizeof(record)) == sizeof(record);
+    ::close(fd);
+    if (!ok) {
+        return false;
+    }
+    checkpoint_lsn = record[0];
+    log_start_lsn = record[1];
+    return true;
+}
@@ -17,8 +17,10 @@ See the Mulan PSL v2 for more details. */
 #include <atomic>
 #include <fstream>
 #include <iostream>
+#include <mutex>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "common/config.h"
 #include "errors.h"  
@@ -36,6 +38,8 @@ class DiskManager {
 
     void read_page(int fd, page_id_t page_no, char *offset, int num_bytes);
 
+    void prefetch_page(int fd, page_id_t page_no);
+
     page_id_t allocate_page(int fd);
 
     void deallocate_page(page_id_t page_id);
@@ -65,13 +69,31 @@ class DiskManager {
     int get_file_fd(const std::string &file_name);
 
     /*日志操作*/
-    int read_log(char *log_data, int size, int offset);
+    int read_log(char *log_data, int size, lsn_t offset);
+
+    void write_log(char *log_data, int size, lsn_t offset);
+
+    void write_log_to(const std::string &dir, const char *log_data, int size, lsn_t offset);
+
+    void sync_log();
+
+    void truncate_log(lsn_t size);
+
+    void discard_log(lsn_t offset);
+
+    void close_log();
+
+    void destroy_log();
 
-    void write_log(char *log_data, int size);
+    /* 本进程写入的日志的末尾 */
+    lsn_t get_log_end() { return log_end_; }
 
-    void SetLogFd(int log_fd) { log_fd_ = log_fd; }
+    void sync_data();
 
-    int GetLogFd() { return log_fd_; }
+    /*主记录操作*/
+    void write_master_record(lsn_t checkpoint_lsn, lsn_t log_start_lsn, const std::string &dir = ".");
+
+    bool read_master_record(lsn_t &checkpoint_lsn, lsn_t &log_start_lsn);
 
     /**
      * @description: 设置文件已经分配的页面个数
@@ -94,6 +116,30 @@ class DiskManager {
     std::unordered_map<std::string, int> path2fd_;  //<Page文件磁盘路径,Page fd>哈希表
     std::unordered_map<int, std::string> fd2path_;  //<Page fd,Page文件磁盘路径>哈希表
 
-    int log_fd_ = -1;                             // WAL日志文件的文件句柄，默认为-1，代表未打开日志文件
+    std::string get_log_segment_name(int segment_no);
+
+    std::vector<int> list_log_segments();
+
+    void sync_dir();
+
+    void write_log_segment_header(int fd, int segment_no);
+
+    bool check_log_segment_header(int fd, int segment_no);
+
+    void open_log_segment(int segment_no);
+
+    // 日志段头，位于日志段文件的开头，其后是LOG_SEGMENT_SIZE字节的日志
+    struct LogSegmentHeader {
+        uint32_t magic;
+        int32_t segment_no;
+        int32_t segment_size;
+        uint32_t crc;          // 前面各字段的CRC32C
+    };
+    static constexpr uint32_t LOG_SEGMENT_MAGIC = 0x524D4C47;  // "RMLG"
+
+    std::mutex log_latch_;                        // 保护日志段的打开、切换和回收
+    int log_fd_ = -1;                             // 正在写入的日志段的文件句柄，默认为-1，代表未打开日志段
+    int log_segment_no_ = -1;                     // 正在写入的日志段的编号
+    lsn_t log_end_ = 0;                           // 本进程写入的日志的末尾
     std::atomic<page_id_t> fd2pageno_[MAX_FD]{};  // 文件中已经分配的页面个数，初始值为0
 };
\ No newline at end of file
@@ -10,6 +10,9 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include <atomic>
+#include <shared_mutex>
+
 #include "common/config.h"
 
 /**
@@ -65,12 +68,21 @@ class Page {
 
     static constexpr size_t OFFSET_PAGE_START = 0;
     static constexpr size_t OFFSET_LSN = 0;
-    static constexpr size_t OFFSET_PAGE_HDR = 4;
+    static constexpr size_t OFFSET_PAGE_HDR = sizeof(lsn_t);
 
     inline lsn_t get_page_lsn() { return *reinterpret_cast<lsn_t *>(get_data() + OFFSET_LSN) ; }
 
     inline void set_page_lsn(lsn_t page_lsn) { memcpy(get_data() + OFFSET_LSN, &page_lsn, sizeof(lsn_t)); }
 
+    /** 页面变脏以来最早一条修改日志的日志号的下界，页面写回磁盘后清空，用于检查点的脏页表 */
+    inline lsn_t get_rec_lsn() const { return rec_lsn_.load(); }
+
+    /** 页面读写锁，保护页面内容在并发读写时的一致性，与pin_count_无关 */
+    inline void RLatch() { rwlatch_.lock_shared(); }
+    inline void RUnlatch() { rwlatch_.unlock_shared(); }
+    inline void WLatch() { rwlatch_.lock(); }
+    inline void WUnlatch() { rwlatch_.unlock(); }
+
    private:
     void reset_memory() { memset(data_, OFFSET_PAGE_START, PAGE_SIZE); }  // 将data_的PAGE_SIZE个字节填充为0
 
@@ -87,4 +99,10 @@ class Page {
 
     /** The pin count of this page. */
     int pin_count_ = 0;
+
+    /** 页面内容的读写锁 */
+    std::shared_mutex rwlatch_;
+
+    /** 页面的recLSN，没有未写回的带日志的修改时为INVALID_LSN */
+    std::atomic<lsn_t> rec_lsn_{INVALID_LSN};
 };
\ No newline at end of file
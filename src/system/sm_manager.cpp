@@ -57,9 +57,7 @@ void SmManager::create_db(const std::string& db_name) {
 
     delete new_db;
 
-    // 创建日志文件
-    disk_manager_->create_file(LOG_FILE_NAME);
-
+    // 日志段在第一次写入日志时创建
     // 回到根目录
     if (chdir("..") < 0) {
         throw UnixError();
@@ -85,7 +83,23 @@ void SmManager::drop_db(const std::string& db_name) {
  * @param {string&} db_name 数据库名称，与文件夹同名
  */
 void SmManager::open_db(const std::string& db_name) {
-    
+    if (!is_dir(db_name)) {
+        throw DatabaseNotFoundError(db_name);
+    }
+    // 进入数据库目录，此后数据文件、日志文件和主记录都使用相对路径
+    if (chdir(db_name.c_str()) < 0) {
+        throw UnixError();
+    }
+    std::ifstream ifs(DB_META_NAME);
+    ifs >> db_;
+    for (auto &[tab_name, tab] : db_.tabs_) {
+        auto fh = rm_manager_->open_file(tab_name);
+        fh->set_table_id(tab.id);
+        fhs_.emplace(tab_name, std::move(fh));
+        for (auto &index : tab.indexes) {
+            ihs_.emplace(ix_manager_->get_index_name(tab_name, index.cols), ix_manager_->open_index(tab_name, index.cols));
+        }
+    }
 }
 
 /**
@@ -97,11 +111,53 @@ void SmManager::flush_meta() {
     ofs << db_;
 }
 
+/**
+ * @description: 执行DDL之前调用，返回的锁在DDL执行完之前持有；在线备份期间拒绝DDL，
+ * 备份拷贝元数据和遍历fhs_/ihs_时表和索引不会变化
+ * @return {unique_lock<mutex>} 持有的DDL锁
+ */
+std::unique_lock<std::mutex> SmManager::lock_ddl() {
+    std::unique_lock<std::mutex> lock(ddl_latch_);
+    if (backup_in_progress_) {
+        throw BackupInProgressError();
+    }
+    return lock;
+}
+
+/**
+ * @description: 在线备份开始，等待正在执行的DDL结束，此后到end_backup()之前的DDL被拒绝
+ */
+void SmManager::begin_backup() {
+    std::scoped_lock lock{ddl_latch_};
+    backup_in_progress_ = true;
+}
+
+/**
+ * @description: 在线备份结束（成功或失败），重新允许DDL
+ */
+void SmManager::end_backup() {
+    std::scoped_lock lock{ddl_latch_};
+    backup_in_progress_ = false;
+}
+
 /**
  * @description: 关闭数据库并把数据落盘
  */
 void SmManager::close_db() {
-    
+    flush_meta();
+    for (auto &[tab_name, fh] : fhs_) {
+        rm_manager_->close_file(fh.get());
+    }
+    for (auto &[ix_name, ih] : ihs_) {
+        ix_manager_->close_index(ih.get());
+    }
+    fhs_.clear();
+    ihs_.clear();
+    db_.tabs_.clear();
+    disk_manager_->close_log();
+    if (chdir("..") < 0) {
+        throw UnixError();
+    }
 }
 
 /**
@@ -162,6 +218,7 @@ void SmManager::create_table(const std::string& tab_name, const std::vector<ColD
     int curr_offset = 0;
     TabMeta tab;
     tab.name = tab_name;
+    tab.id = db_.next_tab_id_++;
     for (auto &col_def : col_defs) {
         ColMeta col = {.tab_name = tab_name,
                        .name = col_def.name,
@@ -177,7 +234,9 @@ void SmManager::create_table(const std::string& tab_name, const std::vector<ColD
     rm_manager_->create_file(tab_name, record_size);
     db_.tabs_[tab_name] = tab;
     // fhs_[tab_name] = rm_manager_->open_file(tab_name);
-    fhs_.emplace(tab_name, rm_manager_->open_file(tab_name));
+    auto fh = rm_manager_->open_file(tab_name);
+    fh->set_table_id(tab.id);
+    fhs_.emplace(tab_name, std::move(fh));
 
     flush_meta();
 }
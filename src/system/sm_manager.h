@@ -10,6 +10,8 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include <mutex>
+
 #include "index/ix.h"
 #include "record/rm_file_handle.h"
 #include "sm_defs.h"
@@ -35,6 +37,8 @@ class SmManager {
     BufferPoolManager* buffer_pool_manager_;
     RmManager* rm_manager_;
     IxManager* ix_manager_;
+    std::mutex ddl_latch_;              // DDL执行期间持有，与在线备份互斥
+    bool backup_in_progress_ = false;   // 是否有正在进行的在线备份，由ddl_latch_保护
 
    public:
     SmManager(DiskManager* disk_manager, BufferPoolManager* buffer_pool_manager, RmManager* rm_manager,
@@ -64,6 +68,12 @@ class SmManager {
 
     void flush_meta();
 
+    std::unique_lock<std::mutex> lock_ddl();
+
+    void begin_backup();
+
+    void end_backup();
+
     void show_tables(Context* context);
 
     void desc_table(const std::string& tab_name, Context* context);
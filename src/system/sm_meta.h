@@ -68,6 +68,7 @@ struct IndexMeta {
 /* 表元数据 */
 struct TabMeta {
     std::string name;                   // 表名称
+    int id = -1;                        // 表的编号，日志中用它引用表，删除表后不会复用
     std::vector<ColMeta> cols;          // 表包含的字段
     std::vector<IndexMeta> indexes;     // 表上建立的索引
 
@@ -75,6 +76,7 @@ struct TabMeta {
 
     TabMeta(const TabMeta &other) {
         name = other.name;
+        id = other.id;
         for(auto col : other.cols) cols.push_back(col);
     }
 
@@ -125,7 +127,7 @@ struct TabMeta {
     }
 
     friend std::ostream &operator<<(std::ostream &os, const TabMeta &tab) {
-        os << tab.name << '\n' << tab.cols.size() << '\n';
+        os << tab.name << '\n' << tab.id << '\n' << tab.cols.size() << '\n';
         for (auto &col : tab.cols) {
             os << col << '\n';  // col是ColMeta类型，然后调用重载的ColMeta的操作符<<
         }
@@ -138,7 +140,7 @@ struct TabMeta {
 
     friend std::istream &operator>>(std::istream &is, TabMeta &tab) {
         size_t n;
-        is >> tab.name >> n;
+        is >> tab.name >> tab.id >> n;
         for (size_t i = 0; i < n; i++) {
             ColMeta col;
             is >> col;
@@ -162,6 +164,7 @@ class DbMeta {
    private:
     std::string name_;                      // 数据库名称
     std::map<std::string, TabMeta> tabs_;   // 数据库中包含的表
+    int next_tab_id_ = 0;                   // 下一个新建的表的编号
 
    public:
     // DbMeta(std::string name) : name_(name) {}
@@ -185,7 +188,7 @@ class DbMeta {
 
     // 重载操作符 <<
     friend std::ostream &operator<<(std::ostream &os, const DbMeta &db_meta) {
-        os << db_meta.name_ << '\n' << db_meta.tabs_.size() << '\n';
+        os << db_meta.name_ << '\n' << db_meta.next_tab_id_ << '\n' << db_meta.tabs_.size() << '\n';
         for (auto &entry : db_meta.tabs_) {
             os << entry.second << '\n';
         }
@@ -194,7 +197,7 @@ class DbMeta {
 
     friend std::istream &operator>>(std::istream &is, DbMeta &db_meta) {
         size_t n;
-        is >> db_meta.name_ >> n;
+        is >> db_meta.name_ >> db_meta.next_tab_id_ >> n;
         for (size_t i = 0; i < n; i++) {
             TabMeta tab;
             is >> tab;
@@ -0,0 +1,98 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+#include "test_util.h"
+
+// 在线备份：写入不停止的情况下备份数据库，从备份启动的rmdb看到备份结束时已提交的数据，未提交的修改被回滚
+
+int main(int argc, char **argv) {
+    CHECK(argc == 2);
+    rmdb_path = argv[1];
+    char dir_template[] = "/tmp/rmdb_backup_XXXXXX";
+    std::string dir = mkdtemp(dir_template);
+    std::string primary_dir = dir + "/primary";
+    std::string restore_dir = dir + "/restore";
+    std::string backup_dir = dir + "/backup";
+    run_command("mkdir -p " + primary_dir + " " + restore_dir);
+    int base_port = 20000 + getpid() % 20000;
+    std::string primary_port = std::to_string(base_port);
+    std::string restore_port = std::to_string(base_port + 1);
+
+    pid_t primary = start_server(primary_dir, {"--port=" + primary_port});
+    int num_before = 0;
+    int num_start = 0;  // 备份开始时t中已提交的记录数
+    int num_end = 0;    // 备份结束时t中最多已提交的记录数
+    std::atomic<int> num_inserted{0};
+    {
+        Client client(base_port);
+        Client txn(base_port);
+        client.query("create table t (id int, v int);");
+        client.query("create table u (id int, v int);");
+        for (; num_before < 200; num_before++) {
+            client.query("insert into t values (" + std::to_string(num_before) + ", 0);");
+        }
+        for (int i = 0; i < 10; i++) {
+            client.query("insert into u values (" + std::to_string(i) + ", 0);");
+        }
+        client.query("update u set v = 1 where id = 1;");
+
+        // 备份结束时未提交的事务
+        txn.query("begin;");
+        txn.query("insert into u values (-1, -1);");
+        txn.query("update u set v = -1 where id = 2;");
+
+        // 备份期间另一个连接继续插入
+        std::atomic<bool> done{false};
+        std::thread writer([&] {
+            Client client(base_port);
+            while (!done) {
+                client.query("insert into t values (" + std::to_string(num_before + num_inserted) + ", 0);");
+                num_inserted++;
+            }
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        num_start = num_before + num_inserted;
+        CHECK(num_start > num_before);
+        CHECK(client.query("backup to '" + backup_dir + "';").find("end_lsn") != std::string::npos);
+        num_end = num_before + num_inserted + 1;
+        done = true;
+        writer.join();
+        CHECK(client.query("backup to '" + backup_dir + "';").find("Backup failed") != std::string::npos);
+
+        // 备份之后提交的修改不在备份中
+        txn.query("commit;");
+        client.query("insert into t values (-2, -2);");
+        stop_server(primary);
+    }
+    run_command("cp -r " + backup_dir + " " + restore_dir + "/db");
+
+    // 备份开始之前提交的数据都在备份中，备份结束之后提交的都不在
+    pid_t restored = start_server(restore_dir, {"--port=" + restore_port});
+    {
+        Client reader(base_port + 1);
+        int num_restored = num_records(reader.query("select * from t;"));
+        CHECK(num_restored >= num_start && num_restored <= num_end);
+        CHECK(num_records(reader.query("select * from t where id < 0;")) == 0);
+        CHECK(num_records(reader.query("select * from u;")) == 10);
+        CHECK(num_records(reader.query("select * from u where v = 1;")) == 1);
+        CHECK(num_records(reader.query("select * from u where v < 0;")) == 0);
+        // 恢复后的数据库可以继续写入
+        reader.query("insert into t values (-3, -3);");
+        CHECK(num_records(reader.query("select * from t where id = -3;")) == 1);
+    }
+    stop_server(restored);
+    run_command("rm -rf " + dir);
+    std::cout << "backup test passed" << std::endl;
+    return 0;
+}
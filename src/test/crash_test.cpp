@@ -0,0 +1,164 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "test_util.h"
+
+// 故障恢复：rmdb进程被kill -9之后重启，已提交的修改都在，未提交的修改被回滚；
+// 重做按页面分给多个线程并行进行；checkpoint语句之后截断的日志不再需要，恢复从检查点开始
+
+static constexpr int NUM_ROWS = 300;        // 每条记录目前占用一个页面，重做涉及同样多的页面
+static constexpr int BIG_ROWS = 100;
+static constexpr int BIG_UPDATES = 200;     // 每次更新约100KB日志，总量超过一个日志段
+
+/* 重启时输出的恢复统计 */
+struct RecoveryStats {
+    long long log_start = -1;
+    long long log_end = -1;
+    long long redo_records = -1;
+    long long redo_pages = -1;
+    int redo_threads = -1;
+    long long undo_txns = -1;
+};
+
+/* server.log中最后一次恢复的统计 */
+RecoveryStats last_recovery(const std::string &dir) {
+    std::ifstream log(dir + "/server.log");
+    std::stringstream data;
+    data << log.rdbuf();
+    std::string text = data.str();
+    size_t pos = text.rfind("Recovery: ");
+    CHECK(pos != std::string::npos);
+    RecoveryStats stats;
+    int num = sscanf(text.c_str() + pos,
+                     "Recovery: log [%lld, %lld), redo %lld records on %lld pages with %d threads, rolled back %lld",
+                     &stats.log_start, &stats.log_end, &stats.redo_records, &stats.redo_pages, &stats.redo_threads,
+                     &stats.undo_txns);
+    CHECK(num == 6);
+    return stats;
+}
+
+/* 名称和值两列的状态输出中name对应的值 */
+long long status_value(const std::string &result, const std::string &name) {
+    size_t pos = result.find(" " + name + " |");
+    CHECK(pos != std::string::npos);
+    return std::stoll(result.substr(pos + name.size() + 3));
+}
+
+/* 整数id的记录中v的值 */
+int value_of(Client &client, int id) {
+    std::string result = client.query("select v from t where id = " + std::to_string(id) + ";");
+    CHECK(num_records(result) == 1);
+    // 表头、分隔线之后的第一行是记录
+    size_t pos = 0;
+    for (int i = 0; i < 3; i++) {
+        pos = result.find('\n', pos) + 1;
+    }
+    return std::stoi(result.substr(pos + 1));
+}
+
+int main(int argc, char **argv) {
+    CHECK(argc == 2);
+    rmdb_path = argv[1];
+    char dir_template[] = "/tmp/rmdb_crash_XXXXXX";
+    std::string dir = mkdtemp(dir_template);
+    int port = 20000 + getpid() % 20000;
+    // 无论机器有几个核，重做都由多个线程进行
+    std::vector<std::string> options = {"--port=" + std::to_string(port), "--redo-threads=4"};
+
+    // 1. 提交的修改只在日志中（脏页没有写回），另一个事务的修改未提交时崩溃
+    pid_t server = start_server(dir, options);
+    {
+        Client client(port);
+        Client txn(port);
+        client.query("create table t (id int, v int);");
+        client.query("create table u (id int, v int);");
+        for (int i = 0; i < NUM_ROWS; i++) {
+            client.query("insert into t values (" + std::to_string(i) + ", 0);");
+        }
+        client.query("update t set v = 1 where id < 100;");
+        client.query("delete from t where id = 299;");
+        txn.query("begin;");
+        txn.query("insert into t values (1000, 1000);");
+        txn.query("update t set v = -1 where id = 5;");
+        txn.query("delete from t where id = 6;");
+        // 另一张表上之后提交的事务的日志持久化时，未提交事务此前的日志也一起持久化
+        client.query("insert into u values (2000, 2000);");
+        crash_server(server);
+    }
+
+    server = start_server(dir, options);
+    {
+        Client client(port);
+        CHECK(num_records(client.query("select * from t;")) == NUM_ROWS - 1);
+        CHECK(num_records(client.query("select * from t where v = 1;")) == 100);
+        CHECK(num_records(client.query("select * from t where id = 299;")) == 0);
+        CHECK(num_records(client.query("select * from t where id = 1000;")) == 0);
+        CHECK(value_of(client, 5) == 1);
+        CHECK(value_of(client, 6) == 1);
+        CHECK(num_records(client.query("select * from u where v = 2000;")) == 1);
+        RecoveryStats stats = last_recovery(dir);
+        CHECK(stats.redo_records >= NUM_ROWS);
+        CHECK(stats.redo_pages >= NUM_ROWS / 2);
+        CHECK(stats.redo_threads == 4);
+        CHECK(stats.undo_txns >= 1);
+    }
+
+    // 2. 产生超过一个日志段的日志后做检查点，之前的日志段被回收
+    long long log_start_lsn;
+    {
+        Client client(port);
+        Client txn(port);
+        client.query("create table big (id int, pad char(500));");
+        for (int i = 0; i < BIG_ROWS; i++) {
+            client.query("insert into big values (" + std::to_string(i) + ", 'a');");
+        }
+        for (int i = 0; i < BIG_UPDATES; i++) {
+            client.query("update big set pad = '" + std::string(500, 'a' + i % 26) + "';");
+        }
+        std::string first_segment = dir + "/db/db.log.00000000";
+        CHECK(access(first_segment.c_str(), F_OK) == 0);
+        std::string result = client.query("checkpoint;");
+        log_start_lsn = status_value(result, "log_start_lsn");
+        CHECK(status_value(result, "checkpoint_lsn") >= log_start_lsn);
+        CHECK(log_start_lsn > 16 * 1024 * 1024);
+        CHECK(access(first_segment.c_str(), F_OK) != 0);
+
+        // 检查点之后的修改靠日志恢复
+        client.query("insert into t values (3000, 3000);");
+        client.query("update t set v = 3 where id = 8;");
+        txn.query("begin;");
+        txn.query("update t set v = -1 where id = 7;");
+        client.query("update u set v = 3000 where id = 2000;");
+        crash_server(server);
+    }
+
+    server = start_server(dir, options);
+    {
+        Client client(port);
+        RecoveryStats stats = last_recovery(dir);
+        CHECK(stats.log_start >= log_start_lsn);
+        CHECK(stats.undo_txns >= 1);
+        CHECK(value_of(client, 3000) == 3000);
+        CHECK(value_of(client, 7) == 1);
+        CHECK(value_of(client, 8) == 3);
+        CHECK(num_records(client.query("select * from u where v = 3000;")) == 1);
+        std::string last_pad(500, 'a' + (BIG_UPDATES - 1) % 26);
+        CHECK(num_records(client.query("select id from big where pad = '" + last_pad + "';")) == BIG_ROWS);
+    }
+    stop_server(server);
+    run_command("rm -rf " + dir);
+    std::cout << "crash test passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,112 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <string>
+
+#include "test_util.h"
+
+// 存储过程：一次调用在服务端执行多条语句，出错时整个事务回滚，重启后过程仍然存在
+
+/* 账户id的余额 */
+int balance(Client &client, int id) {
+    std::string result = client.query("select bal from acct where id = " + std::to_string(id) + ";");
+    CHECK(num_records(result) == 1);
+    // 表头、分隔线之后的第一行是记录
+    size_t pos = 0;
+    for (int i = 0; i < 3; i++) {
+        pos = result.find('\n', pos) + 1;
+    }
+    return std::stoi(result.substr(pos + 1));
+}
+
+int main(int argc, char **argv) {
+    CHECK(argc == 2);
+    rmdb_path = argv[1];
+    char dir_template[] = "/tmp/rmdb_procedure_XXXXXX";
+    std::string dir = mkdtemp(dir_template);
+    int port = 20000 + getpid() % 20000;
+
+    pid_t server = start_server(dir, {"--port=" + std::to_string(port)});
+    {
+        Client client(port);
+        client.query("create table acct (id int, bal int);");
+        client.query("create table hist (src int, dst int, amt int);");
+        for (int id = 1; id <= 3; id++) {
+            client.query("insert into acct values (" + std::to_string(id) + ", 100);");
+        }
+
+        // 转账：读出余额、计算后写回、记录历史，最后返回付款账户
+        std::string result = client.query(
+            "create procedure transfer (src int, dst int, amt int) begin "
+            "select bal into b from acct where id = src; "
+            "update acct set bal = sub(b, amt) where id = src; "
+            "select bal into b from acct where id = dst; "
+            "update acct set bal = add(b, amt) where id = dst; "
+            "insert into hist values (src, dst, amt); "
+            "select * from acct where id = src; "
+            "end;");
+        CHECK(result.find("failure") == std::string::npos && result.find("rror") == std::string::npos);
+        result = client.query("call transfer (1, 2, 30);");
+        CHECK(num_records(result) == 1);
+        CHECK(balance(client, 1) == 70 && balance(client, 2) == 130);
+
+        // 循环处理查询的每一行，变量在循环之间保持
+        client.query(
+            "create procedure spread (amt int) begin "
+            "set n = 0; "
+            "for i, v in (select id, bal from acct) begin "
+            "update acct set bal = add(v, amt) where id = i; "
+            "set n = add(n, 1); "
+            "end; "
+            "insert into hist values (0, n, amt); "
+            "end;");
+        client.query("call spread (5);");
+        CHECK(balance(client, 1) == 75 && balance(client, 2) == 135 && balance(client, 3) == 105);
+        CHECK(num_records(client.query("select * from hist where src = 0 and dst = 3;")) == 1);
+
+        // 显式事务中调用，回滚时过程的修改一起回滚
+        client.query("begin;");
+        client.query("call transfer (3, 1, 5);");
+        client.query("abort;");
+        CHECK(balance(client, 1) == 75 && balance(client, 3) == 105);
+
+        // 过程体中的语句出错时，此前语句的修改也回滚
+        client.query(
+            "create procedure bad (src int) begin "
+            "update acct set bal = 0 where id = src; "
+            "insert into acct values (src, 'x'); "
+            "end;");
+        CHECK(client.query("call bad (1);").find("abort") != std::string::npos);
+        CHECK(balance(client, 1) == 75);
+
+        // 未定义的变量在创建时报错，参数个数错误和不存在的过程在调用时报错
+        CHECK(client.query("create procedure bad2 () begin update acct set bal = x; end;").find("rror") !=
+               std::string::npos);
+        CHECK(client.query("call transfer (1, 2);").find("rror") != std::string::npos);
+        CHECK(client.query("call nothing ();").find("rror") != std::string::npos);
+        CHECK(client.query("create procedure bad (x int) begin delete from acct; end;").find("rror") !=
+               std::string::npos);
+        CHECK(client.query("drop procedure bad;").find("rror") == std::string::npos);
+    }
+    stop_server(server);
+
+    // 重启后存储过程仍然可以调用，删除的过程不再存在
+    server = start_server(dir, {"--port=" + std::to_string(port)});
+    {
+        Client client(port);
+        client.query("call transfer (2, 3, 35);");
+        CHECK(balance(client, 2) == 100 && balance(client, 3) == 140);
+        CHECK(client.query("call bad (1);").find("rror") != std::string::npos);
+    }
+    stop_server(server);
+    run_command("rm -rf " + dir);
+    std::cout << "procedure test passed" << std::endl;
+    return 0;
+}
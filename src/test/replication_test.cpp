@@ -0,0 +1,102 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <functional>
+#include <string>
+#include <thread>
+
+#include "test_util.h"
+
+// 两个rmdb进程之间的日志复制：主库上的修改提交后出现在只读副本上，未提交的修改在副本上不可见
+
+/* 等待副本重放到满足条件，超时返回false */
+bool wait_until(const std::function<bool()> &cond) {
+    for (int i = 0; i < 200; i++) {
+        if (cond()) {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    return false;
+}
+
+int main(int argc, char **argv) {
+    CHECK(argc == 2);
+    rmdb_path = argv[1];
+    char dir_template[] = "/tmp/rmdb_replication_XXXXXX";
+    std::string dir = mkdtemp(dir_template);
+    std::string primary_dir = dir + "/primary";
+    std::string replica_dir = dir + "/replica";
+    run_command("mkdir -p " + primary_dir + " " + replica_dir);
+    int base_port = 20000 + getpid() % 20000;
+    std::string primary_port = std::to_string(base_port);
+    std::string replica_port = std::to_string(base_port + 1);
+    std::string replication_port = std::to_string(base_port + 2);
+    std::vector<std::string> primary_options = {"--port=" + primary_port, "--replication-port=" + replication_port};
+
+    // 副本从正常关闭的主库的拷贝开始
+    pid_t primary = start_server(primary_dir, primary_options);
+    {
+        Client client(base_port);
+        client.query("create table t (id int, v int);");
+        client.query("create table u (id int);");
+        for (int i = 0; i < 10; i++) {
+            client.query("insert into t values (" + std::to_string(i) + ", " + std::to_string(i) + ");");
+        }
+    }
+    stop_server(primary);
+    run_command("cp -r " + primary_dir + "/db " + replica_dir + "/db");
+
+    primary = start_server(primary_dir, primary_options);
+    pid_t replica = start_server(replica_dir, {"--port=" + replica_port, "--replica-of=" + replication_port});
+    {
+        Client writer(base_port);
+        Client txn(base_port);
+        Client reader(base_port + 1);
+        auto replica_count = [&](const std::string &where) {
+            return num_records(reader.query("select * from t" + where + ";"));
+        };
+
+        // 主库提交的修改被复制到副本
+        for (int i = 10; i < 20; i++) {
+            writer.query("insert into t values (" + std::to_string(i) + ", " + std::to_string(i) + ");");
+        }
+        writer.query("update t set v = 1000 where id = 1;");
+        CHECK(wait_until([&] { return replica_count("") == 20 && replica_count(" where v = 1000") == 1; }));
+
+        // 未提交的修改不可见；之后另一个表上提交的事务的日志持久化时会带上它们，确保副本已经重放过
+        txn.query("begin;");
+        txn.query("insert into t values (100, 100);");
+        txn.query("delete from t where id = 2;");
+        txn.query("update t set v = 300 where id = 3;");
+        writer.query("insert into u values (1);");
+        CHECK(wait_until([&] { return num_records(reader.query("select * from u;")) == 1; }));
+        CHECK(replica_count(" where id = 100") == 0);
+        CHECK(replica_count(" where id = 2") == 1);
+        CHECK(replica_count(" where v = 300") == 0);
+        CHECK(replica_count("") == 20);
+
+        // 副本只读
+        CHECK(reader.query("insert into t values (0, 0);").find("read-only") != std::string::npos);
+        CHECK(reader.query("show replication;").find("lag_bytes") != std::string::npos);
+
+        // 提交之后可见
+        txn.query("commit;");
+        CHECK(wait_until([&] { return replica_count(" where id = 100") == 1; }));
+        CHECK(replica_count(" where id = 2") == 0);
+        CHECK(replica_count(" where v = 300") == 1);
+        CHECK(replica_count("") == 20);
+    }
+    stop_server(replica);
+    stop_server(primary);
+    run_command("rm -rf " + dir);
+    std::cout << "replication test passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,277 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <sys/resource.h>
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "test_util.h"
+
+// 事件循环和工作线程池：大量空闲连接不占用线程，每个连接上的请求都能得到正确的结果；
+// 失控的查询可以由语句超时或者其他连接的cancel中止；阻塞在锁等待上的语句和不读取结果的连接不会占满工作线程
+
+static constexpr int NUM_CONNECTIONS = 1000;
+static constexpr int NUM_THREADS = 8;
+static constexpr int RUNAWAY_TABLE_SIZE = 300;
+static constexpr int NUM_LOCK_WAITERS = 40;        // 多于工作线程的数量
+static constexpr int NUM_STALLED_CLIENTS = 40;     // 多于工作线程的数量
+static constexpr int NUM_STALLED_REQUESTS = 4000;  // 结果多于连接两端的缓冲区
+
+/* 分帧协议的一帧：4字节大端序的长度和以'\0'分隔的一批语句 */
+std::string frame(const std::vector<std::string> &batch) {
+    std::string payload;
+    for (auto &sql : batch) {
+        payload.append(sql);
+        payload.push_back('\0');
+    }
+    uint32_t len = htonl(payload.size());
+    return std::string(reinterpret_cast<char *>(&len), sizeof(len)) + payload;
+}
+
+/* 读取一帧结果，返回其中各条语句的结果 */
+std::vector<std::string> receive_frame(Client &client) {
+    std::string header = client.receive_bytes(4);
+    uint32_t len;
+    memcpy(&len, header.data(), sizeof(len));
+    std::string payload = client.receive_bytes(ntohl(len));
+    std::vector<std::string> results;
+    size_t begin = 0, end;
+    while ((end = payload.find('\0', begin)) != std::string::npos) {
+        results.push_back(payload.substr(begin, end - begin));
+        begin = end + 1;
+    }
+    CHECK(begin == payload.size());
+    return results;
+}
+
+int main(int argc, char **argv) {
+    CHECK(argc == 2);
+    rmdb_path = argv[1];
+    // 测试进程和rmdb进程都需要为每个连接打开一个文件描述符
+    rlimit limit;
+    CHECK(getrlimit(RLIMIT_NOFILE, &limit) == 0);
+    limit.rlim_cur = limit.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &limit);
+    if (limit.rlim_cur < NUM_CONNECTIONS + 64) {
+        std::cout << "server test skipped: open file limit " << limit.rlim_cur << " is too low" << std::endl;
+        return 0;
+    }
+    char dir_template[] = "/tmp/rmdb_server_XXXXXX";
+    std::string dir = mkdtemp(dir_template);
+    int port = 20000 + getpid() % 20000;
+
+    pid_t server = start_server(dir, {"--port=" + std::to_string(port)});
+    {
+        Client client(port);
+        client.query("create table t (id int, v int);");
+
+        // 大量连接同时打开，大部分时间空闲
+        std::vector<std::unique_ptr<Client>> clients;
+        for (int i = 0; i < NUM_CONNECTIONS; i++) {
+            clients.push_back(std::make_unique<Client>(port));
+        }
+
+        // 断开连接时回滚未结束的显式事务，释放它持有的锁
+        clients[0]->query("begin;");
+        clients[0]->query("insert into t values (-1, -1);");
+        clients[0].reset();
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        CHECK(num_records(client.query("select * from t;")) == 0);
+
+        // 一次发送的多个请求和分多次到达的请求都按顺序执行
+        client.send_raw(std::string("insert into t values (-2, -2);\0select * from t where id = -2;\0", 62));
+        CHECK(client.receive().find("failure") == std::string::npos);
+        CHECK(num_records(client.receive()) == 1);
+        client.send_raw("select * from t ");
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        client.send_raw(std::string("where id = -2;\0", 15));
+        CHECK(num_records(client.receive()) == 1);
+        CHECK(client.query("delete from t where id = -2;").find("failure") == std::string::npos);
+
+        // 各个线程轮流使用一部分连接，每个连接上执行的语句都得到自己的结果
+        std::vector<std::thread> threads;
+        for (int t = 0; t < NUM_THREADS; t++) {
+            threads.emplace_back([&, t] {
+                for (int i = 1 + t; i < NUM_CONNECTIONS; i += NUM_THREADS) {
+                    std::string id = std::to_string(i);
+                    // no-wait下并发插入的冲突会中止事务，重试到成功
+                    std::string result;
+                    do {
+                        result = clients[i]->query("insert into t values (" + id + ", " + id + ");");
+                        CHECK(result.find("failure") == std::string::npos);
+                    } while (result.find("abort") != std::string::npos);
+                }
+                for (int i = 1 + t; i < NUM_CONNECTIONS; i += NUM_THREADS) {
+                    std::string id = std::to_string(i);
+                    // 查询的表锁同样可能与其他线程的插入冲突
+                    std::string result;
+                    do {
+                        result = clients[i]->query("select * from t where id = " + id + ";");
+                    } while (result.find("abort") != std::string::npos);
+                    CHECK(num_records(result) == 1);
+                    CHECK(result.find(" " + id + " |") != std::string::npos);
+                }
+            });
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        CHECK(num_records(client.query("select * from t;")) == NUM_CONNECTIONS - 1);
+
+        // 分帧协议：一帧中的一批语句在一次往返中执行，多帧不等结果连续发送，结果按顺序返回
+        Client framed(port);
+        std::string long_select = "select * from t" + std::string(20000, ' ') + "where id = 1;";
+        framed.send_raw(std::string("\xffRDB") +
+                        frame({"begin;", "insert into t values (2000, 1);", "insert into t values (2001, 1);",
+                               "commit;"}) +
+                        frame({"select * from t where v = 1;", long_select}) + frame({}));
+        std::vector<std::string> results = receive_frame(framed);
+        CHECK(results.size() == 4);
+        for (auto &result : results) {
+            CHECK(result.find("failure") == std::string::npos && result.find("abort") == std::string::npos);
+        }
+        results = receive_frame(framed);
+        CHECK(results.size() == 2);
+        CHECK(num_records(results[0]) == 3);
+        CHECK(num_records(results[1]) == 1);
+        CHECK(receive_frame(framed).empty());
+
+        // 一批语句中事务被中止后，后面的语句不再执行
+        client.query("begin;");
+        client.query("insert into t values (3000, 3000);");
+        framed.send_raw(frame({"begin;", "select * from t;", "insert into t values (3001, 3001);"}));
+        results = receive_frame(framed);
+        CHECK(results.size() == 3);
+        CHECK(results[1].find("abort") != std::string::npos && results[2].find("abort") != std::string::npos);
+        client.query("commit;");
+        CHECK(num_records(client.query("select * from t where id = 3000;")) == 1);
+        CHECK(num_records(client.query("select * from t where id = 3001;")) == 0);
+
+        // 失控的连接查询：比较次数为三张表大小之积，没有结果
+        for (std::string tab : {"x", "y", "z"}) {
+            client.query("create table " + tab + " (id int, v int);");
+            for (int i = 0; i < RUNAWAY_TABLE_SIZE; i++) {
+                client.query("insert into " + tab + " values (" + std::to_string(i) + ", " + (tab == "z" ? "2" : "1") +
+                             ");");
+            }
+        }
+        std::string runaway = "select * from x, y, z where x.v = y.v and y.v = z.v;";
+
+        // 超过statement_timeout的语句中止所在的事务，之前的修改回滚
+        client.query("set statement_timeout = 200;");
+        client.query("begin;");
+        client.query("insert into t values (4000, 4000);");
+        auto start = std::chrono::steady_clock::now();
+        CHECK(client.query(runaway).find("abort") != std::string::npos);
+        CHECK(std::chrono::steady_clock::now() - start < std::chrono::seconds(10));
+        CHECK(num_records(client.query("select * from t where id = 4000;")) == 0);
+        client.query("set statement_timeout = 0;");
+
+        // 其他连接取消正在执行的语句，锁被释放
+        std::string sessions = client.query("show sessions;");
+        size_t pos = sessions.rfind('|', sessions.find(" (current)"));
+        std::string session_id = std::to_string(std::stoi(sessions.substr(pos + 1)));
+        std::thread canceler([&] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(300));
+            CHECK(clients[1]->query("cancel " + session_id + ";").find("rror") == std::string::npos);
+        });
+        client.query("begin;");
+        client.query("insert into t values (4001, 4001);");
+        start = std::chrono::steady_clock::now();
+        CHECK(client.query(runaway).find("abort") != std::string::npos);
+        CHECK(std::chrono::steady_clock::now() - start < std::chrono::seconds(10));
+        canceler.join();
+        CHECK(clients[1]->query("insert into t values (4002, 4002);").find("abort") == std::string::npos);
+        CHECK(num_records(client.query("select * from t where id = 4001;")) == 0);
+        CHECK(num_records(client.query("select * from t where id = 4002;")) == 1);
+        CHECK(clients[1]->query("cancel 100000;").find("rror") != std::string::npos);
+
+        // 多于工作线程数量的客户端连续发送查询但不读取结果，结果留在会话中等待连接可写，其他连接的请求仍然能执行
+        std::string help = client.query("help;");
+        std::string requests;
+        for (int i = 0; i < NUM_STALLED_REQUESTS; i++) {
+            requests += std::string("help;") + '\0';
+        }
+        std::vector<std::unique_ptr<Client>> stalled;
+        for (int i = 0; i < NUM_STALLED_CLIENTS; i++) {
+            stalled.push_back(std::make_unique<Client>(port, 4096));
+            stalled.back()->send_raw(requests);
+        }
+        // 所有会话上的请求都已经执行完，结果开始发送
+        for (auto &c : stalled) {
+            c->wait_readable();
+        }
+        CHECK(num_records(client.query("select * from t where id = 4002;")) == 1);
+        for (auto &c : stalled) {
+            for (int i = 0; i < NUM_STALLED_REQUESTS; i++) {
+                CHECK(c->receive() == help);
+            }
+        }
+    }
+    stop_server(server);
+
+    // wait-die下多于工作线程数量的年老事务等待一个年轻事务持有的锁，年轻事务的提交和其他连接的请求仍然能执行
+    server = start_server(dir, {"--port=" + std::to_string(port), "2pl", "wait_die"});
+    {
+        Client client(port);
+        client.query("create table w (id int, v int);");
+        client.query("insert into w values (0, 0);");
+        std::vector<std::unique_ptr<Client>> waiters;
+        for (int i = 0; i < NUM_LOCK_WAITERS; i++) {
+            waiters.push_back(std::make_unique<Client>(port));
+            waiters.back()->query("begin;");
+        }
+        Client timed(port);
+        timed.query("set statement_timeout = 200;");
+        timed.query("begin;");
+        Client young(port);
+        young.query("begin;");
+        CHECK(young.query("update w set v = -1 where id = 0;").find("abort") == std::string::npos);
+        // 等待锁的语句同样受statement_timeout限制
+        auto start = std::chrono::steady_clock::now();
+        CHECK(timed.query("update w set v = 1 where id = 0;").find("abort") != std::string::npos);
+        CHECK(std::chrono::steady_clock::now() - start < std::chrono::seconds(10));
+        // 从较年轻的事务开始排队，排在后面的事务更年老，都可以等待
+        for (int i = NUM_LOCK_WAITERS - 1; i >= 0; i--) {
+            waiters[i]->send_raw("update w set v = " + std::to_string(i) + " where id = 0;" + '\0');
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+        CHECK(client.query("show sessions;").find(" (current)") != std::string::npos);
+        CHECK(young.query("commit;").find("abort") == std::string::npos);
+        // 等待者同时得到表上的S锁，之后只有一个能升级为SIX锁，其余因升级冲突回滚，但都会得到结果
+        int updated = 0;
+        for (int i = NUM_LOCK_WAITERS - 1; i >= 0; i--) {
+            if (waiters[i]->receive().find("abort") == std::string::npos) {
+                updated++;
+            }
+            waiters[i]->query("commit;");
+        }
+        CHECK(updated >= 1);
+        CHECK(num_records(client.query("select * from w where v = -1;")) == 0);
+    }
+    stop_server(server);
+
+    // MVCC的修改不写日志，没有显式指定--unlogged时拒绝启动
+    server = start_server(dir, {"--port=" + std::to_string(port), "mvcc"});
+    int status = wait_server(server);
+    CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 1);
+    server = start_server(dir, {"--port=" + std::to_string(port), "mvcc", "--unlogged"});
+    {
+        Client client(port);
+        CHECK(num_records(client.query("select * from t where id = 4002;")) == 1);
+    }
+    stop_server(server);
+    run_command("rm -rf " + dir);
+    std::cout << "server test passed" << std::endl;
+    return 0;
+}
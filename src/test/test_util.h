@@ -0,0 +1,180 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/prctl.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 启动rmdb进程并通过网络执行SQL的测试共用的工具
+
+/* 测试中的检查：与assert不同，定义NDEBUG时同样求值，条件中可以有副作用 */
+#define CHECK(cond)                                                                             \
+    do {                                                                                        \
+        if (!(cond)) {                                                                          \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": check failed: " << #cond << std::endl; \
+            abort();                                                                            \
+        }                                                                                       \
+    } while (0)
+
+/* 被测试的rmdb可执行文件，由main从命令行参数中设置 */
+inline std::string rmdb_path;
+
+/* 执行一条shell命令，失败时测试失败 */
+inline void run_command(const std::string &command) {
+    int status = system(command.c_str());
+    CHECK(status == 0);
+}
+
+/* 在目录dir中启动一个rmdb进程，输出写入dir/server.log */
+inline pid_t start_server(const std::string &dir, const std::vector<std::string> &options) {
+    pid_t pid = fork();
+    CHECK(pid >= 0);
+    if (pid == 0) {
+        // 测试失败退出时结束rmdb进程
+        prctl(PR_SET_PDEATHSIG, SIGKILL);
+        if (chdir(dir.c_str()) < 0) {
+            _exit(1);
+        }
+        int fd = open("server.log", O_WRONLY | O_CREAT | O_APPEND, 0644);
+        dup2(fd, STDOUT_FILENO);
+        dup2(fd, STDERR_FILENO);
+        std::vector<char *> argv = {const_cast<char *>(rmdb_path.c_str()), const_cast<char *>("db")};
+        for (auto &option : options) {
+            argv.push_back(const_cast<char *>(option.c_str()));
+        }
+        argv.push_back(nullptr);
+        execv(rmdb_path.c_str(), argv.data());
+        _exit(1);
+    }
+    return pid;
+}
+
+/* 等待rmdb进程退出，返回waitpid得到的状态 */
+inline int wait_server(pid_t pid) {
+    int status;
+    pid_t waited = waitpid(pid, &status, 0);
+    CHECK(waited == pid);
+    return status;
+}
+
+/* 正常关闭rmdb进程，关闭时写回所有脏页 */
+inline void stop_server(pid_t pid) {
+    kill(pid, SIGINT);
+    wait_server(pid);
+}
+
+/* 模拟崩溃：用SIGKILL结束rmdb进程，缓冲池中的脏页和没有持久化的日志都丢失 */
+inline void crash_server(pid_t pid) {
+    kill(pid, SIGKILL);
+    wait_server(pid);
+}
+
+/* 一个客户端连接，发送以'\0'结尾的SQL，读取以'\0'结尾的结果 */
+class Client {
+   public:
+    /* receive_buffer不为0时在连接之前设置接收缓冲区的大小，模拟读取结果很慢的客户端 */
+    explicit Client(int port, int receive_buffer = 0) {
+        for (int i = 0; i < 100; i++) {
+            fd_ = socket(AF_INET, SOCK_STREAM, 0);
+            if (receive_buffer > 0) {
+                setsockopt(fd_, SOL_SOCKET, SO_RCVBUF, &receive_buffer, sizeof(receive_buffer));
+            }
+            sockaddr_in addr{};
+            addr.sin_family = AF_INET;
+            addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            addr.sin_port = htons(port);
+            if (connect(fd_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == 0) {
+                return;
+            }
+            close(fd_);
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+        CHECK(false && "cannot connect to rmdb");
+    }
+
+    ~Client() { close(fd_); }
+
+    /* 发送原始数据，可以是不完整的请求或者多个请求 */
+    void send_raw(const std::string &data) {
+        size_t sent = 0;
+        while (sent < data.size()) {
+            ssize_t len = write(fd_, data.data() + sent, data.size() - sent);
+            CHECK(len > 0);
+            sent += len;
+        }
+    }
+
+    /* 读取一个以'\0'结尾的结果 */
+    std::string receive() {
+        while (pending_.find('\0') == std::string::npos) {
+            fill();
+        }
+        size_t pos = pending_.find('\0');
+        std::string result = pending_.substr(0, pos);
+        pending_.erase(0, pos + 1);
+        return result;
+    }
+
+    std::string query(const std::string &sql) {
+        send_raw(std::string(sql.c_str(), sql.size() + 1));
+        return receive();
+    }
+
+    /* 等待连接上有结果到达，不读取它 */
+    void wait_readable() {
+        pollfd pfd{fd_, POLLIN, 0};
+        CHECK(poll(&pfd, 1, -1) == 1);
+    }
+
+    /* 读取n个字节 */
+    std::string receive_bytes(size_t n) {
+        while (pending_.size() < n) {
+            fill();
+        }
+        std::string result = pending_.substr(0, n);
+        pending_.erase(0, n);
+        return result;
+    }
+
+   private:
+    /* 从连接上读取一次数据，追加到pending_ */
+    void fill() {
+        char buf[8192];
+        ssize_t len = read(fd_, buf, sizeof(buf));
+        CHECK(len > 0);
+        pending_.append(buf, len);
+    }
+
+    int fd_;
+    std::string pending_;  // 已经读到、还没有返回的结果
+};
+
+/* select语句返回的记录数 */
+inline int num_records(const std::string &result) {
+    size_t pos = result.find("Total record(s): ");
+    CHECK(pos != std::string::npos);
+    return std::stoi(result.substr(pos + strlen("Total record(s): ")));
+}
@@ -10,6 +10,12 @@ See the Mulan PSL v2 for more details. */
 
 #include "lock_manager.h"
 
+#include <functional>
+
+#include "common/context.h"
+
+std::chrono::milliseconds cycle_detection_interval = std::chrono::milliseconds(50);
+
 /**
  * @description: 申请行级共享锁
  * @return {bool} 加锁是否成功
@@ -17,9 +23,8 @@ See the Mulan PSL v2 for more details. */
  * @param {Rid&} rid 加锁的目标记录ID 记录所在的表的fd
  * @param {int} tab_fd
  */
-bool LockManager::lock_shared_on_record(Transaction* txn, const Rid& rid, int tab_fd) {
-    
-    return true;
+bool LockManager::lock_shared_on_record(Transaction* txn, const Rid& rid, int tab_fd, Context* context) {
+    return lock_on_record(txn, rid, tab_fd, LockMode::SHARED, context);
 }
 
 /**
@@ -29,9 +34,8 @@ bool LockManager::lock_shared_on_record(Transaction* txn, const Rid& rid, int ta
  * @param {Rid&} rid 加锁的目标记录ID
  * @param {int} tab_fd 记录所在的表的fd
  */
-bool LockManager::lock_exclusive_on_record(Transaction* txn, const Rid& rid, int tab_fd) {
-
-    return true;
+bool LockManager::lock_exclusive_on_record(Transaction* txn, const Rid& rid, int tab_fd, Context* context) {
+    return lock_on_record(txn, rid, tab_fd, LockMode::EXLUCSIVE, context);
 }
 
 /**
@@ -40,9 +44,8 @@ bool LockManager::lock_exclusive_on_record(Transaction* txn, const Rid& rid, int
  * @param {Transaction*} txn 要申请锁的事务对象指针
  * @param {int} tab_fd 目标表的fd
  */
-bool LockManager::lock_shared_on_table(Transaction* txn, int tab_fd) {
-    
-    return true;
+bool LockManager::lock_shared_on_table(Transaction* txn, int tab_fd, Context* context) {
+    return lock(txn, LockDataId(tab_fd, LockDataType::TABLE), LockMode::SHARED, context);
 }
 
 /**
@@ -51,9 +54,8 @@ bool LockManager::lock_shared_on_table(Transaction* txn, int tab_fd) {
  * @param {Transaction*} txn 要申请锁的事务对象指针
  * @param {int} tab_fd 目标表的fd
  */
-bool LockManager::lock_exclusive_on_table(Transaction* txn, int tab_fd) {
-    
-    return true;
+bool LockManager::lock_exclusive_on_table(Transaction* txn, int tab_fd, Context* context) {
+    return lock(txn, LockDataId(tab_fd, LockDataType::TABLE), LockMode::EXLUCSIVE, context);
 }
 
 /**
@@ -62,9 +64,8 @@ bool LockManager::lock_exclusive_on_table(Transaction* txn, int tab_fd) {
  * @param {Transaction*} txn 要申请锁的事务对象指针
  * @param {int} tab_fd 目标表的fd
  */
-bool LockManager::lock_IS_on_table(Transaction* txn, int tab_fd) {
-    
-    return true;
+bool LockManager::lock_IS_on_table(Transaction* txn, int tab_fd, Context* context) {
+    return lock(txn, LockDataId(tab_fd, LockDataType::TABLE), LockMode::INTENTION_SHARED, context);
 }
 
 /**
@@ -73,9 +74,8 @@ bool LockManager::lock_IS_on_table(Transaction* txn, int tab_fd) {
  * @param {Transaction*} txn 要申请锁的事务对象指针
  * @param {int} tab_fd 目标表的fd
  */
-bool LockManager::lock_IX_on_table(Transaction* txn, int tab_fd) {
-    
-    return true;
+bool LockManager::lock_IX_on_table(Transaction* txn, int tab_fd, Context* context) {
+    return lock(txn, LockDataId(tab_fd, LockDataType::TABLE), LockMode::INTENTION_EXCLUSIVE, context);
 }
 
 /**
@@ -85,6 +85,545 @@ bool LockManager::lock_IX_on_table(Transaction* txn, int tab_fd) {
  * @param {LockDataId} lock_data_id 要释放的锁ID
  */
 bool LockManager::unlock(Transaction* txn, LockDataId lock_data_id) {
-   
+    if (txn->get_state() == TransactionState::GROWING) {
+        txn->set_state(TransactionState::SHRINKING);
+    }
+    bool res = release(txn, lock_data_id);
+    txn->get_lock_set()->erase(lock_data_id);
+    if (lock_data_id.type_ == LockDataType::RECORD) {
+        auto row_locks = txn->get_row_locks()->find(lock_data_id.fd_);
+        if (row_locks != txn->get_row_locks()->end() && row_locks->second.num_row_locks > 0) {
+            row_locks->second.num_row_locks--;
+        }
+    }
+    return res;
+}
+
+/**
+ * @description: 释放事务持有的所有锁，在事务提交或回滚时调用
+ * @param {Transaction*} txn 要释放锁的事务对象指针
+ */
+void LockManager::unlock_all(Transaction* txn) {
+    if (txn->get_state() == TransactionState::GROWING) {
+        txn->set_state(TransactionState::SHRINKING);
+    }
+    auto lock_set = txn->get_lock_set();
+    for (auto &lock_data_id : *lock_set) {
+        release(txn, lock_data_id);
+    }
+    lock_set->clear();
+    txn->get_row_locks()->clear();
+}
+
+/**
+ * @description: 申请行级锁，并统计事务在该表上持有的行锁数量；已持有覆盖该行锁的表锁时无需再加行锁，
+ * 行锁数量达到阈值时升级为表锁，避免大批量扫描或更新使锁表和事务的lock_set无限增长
+ * @return {bool} 加锁是否成功
+ * @param {Transaction*} txn 要申请锁的事务对象指针
+ * @param {Rid&} rid 加锁的目标记录ID
+ * @param {int} tab_fd 记录所在的表的fd
+ * @param {LockMode} lock_mode 行锁类型，SHARED或EXLUCSIVE
+ */
+bool LockManager::lock_on_record(Transaction* txn, const Rid& rid, int tab_fd, LockMode lock_mode, Context* context) {
+    TableRowLocks &row_locks = (*txn->get_row_locks())[tab_fd];
+    if (row_locks.escalated_exclusive || (lock_mode == LockMode::SHARED && row_locks.escalated_shared)) {
+        if (txn->get_state() == TransactionState::SHRINKING) {
+            throw TransactionAbortException(txn->get_transaction_id(), AbortReason::LOCK_ON_SHIRINKING);
+        }
+        return true;
+    }
+    if (row_locks.num_row_locks >= escalation_threshold_) {
+        escalate(txn, tab_fd, lock_mode, row_locks, context);
+        return true;
+    }
+    auto lock_set = txn->get_lock_set();
+    size_t num_locks = lock_set->size();
+    lock(txn, LockDataId(tab_fd, rid, LockDataType::RECORD), lock_mode, context);
+    if (lock_set->size() > num_locks) {
+        row_locks.num_row_locks++;
+    }
+    return true;
+}
+
+/**
+ * @description: 锁升级：在表上申请与行锁同类型的表锁，成功后释放被表锁覆盖的行锁。
+ * 表级S锁（与已有的IX锁合并为SIX）只覆盖行级S锁，行级X锁仍需保留；表级X锁覆盖全部行锁。不做锁降级
+ */
+void LockManager::escalate(Transaction* txn, int tab_fd, LockMode lock_mode, TableRowLocks &row_locks, Context* context) {
+    bool exclusive = lock_mode == LockMode::EXLUCSIVE;
+    lock(txn, LockDataId(tab_fd, LockDataType::TABLE), exclusive ? LockMode::EXLUCSIVE : LockMode::SHARED, context);
+    row_locks.escalated_shared = true;
+    row_locks.escalated_exclusive = exclusive;
+
+    auto lock_set = txn->get_lock_set();
+    row_locks.num_row_locks = 0;
+    for (auto iter = lock_set->begin(); iter != lock_set->end();) {
+        if (iter->type_ != LockDataType::RECORD || iter->fd_ != tab_fd) {
+            ++iter;
+        } else if (release(txn, *iter, !exclusive)) {
+            iter = lock_set->erase(iter);
+        } else {
+            row_locks.num_row_locks++;
+            ++iter;
+        }
+    }
+}
+
+/**
+ * @description: 加锁的通用流程：已持有更强的锁直接返回，已持有较弱的锁则原地升级；
+ * 与其他事务的锁冲突时按死锁处理策略回滚当前事务或在加锁队列上阻塞等待
+ * @return {bool} 加锁是否成功
+ * @param {Transaction*} txn 要申请锁的事务对象指针
+ * @param {LockDataId&} lock_data_id 加锁对象
+ * @param {LockMode} lock_mode 加锁类型
+ * @param {Context*} context 语句的上下文，阻塞等待期间检查语句是否被取消或者超时，为空时不检查
+ */
+bool LockManager::lock(Transaction* txn, const LockDataId& lock_data_id, LockMode lock_mode, Context* context) {
+    if (txn->get_state() == TransactionState::SHRINKING) {
+        throw TransactionAbortException(txn->get_transaction_id(), AbortReason::LOCK_ON_SHIRINKING);
+    }
+    if (txn->get_state() == TransactionState::DEFAULT) {
+        txn->set_state(TransactionState::GROWING);
+    }
+
+    txn_id_t txn_id = txn->get_transaction_id();
+    LockTableBucket &bucket = get_bucket(lock_data_id);
+    std::unique_lock<std::mutex> lock(bucket.latch_);
+    LockRequestQueue *queue = nullptr;
+    auto iter = bucket.lock_table_.find(lock_data_id);
+    if (iter != bucket.lock_table_.end()) {
+        queue = iter->second;
+    } else if (!bucket.free_queues_.empty()) {
+        queue = bucket.free_queues_.back();
+        bucket.free_queues_.pop_back();
+        bucket.lock_table_.emplace(lock_data_id, queue);
+    } else {
+        queue = &bucket.queue_pool_.emplace_back();
+        bucket.lock_table_.emplace(lock_data_id, queue);
+    }
+
+    auto find_own = [&]() {
+        return std::find_if(queue->request_queue_.begin(), queue->request_queue_.end(),
+                            [&](const LockRequest &request) { return request.txn_id_ == txn_id; });
+    };
+    auto own = find_own();
+    bool upgrade = own != queue->request_queue_.end();
+    LockMode target = lock_mode;
+    if (upgrade) {
+        if (covers(own->lock_mode_, lock_mode)) {
+            return true;
+        }
+        target = upgrade_mode(own->lock_mode_, lock_mode);
+        // 两个事务同时升级同一数据项上的锁必然互相等待
+        if (queue->upgrading_ != INVALID_TXN_ID) {
+            throw TransactionAbortException(txn_id, AbortReason::UPGRADE_CONFLICT);
+        }
+    } else {
+        // 新申请排在队尾，未授予之前也占据队列中的位置，保证先来先服务
+        queue->request_queue_.emplace_back(txn_id, target);
+    }
+
+    // 第一次阻塞等待前调用on_wait_，加锁成功或者抛出异常时调用on_wake_
+    struct WaitScope {
+        const std::function<void()> &on_wake;
+        bool waiting = false;
+        ~WaitScope() {
+            if (waiting && on_wake) {
+                on_wake();
+            }
+        }
+    } wait_scope{on_wake_};
+
+    std::vector<txn_id_t> blockers;
+    while (true) {
+        blockers.clear();
+        get_blockers(queue, txn_id, target, &blockers);
+        if (blockers.empty()) {
+            break;
+        }
+        DeadlockPolicy policy = deadlock_policy_;
+        bool die = policy == DeadlockPolicy::NO_WAIT;
+        if (policy == DeadlockPolicy::WAIT_DIE) {
+            // 事务ID单调递增，ID越小的事务越年老；只允许年老的事务等待年轻的事务
+            die = std::any_of(blockers.begin(), blockers.end(), [&](txn_id_t id) { return id < txn_id; });
+        }
+        if (die) {
+            cancel_request(bucket, lock_data_id, queue, upgrade ? INVALID_TXN_ID : txn_id);
+            throw TransactionAbortException(txn_id, upgrade ? AbortReason::UPGRADE_CONFLICT
+                                                            : AbortReason::DEADLOCK_PREVENTION);
+        }
+
+        if (upgrade) {
+            queue->upgrading_ = txn_id;
+            queue->upgrade_mode_ = target;
+        }
+        {
+            std::scoped_lock waits_lock{waits_latch_};
+            waiting_.insert_or_assign(txn_id, WaitingTxn{lock_data_id, false});
+        }
+        if (!wait_scope.waiting) {
+            wait_scope.waiting = true;
+            if (on_wait_) {
+                on_wait_();
+            }
+        }
+        std::exception_ptr interrupt;
+        try {
+            wait_on_queue(lock, queue, context);
+        } catch (TransactionAbortException &) {
+            interrupt = std::current_exception();
+        }
+        bool victim;
+        {
+            std::scoped_lock waits_lock{waits_latch_};
+            auto waiter = waiting_.find(txn_id);
+            victim = waiter->second.victim;
+            waiting_.erase(waiter);
+        }
+        if (upgrade) {
+            queue->upgrading_ = INVALID_TXN_ID;
+        }
+        // 语句被取消或者超时，撤销等待中的申请
+        if (interrupt) {
+            cancel_request(bucket, lock_data_id, queue, upgrade ? INVALID_TXN_ID : txn_id);
+            std::rethrow_exception(interrupt);
+        }
+        // 被死锁检测选为牺牲者
+        if (victim) {
+            cancel_request(bucket, lock_data_id, queue, upgrade ? INVALID_TXN_ID : txn_id);
+            throw TransactionAbortException(txn_id, AbortReason::DEADLOCK_DETECTED);
+        }
+    }
+
+    own = find_own();
+    own->lock_mode_ = target;
+    if (!upgrade) {
+        own->granted_ = true;
+        txn->get_lock_set()->insert(lock_data_id);
+    }
+    update_group_lock_mode(queue);
+    return true;
+}
+
+/**
+ * @description: 在加锁队列上阻塞等待一次唤醒。有语句上下文时最多等待LOCK_WAIT_CHECK_MS（不超过语句的超时时刻），
+ * 超时醒来时检查语句是否被取消或者超时，是则抛出事务中止异常，由调用者撤销加锁申请；
+ * 无论是否超时，调用者都重新检查能否加锁，超时时刻前后到达的唤醒不会丢失
+ * @param {unique_lock<mutex>&} lock 已持有的分区锁
+ * @param {Context*} context 语句的上下文，为空时一直等到被唤醒
+ */
+void LockManager::wait_on_queue(std::unique_lock<std::mutex>& lock, LockRequestQueue* queue, Context* context) {
+    if (context == nullptr) {
+        queue->cv_.wait(lock);
+        return;
+    }
+    auto until = std::min(std::chrono::steady_clock::now() + std::chrono::milliseconds(LOCK_WAIT_CHECK_MS),
+                          context->deadline_);
+    if (queue->cv_.wait_until(lock, until) == std::cv_status::timeout) {
+        context->check_interrupt_now();
+    }
+}
+
+/**
+ * @description: 从加锁队列中移除事务的加锁申请，队列为空时归还到分区的对象池
+ * @param {bool} shared_only 为true时只移除SHARED类型的锁，用于锁升级
+ */
+bool LockManager::release(Transaction* txn, const LockDataId& lock_data_id, bool shared_only) {
+    LockTableBucket &bucket = get_bucket(lock_data_id);
+    std::unique_lock<std::mutex> lock(bucket.latch_);
+    auto iter = bucket.lock_table_.find(lock_data_id);
+    if (iter == bucket.lock_table_.end()) {
+        return false;
+    }
+    LockRequestQueue *queue = iter->second;
+    auto &requests = queue->request_queue_;
+    auto pos = std::find_if(requests.begin(), requests.end(), [&](const LockRequest &request) {
+        return request.txn_id_ == txn->get_transaction_id();
+    });
+    if (pos == requests.end() || (shared_only && pos->lock_mode_ != LockMode::SHARED)) {
+        return false;
+    }
+    requests.erase(pos);
+    if (requests.empty()) {
+        queue->group_lock_mode_ = GroupLockMode::NON_LOCK;
+        bucket.lock_table_.erase(iter);
+        bucket.free_queues_.push_back(queue);
+        return true;
+    }
+    update_group_lock_mode(queue);
+    queue->cv_.notify_all();
     return true;
-}
\ No newline at end of file
+}
+
+/**
+ * @description: 撤销一个未授予的加锁申请并唤醒排在其后的申请
+ * @param {txn_id_t} txn_id 要撤销申请的事务，为INVALID_TXN_ID时只唤醒等待者（锁升级失败时原有的锁仍保留）
+ */
+void LockManager::cancel_request(LockTableBucket &bucket, const LockDataId &lock_data_id, LockRequestQueue *queue,
+                                 txn_id_t txn_id) {
+    auto &requests = queue->request_queue_;
+    if (txn_id != INVALID_TXN_ID) {
+        requests.erase(std::find_if(requests.begin(), requests.end(),
+                                    [&](const LockRequest &request) { return request.txn_id_ == txn_id; }));
+    }
+    if (requests.empty()) {
+        queue->group_lock_mode_ = GroupLockMode::NON_LOCK;
+        bucket.lock_table_.erase(lock_data_id);
+        bucket.free_queues_.push_back(queue);
+        return;
+    }
+    queue->cv_.notify_all();
+}
+
+/**
+ * @description: 找出阻塞事务txn_id以target模式加锁的其他事务：与之冲突的已授予的锁、正在等待的锁升级，
+ * 以及排在它前面且与之冲突的等待申请；锁升级只需要与已授予的锁相容
+ * @param {vector<txn_id_t>*} blockers 输出参数，为空表示可以立即授予
+ */
+void LockManager::get_blockers(const LockRequestQueue *queue, txn_id_t txn_id, LockMode target,
+                               std::vector<txn_id_t> *blockers) {
+    bool upgrade = false;
+    for (auto &request : queue->request_queue_) {
+        if (request.txn_id_ == txn_id) {
+            upgrade = request.granted_;
+            break;
+        }
+    }
+    if (!upgrade && queue->upgrading_ != INVALID_TXN_ID && !is_compatible(queue->upgrade_mode_, target)) {
+        blockers->push_back(queue->upgrading_);
+    }
+    for (auto &request : queue->request_queue_) {
+        if (request.txn_id_ == txn_id) {
+            if (!upgrade) {
+                break;
+            }
+            continue;
+        }
+        if (upgrade && !request.granted_) {
+            continue;
+        }
+        if (!is_compatible(request.lock_mode_, target)) {
+            blockers->push_back(request.txn_id_);
+        }
+    }
+}
+
+/**
+ * @description: 启动后台死锁检测线程，每隔cycle_detection_interval检测一次等待图
+ */
+void LockManager::start_deadlock_detection() {
+    std::scoped_lock lock{detector_latch_};
+    if (detector_running_) {
+        return;
+    }
+    detector_running_ = true;
+    detector_thread_ = std::thread([this]() {
+        std::unique_lock<std::mutex> lock(detector_latch_);
+        while (detector_running_) {
+            detector_cv_.wait_for(lock, cycle_detection_interval, [this]() { return !detector_running_; });
+            if (!detector_running_) {
+                break;
+            }
+            lock.unlock();
+            run_cycle_detection();
+            lock.lock();
+        }
+    });
+}
+
+void LockManager::stop_deadlock_detection() {
+    {
+        std::scoped_lock lock{detector_latch_};
+        if (!detector_running_) {
+            return;
+        }
+        detector_running_ = false;
+    }
+    detector_cv_.notify_all();
+    detector_thread_.join();
+}
+
+/**
+ * @description: 进行一轮死锁检测：根据正在等待的事务构造等待图，每找到一个环就回滚环中最年轻（ID最大）的事务，
+ * 直到等待图中没有环为止。牺牲者被标记并唤醒，由它自己的线程撤销加锁申请并抛出异常
+ */
+void LockManager::run_cycle_detection() {
+    std::vector<std::pair<txn_id_t, WaitingTxn>> waiting;
+    {
+        std::scoped_lock lock{waits_latch_};
+        waiting.assign(waiting_.begin(), waiting_.end());
+    }
+    std::map<txn_id_t, std::vector<txn_id_t>> graph;
+    std::unordered_map<txn_id_t, WaitingTxn> waiters;
+    for (auto &[txn_id, waiter] : waiting) {
+        LockTableBucket &bucket = get_bucket(waiter.lock_data_id);
+        std::scoped_lock lock{bucket.latch_};
+        auto iter = bucket.lock_table_.find(waiter.lock_data_id);
+        if (iter == bucket.lock_table_.end()) {
+            continue;
+        }
+        LockRequestQueue *queue = iter->second;
+        LockMode target;
+        if (queue->upgrading_ == txn_id) {
+            target = queue->upgrade_mode_;
+        } else {
+            auto pos = std::find_if(queue->request_queue_.begin(), queue->request_queue_.end(),
+                                    [&](const LockRequest &request) { return request.txn_id_ == txn_id; });
+            if (pos == queue->request_queue_.end() || pos->granted_) {
+                continue;
+            }
+            target = pos->lock_mode_;
+        }
+        auto &edges = graph[txn_id];
+        get_blockers(queue, txn_id, target, &edges);
+        std::sort(edges.begin(), edges.end());
+        waiters.emplace(txn_id, waiter);
+    }
+
+    txn_id_t victim;
+    while (find_cycle(graph, &victim)) {
+        graph.erase(victim);
+        for (auto &[txn_id, edges] : graph) {
+            edges.erase(std::remove(edges.begin(), edges.end(), victim), edges.end());
+        }
+        // 构造等待图之后牺牲者可能已经获得锁，只有仍在等待同一数据项时才回滚它
+        WaitingTxn &waiter = waiters.at(victim);
+        LockTableBucket &bucket = get_bucket(waiter.lock_data_id);
+        std::scoped_lock lock{bucket.latch_};
+        {
+            std::scoped_lock waits_lock{waits_latch_};
+            auto iter = waiting_.find(victim);
+            if (iter == waiting_.end() || !(iter->second.lock_data_id == waiter.lock_data_id)) {
+                continue;
+            }
+            iter->second.victim = true;
+        }
+        bucket.lock_table_.at(waiter.lock_data_id)->cv_.notify_all();
+    }
+}
+
+/**
+ * @description: 按事务ID从小到大深度优先搜索等待图，找到环时返回环中ID最大的事务
+ * @return {bool} 是否存在环
+ */
+bool LockManager::find_cycle(const std::map<txn_id_t, std::vector<txn_id_t>> &graph, txn_id_t *victim) {
+    std::unordered_map<txn_id_t, int> color;   // 0: 未访问 1: 在搜索路径上 2: 已完成
+    std::vector<txn_id_t> path;
+    std::function<bool(txn_id_t)> dfs = [&](txn_id_t u) {
+        color[u] = 1;
+        path.push_back(u);
+        auto iter = graph.find(u);
+        if (iter != graph.end()) {
+            for (txn_id_t v : iter->second) {
+                if (color[v] == 1) {
+                    auto begin = std::find(path.begin(), path.end(), v);
+                    *victim = *std::max_element(begin, path.end());
+                    return true;
+                }
+                if (color[v] == 0 && dfs(v)) {
+                    return true;
+                }
+            }
+        }
+        color[u] = 2;
+        path.pop_back();
+        return false;
+    };
+    for (auto &[txn_id, edges] : graph) {
+        if (color[txn_id] == 0 && dfs(txn_id)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+LockManager::LockTableBucket &LockManager::get_bucket(const LockDataId& lock_data_id) {
+    // std::hash<int64_t>是恒等映射，先混合高低位，避免同一张表的记录集中在少数分区
+    uint64_t h = static_cast<uint64_t>(lock_data_id.Get());
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return buckets_[h % LOCK_TABLE_BUCKETS];
+}
+
+/**
+ * @description: 锁相容矩阵，held为其他事务已持有的锁，requested为当前申请的锁
+ */
+bool LockManager::is_compatible(LockMode held, LockMode requested) {
+    switch (held) {
+        case LockMode::INTENTION_SHARED:
+            return requested != LockMode::EXLUCSIVE;
+        case LockMode::INTENTION_EXCLUSIVE:
+            return requested == LockMode::INTENTION_SHARED || requested == LockMode::INTENTION_EXCLUSIVE;
+        case LockMode::SHARED:
+            return requested == LockMode::INTENTION_SHARED || requested == LockMode::SHARED;
+        case LockMode::S_IX:
+            return requested == LockMode::INTENTION_SHARED;
+        case LockMode::EXLUCSIVE:
+            return false;
+    }
+    return false;
+}
+
+/**
+ * @description: 已持有的锁held是否包含了申请的锁requested的全部权限
+ */
+bool LockManager::covers(LockMode held, LockMode requested) {
+    if (held == requested || held == LockMode::EXLUCSIVE) {
+        return true;
+    }
+    switch (held) {
+        case LockMode::S_IX:
+            return requested != LockMode::EXLUCSIVE;
+        case LockMode::SHARED:
+        case LockMode::INTENTION_EXCLUSIVE:
+            return requested == LockMode::INTENTION_SHARED;
+        default:
+            return false;
+    }
+}
+
+/**
+ * @description: 锁升级后的类型，为held和requested在锁强度格上的最小上界，S与IX合并为SIX
+ */
+LockManager::LockMode LockManager::upgrade_mode(LockMode held, LockMode requested) {
+    if (covers(held, requested)) {
+        return held;
+    }
+    if (covers(requested, held)) {
+        return requested;
+    }
+    if (requested == LockMode::EXLUCSIVE || held == LockMode::EXLUCSIVE) {
+        return LockMode::EXLUCSIVE;
+    }
+    return LockMode::S_IX;
+}
+
+void LockManager::update_group_lock_mode(LockRequestQueue *queue) {
+    bool has_is = false, has_ix = false, has_s = false, has_six = false, has_x = false;
+    for (auto &request : queue->request_queue_) {
+        if (!request.granted_) {
+            continue;
+        }
+        switch (request.lock_mode_) {
+            case LockMode::INTENTION_SHARED: has_is = true; break;
+            case LockMode::INTENTION_EXCLUSIVE: has_ix = true; break;
+            case LockMode::SHARED: has_s = true; break;
+            case LockMode::S_IX: has_six = true; break;
+            case LockMode::EXLUCSIVE: has_x = true; break;
+        }
+    }
+    if (has_x) {
+        queue->group_lock_mode_ = GroupLockMode::X;
+    } else if (has_six || (has_s && has_ix)) {
+        queue->group_lock_mode_ = GroupLockMode::SIX;
+    } else if (has_s) {
+        queue->group_lock_mode_ = GroupLockMode::S;
+    } else if (has_ix) {
+        queue->group_lock_mode_ = GroupLockMode::IX;
+    } else if (has_is) {
+        queue->group_lock_mode_ = GroupLockMode::IS;
+    } else {
+        queue->group_lock_mode_ = GroupLockMode::NON_LOCK;
+    }
+}
@@ -10,12 +10,28 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <mutex>
 #include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 #include "transaction/transaction.h"
 
+class Context;
+
 static const std::string GroupLockModeStr[10] = {"NON_LOCK", "IS", "IX", "S", "X", "SIX"};
 
+static constexpr size_t LOCK_TABLE_BUCKETS = 256;   // 锁表的分区数量，每个分区有独立的锁
+static constexpr size_t LOCK_ESCALATION_THRESHOLD = 1024;   // 事务在一张表上的行锁超过该数量后升级为表锁
+
+/* 死锁处理策略：冲突时直接回滚；wait-die（年老的事务等待，年轻的事务回滚）；阻塞等待并由后台线程检测等待图中的环 */
+enum class DeadlockPolicy { NO_WAIT = 0, WAIT_DIE, DETECTION };
+
 class LockManager {
     /* 加锁类型，包括共享锁、排他锁、意向共享锁、意向排他锁、SIX（意向排他锁+共享锁） */
     enum class LockMode { SHARED, EXLUCSIVE, INTENTION_SHARED, INTENTION_EXCLUSIVE, S_IX };
@@ -34,34 +50,112 @@ class LockManager {
         bool granted_;          // 该事务是否已经被赋予锁
     };
 
-    /* 数据项上的加锁队列 */
+    /* 数据项上的加锁队列，队列对象由所在分区的对象池分配，回收时保留request_queue_的容量 */
     class LockRequestQueue {
     public:
-        std::list<LockRequest> request_queue_;  // 加锁队列
+        std::vector<LockRequest> request_queue_;  // 加锁队列
         std::condition_variable cv_;            // 条件变量，用于唤醒正在等待加锁的申请，在no-wait策略下无需使用
         GroupLockMode group_lock_mode_ = GroupLockMode::NON_LOCK;   // 加锁队列的锁模式
+        txn_id_t upgrading_ = INVALID_TXN_ID;   // 正在等待锁升级的事务，同一时刻只允许一个
+        LockMode upgrade_mode_ = LockMode::SHARED;  // 锁升级的目标类型
+    };
+
+    /* 锁表的一个分区：按LockDataId的哈希值划分，不同分区的加锁和解锁互不阻塞 */
+    class LockTableBucket {
+    public:
+        std::mutex latch_;                                              // 用于本分区的并发
+        std::unordered_map<LockDataId, LockRequestQueue *> lock_table_; // 本分区的锁表
+        std::deque<LockRequestQueue> queue_pool_;                       // 本分区分配过的加锁队列
+        std::vector<LockRequestQueue *> free_queues_;                   // 空闲的加锁队列
     };
 
 public:
     LockManager() {}
 
-    ~LockManager() {}
+    ~LockManager() { stop_deadlock_detection(); }
+
+    void set_deadlock_policy(DeadlockPolicy policy) { deadlock_policy_ = policy; }
+
+    DeadlockPolicy get_deadlock_policy() const { return deadlock_policy_; }
 
-    bool lock_shared_on_record(Transaction* txn, const Rid& rid, int tab_fd);
+    void set_escalation_threshold(size_t threshold) { escalation_threshold_ = threshold; }
 
-    bool lock_exclusive_on_record(Transaction* txn, const Rid& rid, int tab_fd);
+    /**
+     * @description: 设置线程开始和结束阻塞等待锁时的回调，服务端的线程池据此补充工作线程，
+     * 等待中的请求不会占满线程池而使持有锁的事务无法提交
+     */
+    void set_wait_hooks(std::function<void()> on_wait, std::function<void()> on_wake) {
+        on_wait_ = std::move(on_wait);
+        on_wake_ = std::move(on_wake);
+    }
 
-    bool lock_shared_on_table(Transaction* txn, int tab_fd);
+    void start_deadlock_detection();
 
-    bool lock_exclusive_on_table(Transaction* txn, int tab_fd);
+    void stop_deadlock_detection();
 
-    bool lock_IS_on_table(Transaction* txn, int tab_fd);
+    void run_cycle_detection();
 
-    bool lock_IX_on_table(Transaction* txn, int tab_fd);
+    bool lock_shared_on_record(Transaction* txn, const Rid& rid, int tab_fd, Context* context = nullptr);
+
+    bool lock_exclusive_on_record(Transaction* txn, const Rid& rid, int tab_fd, Context* context = nullptr);
+
+    bool lock_shared_on_table(Transaction* txn, int tab_fd, Context* context = nullptr);
+
+    bool lock_exclusive_on_table(Transaction* txn, int tab_fd, Context* context = nullptr);
+
+    bool lock_IS_on_table(Transaction* txn, int tab_fd, Context* context = nullptr);
+
+    bool lock_IX_on_table(Transaction* txn, int tab_fd, Context* context = nullptr);
 
     bool unlock(Transaction* txn, LockDataId lock_data_id);
 
+    void unlock_all(Transaction* txn);
+
 private:
-    std::mutex latch_;      // 用于锁表的并发
-    std::unordered_map<LockDataId, LockRequestQueue> lock_table_;   // 全局锁表
+    bool lock(Transaction* txn, const LockDataId& lock_data_id, LockMode lock_mode, Context* context);
+
+    void wait_on_queue(std::unique_lock<std::mutex>& lock, LockRequestQueue* queue, Context* context);
+
+    bool release(Transaction* txn, const LockDataId& lock_data_id, bool shared_only = false);
+
+    bool lock_on_record(Transaction* txn, const Rid& rid, int tab_fd, LockMode lock_mode, Context* context);
+
+    void escalate(Transaction* txn, int tab_fd, LockMode lock_mode, TableRowLocks &row_locks, Context* context);
+
+    LockTableBucket &get_bucket(const LockDataId& lock_data_id);
+
+    static bool is_compatible(LockMode held, LockMode requested);
+
+    static bool covers(LockMode held, LockMode requested);
+
+    static LockMode upgrade_mode(LockMode held, LockMode requested);
+
+    static void update_group_lock_mode(LockRequestQueue *queue);
+
+    static void get_blockers(const LockRequestQueue *queue, txn_id_t txn_id, LockMode target,
+                             std::vector<txn_id_t> *blockers);
+
+    void cancel_request(LockTableBucket &bucket, const LockDataId &lock_data_id, LockRequestQueue *queue,
+                        txn_id_t txn_id);
+
+    static bool find_cycle(const std::map<txn_id_t, std::vector<txn_id_t>> &graph, txn_id_t *victim);
+
+    LockTableBucket buckets_[LOCK_TABLE_BUCKETS];   // 分区锁表
+    std::atomic<DeadlockPolicy> deadlock_policy_{DeadlockPolicy::NO_WAIT};
+    size_t escalation_threshold_ = LOCK_ESCALATION_THRESHOLD;
+    std::function<void()> on_wait_;             // 开始阻塞等待锁时调用
+    std::function<void()> on_wake_;             // 结束阻塞等待时调用
+
+    /* 正在阻塞等待的事务及其等待的数据项，供死锁检测构造等待图；加锁顺序为分区锁在前，waits_latch_在后 */
+    struct WaitingTxn {
+        LockDataId lock_data_id;
+        bool victim;        // 被死锁检测选为牺牲者，唤醒后需要回滚
+    };
+    std::mutex waits_latch_;
+    std::unordered_map<txn_id_t, WaitingTxn> waiting_;
+
+    std::thread detector_thread_;               // 后台死锁检测线程
+    bool detector_running_ = false;
+    std::mutex detector_latch_;
+    std::condition_variable detector_cv_;
 };
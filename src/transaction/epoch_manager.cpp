@@ -0,0 +1,128 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "transaction/epoch_manager.h"
+
+#include "errors.h"
+
+namespace {
+
+// 线程槽位号在进程内全局分配，线程退出时归还，所有EpochManager共用同一个槽位号
+std::atomic<bool> thread_slot_used[EPOCH_MAX_THREADS];
+
+struct ThreadSlot {
+    int slot_no = -1;
+
+    ThreadSlot() {
+        for (int i = 0; i < EPOCH_MAX_THREADS; i++) {
+            bool expected = false;
+            if (!thread_slot_used[i].load() && thread_slot_used[i].compare_exchange_strong(expected, true)) {
+                slot_no = i;
+                return;
+            }
+        }
+    }
+
+    ~ThreadSlot() {
+        if (slot_no >= 0) {
+            thread_slot_used[slot_no].store(false);
+        }
+    }
+};
+
+int current_thread_slot() {
+    thread_local ThreadSlot slot;
+    if (slot.slot_no < 0) {
+        throw InternalError("too many threads for epoch based reclamation");
+    }
+    return slot.slot_no;
+}
+
+}  // namespace
+
+EpochManager::~EpochManager() {
+    for (auto &retired : retired_) {
+        retired.deleter_(retired.ptr_);
+    }
+}
+
+/**
+ * @description: 当前线程进入纪元，此后读到的共享对象在exit之前不会被释放
+ */
+void EpochManager::enter() {
+    ThreadRecord &record = records_[current_thread_slot()];
+    if (record.depth_++ == 0) {
+        // 先发布本线程的纪元再访问共享结构，回收线程推进纪元时一定能看到
+        record.epoch_.store(global_epoch_.load());
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+}
+
+/**
+ * @description: 当前线程退出纪元，最外层退出后不再阻止纪元推进
+ */
+void EpochManager::exit() {
+    ThreadRecord &record = records_[current_thread_slot()];
+    if (--record.depth_ == 0) {
+        record.epoch_.store(INACTIVE_EPOCH, std::memory_order_release);
+    }
+}
+
+void EpochManager::retire(void *ptr, void (*deleter)(void *)) {
+    std::scoped_lock lock{retired_latch_};
+    // 对象已经从共享结构中摘除，此后进入的线程都读不到它
+    retired_.push_back({ptr, deleter, global_epoch_.load()});
+}
+
+/**
+ * @description: 所有活跃线程都已观察到当前纪元时推进全局纪元
+ * @return {bool} 是否推进成功
+ */
+bool EpochManager::try_advance() {
+    uint64_t epoch = global_epoch_.load();
+    for (int i = 0; i < EPOCH_MAX_THREADS; i++) {
+        uint64_t thread_epoch = records_[i].epoch_.load();
+        if (thread_epoch != INACTIVE_EPOCH && thread_epoch != epoch) {
+            return false;
+        }
+    }
+    return global_epoch_.compare_exchange_strong(epoch, epoch + 1);
+}
+
+/**
+ * @description: 尝试推进纪元，并释放不会再被任何线程访问的对象
+ * @return {size_t} 本次释放的对象数量
+ */
+size_t EpochManager::reclaim() {
+    std::vector<RetiredObject> garbage;
+    {
+        std::scoped_lock lock{retired_latch_};
+        try_advance();
+        uint64_t epoch = global_epoch_.load();
+        size_t kept = 0;
+        for (auto &retired : retired_) {
+            if (retired.epoch_ + 2 <= epoch) {
+                garbage.push_back(retired);
+            } else {
+                retired_[kept++] = retired;
+            }
+        }
+        retired_.resize(kept);
+    }
+    for (auto &retired : garbage) {
+        retired.deleter_(retired.ptr_);
+    }
+    return garbage.size();
+}
+
+size_t EpochManager::num_retired() {
+    std::scoped_lock lock{retired_latch_};
+    return retired_.size();
+}
@@ -0,0 +1,91 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "common/config.h"
+
+/**
+ * @description: 基于纪元的内存回收
+ * 线程在访问共享对象之前进入纪元（enter），访问结束后退出（exit）；对象从共享结构中摘除后交给retire，
+ * 等到所有在摘除之前进入的线程都退出后才真正释放。
+ * 全局纪元只有在所有活跃线程都已观察到当前纪元时才能推进，在纪元e被retire的对象，
+ * 全局纪元推进到e+2之后就不会再被任何线程访问。
+ */
+class EpochManager {
+   public:
+    EpochManager() : records_(new ThreadRecord[EPOCH_MAX_THREADS]) {}
+
+    ~EpochManager();
+
+    void enter();
+
+    void exit();
+
+    /**
+     * @description: 延迟释放已从共享结构中摘除的对象
+     * @param {T*} ptr 需要释放的对象
+     */
+    template <typename T>
+    void retire(T *ptr) {
+        retire(ptr, [](void *p) { delete static_cast<T *>(p); });
+    }
+
+    size_t reclaim();
+
+    uint64_t get_epoch() { return global_epoch_.load(); }
+
+    size_t num_retired();
+
+   private:
+    static constexpr uint64_t INACTIVE_EPOCH = UINT64_MAX;
+
+    struct alignas(64) ThreadRecord {
+        std::atomic<uint64_t> epoch_{INACTIVE_EPOCH};  // 线程进入时观察到的全局纪元，不在临界区时为INACTIVE_EPOCH
+        int depth_ = 0;                                 // 嵌套进入的层数，只由所属线程访问
+    };
+
+    struct RetiredObject {
+        void *ptr_;
+        void (*deleter_)(void *);
+        uint64_t epoch_;    // 被retire时的全局纪元
+    };
+
+    void retire(void *ptr, void (*deleter)(void *));
+
+    bool try_advance();
+
+    std::atomic<uint64_t> global_epoch_{0};
+    std::unique_ptr<ThreadRecord[]> records_;  // 按线程槽位号索引
+    std::mutex retired_latch_;
+    std::vector<RetiredObject> retired_;
+};
+
+/**
+ * @description: 在作用域内进入纪元，可以嵌套
+ */
+class EpochGuard {
+   public:
+    explicit EpochGuard(EpochManager *epoch_manager) : epoch_manager_(epoch_manager) { epoch_manager_->enter(); }
+
+    ~EpochGuard() { epoch_manager_->exit(); }
+
+    EpochGuard(const EpochGuard &) = delete;
+    EpochGuard &operator=(const EpochGuard &) = delete;
+
+   private:
+    EpochManager *epoch_manager_;
+};
@@ -15,6 +15,7 @@ See the Mulan PSL v2 for more details. */
 #include <memory>
 #include <string>
 #include <thread>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
@@ -53,6 +54,19 @@ struct UndoLog {
   UndoLink prev_version_{};
 };
 
+/* OCC读集合中的一项：读到的元组及当时的版本字 */
+struct OccReadRecord {
+    int fd_;
+    Rid rid_;
+    timestamp_t version_;
+};
+
+/* 事务在一张表上持有的行锁，行锁数量超过阈值后升级为表锁 */
+struct TableRowLocks {
+    size_t num_row_locks = 0;           // 持有的行锁数量
+    bool escalated_shared = false;      // 已持有覆盖行级S锁的表锁
+    bool escalated_exclusive = false;   // 已持有表级X锁
+};
 
 class Transaction {
    public:
@@ -75,6 +89,9 @@ class Transaction {
     inline void set_txn_mode(bool txn_mode) { txn_mode_ = txn_mode; }
     inline bool get_txn_mode() { return txn_mode_; }
 
+    inline void set_synchronous_commit(bool synchronous_commit) { synchronous_commit_ = synchronous_commit; }
+    inline bool get_synchronous_commit() { return synchronous_commit_; }
+
     inline void set_start_ts(timestamp_t start_ts) { start_ts_ = start_ts; }
     inline timestamp_t get_start_ts() { return start_ts_; }
 
@@ -84,7 +101,14 @@ class Transaction {
     inline void set_state(TransactionState state) { state_ = state; }
 
     inline lsn_t get_prev_lsn() { return prev_lsn_; }
-    inline void set_prev_lsn(lsn_t prev_lsn) { prev_lsn_ = prev_lsn; }
+    inline void set_prev_lsn(lsn_t prev_lsn) {
+        if (first_lsn_ == INVALID_LSN) {
+            first_lsn_ = prev_lsn;
+        }
+        prev_lsn_ = prev_lsn;
+    }
+    /** 事务的第一条日志，检查点截断日志时需要保留活跃事务的全部日志 */
+    inline lsn_t get_first_lsn() { return first_lsn_; }
 
     inline std::shared_ptr<std::deque<WriteRecord *>> get_write_set() { return write_set_; }  
     inline void append_write_record(WriteRecord* write_record) { write_set_->push_back(write_record); }
@@ -97,8 +121,19 @@ class Transaction {
 
     inline std::shared_ptr<std::unordered_set<LockDataId>> get_lock_set() { return lock_set_; }
 
+    inline std::unordered_map<int, TableRowLocks> *get_row_locks() { return &row_locks_; }
+
+    inline std::vector<OccReadRecord> *get_read_set() { return &read_set_; }
+    inline std::unordered_map<int, uint64_t> *get_scan_set() { return &scan_set_; }
+    inline std::unordered_map<LockDataId, WriteRecord *> *get_write_map() { return &write_map_; }
+
     inline timestamp_t get_read_ts() const { return read_ts_; }
+    inline void set_read_ts(timestamp_t read_ts) { read_ts_ = read_ts; }
     inline timestamp_t get_commit_ts() const { return commit_ts_; }
+    inline void set_commit_ts(timestamp_t commit_ts) { commit_ts_ = commit_ts; }
+
+    /** MVCC下未提交元组的临时时间戳，大于任何提交时间戳，其他事务据此判断元组正在被修改 */
+    inline timestamp_t get_temp_ts() const { return TXN_START_ID + txn_id_; }
 
     /** 修改现有的撤销日志 */
     inline auto ModifyUndoLog(int log_idx, UndoLog new_log) {
@@ -126,15 +161,22 @@ class Transaction {
 
    private:
     bool txn_mode_;                   // 用于标识当前事务为显式事务还是单条SQL语句的隐式事务
+    bool synchronous_commit_ = true;  // 提交时是否等待提交日志持久化
     TransactionState state_;          // 事务状态
     IsolationLevel isolation_level_;  // 事务的隔离级别，默认隔离级别为可串行化
     std::thread::id thread_id_;       // 当前事务对应的线程id
-    lsn_t prev_lsn_;                  // 当前事务执行的最后一条操作对应的lsn，用于系统故障恢复
+    std::atomic<lsn_t> prev_lsn_;     // 当前事务执行的最后一条操作对应的lsn，用于系统故障恢复，检查点线程会并发读取
+    std::atomic<lsn_t> first_lsn_{INVALID_LSN};   // 当前事务的第一条日志的lsn
     txn_id_t txn_id_;                 // 事务的ID，唯一标识符
     timestamp_t start_ts_;            // 事务的开始时间戳
 
     std::shared_ptr<std::deque<WriteRecord *>> write_set_;  // 事务包含的所有写操作
     std::shared_ptr<std::unordered_set<LockDataId>> lock_set_;  // 事务申请的所有锁
+    std::unordered_map<int, TableRowLocks> row_locks_;          // 按表fd统计的行锁，用于锁升级
+
+    std::vector<OccReadRecord> read_set_;                       // OCC下读过的元组及其版本
+    std::unordered_map<int, uint64_t> scan_set_;                // OCC下扫描过的表及扫描开始时表的插入版本，用于检测幻读
+    std::unordered_map<LockDataId, WriteRecord *> write_map_;   // OCC下缓冲的更新和删除，按元组索引write_set_中的写记录
     std::shared_ptr<std::deque<Page*>> index_latch_page_set_;          // 维护事务执行过程中加锁的索引页面
     std::shared_ptr<std::deque<Page*>> index_deleted_page_set_;    // 维护事务执行过程中删除的索引页面
 
@@ -9,10 +9,18 @@ MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
 See the Mulan PSL v2 for more details. */
 
 #include "transaction_manager.h"
+
+#include <algorithm>
+
+#include "index/ix.h"
 #include "record/rm_file_handle.h"
 #include "system/sm_manager.h"
 
-std::unordered_map<txn_id_t, Transaction *> TransactionManager::txn_map = {};
+TransactionManager::~TransactionManager() {
+    StopGarbageCollector();
+    // 剩余的事务对象随事务表一起释放，已删除的由epoch_manager_释放
+    txn_table_.for_each([](Transaction *txn) { delete txn; });
+}
 
 /**
  * @description: 事务的开始方法
@@ -21,14 +29,26 @@ std::unordered_map<txn_id_t, Transaction *> TransactionManager::txn_map = {};
  * @param {LogManager*} log_manager 日志管理器指针
  */
 Transaction * TransactionManager::begin(Transaction* txn, LogManager* log_manager) {
-    // Todo:
     // 1. 判断传入事务参数是否为空指针
     // 2. 如果为空指针，创建新事务
+    if (txn == nullptr) {
+        txn = new Transaction(next_txn_id_++);
+    }
+    txn->set_start_ts(next_timestamp_++);
+    txn->set_state(TransactionState::GROWING);
+
     // 3. 把开始事务加入到全局事务表中
+    txn_table_.insert(txn);
+    if (concurrency_mode_ == ConcurrencyMode::MVCC) {
+        std::unique_lock<std::mutex> lock(latch_);
+        // 快照为最近一次发布的提交时间戳，与提交时的发布在同一把锁内，水印不会越过正在开始的事务
+        txn->set_read_ts(last_commit_ts_);
+        running_txns_.AddTxn(txn->get_read_ts());
+    }
+    BeginLogRecord log_record(txn->get_transaction_id());
+    append_log(txn, &log_record, log_manager);
     // 4. 返回当前事务指针
-    // 如果需要支持MVCC请在上述过程中添加代码
-    
-    return nullptr;
+    return txn;
 }
 
 /**
@@ -37,14 +57,71 @@ Transaction * TransactionManager::begin(Transaction* txn, LogManager* log_manage
  * @param {LogManager*} log_manager 日志管理器指针
  */
 void TransactionManager::commit(Transaction* txn, LogManager* log_manager) {
-    // Todo:
-    // 1. 如果存在未提交的写操作，提交所有的写操作
-    // 2. 释放所有锁
-    // 3. 释放事务相关资源，eg.锁集
-    // 4. 把事务日志刷入磁盘中
-    // 5. 更新事务状态
-    // 如果需要支持MVCC请在上述过程中添加代码
+    // 提交日志在修改对其他事务可见之前追加，读到本事务修改的事务的提交日志一定排在后面，
+    // 因此可以先释放锁再等待日志持久化；只读事务只需等待它之前的提交日志持久化
+    bool read_only = txn->get_write_set()->empty();
+    lsn_t wait_lsn = read_only && log_manager != nullptr ? log_manager->get_last_commit_lsn() : INVALID_LSN;
+    bool synchronous_commit = txn->get_synchronous_commit();
+    if (concurrency_mode_ == ConcurrencyMode::OCC) {
+        // 1. 验证读集合并写回缓冲的修改，验证失败时抛出异常，由调用者回滚
+        commit_occ(txn, log_manager);
+    } else if (concurrency_mode_ == ConcurrencyMode::MVCC) {
+        // 1. 分配提交时间戳，把事务写过的元组的临时时间戳替换为提交时间戳
+        // 先改元组再发布last_commit_ts_，发布前开始的事务读到更大的时间戳会沿版本链读取旧版本
+        std::unique_lock<std::mutex> commit_lock(commit_latch_);
+        timestamp_t commit_ts = last_commit_ts_ + 1;
+        timestamp_t temp_ts = txn->get_temp_ts();
+        for (auto write_record : *txn->get_write_set()) {
+            auto iter = sm_manager_->fhs_.find(write_record->GetTableName());
+            if (iter == sm_manager_->fhs_.end()) {
+                continue;
+            }
+            bool is_deleted = false;
+            iter->second->write_tuple(write_record->GetRid(), [&](TupleMeta &meta, char *data) {
+                if (meta.ts_ != temp_ts) {
+                    return false;
+                }
+                meta.ts_ = commit_ts;
+                is_deleted = meta.is_deleted_;
+                return true;
+            });
+            if (is_deleted) {
+                std::scoped_lock gc_lock{gc_latch_};
+                deleted_tuples_.push_back({commit_ts, write_record->GetTableName(), write_record->GetRid()});
+            }
+        }
+        txn->set_commit_ts(commit_ts);
+        CommitLogRecord log_record(txn->get_transaction_id());
+        append_log(txn, &log_record, log_manager);
+
+        // 2. 发布提交时间戳，把事务从水印中移除
+        std::unique_lock<std::mutex> lock(latch_);
+        last_commit_ts_ = commit_ts;
+        running_txns_.UpdateCommitTs(commit_ts);
+        running_txns_.RemoveTxn(txn->get_read_ts());
+    } else {
+        CommitLogRecord log_record(txn->get_transaction_id());
+        append_log(txn, &log_record, log_manager);
+    }
+    if (!read_only) {
+        wait_lsn = txn->get_prev_lsn();
+    }
+
+    // 3. 释放所有锁，释放事务相关资源
+    lock_manager_->unlock_all(txn);
+    for (auto write_record : *txn->get_write_set()) {
+        delete write_record;
+    }
+    txn->get_write_set()->clear();
 
+    // 4. 更新事务状态，此后事务对象随时可能被垃圾回收
+    txn->set_state(TransactionState::COMMITTED);
+
+    // 5. 等待提交日志持久化（组提交）；异步提交不等待，提交日志由刷盘线程在log_timeout内持久化，
+    // 故障时至多丢失这段时间内的提交，已持久化的日志仍然完整
+    if (log_manager != nullptr && enable_logging && wait_lsn != INVALID_LSN && synchronous_commit) {
+        log_manager->wait_for_flush(wait_lsn);
+    }
 }
 
 /**
@@ -53,12 +130,672 @@ void TransactionManager::commit(Transaction* txn, LogManager* log_manager) {
  * @param {LogManager} *log_manager 日志管理器指针
  */
 void TransactionManager::abort(Transaction * txn, LogManager *log_manager) {
-    // Todo:
     // 1. 回滚所有写操作
-    // 2. 释放所有锁
-    // 3. 清空事务相关资源，eg.锁集
-    // 4. 把事务日志刷入磁盘中
-    // 5. 更新事务状态
-    // 如果需要支持MVCC请在上述过程中添加代码
-    
-}
\ No newline at end of file
+    if (concurrency_mode_ == ConcurrencyMode::MVCC) {
+        rollback_mvcc(txn);
+        std::unique_lock<std::mutex> lock(latch_);
+        running_txns_.RemoveTxn(txn->get_read_ts());
+        // 中止的事务记录中止时最新的提交时间戳：此前开始的读者可能还持有指向其撤销日志的链接，
+        // 垃圾回收要等水印越过该时间戳才能释放它
+        txn->set_commit_ts(last_commit_ts_);
+    } else if (concurrency_mode_ == ConcurrencyMode::OCC) {
+        rollback_occ(txn);
+    } else {
+        rollback_2pl(txn, log_manager);
+    }
+    AbortLogRecord log_record(txn->get_transaction_id());
+    append_log(txn, &log_record, log_manager);
+
+    // 2. 释放所有锁，清空事务相关资源
+    lock_manager_->unlock_all(txn);
+    for (auto write_record : *txn->get_write_set()) {
+        delete write_record;
+    }
+    txn->get_write_set()->clear();
+
+    // 3. 更新事务状态
+    txn->set_state(TransactionState::ABORTED);
+}
+
+/**
+ * @description: OCC（Silo）的提交：
+ * 1. 按(fd, rid)的顺序在写集合中的元组的版本字上加锁，固定的加锁顺序保证不会死锁
+ * 2. 分配提交时间戳，作为事务的串行化点
+ * 3. 验证读集合：读过的元组版本未变且未被其他事务加锁，扫描过的表没有新插入的元组
+ * 4. 写回缓冲的更新和删除，把版本字设为提交时间戳，同时释放锁；本事务插入的元组改为可见
+ */
+void TransactionManager::commit_occ(Transaction *txn, LogManager *log_manager) {
+    std::unordered_map<int, RmFileHandle *> fhs;
+    for (auto &[tab_name, fh] : sm_manager_->fhs_) {
+        fhs.emplace(fh->GetFd(), fh.get());
+    }
+    auto write_map = txn->get_write_map();
+    std::vector<std::pair<LockDataId, WriteRecord *>> writes(write_map->begin(), write_map->end());
+    std::sort(writes.begin(), writes.end(), [](const auto &a, const auto &b) {
+        if (a.first.fd_ != b.first.fd_) {
+            return a.first.fd_ < b.first.fd_;
+        }
+        if (a.first.rid_.page_no != b.first.rid_.page_no) {
+            return a.first.rid_.page_no < b.first.rid_.page_no;
+        }
+        return a.first.rid_.slot_no < b.first.rid_.slot_no;
+    });
+
+    auto unlock = [&](size_t num_locked) {
+        for (size_t i = 0; i < num_locked; i++) {
+            fhs.at(writes[i].first.fd_)->write_tuple(writes[i].first.rid_, [](TupleMeta &meta, char *data) {
+                meta.ts_ &= ~OCC_LOCK_BIT;
+                return true;
+            });
+        }
+    };
+
+    // 1. 加锁，版本字已被其他提交中的事务锁住时等待其写回
+    size_t num_locked = 0;
+    for (; num_locked < writes.size(); num_locked++) {
+        RmFileHandle *fh = fhs.at(writes[num_locked].first.fd_);
+        bool acquired = false;
+        try {
+            while (true) {
+                fh->write_tuple(writes[num_locked].first.rid_, [&](TupleMeta &meta, char *data) {
+                    if (meta.ts_ & OCC_LOCK_BIT) {
+                        return false;
+                    }
+                    meta.ts_ |= OCC_LOCK_BIT;
+                    acquired = true;
+                    return true;
+                });
+                if (acquired) {
+                    break;
+                }
+                std::this_thread::yield();
+            }
+        } catch (RecordNotFoundError &e) {
+            // 元组已被其他事务删除
+            break;
+        }
+    }
+
+    // 2. 分配提交时间戳，3. 验证读集合
+    timestamp_t commit_ts = ++last_commit_ts_;
+    if (num_locked < writes.size() || !validate_occ(txn, fhs)) {
+        unlock(num_locked);
+        throw TransactionAbortException(txn->get_transaction_id(), AbortReason::VALIDATION_FAILED);
+    }
+
+    CommitLogRecord log_record(txn->get_transaction_id());
+    append_log(txn, &log_record, log_manager);
+
+    // 4. 写回
+    timestamp_t temp_ts = txn->get_temp_ts();
+    for (auto write_record : *txn->get_write_set()) {
+        RmFileHandle *fh = sm_manager_->fhs_.at(write_record->GetTableName()).get();
+        const TabMeta &tab = sm_manager_->db_.get_table(write_record->GetTableName());
+        Rid &rid = write_record->GetRid();
+        switch (write_record->GetWriteType()) {
+            case WType::INSERT_TUPLE: {
+                try {
+                    fh->write_tuple(rid, [&](TupleMeta &meta, char *data) {
+                        if (meta.ts_ != temp_ts) {
+                            // 插入后又被本事务删除，槽位可能已被其他事务重用
+                            return false;
+                        }
+                        meta = TupleMeta{commit_ts, false};
+                        return true;
+                    });
+                } catch (RecordNotFoundError &e) {
+                }
+            } break;
+            case WType::UPDATE_TUPLE: {
+                auto rec = fh->get_record(rid, nullptr);
+                delete_index_entries(tab, rec->data, txn);
+                fh->write_tuple(rid, [&](TupleMeta &meta, char *data) {
+                    memcpy(data, write_record->GetRecord().data, write_record->GetRecord().size);
+                    meta.ts_ = commit_ts;
+                    return true;
+                });
+                insert_index_entries(tab, write_record->GetRecord().data, rid, txn);
+            } break;
+            case WType::DELETE_TUPLE: {
+                auto rec = fh->get_record(rid, nullptr);
+                delete_index_entries(tab, rec->data, txn);
+                fh->delete_record(rid, nullptr);
+            } break;
+        }
+    }
+    txn->set_commit_ts(commit_ts);
+    txn->get_read_set()->clear();
+    txn->get_scan_set()->clear();
+    write_map->clear();
+}
+
+/**
+ * @description: 为事务追加一条日志，并链接到该事务的上一条日志
+ * @param {Transaction*} txn 事务
+ * @param {LogRecord*} log_record 日志记录
+ * @param {LogManager*} log_manager 日志管理器，为空或未开启日志时不记录
+ */
+void TransactionManager::append_log(Transaction *txn, LogRecord *log_record, LogManager *log_manager) {
+    if (log_manager == nullptr || !enable_logging) {
+        return;
+    }
+    log_record->prev_lsn_ = txn->get_prev_lsn();
+    txn->set_prev_lsn(log_manager->add_log_to_buffer(log_record));
+}
+
+/**
+ * @description: OCC的读集合验证，调用时写集合中的元组已经加锁
+ * @return {bool} 读到的数据在串行化点仍然有效
+ */
+bool TransactionManager::validate_occ(Transaction *txn, const std::unordered_map<int, RmFileHandle *> &fhs) {
+    auto write_map = txn->get_write_map();
+    for (auto &[fd, version] : *txn->get_scan_set()) {
+        if (fhs.at(fd)->get_insert_version() != version) {
+            return false;
+        }
+    }
+    for (auto &read : *txn->get_read_set()) {
+        TupleMeta meta;
+        try {
+            fhs.at(read.fd_)->read_tuple(read.rid_, [&](const TupleMeta &m, const char *data) { meta = m; });
+        } catch (RecordNotFoundError &e) {
+            return false;
+        }
+        if ((meta.ts_ & ~OCC_LOCK_BIT) != read.version_) {
+            return false;
+        }
+        if ((meta.ts_ & OCC_LOCK_BIT) && write_map->count(LockDataId(read.fd_, read.rid_, LockDataType::RECORD)) == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @description: OCC下的回滚：缓冲的修改直接丢弃，只需要删除本事务插入的元组
+ */
+void TransactionManager::rollback_occ(Transaction *txn) {
+    timestamp_t temp_ts = txn->get_temp_ts();
+    auto write_set = txn->get_write_set();
+    for (auto iter = write_set->rbegin(); iter != write_set->rend(); ++iter) {
+        WriteRecord *write_record = *iter;
+        if (write_record->GetWriteType() != WType::INSERT_TUPLE) {
+            continue;
+        }
+        auto fh_iter = sm_manager_->fhs_.find(write_record->GetTableName());
+        if (fh_iter == sm_manager_->fhs_.end()) {
+            continue;
+        }
+        RmFileHandle *fh = fh_iter->second.get();
+        const TabMeta &tab = sm_manager_->db_.get_table(write_record->GetTableName());
+        Rid &rid = write_record->GetRid();
+        std::unique_ptr<RmRecord> rec;
+        try {
+            fh->read_tuple(rid, [&](const TupleMeta &meta, const char *data) {
+                if (meta.ts_ == temp_ts) {
+                    rec = std::make_unique<RmRecord>(fh->get_file_hdr().record_size, const_cast<char *>(data));
+                }
+            });
+        } catch (RecordNotFoundError &e) {
+        }
+        if (rec != nullptr) {
+            delete_index_entries(tab, rec->data, txn);
+            fh->delete_record(rid, nullptr);
+        }
+    }
+    txn->get_read_set()->clear();
+    txn->get_scan_set()->clear();
+    txn->get_write_map()->clear();
+}
+
+/**
+ * @description: 两阶段封锁下按写集合的逆序恢复元组的前像，每次恢复写一条补偿日志，
+ * 补偿日志的undo_next_lsn指向被补偿的修改之前的日志，故障恢复时已补偿的修改不会再被撤销
+ */
+void TransactionManager::rollback_2pl(Transaction *txn, LogManager *log_manager) {
+    Context context(lock_manager_, log_manager, txn);
+    auto write_set = txn->get_write_set();
+    for (auto iter = write_set->rbegin(); iter != write_set->rend(); ++iter) {
+        WriteRecord *write_record = *iter;
+        auto fh_iter = sm_manager_->fhs_.find(write_record->GetTableName());
+        if (fh_iter == sm_manager_->fhs_.end()) {
+            continue;
+        }
+        RmFileHandle *fh = fh_iter->second.get();
+        const TabMeta &tab = sm_manager_->db_.get_table(write_record->GetTableName());
+        Rid &rid = write_record->GetRid();
+        switch (write_record->GetWriteType()) {
+            case WType::INSERT_TUPLE: {
+                auto rec = fh->get_record(rid, nullptr);
+                delete_index_entries(tab, rec->data, txn);
+                fh->rollback_tuple(rid, nullptr, write_record->GetUndoNextLsn(), &context);
+            } break;
+            case WType::DELETE_TUPLE: {
+                fh->rollback_tuple(rid, write_record->GetRecord().data, write_record->GetUndoNextLsn(), &context);
+                insert_index_entries(tab, write_record->GetRecord().data, rid, txn);
+            } break;
+            case WType::UPDATE_TUPLE: {
+                auto rec = fh->get_record(rid, nullptr);
+                delete_index_entries(tab, rec->data, txn);
+                fh->rollback_tuple(rid, write_record->GetRecord().data, write_record->GetUndoNextLsn(), &context);
+                insert_index_entries(tab, write_record->GetRecord().data, rid, txn);
+            } break;
+        }
+    }
+}
+
+/**
+ * @description: MVCC下按写集合的逆序回滚：事务插入的元组直接物理删除，
+ * 修改过的元组用版本链表头上本事务的撤销日志恢复，并把版本链指回更早的版本
+ */
+void TransactionManager::rollback_mvcc(Transaction *txn) {
+    timestamp_t temp_ts = txn->get_temp_ts();
+    auto write_set = txn->get_write_set();
+    for (auto iter = write_set->rbegin(); iter != write_set->rend(); ++iter) {
+        WriteRecord *write_record = *iter;
+        auto fh_iter = sm_manager_->fhs_.find(write_record->GetTableName());
+        if (fh_iter == sm_manager_->fhs_.end()) {
+            continue;
+        }
+        RmFileHandle *fh = fh_iter->second.get();
+        const TabMeta &tab = sm_manager_->db_.get_table(write_record->GetTableName());
+        Rid &rid = write_record->GetRid();
+        int fd = fh->GetFd();
+        if (write_record->GetWriteType() == WType::INSERT_TUPLE) {
+            auto rec = fh->get_record(rid, nullptr);
+            delete_index_entries(tab, rec->data, txn);
+            fh->delete_record(rid, nullptr);
+            continue;
+        }
+        fh->write_tuple(rid, [&](TupleMeta &meta, char *data) {
+            if (meta.ts_ != temp_ts) {
+                // 同一元组的多条写记录，已经在前面恢复过了
+                return false;
+            }
+            auto link = GetUndoLink(fd, rid);
+            if (!link.has_value() || link->prev_txn_ != txn->get_transaction_id()) {
+                // 本事务插入的元组，由写集合中的插入记录负责删除
+                return false;
+            }
+            UndoLog log = txn->GetUndoLog(link->prev_log_idx_);
+            ApplyUndoLog(tab, log, data);
+            meta.ts_ = log.ts_;
+            meta.is_deleted_ = log.is_deleted_;
+            UpdateUndoLink(fd, rid, log.prev_version_.IsValid() ? std::make_optional(log.prev_version_) : std::nullopt);
+            return true;
+        });
+    }
+}
+
+void TransactionManager::insert_index_entries(const TabMeta &tab, const char *data, const Rid &rid, Transaction *txn) {
+    for (auto &index : tab.indexes) {
+        auto ih = sm_manager_->ihs_.at(sm_manager_->get_ix_manager()->get_index_name(tab.name, index.cols)).get();
+        std::vector<char> key(index.col_tot_len);
+        int offset = 0;
+        for (auto &col : index.cols) {
+            memcpy(key.data() + offset, data + col.offset, col.len);
+            offset += col.len;
+        }
+        ih->insert_entry(key.data(), rid, txn);
+    }
+}
+
+void TransactionManager::delete_index_entries(const TabMeta &tab, const char *data, Transaction *txn) {
+    for (auto &index : tab.indexes) {
+        auto ih = sm_manager_->ihs_.at(sm_manager_->get_ix_manager()->get_index_name(tab.name, index.cols)).get();
+        std::vector<char> key(index.col_tot_len);
+        int offset = 0;
+        for (auto &col : index.cols) {
+            memcpy(key.data() + offset, data + col.offset, col.len);
+            offset += col.len;
+        }
+        ih->delete_entry(key.data(), txn);
+    }
+}
+
+/**
+ * @description: 把撤销日志中记录的旧字段值写回元组
+ * @param {TabMeta&} tab 元组所在表的元数据
+ * @param {UndoLog&} log 撤销日志，tuple_按字段顺序保存modified_fields_为true的字段
+ * @param {char*} data 元组数据，原地修改
+ */
+void TransactionManager::ApplyUndoLog(const TabMeta &tab, const UndoLog &log, char *data) {
+    size_t value_idx = 0;
+    for (size_t i = 0; i < log.modified_fields_.size() && i < tab.cols.size(); i++) {
+        if (!log.modified_fields_[i]) {
+            continue;
+        }
+        const ColMeta &col = tab.cols[i];
+        memcpy(data + col.offset, log.tuple_[value_idx].raw->data, col.len);
+        value_idx++;
+    }
+}
+
+bool TransactionManager::UpdateUndoLink(int fd, Rid rid, std::optional<UndoLink> prev_link,
+                                        std::function<bool(std::optional<UndoLink>)> &&check) {
+    std::function<bool(std::optional<VersionUndoLink>)> version_check = nullptr;
+    if (check != nullptr) {
+        version_check = [&check](const std::optional<VersionUndoLink> &link) -> bool {
+            if (link.has_value()) {
+                return check(link->prev_);
+            }
+            return check(std::nullopt);
+        };
+    }
+    return UpdateVersionLink(fd, rid, VersionUndoLink::FromOptionalUndoLink(prev_link), std::move(version_check));
+}
+
+bool TransactionManager::UpdateVersionLink(int fd, Rid rid, std::optional<VersionUndoLink> prev_version,
+                                           std::function<bool(std::optional<VersionUndoLink>)> &&check) {
+    std::unique_lock<std::shared_mutex> lock(version_info_mutex_);
+    std::shared_ptr<PageVersionInfo> pg_ver_info = nullptr;
+    auto iter = version_info_.find(PageId{fd, rid.page_no});
+    if (iter == version_info_.end()) {
+        pg_ver_info = std::make_shared<PageVersionInfo>();
+        version_info_[PageId{fd, rid.page_no}] = pg_ver_info;
+    } else {
+        pg_ver_info = iter->second;
+    }
+    std::unique_lock<std::shared_mutex> page_lock(pg_ver_info->mutex_);
+    lock.unlock();
+    auto iter2 = pg_ver_info->prev_version_.find(rid.slot_no);
+    if (check != nullptr) {
+        std::optional<VersionUndoLink> cur = std::nullopt;
+        if (iter2 != pg_ver_info->prev_version_.end()) {
+            cur = iter2->second;
+        }
+        if (!check(cur)) {
+            return false;
+        }
+    }
+    if (prev_version.has_value()) {
+        pg_ver_info->prev_version_[rid.slot_no] = *prev_version;
+    } else if (iter2 != pg_ver_info->prev_version_.end()) {
+        pg_ver_info->prev_version_.erase(iter2);
+    }
+    return true;
+}
+
+std::optional<VersionUndoLink> TransactionManager::GetVersionLink(int fd, Rid rid) {
+    std::shared_lock<std::shared_mutex> lock(version_info_mutex_);
+    auto iter = version_info_.find(PageId{fd, rid.page_no});
+    if (iter == version_info_.end()) {
+        return std::nullopt;
+    }
+    std::shared_ptr<PageVersionInfo> pg_ver_info = iter->second;
+    std::shared_lock<std::shared_mutex> page_lock(pg_ver_info->mutex_);
+    lock.unlock();
+    auto iter2 = pg_ver_info->prev_version_.find(rid.slot_no);
+    if (iter2 == pg_ver_info->prev_version_.end()) {
+        return std::nullopt;
+    }
+    return std::make_optional(iter2->second);
+}
+
+std::optional<UndoLink> TransactionManager::GetUndoLink(int fd, Rid rid) {
+    auto version_link = GetVersionLink(fd, rid);
+    if (version_link.has_value() && version_link->prev_.IsValid()) {
+        return version_link->prev_;
+    }
+    return std::nullopt;
+}
+
+std::optional<UndoLog> TransactionManager::GetUndoLogOptional(UndoLink link) {
+    // 撤销日志的所有者可能已经结束，纪元保护期间不会被释放
+    EpochGuard guard(&epoch_manager_);
+    Transaction *txn = txn_table_.find(link.prev_txn_);
+    if (txn == nullptr) {
+        return std::nullopt;
+    }
+    return txn->GetUndoLog(link.prev_log_idx_);
+}
+
+UndoLog TransactionManager::GetUndoLog(UndoLink link) {
+    auto undo_log = GetUndoLogOptional(link);
+    if (!undo_log.has_value()) {
+        throw InternalError("undo log of transaction " + std::to_string(link.prev_txn_) + " not exist");
+    }
+    return *undo_log;
+}
+
+timestamp_t TransactionManager::GetWatermark() {
+    std::unique_lock<std::mutex> lock(latch_);
+    return running_txns_.GetWatermark();
+}
+
+Transaction *TransactionManager::find_transaction(txn_id_t txn_id) {
+    return txn_table_.find(txn_id);
+}
+
+/**
+ * @description: 垃圾回收，由后台线程周期性调用
+ * 1. 物理删除提交时间戳不超过水印的已删除元组
+ * 2. 截断版本链：时间戳不超过水印的第一个版本对所有活跃事务可见，更早的撤销日志不会再被访问
+ * 3. 把撤销日志都已不在版本链上的已结束事务从事务表中删除，等到没有线程可能访问它们后再释放
+ * 1和2只在水印比上一次前进后执行：水印不变时没有新的版本对所有活跃事务可见，遍历版本链不会回收任何东西
+ */
+void TransactionManager::GarbageCollection() {
+    {
+        EpochGuard guard(&epoch_manager_);
+        // 只回收本轮开始前就已结束的事务，之后结束的事务可能在遍历版本链之后才写入撤销日志
+        std::vector<Transaction *> finished_txns;
+        txn_table_.for_each([&](Transaction *txn) {
+            if (txn->get_state() == TransactionState::COMMITTED || txn->get_state() == TransactionState::ABORTED) {
+                finished_txns.push_back(txn);
+            }
+        });
+
+        bool mvcc = concurrency_mode_ == ConcurrencyMode::MVCC;
+        timestamp_t watermark = GetWatermark();
+        bool advanced = mvcc && watermark > gc_watermark_;
+        std::unordered_map<txn_id_t, size_t> reachable;
+        if (advanced) {
+            reclaim_deleted_tuples(watermark);
+            truncate_version_chains(watermark, reachable);
+            gc_watermark_ = watermark;
+        }
+
+        for (auto txn : finished_txns) {
+            if (reachable.count(txn->get_transaction_id()) > 0) {
+                continue;
+            }
+            // 没有遍历版本链时不知道撤销日志是否仍被引用，只回收没有撤销日志的事务
+            if (mvcc && !advanced && txn->GetUndoLogNum() > 0) {
+                continue;
+            }
+            if (mvcc && txn->get_state() == TransactionState::ABORTED && txn->get_commit_ts() >= watermark) {
+                continue;
+            }
+            if (txn_table_.erase(txn->get_transaction_id())) {
+                epoch_manager_.retire(txn);
+            }
+        }
+    }
+    // 释放此前删除、且已没有线程可能持有的事务对象
+    epoch_manager_.reclaim();
+}
+
+/**
+ * @description: 物理删除对所有活跃事务都不可见的已删除元组，并移除它们的版本链和索引项
+ */
+void TransactionManager::reclaim_deleted_tuples(timestamp_t watermark) {
+    while (true) {
+        DeletedTuple deleted;
+        {
+            std::scoped_lock gc_lock{gc_latch_};
+            if (deleted_tuples_.empty() || deleted_tuples_.front().commit_ts > watermark) {
+                return;
+            }
+            deleted = deleted_tuples_.front();
+            deleted_tuples_.pop_front();
+        }
+        auto fh_iter = sm_manager_->fhs_.find(deleted.tab_name);
+        if (fh_iter == sm_manager_->fhs_.end()) {
+            continue;
+        }
+        RmFileHandle *fh = fh_iter->second.get();
+        int fd = fh->GetFd();
+        try {
+            std::unique_ptr<RmRecord> rec;
+            fh->write_tuple(deleted.rid, [&](TupleMeta &meta, char *data) {
+                if (meta.is_deleted_ && meta.ts_ <= watermark) {
+                    rec = std::make_unique<RmRecord>(fh->get_file_hdr().record_size, data);
+                    UpdateUndoLink(fd, deleted.rid, std::nullopt);
+                }
+                return false;
+            });
+            if (rec == nullptr) {
+                continue;
+            }
+            // 索引项只在仍指向该元组时才删除，键可能已经被后来插入的元组复用
+            const TabMeta &tab = sm_manager_->db_.get_table(deleted.tab_name);
+            for (auto &index : tab.indexes) {
+                auto ih = sm_manager_->ihs_.at(sm_manager_->get_ix_manager()->get_index_name(tab.name, index.cols)).get();
+                std::vector<char> key(index.col_tot_len);
+                int offset = 0;
+                for (auto &col : index.cols) {
+                    memcpy(key.data() + offset, rec->data + col.offset, col.len);
+                    offset += col.len;
+                }
+                std::vector<Rid> rids;
+                if (ih->get_value(key.data(), &rids, nullptr) &&
+                    std::find(rids.begin(), rids.end(), deleted.rid) != rids.end()) {
+                    ih->delete_entry(key.data(), nullptr);
+                }
+            }
+            fh->delete_record(deleted.rid, nullptr);
+        } catch (RMDBError &e) {
+            // 元组所在的页面或记录已不存在
+        }
+    }
+}
+
+/**
+ * @description: 截断所有版本链，并统计各事务仍在版本链上的撤销日志数量
+ * @param {timestamp_t} watermark 当前水印
+ * @param {unordered_map<txn_id_t, size_t>&} reachable 输出参数，事务ID -> 仍可达的撤销日志数
+ */
+void TransactionManager::truncate_version_chains(timestamp_t watermark,
+                                                 std::unordered_map<txn_id_t, size_t> &reachable) {
+    std::unordered_map<int, RmFileHandle *> fd2fh;
+    for (auto &[tab_name, fh] : sm_manager_->fhs_) {
+        fd2fh[fh->GetFd()] = fh.get();
+    }
+
+    std::vector<std::pair<PageId, std::shared_ptr<PageVersionInfo>>> pages;
+    {
+        std::shared_lock<std::shared_mutex> lock(version_info_mutex_);
+        pages.assign(version_info_.begin(), version_info_.end());
+    }
+
+    for (auto &[page_id, pg_ver_info] : pages) {
+        auto fh_iter = fd2fh.find(page_id.fd);
+        std::vector<slot_offset_t> slots;
+        {
+            std::shared_lock<std::shared_mutex> page_lock(pg_ver_info->mutex_);
+            for (auto &[slot_no, link] : pg_ver_info->prev_version_) {
+                slots.push_back(slot_no);
+            }
+        }
+        for (auto slot_no : slots) {
+            Rid rid{page_id.page_no, static_cast<int>(slot_no)};
+            if (fh_iter == fd2fh.end()) {
+                // 表已被删除
+                UpdateUndoLink(page_id.fd, rid, std::nullopt);
+                continue;
+            }
+            try {
+                // 在页面写锁内处理，与写者修改版本链表头、合并撤销日志互斥
+                fh_iter->second->write_tuple(rid, [&](TupleMeta &meta, char *data) {
+                    if (meta.ts_ <= watermark) {
+                        // 表堆中的版本对所有活跃事务可见，整条版本链都不再需要
+                        UpdateUndoLink(page_id.fd, rid, std::nullopt);
+                        return false;
+                    }
+                    auto link = GetUndoLink(page_id.fd, rid);
+                    while (link.has_value()) {
+                        auto undo_log = GetUndoLogOptional(*link);
+                        if (!undo_log.has_value()) {
+                            break;
+                        }
+                        reachable[link->prev_txn_]++;
+                        if (undo_log->ts_ <= watermark) {
+                            if (undo_log->prev_version_.IsValid()) {
+                                Transaction *owner = find_transaction(link->prev_txn_);
+                                undo_log->prev_version_ = UndoLink{};
+                                owner->ModifyUndoLog(link->prev_log_idx_, *undo_log);
+                            }
+                            break;
+                        }
+                        link = undo_log->prev_version_.IsValid() ? std::make_optional(undo_log->prev_version_)
+                                                                 : std::nullopt;
+                    }
+                    return false;
+                });
+            } catch (RMDBError &e) {
+                UpdateUndoLink(page_id.fd, rid, std::nullopt);
+            }
+        }
+    }
+
+    // 移除没有任何版本链的页面
+    std::unique_lock<std::shared_mutex> lock(version_info_mutex_);
+    for (auto iter = version_info_.begin(); iter != version_info_.end();) {
+        std::shared_lock<std::shared_mutex> page_lock(iter->second->mutex_);
+        if (iter->second->prev_version_.empty()) {
+            page_lock.unlock();
+            iter = version_info_.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+}
+
+void TransactionManager::StartGarbageCollector() {
+    std::unique_lock<std::mutex> lock(gc_cv_latch_);
+    if (gc_running_) {
+        return;
+    }
+    gc_running_ = true;
+    gc_thread_ = std::thread([this] {
+        std::unique_lock<std::mutex> lock(gc_cv_latch_);
+        while (!gc_cv_.wait_for(lock, std::chrono::milliseconds(GC_INTERVAL_MS), [this] { return !gc_running_; })) {
+            lock.unlock();
+            GarbageCollection();
+            lock.lock();
+        }
+    });
+}
+
+void TransactionManager::StopGarbageCollector() {
+    {
+        std::unique_lock<std::mutex> lock(gc_cv_latch_);
+        if (!gc_running_) {
+            return;
+        }
+        gc_running_ = false;
+    }
+    gc_cv_.notify_all();
+    if (gc_thread_.joinable()) {
+        gc_thread_.join();
+    }
+}
+
+/**
+ * @description: 获取检查点时的活跃事务表：已经写过日志、还没有提交或回滚的事务
+ * 事务表在遍历期间可能变化，提交日志已经追加、状态尚未更新的事务也会被记入，分析阶段会把它从活跃事务表中移除
+ * @return {vector<CheckpointTxnEntry>} 每个活跃事务的事务ID、最后一条日志和第一条日志的日志号
+ */
+std::vector<CheckpointTxnEntry> TransactionManager::get_active_transactions() {
+    EpochGuard guard(&epoch_manager_);
+    std::vector<CheckpointTxnEntry> active_txns;
+    txn_table_.for_each([&](Transaction *txn) {
+        TransactionState state = txn->get_state();
+        lsn_t first_lsn = txn->get_first_lsn();
+        if (state == TransactionState::COMMITTED || state == TransactionState::ABORTED || first_lsn == INVALID_LSN) {
+            return;
+        }
+        active_txns.push_back({txn->get_transaction_id(), txn->get_prev_lsn(), first_lsn});
+    });
+    return active_txns;
+}
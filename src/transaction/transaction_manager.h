@@ -11,12 +11,17 @@ See the Mulan PSL v2 for more details. */
 #pragma once
 
 #include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <unordered_map>
 #include <optional>
 #include <functional>
 #include <shared_mutex>
+#include <thread>
 
+#include "epoch_manager.h"
 #include "transaction.h"
+#include "txn_table.h"
 #include "watermark.h"
 #include "recovery/log_manager.h"
 #include "concurrency/lock_manager.h"
@@ -24,7 +29,7 @@ See the Mulan PSL v2 for more details. */
 #include "common/exception.h"
 
 /* 系统采用的并发控制算法，当前题目中要求两阶段封锁并发控制算法 */
-enum class ConcurrencyMode { TWO_PHASE_LOCKING = 0, BASIC_TO, MVCC };
+enum class ConcurrencyMode { TWO_PHASE_LOCKING = 0, BASIC_TO, MVCC, OCC };
 
 /// 版本链中的第一个撤销链接，将表堆元组链接到撤销日志。
 struct VersionUndoLink {
@@ -55,7 +60,7 @@ public:
         concurrency_mode_ = concurrency_mode;
     }
     
-    ~TransactionManager() = default;
+    ~TransactionManager();
 
     Transaction* begin(Transaction* txn, LogManager* log_manager);
 
@@ -70,46 +75,50 @@ public:
     LockManager* get_lock_manager() { return lock_manager_; }
 
     /**
-     * @description: 获取事务ID为txn_id的事务对象
+     * @description: 获取事务ID为txn_id的事务对象，不加锁
+     * 已结束的事务随时可能被垃圾回收从事务表中删除，返回的指针只在调用者的纪元保护内有效
+     * 显式事务的各条语句可能由不同的工作线程执行，同一会话的语句不会并发执行
      * @return {Transaction*} 事务对象的指针
      * @param {txn_id_t} txn_id 事务ID
      */    
     Transaction* get_transaction(txn_id_t txn_id) {
         if(txn_id == INVALID_TXN_ID) return nullptr;
-        
-        std::unique_lock<std::mutex> lock(latch_);
-        assert(TransactionManager::txn_map.find(txn_id) != TransactionManager::txn_map.end());
-        auto *res = TransactionManager::txn_map[txn_id];
-        lock.unlock();
-        assert(res != nullptr);
-        assert(res->get_thread_id() == std::this_thread::get_id());
-
-        return res;
+
+        // 已结束的事务可能已经被垃圾回收释放
+        return txn_table_.find(txn_id);
     }
 
-    static std::unordered_map<txn_id_t, Transaction *> txn_map;     // 全局事务表，存放事务ID与事务对象的映射关系
-    std::shared_mutex txn_map_mutex_;
+    EpochManager* get_epoch_manager() { return &epoch_manager_; }
+
+    /**
+     * @description: 设置下一个分配的事务ID，故障恢复后调用，避免与日志中已有的事务ID重复
+     * @param {txn_id_t} next_txn_id 下一个事务ID
+     */
+    void set_next_txn_id(txn_id_t next_txn_id) { next_txn_id_ = next_txn_id; }
+
+    std::vector<CheckpointTxnEntry> get_active_transactions();
+
     /** ------------------------以下函数仅可能在MVCC当中使用------------------------------------------*/
 
     /**
     * @brief 更新一个撤销链接，该链接将表堆元组与第一个撤销日志连接起来。
     * 在更新之前，将调用 `check` 函数以确保有效性。
     */
-    bool UpdateUndoLink(Rid rid, std::optional<UndoLink> prev_link,
+    bool UpdateUndoLink(int fd, Rid rid, std::optional<UndoLink> prev_link,
                         std::function<bool(std::optional<UndoLink>)> &&check = nullptr);
 
     /**
      * @brief 更新一个撤销链接，该链接将表堆元组与第一个撤销日志连接起来。
      * 在更新之前，将调用 `check` 函数以确保有效性。
      */
-    bool UpdateVersionLink(Rid rid, std::optional<VersionUndoLink> prev_version,
+    bool UpdateVersionLink(int fd, Rid rid, std::optional<VersionUndoLink> prev_version,
                            std::function<bool(std::optional<VersionUndoLink>)> &&check = nullptr);
 
     /** @brief 获取表堆元组的第一个撤销日志。 */
-    std::optional<UndoLink> GetUndoLink(Rid rid);
+    std::optional<UndoLink> GetUndoLink(int fd, Rid rid);
 
     /** @brief 获取表堆元组的第一个撤销日志。*/
-    std::optional<VersionUndoLink> GetVersionLink(Rid rid);
+    std::optional<VersionUndoLink> GetVersionLink(int fd, Rid rid);
 
     /** @brief 访问事务撤销日志缓冲区并获取撤销日志。如果事务不存在，返回 nullopt。
      * 如果索引超出范围仍然会抛出异常。 */
@@ -122,9 +131,19 @@ public:
     /** @brief 获取系统中的最低读时间戳。 */
     timestamp_t GetWatermark();
 
-    /** @brief 垃圾回收。仅在所有事务都未访问时调用。 */
+    /** @brief 把一条撤销日志应用到元组上，得到该元组的前一个版本（不处理删除标记）。 */
+    static void ApplyUndoLog(const TabMeta &tab, const UndoLog &log, char *data);
+
+    /** @brief 垃圾回收：截断水印之前的版本链，回收已删除的元组，回收撤销日志不再被引用的已结束事务。
+     * 每个元组只在自己的页面写锁内处理，可以与正常事务并发执行。 */
     void GarbageCollection();
 
+    /** @brief 启动后台垃圾回收线程，每隔GC_INTERVAL_MS执行一次GarbageCollection。 */
+    void StartGarbageCollector();
+
+    /** @brief 停止后台垃圾回收线程。 */
+    void StopGarbageCollector();
+
     struct PageVersionInfo {
         std::shared_mutex mutex_;
         /** 存储所有槽的先前版本信息。注意：不要使用 `[x]` 来访问它，因为
@@ -135,18 +154,58 @@ public:
 
     /** 保护版本信息 */
     std::shared_mutex version_info_mutex_;
-    /** 存储表堆中每个元组的先前版本。 */
-    std::unordered_map<page_id_t, std::shared_ptr<PageVersionInfo>> version_info_;
+    /** 存储表堆中每个元组的先前版本，不同表的页号会重复，因此以(fd, page_no)为键。 */
+    std::unordered_map<PageId, std::shared_ptr<PageVersionInfo>> version_info_;
 
 
 private:
+    void rollback_2pl(Transaction *txn, LogManager *log_manager);
+
+    void rollback_mvcc(Transaction *txn);
+
+    void commit_occ(Transaction *txn, LogManager *log_manager);
+
+    void rollback_occ(Transaction *txn);
+
+    bool validate_occ(Transaction *txn, const std::unordered_map<int, RmFileHandle *> &fhs);
+
+    void append_log(Transaction *txn, LogRecord *log_record, LogManager *log_manager);
+
+    void insert_index_entries(const TabMeta &tab, const char *data, const Rid &rid, Transaction *txn);
+
+    void delete_index_entries(const TabMeta &tab, const char *data, Transaction *txn);
+
+    Transaction *find_transaction(txn_id_t txn_id);
+
+    void truncate_version_chains(timestamp_t watermark, std::unordered_map<txn_id_t, size_t> &reachable);
+
+    void reclaim_deleted_tuples(timestamp_t watermark);
+
+    /* 已提交的MVCC删除，提交时间戳不超过水印后元组对所有事务都不可见，可以物理删除 */
+    struct DeletedTuple {
+        timestamp_t commit_ts;
+        std::string tab_name;
+        Rid rid;
+    };
+
     ConcurrencyMode concurrency_mode_;      // 事务使用的并发控制算法，目前只需要考虑2PL
     std::atomic<txn_id_t> next_txn_id_{0};  // 用于分发事务ID
     std::atomic<timestamp_t> next_timestamp_{0};    // 用于分发事务时间戳
-    std::mutex latch_;  // 用于txn_map的并发
+    std::mutex latch_;  // 保护水印，MVCC下提交时间戳的发布与事务开始时读取快照互斥
+    TxnTable txn_table_;                    // 全局事务表，存放事务ID与事务对象的映射关系
+    EpochManager epoch_manager_;            // 延迟释放从事务表中删除的事务对象
     SmManager *sm_manager_;
     LockManager *lock_manager_;
 
-    std::atomic<timestamp_t> last_commit_ts_{0};    // 最后提交的时间戳,仅用于MVCC
+    std::atomic<timestamp_t> last_commit_ts_{0};    // 最后提交的时间戳，MVCC和OCC下使用
+    std::mutex commit_latch_;               // 串行化MVCC事务的提交，保证提交时间戳按顺序发布
     Watermark running_txns_{0};             // 存储所有正在运行事务的读取时间戳，以便于垃圾回收，仅用于MVCC
+
+    std::mutex gc_latch_;                   // 保护deleted_tuples_
+    std::deque<DeletedTuple> deleted_tuples_;   // 按提交时间戳排序的待回收删除元组
+    timestamp_t gc_watermark_ = 0;          // 上一次截断版本链时的水印，只由垃圾回收线程访问
+    std::thread gc_thread_;                 // 后台垃圾回收线程
+    bool gc_running_ = false;
+    std::mutex gc_cv_latch_;
+    std::condition_variable gc_cv_;
 };
\ No newline at end of file
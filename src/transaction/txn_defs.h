@@ -58,11 +58,17 @@ class WriteRecord {
 
     inline std::string &GetTableName() { return tab_name_; }
 
+    /** 写入本次修改的日志之前事务的最后一条日志，回滚时写入补偿日志 */
+    inline lsn_t GetUndoNextLsn() { return undo_next_lsn_; }
+
+    inline void SetUndoNextLsn(lsn_t undo_next_lsn) { undo_next_lsn_ = undo_next_lsn; }
+
    private:
     WType wtype_;
     std::string tab_name_;
     Rid rid_;
     RmRecord record_;
+    lsn_t undo_next_lsn_ = INVALID_LSN;
 };
 
 /* 多粒度锁，加锁对象的类型，包括记录和表 */
@@ -117,7 +123,8 @@ struct std::hash<LockDataId> {
 };
 
 /* 事务回滚原因 */
-enum class AbortReason { LOCK_ON_SHIRINKING = 0, UPGRADE_CONFLICT, DEADLOCK_PREVENTION };
+enum class AbortReason { LOCK_ON_SHIRINKING = 0, UPGRADE_CONFLICT, DEADLOCK_PREVENTION, WRITE_CONFLICT, DEADLOCK_DETECTED, VALIDATION_FAILED,
+                         PROCEDURE_FAILED, STATEMENT_CANCELED, STATEMENT_TIMEOUT };
 
 /* 事务回滚异常，在rmdb.cpp中进行处理 */
 class TransactionAbortException : public std::exception {
@@ -146,6 +153,34 @@ class TransactionAbortException : public std::exception {
                 return "Transaction " + std::to_string(txn_id_) + " aborted for deadlock prevention\n";
             } break;
 
+            case AbortReason::WRITE_CONFLICT: {
+                return "Transaction " + std::to_string(txn_id_) +
+                       " aborted because the tuple was modified by a concurrent transaction\n";
+            } break;
+
+            case AbortReason::DEADLOCK_DETECTED: {
+                return "Transaction " + std::to_string(txn_id_) + " aborted to break a deadlock\n";
+            } break;
+
+            case AbortReason::VALIDATION_FAILED: {
+                return "Transaction " + std::to_string(txn_id_) +
+                       " aborted because its reads were invalidated by a concurrent commit\n";
+            } break;
+
+            case AbortReason::PROCEDURE_FAILED: {
+                return "Transaction " + std::to_string(txn_id_) +
+                       " aborted because a statement in the called procedure failed\n";
+            } break;
+
+            case AbortReason::STATEMENT_CANCELED: {
+                return "Transaction " + std::to_string(txn_id_) + " aborted because its statement was canceled\n";
+            } break;
+
+            case AbortReason::STATEMENT_TIMEOUT: {
+                return "Transaction " + std::to_string(txn_id_) +
+                       " aborted because its statement exceeded statement_timeout\n";
+            } break;
+
             default: {
                 return "Transaction aborted\n";
             } break;
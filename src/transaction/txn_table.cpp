@@ -0,0 +1,116 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "transaction/txn_table.h"
+
+/**
+ * @description: 把事务加入事务表，同一个事务ID只会插入一次
+ * @param {Transaction*} txn 事务对象
+ */
+void TxnTable::insert(Transaction *txn) {
+    txn_id_t txn_id = txn->get_transaction_id();
+    for (size_t i = 0; i < TXN_TABLE_PROBE; i++) {
+        Slot &slot = slots_[(txn_id + i) & mask_];
+        txn_id_t expected = INVALID_TXN_ID;
+        if (slot.txn_id_.load() == INVALID_TXN_ID && slot.txn_id_.compare_exchange_strong(expected, txn_id)) {
+            slot.txn_.store(txn, std::memory_order_release);
+            return;
+        }
+    }
+    std::scoped_lock lock{overflow_latch_};
+    overflow_[txn_id] = txn;
+    overflow_size_++;
+}
+
+/**
+ * @description: 查找事务对象
+ * @return {Transaction*} 事务对象，不存在时返回空指针
+ * @param {txn_id_t} txn_id 事务ID
+ */
+Transaction *TxnTable::find(txn_id_t txn_id) {
+    for (size_t i = 0; i < TXN_TABLE_PROBE; i++) {
+        Slot &slot = slots_[(txn_id + i) & mask_];
+        if (slot.txn_id_.load(std::memory_order_acquire) != txn_id) {
+            continue;
+        }
+        Transaction *txn = slot.txn_.load(std::memory_order_acquire);
+        // 读到事务ID后槽位可能被清空并被其他事务复用，需要确认读到的事务对象
+        if (txn != nullptr && txn->get_transaction_id() == txn_id) {
+            return txn;
+        }
+    }
+    if (overflow_size_.load() == 0) {
+        return nullptr;
+    }
+    std::scoped_lock lock{overflow_latch_};
+    auto iter = overflow_.find(txn_id);
+    return iter == overflow_.end() ? nullptr : iter->second;
+}
+
+/**
+ * @description: 从事务表中删除事务，事务对象由调用者延迟释放
+ * @return {bool} 事务是否存在
+ * @param {txn_id_t} txn_id 事务ID
+ */
+bool TxnTable::erase(txn_id_t txn_id) {
+    for (size_t i = 0; i < TXN_TABLE_PROBE; i++) {
+        Slot &slot = slots_[(txn_id + i) & mask_];
+        if (slot.txn_id_.load() == txn_id) {
+            slot.txn_.store(nullptr);
+            slot.txn_id_.store(INVALID_TXN_ID, std::memory_order_release);
+            return true;
+        }
+    }
+    if (overflow_size_.load() == 0) {
+        return false;
+    }
+    std::scoped_lock lock{overflow_latch_};
+    if (overflow_.erase(txn_id) == 0) {
+        return false;
+    }
+    overflow_size_--;
+    return true;
+}
+
+/**
+ * @description: 遍历事务表中的所有事务，遍历期间插入或删除的事务可能被遗漏
+ * @param {function<void(Transaction*)>} &func 对每个事务调用的函数
+ */
+void TxnTable::for_each(const std::function<void(Transaction *)> &func) {
+    for (auto &slot : slots_) {
+        txn_id_t txn_id = slot.txn_id_.load(std::memory_order_acquire);
+        if (txn_id == INVALID_TXN_ID) {
+            continue;
+        }
+        Transaction *txn = slot.txn_.load(std::memory_order_acquire);
+        if (txn != nullptr && txn->get_transaction_id() == txn_id) {
+            func(txn);
+        }
+    }
+    if (overflow_size_.load() == 0) {
+        return;
+    }
+    std::vector<Transaction *> txns;
+    {
+        std::scoped_lock lock{overflow_latch_};
+        for (auto &[txn_id, txn] : overflow_) {
+            txns.push_back(txn);
+        }
+    }
+    for (auto txn : txns) {
+        func(txn);
+    }
+}
+
+size_t TxnTable::size() {
+    size_t size = 0;
+    for_each([&](Transaction *) { size++; });
+    return size;
+}
@@ -0,0 +1,55 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "transaction.h"
+
+/**
+ * @description: 全局事务表，存放事务ID与事务对象的映射关系
+ * 开放寻址的哈希表，槽位为原子变量。事务ID连续分配，以事务ID取模得到起始槽位，
+ * 在其后TXN_TABLE_PROBE个槽位组成的探测窗口内存放。查找和插入都不加锁；
+ * 查找总是扫描整个探测窗口，因此删除可以直接清空槽位，不需要墓碑。
+ * 探测窗口被占满时放入加锁的溢出表，溢出表为空时查找不会访问它。
+ * 删除后的事务对象需要通过EpochManager延迟释放，调用者在纪元保护内使用查找到的指针。
+ */
+class TxnTable {
+   public:
+    explicit TxnTable(size_t capacity = TXN_TABLE_SIZE) : mask_(capacity - 1), slots_(capacity) {}
+
+    void insert(Transaction *txn);
+
+    Transaction *find(txn_id_t txn_id);
+
+    bool erase(txn_id_t txn_id);
+
+    void for_each(const std::function<void(Transaction *)> &func);
+
+    size_t size();
+
+   private:
+    struct Slot {
+        std::atomic<txn_id_t> txn_id_{INVALID_TXN_ID};
+        std::atomic<Transaction *> txn_{nullptr};
+    };
+
+    size_t mask_;
+    std::vector<Slot> slots_;
+
+    std::atomic<size_t> overflow_size_{0};
+    std::mutex overflow_latch_;
+    std::unordered_map<txn_id_t, Transaction *> overflow_;
+};
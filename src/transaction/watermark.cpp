@@ -12,8 +12,28 @@ See the Mulan PSL v2 for more details. */
 
 
 auto Watermark::AddTxn(timestamp_t read_ts) -> void {
+    current_reads_[read_ts]++;
 }
 
 auto Watermark::RemoveTxn(timestamp_t read_ts) -> void {
+    auto iter = current_reads_.find(read_ts);
+    if (iter == current_reads_.end()) {
+        return;
+    }
+    if (--iter->second == 0) {
+        current_reads_.erase(iter);
+    }
+}
+
+auto Watermark::UpdateCommitTs(timestamp_t commit_ts) -> void {
+    commit_ts_ = commit_ts;
+}
 
-}
\ No newline at end of file
+/**
+ * @description: 水印为所有正在运行事务的最小读时间戳，没有运行中的事务时为最新的提交时间戳
+ * 时间戳小于等于水印的版本对所有事务可见，更旧的撤销日志不会再被访问
+ */
+auto Watermark::GetWatermark() -> timestamp_t {
+    watermark_ = current_reads_.empty() ? commit_ts_ : current_reads_.begin()->first;
+    return watermark_;
+}
@@ -13,17 +13,30 @@ See the Mulan PSL v2 for more details. */
 #define private public
 
 #include "record/rm.h"
+#include "recovery/log_manager.h"
+#include "recovery/log_recovery.h"
 #include "storage/buffer_pool_manager.h"
+#include "transaction/concurrency/lock_manager.h"
+#include "transaction/epoch_manager.h"
+#include "transaction/txn_table.h"
+#include "analyze/analyze.h"
+#include "execution/execution_common.h"
+#include "optimizer/optimizer.h"
+#include "optimizer/planner.h"
+#include "portal.h"
 
 #undef private
 
 #include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <ctime>
+#include <future>
 #include <iostream>
+#include <limits>
 #include <memory>
 #include <random>
 #include <set>
@@ -328,6 +341,74 @@ TEST_F(BufferPoolManagerTest, SampleTest) {
     bpm->flush_all_pages(fd);
 }
 
+// 淘汰脏页之前等待日志刷盘时不持有缓冲池的latch_，等待期间其他线程仍然可以访问缓冲池中的页面
+TEST_F(BufferPoolManagerTest, LogForceTest) {
+    const size_t buffer_pool_size = 2;
+    const lsn_t page_lsn = 100;
+    int fd = BufferPoolManagerTest::fd_;
+    auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, BufferPoolManagerTest::disk_manager_.get());
+    // 日志刷盘一直等到测试把persist_lsn推进到请求的日志号
+    std::mutex mutex;
+    std::condition_variable cv;
+    lsn_t persist_lsn = INVALID_LSN;
+    bool flushing = false;
+    bpm->set_log_flusher(
+        [&](lsn_t lsn) {
+            std::unique_lock<std::mutex> lock(mutex);
+            flushing = true;
+            cv.notify_all();
+            cv.wait(lock, [&] { return persist_lsn >= lsn; });
+        },
+        [&] {
+            std::scoped_lock lock{mutex};
+            return persist_lsn;
+        });
+
+    // 页面0被带日志的操作修改过，是最早可淘汰的页面
+    PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+    Page *page0 = bpm->new_page(&page_id);
+    ASSERT_NE(nullptr, page0);
+    strcpy(page0->get_data() + Page::OFFSET_PAGE_HDR, "logged");  // NOLINT
+    page0->set_page_lsn(page_lsn);
+    BufferPoolManager::mark_dirty(page0, page_lsn);
+    EXPECT_TRUE(bpm->unpin_page(page_id, true));
+    Page *page1 = bpm->new_page(&page_id);
+    ASSERT_NE(nullptr, page1);
+    EXPECT_TRUE(bpm->unpin_page(page_id, false));
+
+    // 调入新页面需要淘汰页面0，等待它的日志刷盘
+    auto evict = std::async(std::launch::async, [&] {
+        PageId new_page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+        Page *page = bpm->new_page(&new_page_id);
+        if (page != nullptr) {
+            bpm->unpin_page(new_page_id, false);
+        }
+        return page;
+    });
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [&] { return flushing; });
+    }
+    auto fetch = std::async(std::launch::async, [&] { return bpm->fetch_page(PageId{fd, 1}); });
+    EXPECT_EQ(fetch.wait_for(std::chrono::seconds(5)), std::future_status::ready);
+    {
+        std::scoped_lock lock{mutex};
+        persist_lsn = page_lsn;
+        cv.notify_all();
+    }
+    EXPECT_EQ(fetch.get(), page1);
+    EXPECT_NE(evict.get(), nullptr);
+    EXPECT_TRUE(bpm->unpin_page(PageId{fd, 1}, false));
+
+    // 日志持久化之后页面0才被写回
+    std::vector<char> buf(PAGE_SIZE);
+    disk_manager_->read_page(fd, 0, buf.data(), PAGE_SIZE);
+    lsn_t disk_lsn;
+    memcpy(&disk_lsn, buf.data() + Page::OFFSET_LSN, sizeof(lsn_t));
+    EXPECT_EQ(disk_lsn, page_lsn);
+    EXPECT_EQ(0, strcmp(buf.data() + Page::OFFSET_PAGE_HDR, "logged"));
+}
+
 /** 注意：每个测试点只测试了单个文件！
  * 对于每个测试点，先创建和进入目录TEST_DB_NAME
  * 然后在此目录下创建和打开文件TEST_FILE_NAME_CCUR，记录其文件描述符fd */
@@ -661,3 +742,1395 @@ TEST(RecordManagerTest, SimpleTest) {
     rm_manager->close_file(file_handle.get());
     rm_manager->destroy_file(filename);
 }
+
+TEST(RecordManagerTest, SampleTest) {
+    auto disk_manager = std::make_unique<DiskManager>();
+    auto buffer_pool_manager = std::make_unique<BufferPoolManager>(BUFFER_POOL_SIZE, disk_manager.get());
+    auto rm_manager = std::make_unique<RmManager>(disk_manager.get(), buffer_pool_manager.get());
+
+    std::string filename = "sample.txt";
+    if (disk_manager->is_file(filename)) {
+        disk_manager->destroy_file(filename);
+    }
+    int record_size = 64;
+    int num_records = 2000;
+    rm_manager->create_file(filename, record_size);
+    auto file_handle = rm_manager->open_file(filename);
+    char write_buf[PAGE_SIZE];
+    for (int i = 0; i < num_records; i++) {
+        memset(write_buf, 0, record_size);
+        *(int *)write_buf = i;
+        file_handle->insert_record(write_buf, nullptr);
+    }
+    rm_manager->close_file(file_handle.get());
+
+    // 用新的缓冲池重新打开文件，采样之后缓冲池中不应该有任何页面
+    auto sample_bpm = std::make_unique<BufferPoolManager>(TEST_BUFFER_POOL_SIZE, disk_manager.get());
+    auto sample_rm_manager = std::make_unique<RmManager>(disk_manager.get(), sample_bpm.get());
+    file_handle = sample_rm_manager->open_file(filename);
+
+    // 全表采样，结果应该是精确的
+    RmSampler full_sampler(file_handle.get(), 1.0);
+    RmSampleStats stats = full_sampler.sample([](const RmRecord &rec) { return *(int *)rec.data < 500; },
+                                              std::chrono::seconds(10));
+    EXPECT_EQ(stats.sampled_pages, stats.total_pages);
+    EXPECT_EQ(stats.sampled_records, (size_t)num_records);
+    EXPECT_EQ(stats.matched_records, (size_t)500);
+    EXPECT_DOUBLE_EQ(stats.est_records(), num_records);
+    EXPECT_TRUE(sample_bpm->page_table_.empty());
+
+    // 部分采样，至少采样min_pages个页面
+    RmSampler part_sampler(file_handle.get(), 0.1, 2);
+    stats = part_sampler.sample(nullptr, std::chrono::seconds(10));
+    EXPECT_GE(stats.sampled_pages, 2);
+    EXPECT_EQ(stats.matched_records, stats.sampled_records);
+    EXPECT_TRUE(sample_bpm->page_table_.empty());
+
+    sample_rm_manager->close_file(file_handle.get());
+    rm_manager->destroy_file(filename);
+}
+
+TEST(LockManagerTest, SimpleTest) {
+    LockManager lock_manager;
+    Transaction txn1(1), txn2(2);
+    int fd = 3;
+    Rid rid{1, 1};
+
+    // 表级S锁相互兼容，与X锁冲突，no-wait下冲突直接回滚
+    EXPECT_TRUE(lock_manager.lock_shared_on_table(&txn1, fd));
+    EXPECT_TRUE(lock_manager.lock_shared_on_table(&txn2, fd));
+    EXPECT_THROW(lock_manager.lock_exclusive_on_table(&txn2, fd), TransactionAbortException);
+    // S + IX 升级为SIX，与其他事务的S锁冲突
+    EXPECT_THROW(lock_manager.lock_IX_on_table(&txn1, fd), TransactionAbortException);
+    lock_manager.unlock_all(&txn2);
+    // 释放锁之后进入收缩阶段，不能再申请锁
+    EXPECT_THROW(lock_manager.lock_IS_on_table(&txn2, fd), TransactionAbortException);
+    Transaction txn3(3);
+    EXPECT_TRUE(lock_manager.lock_IX_on_table(&txn1, fd));
+    EXPECT_TRUE(lock_manager.lock_IS_on_table(&txn3, fd));
+
+    // 行级X锁互斥，已持有的锁可以重复申请
+    EXPECT_TRUE(lock_manager.lock_exclusive_on_record(&txn1, rid, fd));
+    EXPECT_TRUE(lock_manager.lock_shared_on_record(&txn1, rid, fd));
+    EXPECT_THROW(lock_manager.lock_shared_on_record(&txn3, rid, fd), TransactionAbortException);
+    EXPECT_EQ(txn1.get_lock_set()->size(), (size_t)2);
+
+    lock_manager.unlock_all(&txn1);
+    lock_manager.unlock_all(&txn3);
+    for (auto &bucket : lock_manager.buckets_) {
+        EXPECT_TRUE(bucket.lock_table_.empty());
+    }
+}
+
+TEST(LockManagerTest, ConcurrencyTest) {
+    LockManager lock_manager;
+    const int num_locks = 20000;
+    // 不同线程在不同的表和记录上加解锁，分区锁表下吞吐量应随线程数增长
+    for (int num_threads : {1, 4, 8}) {
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (int t = 0; t < num_threads; t++) {
+            threads.emplace_back([&lock_manager, t]() {
+                int fd = 3 + t;
+                for (int i = 0; i < num_locks; i++) {
+                    Transaction txn(t * num_locks + i);
+                    lock_manager.lock_IX_on_table(&txn, fd);
+                    lock_manager.lock_exclusive_on_record(&txn, Rid{t + 1, i}, fd);
+                    lock_manager.unlock_all(&txn);
+                }
+            });
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << num_threads << " threads: " << num_threads * num_locks / secs << " txns/s" << std::endl;
+    }
+    for (auto &bucket : lock_manager.buckets_) {
+        EXPECT_TRUE(bucket.lock_table_.empty());
+    }
+}
+
+TEST(LockManagerTest, DeadlockDetectionTest) {
+    LockManager lock_manager;
+    lock_manager.set_deadlock_policy(DeadlockPolicy::DETECTION);
+    lock_manager.start_deadlock_detection();
+    Transaction txn1(1), txn2(2);
+    int fd = 3;
+    Rid rid1{1, 1}, rid2{1, 2};
+    EXPECT_TRUE(lock_manager.lock_exclusive_on_record(&txn1, rid1, fd));
+    EXPECT_TRUE(lock_manager.lock_exclusive_on_record(&txn2, rid2, fd));
+
+    // txn1等待txn2，txn2等待txn1，检测线程应回滚较年轻的txn2
+    std::thread waiter([&]() { EXPECT_TRUE(lock_manager.lock_exclusive_on_record(&txn1, rid2, fd)); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    EXPECT_THROW(lock_manager.lock_exclusive_on_record(&txn2, rid1, fd), TransactionAbortException);
+    lock_manager.unlock_all(&txn2);
+    waiter.join();
+    EXPECT_EQ(txn1.get_lock_set()->size(), (size_t)2);
+    lock_manager.unlock_all(&txn1);
+    lock_manager.stop_deadlock_detection();
+
+    // wait-die：年老的事务等待，年轻的事务直接回滚
+    lock_manager.set_deadlock_policy(DeadlockPolicy::WAIT_DIE);
+    Transaction txn3(3), txn4(4), txn5(5);
+    EXPECT_TRUE(lock_manager.lock_exclusive_on_record(&txn4, rid1, fd));
+    EXPECT_THROW(lock_manager.lock_shared_on_record(&txn5, rid1, fd), TransactionAbortException);
+    std::thread older([&]() { EXPECT_TRUE(lock_manager.lock_shared_on_record(&txn3, rid1, fd)); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    lock_manager.unlock_all(&txn4);
+    older.join();
+    lock_manager.unlock_all(&txn3);
+    for (auto &bucket : lock_manager.buckets_) {
+        EXPECT_TRUE(bucket.lock_table_.empty());
+    }
+}
+
+TEST(LockManagerTest, InterruptTest) {
+    // 阻塞等待锁的语句超时或者被取消时中止，等待中的申请被撤销，不影响锁的持有者和之后的申请
+    for (DeadlockPolicy policy : {DeadlockPolicy::WAIT_DIE, DeadlockPolicy::DETECTION}) {
+        LockManager lock_manager;
+        lock_manager.set_deadlock_policy(policy);
+        Transaction old_txn(1), young_txn(2);
+        int fd = 3;
+        Rid rid{1, 1};
+        EXPECT_TRUE(lock_manager.lock_exclusive_on_record(&young_txn, rid, fd));
+        auto abort_reason = [&](Context &context) {
+            auto start = std::chrono::steady_clock::now();
+            try {
+                lock_manager.lock_exclusive_on_record(&old_txn, rid, fd, &context);
+            } catch (TransactionAbortException &e) {
+                EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+                return e.GetAbortReason();
+            }
+            ADD_FAILURE() << "lock wait was not interrupted";
+            return AbortReason::DEADLOCK_PREVENTION;
+        };
+
+        Context timeout_context(&lock_manager, nullptr, &old_txn);
+        timeout_context.deadline_ = std::chrono::steady_clock::now() + std::chrono::milliseconds(100);
+        EXPECT_EQ(abort_reason(timeout_context), AbortReason::STATEMENT_TIMEOUT);
+
+        std::atomic<bool> cancel{false};
+        Context cancel_context(&lock_manager, nullptr, &old_txn);
+        cancel_context.cancel_ = &cancel;
+        std::thread canceler([&]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            cancel = true;
+        });
+        EXPECT_EQ(abort_reason(cancel_context), AbortReason::STATEMENT_CANCELED);
+        canceler.join();
+        EXPECT_EQ(lock_manager.get_bucket(LockDataId(fd, rid, LockDataType::RECORD))
+                      .lock_table_.at(LockDataId(fd, rid, LockDataType::RECORD))
+                      ->request_queue_.size(),
+                  (size_t)1);
+
+        // 没有被中止的等待者在锁释放后得到锁
+        Transaction waiter_txn(0);
+        Context context(&lock_manager, nullptr, &waiter_txn);
+        std::thread waiter([&]() { EXPECT_TRUE(lock_manager.lock_exclusive_on_record(&waiter_txn, rid, fd, &context)); });
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        lock_manager.unlock_all(&young_txn);
+        waiter.join();
+        lock_manager.unlock_all(&waiter_txn);
+        lock_manager.unlock_all(&old_txn);
+        for (auto &bucket : lock_manager.buckets_) {
+            EXPECT_TRUE(bucket.lock_table_.empty());
+        }
+    }
+}
+
+TEST(LockManagerTest, DeadlockPolicyTest) {
+    // 多个线程以随机顺序对少量热点记录加X锁，比较不同死锁处理策略下的回滚率和吞吐量
+    const int num_threads = 4;
+    const int num_records = 8;
+    const auto duration = std::chrono::milliseconds(300);
+    std::pair<DeadlockPolicy, const char *> policies[] = {{DeadlockPolicy::NO_WAIT, "no-wait"},
+                                                         {DeadlockPolicy::WAIT_DIE, "wait-die"},
+                                                         {DeadlockPolicy::DETECTION, "detection"}};
+    for (auto &[policy, name] : policies) {
+        LockManager lock_manager;
+        lock_manager.set_deadlock_policy(policy);
+        if (policy == DeadlockPolicy::DETECTION) {
+            lock_manager.start_deadlock_detection();
+        }
+        std::atomic<txn_id_t> next_txn_id{0};
+        std::atomic<size_t> commits{0}, aborts{0};
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (int t = 0; t < num_threads; t++) {
+            threads.emplace_back([&, t]() {
+                std::mt19937 rng(t);
+                while (std::chrono::steady_clock::now() - start < duration) {
+                    Transaction txn(next_txn_id++);
+                    try {
+                        lock_manager.lock_IX_on_table(&txn, 3);
+                        for (int i = 0; i < 2; i++) {
+                            lock_manager.lock_exclusive_on_record(&txn, Rid{1, (int)(rng() % num_records)}, 3);
+                            std::this_thread::yield();
+                        }
+                        commits++;
+                    } catch (TransactionAbortException &e) {
+                        aborts++;
+                    }
+                    lock_manager.unlock_all(&txn);
+                }
+            });
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        lock_manager.stop_deadlock_detection();
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << name << ": " << commits / secs << " txns/s, abort rate "
+                  << (double)aborts / (commits + aborts) << std::endl;
+        EXPECT_GT(commits.load(), (size_t)0);
+        for (auto &bucket : lock_manager.buckets_) {
+            EXPECT_TRUE(bucket.lock_table_.empty());
+        }
+    }
+}
+
+TEST(LockManagerTest, EscalationTest) {
+    LockManager lock_manager;
+    lock_manager.set_escalation_threshold(10);
+    Transaction txn1(1), txn2(2);
+    int fd = 3;
+    auto num_queues = [&]() {
+        size_t num = 0;
+        for (auto &bucket : lock_manager.buckets_) {
+            num += bucket.lock_table_.size();
+        }
+        return num;
+    };
+
+    // 行级X锁超过阈值后升级为表级X锁，释放全部行锁
+    EXPECT_TRUE(lock_manager.lock_IX_on_table(&txn1, fd));
+    for (int i = 0; i < 1000; i++) {
+        EXPECT_TRUE(lock_manager.lock_exclusive_on_record(&txn1, Rid{1, i}, fd));
+    }
+    EXPECT_EQ(txn1.get_lock_set()->size(), (size_t)1);
+    EXPECT_EQ(num_queues(), (size_t)1);
+    EXPECT_THROW(lock_manager.lock_IS_on_table(&txn2, fd), TransactionAbortException);
+    lock_manager.unlock_all(&txn1);
+
+    // 行级S锁升级为表级SIX锁，只释放行级S锁
+    Transaction txn3(3);
+    EXPECT_TRUE(lock_manager.lock_IX_on_table(&txn3, fd + 1));
+    EXPECT_TRUE(lock_manager.lock_exclusive_on_record(&txn3, Rid{1, 0}, fd + 1));
+    for (int i = 1; i < 100; i++) {
+        EXPECT_TRUE(lock_manager.lock_shared_on_record(&txn3, Rid{1, i}, fd + 1));
+    }
+    EXPECT_EQ(txn3.get_lock_set()->size(), (size_t)2);
+    lock_manager.unlock_all(&txn3);
+    EXPECT_EQ(num_queues(), (size_t)0);
+}
+
+TEST(TxnTableTest, SimpleTest) {
+    // 容量很小的事务表，探测窗口占满后的事务进入溢出表
+    TxnTable txn_table(64);
+    std::vector<std::unique_ptr<Transaction>> txns;
+    for (int i = 0; i < 100; i++) {
+        txns.push_back(std::make_unique<Transaction>(i));
+        txn_table.insert(txns.back().get());
+    }
+    EXPECT_GT(txn_table.overflow_.size(), 0);
+    EXPECT_EQ(txn_table.size(), 100);
+    for (int i = 0; i < 100; i += 2) {
+        EXPECT_TRUE(txn_table.erase(i));
+    }
+    for (int i = 0; i < 100; i++) {
+        EXPECT_EQ(txn_table.find(i), i % 2 == 0 ? nullptr : txns[i].get());
+    }
+    EXPECT_FALSE(txn_table.erase(0));
+
+    // 多个线程并发插入、查找、删除各自的事务
+    const int num_threads = 4;
+    const int num_txns = 10000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; t++) {
+        threads.emplace_back([&, t]() {
+            for (int i = 0; i < num_txns; i++) {
+                Transaction txn(1000 + i * num_threads + t);
+                txn_table.insert(&txn);
+                EXPECT_EQ(txn_table.find(txn.get_transaction_id()), &txn);
+                EXPECT_TRUE(txn_table.erase(txn.get_transaction_id()));
+                EXPECT_EQ(txn_table.find(txn.get_transaction_id()), nullptr);
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(txn_table.size(), 50);
+}
+
+TEST(TxnTableTest, EpochReclaimTest) {
+    static std::atomic<int> num_freed{0};
+    struct Object {
+        ~Object() { num_freed++; }
+    };
+    EpochManager epoch_manager;
+    std::atomic<bool> entered{false}, done{false};
+
+    // 读者在retire之前进入纪元，退出前对象不能被释放
+    std::thread reader([&]() {
+        EpochGuard guard(&epoch_manager);
+        entered = true;
+        while (!done) {
+            std::this_thread::yield();
+        }
+    });
+    while (!entered) {
+        std::this_thread::yield();
+    }
+    epoch_manager.retire(new Object());
+    for (int i = 0; i < 5; i++) {
+        epoch_manager.reclaim();
+    }
+    EXPECT_EQ(num_freed, 0);
+    EXPECT_EQ(epoch_manager.num_retired(), 1);
+
+    done = true;
+    reader.join();
+    for (int i = 0; i < 3; i++) {
+        epoch_manager.reclaim();
+    }
+    EXPECT_EQ(num_freed, 1);
+    EXPECT_EQ(epoch_manager.num_retired(), 0);
+
+    // 嵌套进入只在最外层退出后失效
+    epoch_manager.enter();
+    epoch_manager.enter();
+    epoch_manager.exit();
+    epoch_manager.retire(new Object());
+    uint64_t epoch = epoch_manager.get_epoch();
+    for (int i = 0; i < 5; i++) {
+        epoch_manager.reclaim();
+    }
+    EXPECT_EQ(num_freed, 1);
+    EXPECT_LE(epoch_manager.get_epoch(), epoch + 1);
+    epoch_manager.exit();
+}
+
+TEST(LogManagerTest, GroupCommitTest) {
+    const int num_threads = 16;
+    const int num_commits = 100;
+    // 每个线程不断提交事务：追加begin和commit日志，等待commit日志持久化
+    auto run = [&](bool group_commit) {
+        DiskManager disk_manager;
+        disk_manager.destroy_log();
+        auto log_manager = std::make_unique<LogManager>(&disk_manager);
+        if (group_commit) {
+            log_manager->start_flusher();
+        }
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (int t = 0; t < num_threads; t++) {
+            threads.emplace_back([&, t]() {
+                for (int i = 0; i < num_commits; i++) {
+                    txn_id_t txn_id = t * num_commits + i;
+                    BeginLogRecord begin_log(txn_id);
+                    log_manager->add_log_to_buffer(&begin_log);
+                    CommitLogRecord commit_log(txn_id);
+                    lsn_t lsn = log_manager->add_log_to_buffer(&commit_log);
+                    log_manager->wait_for_flush(lsn);
+                    EXPECT_GE(log_manager->get_persist_lsn(), lsn);
+                }
+            });
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        log_manager->stop_flusher();
+        EXPECT_EQ(disk_manager.get_log_end(), num_threads * num_commits * 2 * LOG_HEADER_SIZE);
+        std::cout << (group_commit ? "group commit: " : "flush per commit: ") << num_threads * num_commits / seconds
+                  << " commits/s\n";
+        disk_manager.destroy_log();
+    };
+    run(false);
+    run(true);
+}
+
+TEST(LogManagerTest, ConcurrentAppendTest) {
+    const int num_records = 20000;
+    // 多个线程并发追加日志，日志量超过多个缓冲区，检查文件中的日志完整且日志号与位置一致
+    auto run = [&](int num_threads, lsn_t start_lsn) {
+        DiskManager disk_manager;
+        disk_manager.destroy_log();
+        auto log_manager = std::make_unique<LogManager>(&disk_manager);
+        log_manager->set_next_lsn(start_lsn);
+        log_manager->start_flusher();
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (int t = 0; t < num_threads; t++) {
+            threads.emplace_back([&, t]() {
+                for (int i = 0; i < num_records; i++) {
+                    BeginLogRecord log_record(t);
+                    log_manager->add_log_to_buffer(&log_record);
+                }
+            });
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        log_manager->stop_flusher();
+        std::cout << num_threads << " threads: " << num_threads * num_records / seconds << " appends/s\n";
+
+        int file_size = disk_manager.get_log_end() - start_lsn;
+        ASSERT_EQ(file_size, num_threads * num_records * LOG_HEADER_SIZE);
+        std::vector<char> data(file_size);
+        ASSERT_EQ(disk_manager.read_log(data.data(), file_size, start_lsn), file_size);
+        std::vector<int> counts(num_threads);
+        for (int offset = 0; offset < file_size; offset += LOG_HEADER_SIZE) {
+            BeginLogRecord log_record;
+            log_record.deserialize(data.data() + offset);
+            ASSERT_EQ(log_record.lsn_, start_lsn + offset);
+            counts[log_record.log_tid_]++;
+        }
+        for (int t = 0; t < num_threads; t++) {
+            EXPECT_EQ(counts[t], num_records);
+        }
+        disk_manager.destroy_log();
+    };
+    run(1, 0);
+    run(32, 0);
+    // 日志号跨越旧的状态字中32位日志号的上限
+    run(32, (1LL << 32) - LOG_BUFFER_SIZE);
+}
+
+TEST(LogManagerTest, LogSegmentTest) {
+    DiskManager disk_manager;
+    disk_manager.destroy_log();
+    // 写入跨越日志段边界的日志，日志段按日志号定位
+    std::vector<char> data(LOG_SEGMENT_SIZE / 2);
+    for (size_t i = 0; i < data.size(); i++) {
+        data[i] = static_cast<char>(rand());
+    }
+    int offset = LOG_SEGMENT_SIZE - LOG_SEGMENT_SIZE / 4;
+    disk_manager.write_log(data.data(), offset, 0);
+    disk_manager.write_log(data.data(), data.size(), offset);
+    disk_manager.sync_log();
+    EXPECT_EQ(disk_manager.get_log_end(), offset + static_cast<int>(data.size()));
+    EXPECT_EQ(disk_manager.get_file_size(LOG_FILE_NAME + ".00000000"), LOG_SEGMENT_FILE_SIZE);
+    EXPECT_EQ(disk_manager.get_file_size(LOG_FILE_NAME + ".00000001"), LOG_SEGMENT_FILE_SIZE);
+    std::vector<char> buf(data.size());
+    ASSERT_EQ(disk_manager.read_log(buf.data(), buf.size(), offset), static_cast<int>(buf.size()));
+    EXPECT_EQ(buf, data);
+    // 读到最后一个日志段末尾为止
+    EXPECT_EQ(disk_manager.read_log(buf.data(), buf.size(), 2 * LOG_SEGMENT_SIZE - 10), 10);
+
+    // 第一个日志段被回收为第三个日志段，段头的编号不一致，不能读取
+    disk_manager.discard_log(LOG_SEGMENT_SIZE + 1);
+    EXPECT_FALSE(disk_manager.is_file(LOG_FILE_NAME + ".00000000"));
+    EXPECT_TRUE(disk_manager.is_file(LOG_FILE_NAME + ".00000002"));
+    EXPECT_EQ(disk_manager.read_log(buf.data(), 16, 0), 0);
+    EXPECT_EQ(disk_manager.read_log(buf.data(), 16, 2 * LOG_SEGMENT_SIZE), 0);
+    EXPECT_EQ(disk_manager.read_log(buf.data(), 16, 2 * LOG_SEGMENT_SIZE - 8), 8);
+
+    // 截断后有效日志之后的内容为0，之后的日志段被删除
+    disk_manager.truncate_log(LOG_SEGMENT_SIZE + 100);
+    EXPECT_FALSE(disk_manager.is_file(LOG_FILE_NAME + ".00000002"));
+    ASSERT_EQ(disk_manager.read_log(buf.data(), 200, LOG_SEGMENT_SIZE), 200);
+    EXPECT_TRUE(std::equal(buf.begin(), buf.begin() + 100, data.begin() + LOG_SEGMENT_SIZE / 4));
+    EXPECT_TRUE(std::all_of(buf.begin() + 100, buf.begin() + 200, [](char c) { return c == 0; }));
+    disk_manager.destroy_log();
+}
+
+// 日志总量超过2GB后日志号仍然为正：追加、日志段定位、主记录、恢复时的扫描和回收都按64位的偏移量处理
+TEST(LogManagerTest, LargeLsnTest) {
+    DiskManager disk_manager;
+    disk_manager.destroy_log();
+    auto buffer_pool_manager = std::make_unique<BufferPoolManager>(TEST_BUFFER_POOL_SIZE, &disk_manager);
+    auto rm_manager = std::make_unique<RmManager>(&disk_manager, buffer_pool_manager.get());
+    auto ix_manager = std::make_unique<IxManager>(&disk_manager, buffer_pool_manager.get());
+    auto sm_manager =
+        std::make_unique<SmManager>(&disk_manager, buffer_pool_manager.get(), rm_manager.get(), ix_manager.get());
+    // 从旧的32位上限之前不远处开始，日志跨越2^31
+    const lsn_t start_lsn = (1LL << 31) - 10 * LOG_HEADER_SIZE;
+    const int num_records = 20;
+    const lsn_t end_lsn = start_lsn + num_records * LOG_HEADER_SIZE;
+    const txn_id_t txn_id = 1;
+    std::vector<lsn_t> lsns;
+    auto log_manager = std::make_unique<LogManager>(&disk_manager);
+    log_manager->set_next_lsn(start_lsn);
+    EXPECT_EQ(log_manager->get_buffer_start_lsn(), start_lsn);
+    for (int i = 0; i < num_records; i++) {
+        BeginLogRecord log_record(txn_id);
+        log_record.prev_lsn_ = lsns.empty() ? INVALID_LSN : lsns.back();
+        lsns.push_back(log_manager->add_log_to_buffer(&log_record));
+        EXPECT_EQ(lsns.back(), start_lsn + i * LOG_HEADER_SIZE);
+    }
+    log_manager->flush_log_to_disk();
+    EXPECT_EQ(log_manager->get_persist_lsn(), end_lsn - 1);
+    EXPECT_EQ(disk_manager.get_log_end(), end_lsn);
+    EXPECT_TRUE(disk_manager.is_file(LOG_FILE_NAME + ".00000127"));
+    EXPECT_TRUE(disk_manager.is_file(LOG_FILE_NAME + ".00000128"));
+    std::vector<char> data(end_lsn - start_lsn);
+    ASSERT_EQ(disk_manager.read_log(data.data(), data.size(), start_lsn), static_cast<int>(data.size()));
+    for (lsn_t lsn : lsns) {
+        EXPECT_TRUE(check_log_record(data.data() + (lsn - start_lsn), end_lsn - lsn, lsn));
+    }
+
+    // 主记录保存完整的日志号
+    disk_manager.write_master_record(lsns[5], start_lsn);
+    lsn_t checkpoint_lsn = INVALID_LSN;
+    lsn_t log_start_lsn = INVALID_LSN;
+    ASSERT_TRUE(disk_manager.read_master_record(checkpoint_lsn, log_start_lsn));
+    EXPECT_EQ(checkpoint_lsn, lsns[5]);
+    EXPECT_EQ(log_start_lsn, start_lsn);
+
+    // 分析阶段从主记录中的日志号开始扫描到日志末尾，沿prev_lsn链读回未完成事务的全部日志
+    log_manager = std::make_unique<LogManager>(&disk_manager);
+    auto recovery = std::make_unique<RecoveryManager>(&disk_manager, buffer_pool_manager.get(), sm_manager.get(),
+                                                      log_manager.get());
+    recovery->analyze();
+    EXPECT_EQ(recovery->get_log_start_lsn(), start_lsn);
+    EXPECT_EQ(recovery->get_log_end_lsn(), end_lsn);
+    auto pending_txns = recovery->get_pending_txns();
+    ASSERT_EQ(pending_txns.count(txn_id), 1u);
+    EXPECT_EQ(pending_txns[txn_id].first_lsn, start_lsn);
+    BeginLogRecord log_record(txn_id + 1);
+    EXPECT_EQ(log_manager->add_log_to_buffer(&log_record), end_lsn);
+
+    // 回收2^31之前的日志段，之后的日志仍然可以读取
+    disk_manager.discard_log(1LL << 31);
+    EXPECT_FALSE(disk_manager.is_file(LOG_FILE_NAME + ".00000127"));
+    EXPECT_EQ(disk_manager.read_log(data.data(), LOG_HEADER_SIZE, lsns[10]), LOG_HEADER_SIZE);
+    EXPECT_TRUE(check_log_record(data.data(), LOG_HEADER_SIZE, lsns[10]));
+    log_manager.reset();
+    disk_manager.destroy_log();
+    disk_manager.destroy_file(MASTER_RECORD_NAME);
+}
+
+TEST(LogManagerTest, LogChecksumTest) {
+    DiskManager disk_manager;
+    disk_manager.destroy_log();
+    auto log_manager = std::make_unique<LogManager>(&disk_manager);
+    std::vector<lsn_t> lsns;
+    for (int i = 0; i < 10; i++) {
+        BeginLogRecord log_record(i);
+        lsns.push_back(log_manager->add_log_to_buffer(&log_record));
+    }
+    log_manager->flush_log_to_disk();
+    int size = disk_manager.get_log_end();
+    std::vector<char> data(size);
+    ASSERT_EQ(disk_manager.read_log(data.data(), size, 0), size);
+    for (lsn_t lsn : lsns) {
+        EXPECT_TRUE(check_log_record(data.data() + lsn, size - lsn, lsn));
+    }
+    // 日志号与位置不一致、日志被截断或者内容被修改的日志都无法通过检查
+    EXPECT_FALSE(check_log_record(data.data() + lsns[1], size - lsns[1], lsns[2]));
+    EXPECT_FALSE(check_log_record(data.data() + lsns[1], LOG_HEADER_SIZE - 1, lsns[1]));
+    data[lsns[5] + OFFSET_LOG_TID] ^= 1;
+    EXPECT_FALSE(check_log_record(data.data() + lsns[5], size - lsns[5], lsns[5]));
+    EXPECT_TRUE(check_log_record(data.data() + lsns[6], size - lsns[6], lsns[6]));
+    // 软件查表与硬件指令的结果一致
+    const char* str = "123456789";
+    EXPECT_EQ(crc32c::value(str, 9), 0xE3069283);
+    EXPECT_EQ(~crc32c::extend_sw(~0u, data.data(), size), crc32c::value(data.data(), size));
+    disk_manager.destroy_log();
+}
+
+TEST(LogManagerTest, UpdateLogTest) {
+    const int record_size = 512;
+    // 只修改记录中的几个整数，日志中只包含变化的字节区间
+    std::vector<char> old_value(record_size);
+    for (int i = 0; i < record_size; i++) {
+        old_value[i] = static_cast<char>(i * 7);
+    }
+    std::vector<char> new_value = old_value;
+    int changes[][2] = {{4, 100}, {8, -3}, {300, 1 << 20}, {508, 42}};
+    for (auto &[offset, value] : changes) {
+        memcpy(new_value.data() + offset, &value, sizeof(int));
+    }
+    UpdateLogRecord log_record(7, old_value.data(), new_value.data(), record_size, Rid{300, 129}, 200);
+    EXPECT_LT(log_record.log_tot_len_, LOG_HEADER_SIZE + 64);
+
+    std::vector<char> buf(log_record.log_tot_len_);
+    log_record.serialize(buf.data());
+    auto read = deserialize_log_record(buf.data());
+    ASSERT_NE(read, nullptr);
+    ASSERT_EQ(read->log_type_, LogType::UPDATE);
+    auto &update = static_cast<UpdateLogRecord &>(*read);
+    EXPECT_EQ(update.log_tid_, 7);
+    EXPECT_EQ(update.table_id_, 200);
+    EXPECT_EQ(update.rid_, (Rid{300, 129}));
+    EXPECT_EQ(update.ranges_.size(), log_record.ranges_.size());
+
+    std::vector<char> data = old_value;
+    update.redo(data.data());
+    EXPECT_EQ(data, new_value);
+    update.undo(data.data());
+    EXPECT_EQ(data, old_value);
+}
+
+/** SQL级别的测试：在目录TEST_SQL_DB_NAME中新建数据库，
+ * 按rmdb处理请求的流程（解析、语义分析、生成计划、执行）执行SQL语句 */
+
+const std::string TEST_SQL_DB_NAME = "SqlTest_db";
+
+class SqlTest : public ::testing::Test {
+   public:
+    std::unique_ptr<DiskManager> disk_manager_;
+    std::unique_ptr<BufferPoolManager> buffer_pool_manager_;
+    std::unique_ptr<RmManager> rm_manager_;
+    std::unique_ptr<IxManager> ix_manager_;
+    std::unique_ptr<SmManager> sm_manager_;
+    std::unique_ptr<LockManager> lock_manager_;
+    std::unique_ptr<TransactionManager> txn_manager_;
+    std::unique_ptr<Planner> planner_;
+    std::unique_ptr<Optimizer> optimizer_;
+    std::unique_ptr<QlManager> ql_manager_;
+    std::unique_ptr<Portal> portal_;
+    std::unique_ptr<Analyze> analyze_;
+    SessionVars session_;
+    std::shared_ptr<Plan> last_plan_;  // 最近一条语句执行的计划
+
+   public:
+    void SetUp() override {
+        ::testing::Test::SetUp();
+        disk_manager_ = std::make_unique<DiskManager>();
+        buffer_pool_manager_ = std::make_unique<BufferPoolManager>(BUFFER_POOL_SIZE, disk_manager_.get());
+        rm_manager_ = std::make_unique<RmManager>(disk_manager_.get(), buffer_pool_manager_.get());
+        ix_manager_ = std::make_unique<IxManager>(disk_manager_.get(), buffer_pool_manager_.get());
+        sm_manager_ = std::make_unique<SmManager>(disk_manager_.get(), buffer_pool_manager_.get(), rm_manager_.get(),
+                                                  ix_manager_.get());
+        lock_manager_ = std::make_unique<LockManager>();
+        txn_manager_ = std::make_unique<TransactionManager>(lock_manager_.get(), sm_manager_.get());
+        planner_ = std::make_unique<Planner>(sm_manager_.get());
+        optimizer_ = std::make_unique<Optimizer>(sm_manager_.get(), planner_.get());
+        ql_manager_ = std::make_unique<QlManager>(sm_manager_.get(), txn_manager_.get(), planner_.get());
+        portal_ = std::make_unique<Portal>(sm_manager_.get(), planner_->get_feedback(), planner_->get_sampler());
+        analyze_ = std::make_unique<Analyze>(sm_manager_.get());
+        // 上一个测试点留下的数据库先删除
+        if (disk_manager_->is_dir(TEST_SQL_DB_NAME)) {
+            sm_manager_->drop_db(TEST_SQL_DB_NAME);
+        }
+        sm_manager_->create_db(TEST_SQL_DB_NAME);
+        sm_manager_->open_db(TEST_SQL_DB_NAME);
+    }
+
+    void TearDown() override { sm_manager_->close_db(); }
+
+    /**
+     * @description: 在事务txn中执行一条SQL语句，txn为空时单独开启一个事务并在执行后提交
+     * @return {string} 返回给客户端的结果
+     */
+    std::string execute(const std::string &sql, Transaction *txn = nullptr) {
+        std::vector<char> data_send(BUFFER_LENGTH);
+        int offset = 0;
+        Context context(lock_manager_.get(), nullptr, txn, data_send.data(), &offset);
+        context.txn_mgr_ = txn_manager_.get();
+        context.session_ = &session_;
+        if (txn == nullptr) {
+            context.txn_ = txn_manager_->begin(nullptr, nullptr);
+        }
+        txn_id_t txn_id = context.txn_->get_transaction_id();
+        YY_BUFFER_STATE buf = yy_scan_string(sql.c_str());
+        EXPECT_EQ(yyparse(), 0) << sql;
+        yy_delete_buffer(buf);
+        std::shared_ptr<Query> query = analyze_->do_analyze(ast::parse_tree);
+        last_plan_ = optimizer_->plan_query(query, &context);
+        std::shared_ptr<PortalStmt> stmt = portal_->start(last_plan_, &context);
+        portal_->run(stmt, ql_manager_.get(), &txn_id, &context);
+        portal_->drop(stmt);
+        if (txn == nullptr) {
+            txn_manager_->commit(context.txn_, nullptr);
+        }
+        return std::string(data_send.data(), offset);
+    }
+};
+
+/** 计划树中第一个连接算子 */
+std::shared_ptr<JoinPlan> find_join(const std::shared_ptr<Plan> &plan) {
+    if (auto x = std::dynamic_pointer_cast<JoinPlan>(plan)) {
+        return x;
+    }
+    if (auto x = std::dynamic_pointer_cast<DMLPlan>(plan)) {
+        return find_join(x->subplan_);
+    }
+    if (auto x = std::dynamic_pointer_cast<ProjectionPlan>(plan)) {
+        return find_join(x->subplan_);
+    }
+    if (auto x = std::dynamic_pointer_cast<SortPlan>(plan)) {
+        return find_join(x->subplan_);
+    }
+    return nullptr;
+}
+
+// 同一个查询第二次生成计划时，连接的基数使用第一次执行回填的实际基数，而不是默认选择率
+TEST_F(SqlTest, CardinalityFeedbackTest) {
+    const int num_rows = 200;
+    execute("create table a (id int, v int);");
+    execute("create table b (id int);");
+    for (int i = 0; i < num_rows; i++) {
+        execute("insert into a values (" + std::to_string(i) + ", " + std::to_string(i % 2) + ");");
+        execute("insert into b values (" + std::to_string(i) + ");");
+    }
+    const std::string sql = "select a.v from a, b where a.id = b.id;";
+
+    execute(sql);
+    auto join = find_join(last_plan_);
+    ASSERT_NE(join, nullptr);
+    ASSERT_TRUE(join->has_actual_rows_);
+    EXPECT_EQ(join->actual_rows_, static_cast<size_t>(num_rows));
+    double first_error = std::abs(join->est_rows_ - num_rows);
+    EXPECT_GT(first_error, num_rows);
+
+    execute(sql);
+    join = find_join(last_plan_);
+    ASSERT_NE(join, nullptr);
+    EXPECT_DOUBLE_EQ(join->est_rows_, num_rows);
+    EXPECT_EQ(join->actual_rows_, static_cast<size_t>(num_rows));
+}
+
+// 只有常量不同的谓词共用一次采样；DML的修改量超过阈值、DDL和ANALYZE使表的采样结果失效
+TEST_F(SqlTest, SelectivitySamplerTest) {
+    const int num_rows = 100;
+    execute("create table t (id int, v int);");
+    for (int i = 0; i < num_rows; i++) {
+        execute("insert into t values (" + std::to_string(i) + ", " + std::to_string(i % 4) + ");");
+    }
+    SelectivitySampler *sampler = planner_->get_sampler();
+    execute("select * from t where v = 1;");
+    ASSERT_EQ(sampler->cache_.count("t"), 1u);
+    size_t num_shapes = sampler->cache_.at("t").stats.size();
+    execute("select * from t where v = 2;");
+    execute("select * from t where v = 3;");
+    EXPECT_EQ(sampler->cache_.at("t").stats.size(), num_shapes);
+    execute("select * from t where v = 3 and id > 10;");
+    EXPECT_EQ(sampler->cache_.at("t").stats.size(), num_shapes + 1);
+
+    // ANALYZE丢弃旧结果，以更大的比例重新采样，小表的所有页面都被采样
+    std::string result = execute("analyze t;");
+    size_t pos = result.find("est_records");
+    ASSERT_NE(pos, std::string::npos);
+    std::string line = result.substr(pos, result.find('\n', pos) - pos);
+    EXPECT_NE(line.find(" " + std::to_string(num_rows) + " |"), std::string::npos) << result;
+    EXPECT_EQ(sampler->cache_.at("t").stats.size(), 1u);
+
+    // 修改量不超过表记录数的SAMPLE_STALE_FRACTION时保留采样结果，超过后失效
+    execute("insert into t values (" + std::to_string(num_rows) + ", 0);");
+    ASSERT_EQ(sampler->cache_.count("t"), 1u);
+    execute("delete from t where id < 20;");
+    EXPECT_EQ(sampler->cache_.count("t"), 0u);
+
+    // 执行过的谓词直接使用执行反馈，换一个常量才会重新采样
+    execute("select * from t where v = 0;");
+    ASSERT_EQ(sampler->cache_.count("t"), 1u);
+    execute("drop table t;");
+    EXPECT_EQ(sampler->cache_.count("t"), 0u);
+}
+
+/** 表t的列col和常量v比较的条件 */
+Condition make_cond(const std::string &col, CompOp op, const Value &v) {
+    Condition cond;
+    cond.lhs_col = TabCol{.tab_name = "t", .col_name = col};
+    cond.op = op;
+    cond.is_rhs_val = true;
+    cond.rhs_val = v;
+    return cond;
+}
+
+Value int_value(int v) {
+    Value val;
+    val.set_int(v);
+    return val;
+}
+
+Value float_value(float v) {
+    Value val;
+    val.set_float(v);
+    return val;
+}
+
+// int列和float常量比较时改写为等价的整数比较，超出int范围的常量直接求值
+TEST(AnalyzeTest, CoerceCondTest) {
+    Analyze analyze(nullptr);
+    const int int_min = std::numeric_limits<int>::min();
+    struct Case {
+        CompOp op;
+        float v;
+        CondFoldResult res;
+        CompOp new_op;
+        int new_v;
+    };
+    std::vector<Case> cases = {
+        {OP_GT, 3.5, COND_KEEP, OP_GE, 4},
+        {OP_GE, 3.5, COND_KEEP, OP_GE, 4},
+        {OP_LT, 3.5, COND_KEEP, OP_LE, 3},
+        {OP_LE, -3.5, COND_KEEP, OP_LE, -4},
+        {OP_GT, 3.0, COND_KEEP, OP_GT, 3},
+        {OP_EQ, 3.0, COND_KEEP, OP_EQ, 3},
+        {OP_EQ, 3.5, COND_FALSE},
+        {OP_NE, 3.5, COND_TRUE},
+        // 2^31不在int范围内
+        {OP_EQ, 2147483648.0f, COND_FALSE},
+        {OP_GE, 2147483648.0f, COND_FALSE},
+        {OP_LT, 2147483648.0f, COND_TRUE},
+        {OP_LE, 1e10, COND_TRUE},
+        {OP_GT, -1e10, COND_TRUE},
+        {OP_LT, -1e10, COND_FALSE},
+        // -2^31正好是INT_MIN
+        {OP_GE, -2147483648.0f, COND_TRUE},
+        {OP_LT, -2147483648.0f, COND_FALSE},
+        {OP_GT, -2147483648.0f, COND_KEEP, OP_GT, int_min},
+        {OP_LE, -2147483648.0f, COND_KEEP, OP_LE, int_min},
+    };
+    for (auto &c : cases) {
+        Condition cond = make_cond("a", c.op, float_value(c.v));
+        EXPECT_EQ(analyze.coerce_cond(cond, TYPE_INT), c.res) << "op " << c.op << " value " << c.v;
+        if (c.res == COND_KEEP) {
+            EXPECT_EQ(cond.op, c.new_op) << "op " << c.op << " value " << c.v;
+            EXPECT_EQ(cond.rhs_val.type, TYPE_INT);
+            EXPECT_EQ(cond.rhs_val.int_val, c.new_v) << "op " << c.op << " value " << c.v;
+        }
+    }
+
+    // float列和int常量比较时常量转换为float
+    Condition cond = make_cond("f", OP_LT, int_value(7));
+    EXPECT_EQ(analyze.coerce_cond(cond, TYPE_FLOAT), COND_KEEP);
+    EXPECT_EQ(cond.rhs_val.type, TYPE_FLOAT);
+    EXPECT_EQ(cond.rhs_val.float_val, 7.0f);
+
+    Value str;
+    str.set_str("x");
+    cond = make_cond("a", OP_EQ, str);
+    EXPECT_THROW(analyze.coerce_cond(cond, TYPE_INT), IncompatibleTypeError);
+}
+
+/** 化简一组条件，返回化简后的条件，恒为假时返回空并置always_false */
+std::vector<Condition> normalize(std::vector<Condition> conds, bool &always_false) {
+    Analyze analyze(nullptr);
+    always_false = false;
+    analyze.normalize_clause(conds, always_false);
+    return conds;
+}
+
+void expect_cond(const Condition &cond, const std::string &col, CompOp op, int v) {
+    EXPECT_EQ(cond.lhs_col.col_name, col);
+    EXPECT_EQ(cond.op, op);
+    EXPECT_TRUE(cond.is_rhs_val);
+    EXPECT_EQ(cond.rhs_val.int_val, v);
+}
+
+// 同一列上的条件合并为区间，开区间端点转换为闭区间，空区间和INT_MIN/INT_MAX以外的边界使整个条件恒为假
+TEST(AnalyzeTest, NormalizeClauseTest) {
+    const int int_max = std::numeric_limits<int>::max();
+    const int int_min = std::numeric_limits<int>::min();
+    bool always_false;
+
+    auto conds = normalize({make_cond("a", OP_GT, int_value(3)), make_cond("b", OP_EQ, int_value(1)),
+                            make_cond("a", OP_LT, int_value(10)), make_cond("a", OP_GE, int_value(5))},
+                           always_false);
+    EXPECT_FALSE(always_false);
+    ASSERT_EQ(conds.size(), 3u);
+    expect_cond(conds[0], "a", OP_GE, 5);
+    expect_cond(conds[1], "a", OP_LE, 9);
+    expect_cond(conds[2], "b", OP_EQ, 1);
+
+    // 上下界相等时合并为等值条件
+    conds = normalize({make_cond("a", OP_GT, int_value(4)), make_cond("a", OP_LE, int_value(5))}, always_false);
+    ASSERT_EQ(conds.size(), 1u);
+    expect_cond(conds[0], "a", OP_EQ, 5);
+
+    // 区间之外的不等条件删除，区间之内的保留一次
+    conds = normalize({make_cond("a", OP_NE, int_value(100)), make_cond("a", OP_LT, int_value(10)),
+                       make_cond("a", OP_NE, int_value(3)), make_cond("a", OP_NE, int_value(3))},
+                      always_false);
+    ASSERT_EQ(conds.size(), 2u);
+    expect_cond(conds[0], "a", OP_LE, 9);
+    expect_cond(conds[1], "a", OP_NE, 3);
+
+    // 空区间
+    normalize({make_cond("a", OP_GT, int_value(5)), make_cond("a", OP_LT, int_value(6))}, always_false);
+    EXPECT_TRUE(always_false);
+    normalize({make_cond("a", OP_EQ, int_value(3)), make_cond("a", OP_EQ, int_value(4))}, always_false);
+    EXPECT_TRUE(always_false);
+    normalize({make_cond("a", OP_EQ, int_value(3)), make_cond("a", OP_NE, int_value(3))}, always_false);
+    EXPECT_TRUE(always_false);
+
+    // INT_MAX之上、INT_MIN之下没有整数
+    normalize({make_cond("a", OP_GT, int_value(int_max))}, always_false);
+    EXPECT_TRUE(always_false);
+    normalize({make_cond("a", OP_LT, int_value(int_min))}, always_false);
+    EXPECT_TRUE(always_false);
+    conds = normalize({make_cond("a", OP_GE, int_value(int_max))}, always_false);
+    EXPECT_FALSE(always_false);
+    ASSERT_EQ(conds.size(), 1u);
+    expect_cond(conds[0], "a", OP_GE, int_max);
+    conds = normalize({make_cond("a", OP_LT, int_value(int_min + 1))}, always_false);
+    ASSERT_EQ(conds.size(), 1u);
+    expect_cond(conds[0], "a", OP_LE, int_min);
+
+    // float列的开区间不转换
+    conds = normalize({make_cond("f", OP_GT, float_value(1.5)), make_cond("f", OP_LT, float_value(2.5))},
+                      always_false);
+    ASSERT_EQ(conds.size(), 2u);
+    EXPECT_EQ(conds[0].op, OP_GT);
+    EXPECT_EQ(conds[1].op, OP_LT);
+
+    // 同一列两侧的条件直接求值
+    Condition self;
+    self.lhs_col = self.rhs_col = TabCol{.tab_name = "t", .col_name = "a"};
+    self.is_rhs_val = false;
+    self.op = OP_LE;
+    conds = normalize({self}, always_false);
+    EXPECT_FALSE(always_false);
+    EXPECT_TRUE(conds.empty());
+    self.op = OP_NE;
+    normalize({self}, always_false);
+    EXPECT_TRUE(always_false);
+}
+
+// where条件中的类型转换和区间合并对查询结果不可见，恒为假的条件不扫描任何记录
+TEST_F(SqlTest, AnalyzeWhereClauseTest) {
+    execute("create table t (a int, f float);");
+    for (int i = 1; i <= 6; i++) {
+        execute("insert into t values (" + std::to_string(i) + ", " + std::to_string(i) + ".5);");
+    }
+    struct Case {
+        std::string where;
+        int num_records;
+    };
+    std::vector<Case> cases = {
+        {"a > 2.5 and a < 5.5", 3},
+        {"a >= 2 and a <= 2.9", 1},
+        {"a = 3.0", 1},
+        {"a <> 3.5", 6},
+        {"a > 1 and a > 3 and a <> 5", 2},
+        {"f > 2 and f < 4", 2},
+        {"a < 3000000000.0", 6},
+        {"a > -3000000000.0 and a < 2", 1},
+        {"a = 2147483647 and a > 3", 0},
+    };
+    for (auto &c : cases) {
+        std::string result = execute("select * from t where " + c.where + ";");
+        EXPECT_NE(result.find("Total record(s): " + std::to_string(c.num_records) + "\n"), std::string::npos)
+            << c.where << "\n" << result;
+    }
+
+    std::vector<std::string> false_wheres = {"a = 3.5", "a > 4 and a < 5", "a < -3000000000.0",
+                                             "a > 2147483647", "a < a"};
+    for (auto &where : false_wheres) {
+        std::string result = execute("select * from t where " + where + ";");
+        EXPECT_NE(result.find("Total record(s): 0\n"), std::string::npos) << where << "\n" << result;
+        auto scan = std::dynamic_pointer_cast<ScanPlan>(
+            std::dynamic_pointer_cast<ProjectionPlan>(std::dynamic_pointer_cast<DMLPlan>(last_plan_)->subplan_)
+                ->subplan_);
+        ASSERT_NE(scan, nullptr) << where;
+        EXPECT_TRUE(scan->always_false_) << where;
+        EXPECT_TRUE(scan->has_actual_rows_) << where;
+        EXPECT_EQ(scan->actual_rows_, 0u) << where;
+    }
+}
+
+// 在线备份期间拒绝DDL，备份开始时等待正在执行的DDL结束
+TEST_F(SqlTest, BackupBlocksDDLTest) {
+    execute("create table t (id int);");
+    sm_manager_->begin_backup();
+    EXPECT_THROW(execute("create table u (id int);"), BackupInProgressError);
+    EXPECT_THROW(execute("drop table t;"), BackupInProgressError);
+    EXPECT_TRUE(sm_manager_->db_.is_table("t"));
+    EXPECT_FALSE(sm_manager_->db_.is_table("u"));
+    execute("insert into t values (1);");
+    sm_manager_->end_backup();
+    execute("create table u (id int);");
+    EXPECT_TRUE(sm_manager_->db_.is_table("u"));
+
+    auto ddl_lock = sm_manager_->lock_ddl();
+    std::atomic<bool> started{false};
+    std::thread backup([&]() {
+        sm_manager_->begin_backup();
+        started = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(started);
+    ddl_lock.unlock();
+    backup.join();
+    EXPECT_TRUE(started);
+    sm_manager_->end_backup();
+}
+
+/** MVCC下的测试：表t(id int, v int)中只有一条记录(1, 10) */
+class MvccTest : public SqlTest {
+   public:
+    Rid rid_;   // 记录(1, 10)的位置
+
+   public:
+    void SetUp() override {
+        SqlTest::SetUp();
+        txn_manager_->set_concurrency_mode(ConcurrencyMode::MVCC);
+        execute("create table t (id int, v int);");
+        execute("insert into t values (1, 10);");
+        RmScan scan(sm_manager_->fhs_.at("t").get());
+        ASSERT_FALSE(scan.is_end());
+        rid_ = scan.rid();
+    }
+
+    /** rid_处对事务txn可见的版本中v的值，不可见时返回-1 */
+    int visible_value(Transaction *txn) {
+        Context context(lock_manager_.get(), nullptr, txn);
+        context.txn_mgr_ = txn_manager_.get();
+        auto rec = GetVisibleTuple(&sm_manager_->db_.get_table("t"), sm_manager_->fhs_.at("t").get(), rid_, &context);
+        if (rec == nullptr) {
+            return -1;
+        }
+        return *reinterpret_cast<int *>(rec->data + sizeof(int));
+    }
+
+    /** 在事务txn中执行修改语句，返回是否因写写冲突中止 */
+    bool write_conflicts(const std::string &sql, Transaction *txn) {
+        try {
+            execute(sql, txn);
+        } catch (TransactionAbortException &e) {
+            EXPECT_EQ(e.GetAbortReason(), AbortReason::WRITE_CONFLICT);
+            txn_manager_->abort(txn, nullptr);
+            return true;
+        }
+        return false;
+    }
+};
+
+// 快照读：每个事务看到开始时已经提交的版本和自己的修改，沿版本链重建被覆盖和删除的旧版本
+TEST_F(MvccTest, GetVisibleTupleTest) {
+    Transaction *old_reader = txn_manager_->begin(nullptr, nullptr);
+    Transaction *writer = txn_manager_->begin(nullptr, nullptr);
+    execute("update t set v = 20 where id = 1;", writer);
+    EXPECT_EQ(visible_value(writer), 20);
+    EXPECT_EQ(visible_value(old_reader), 10);
+    // 同一事务再次修改，只保留一条撤销日志，旧版本仍然是提交的值
+    execute("update t set v = 21 where id = 1;", writer);
+    EXPECT_EQ(visible_value(writer), 21);
+    EXPECT_EQ(visible_value(old_reader), 10);
+    txn_manager_->commit(writer, nullptr);
+    EXPECT_EQ(visible_value(old_reader), 10);
+
+    Transaction *mid_reader = txn_manager_->begin(nullptr, nullptr);
+    EXPECT_EQ(visible_value(mid_reader), 21);
+    Transaction *deleter = txn_manager_->begin(nullptr, nullptr);
+    execute("delete from t where id = 1;", deleter);
+    EXPECT_EQ(visible_value(deleter), -1);
+    EXPECT_EQ(visible_value(mid_reader), 21);
+    txn_manager_->commit(deleter, nullptr);
+
+    // 版本链上有两个版本：删除之前的21和更早的10
+    Transaction *new_reader = txn_manager_->begin(nullptr, nullptr);
+    EXPECT_EQ(visible_value(new_reader), -1);
+    EXPECT_EQ(visible_value(mid_reader), 21);
+    EXPECT_EQ(visible_value(old_reader), 10);
+    std::string result = execute("select * from t;", old_reader);
+    EXPECT_NE(result.find("Total record(s): 1\n"), std::string::npos) << result;
+    result = execute("select * from t;", new_reader);
+    EXPECT_NE(result.find("Total record(s): 0\n"), std::string::npos) << result;
+
+    // 未提交的插入只对插入的事务可见
+    Transaction *inserter = txn_manager_->begin(nullptr, nullptr);
+    execute("insert into t values (2, 30);", inserter);
+    result = execute("select * from t where id = 2;", new_reader);
+    EXPECT_NE(result.find("Total record(s): 0\n"), std::string::npos) << result;
+    result = execute("select * from t where id = 2;", inserter);
+    EXPECT_NE(result.find("Total record(s): 1\n"), std::string::npos) << result;
+    txn_manager_->abort(inserter, nullptr);
+    for (auto txn : {old_reader, mid_reader, new_reader}) {
+        txn_manager_->commit(txn, nullptr);
+    }
+}
+
+// 写写冲突（先提交者胜）：元组被未提交的事务修改，或在快照之后被提交修改时，后写的事务中止
+TEST_F(MvccTest, WriteWriteConflictTest) {
+    Transaction *first = txn_manager_->begin(nullptr, nullptr);
+    Transaction *second = txn_manager_->begin(nullptr, nullptr);
+    Transaction *third = txn_manager_->begin(nullptr, nullptr);
+    EXPECT_FALSE(write_conflicts("update t set v = 20 where id = 1;", first));
+    // 修改未提交的元组
+    EXPECT_TRUE(write_conflicts("update t set v = 30 where id = 1;", second));
+    txn_manager_->commit(first, nullptr);
+    // 修改快照之后提交的元组，删除同样冲突
+    EXPECT_TRUE(write_conflicts("delete from t where id = 1;", third));
+
+    // 中止的事务没有改变元组，快照在提交之后的事务可以修改
+    Transaction *fourth = txn_manager_->begin(nullptr, nullptr);
+    EXPECT_EQ(visible_value(fourth), 20);
+    EXPECT_FALSE(write_conflicts("update t set v = 40 where id = 1;", fourth));
+    txn_manager_->commit(fourth, nullptr);
+
+    // 回滚后元组恢复为提交的版本，其他事务可以继续修改
+    Transaction *aborted = txn_manager_->begin(nullptr, nullptr);
+    EXPECT_FALSE(write_conflicts("update t set v = 50 where id = 1;", aborted));
+    txn_manager_->abort(aborted, nullptr);
+    Transaction *fifth = txn_manager_->begin(nullptr, nullptr);
+    EXPECT_EQ(visible_value(fifth), 40);
+    EXPECT_FALSE(write_conflicts("update t set v = 60 where id = 1;", fifth));
+    txn_manager_->commit(fifth, nullptr);
+}
+
+// 页面中加入元组元信息之前创建的表文件，每页的slot数量与现在的布局不同，打开时报错而不是读坏页面
+TEST(RecordManagerTest, OldPageLayoutTest) {
+    auto disk_manager = std::make_unique<DiskManager>();
+    auto buffer_pool_manager = std::make_unique<BufferPoolManager>(TEST_BUFFER_POOL_SIZE, disk_manager.get());
+    auto rm_manager = std::make_unique<RmManager>(disk_manager.get(), buffer_pool_manager.get());
+    const std::string filename = "old_layout";
+    if (disk_manager->is_file(filename)) {
+        disk_manager->destroy_file(filename);
+    }
+    const int record_size = 8;
+    rm_manager->create_file(filename, record_size);
+    rm_manager->close_file(rm_manager->open_file(filename).get());
+
+    // 按旧的公式改写文件头：sizeof(hdr) + (n + 7) / 8 + n * record_size <= PAGE_SIZE
+    int fd = disk_manager->open_file(filename);
+    RmFileHdr hdr{};
+    disk_manager->read_page(fd, RM_FILE_HDR_PAGE, reinterpret_cast<char *>(&hdr), sizeof(hdr));
+    hdr.num_records_per_page =
+        (BITMAP_WIDTH * (PAGE_SIZE - 1 - static_cast<int>(sizeof(RmFileHdr))) + 1) / (1 + record_size * BITMAP_WIDTH);
+    hdr.bitmap_size = (hdr.num_records_per_page + BITMAP_WIDTH - 1) / BITMAP_WIDTH;
+    disk_manager->write_page(fd, RM_FILE_HDR_PAGE, reinterpret_cast<char *>(&hdr), sizeof(hdr));
+    disk_manager->close_file(fd);
+
+    EXPECT_THROW(rm_manager->open_file(filename), IncompatibleFileFormatError);
+
+    // 页面LSN为4字节时创建的文件，文件头中没有页面LSN的大小
+    rm_manager->create_file(filename + "_lsn", record_size);
+    fd = disk_manager->open_file(filename + "_lsn");
+    disk_manager->read_page(fd, RM_FILE_HDR_PAGE, reinterpret_cast<char *>(&hdr), sizeof(hdr));
+    hdr.page_lsn_size = 0;
+    disk_manager->write_page(fd, RM_FILE_HDR_PAGE, reinterpret_cast<char *>(&hdr), sizeof(hdr));
+    disk_manager->close_file(fd);
+    EXPECT_THROW(rm_manager->open_file(filename + "_lsn"), IncompatibleFileFormatError);
+    // 打开失败时文件已经关闭，可以删除
+    disk_manager->destroy_file(filename);
+    disk_manager->destroy_file(filename + "_lsn");
+}
+
+// 垃圾回收：撤销日志在仍有读者需要时保留，读者结束、水印前进后版本链被截断，写者事务从事务表中回收
+TEST_F(MvccTest, GarbageCollectionTest) {
+    Transaction *reader = txn_manager_->begin(nullptr, nullptr);
+    Transaction *writer = txn_manager_->begin(nullptr, nullptr);
+    txn_id_t writer_id = writer->get_transaction_id();
+    execute("update t set v = 20 where id = 1;", writer);
+    txn_manager_->commit(writer, nullptr);
+
+    txn_manager_->GarbageCollection();
+    EXPECT_EQ(visible_value(reader), 10);
+    EXPECT_FALSE(txn_manager_->version_info_.empty());
+    EXPECT_NE(txn_manager_->txn_table_.find(writer_id), nullptr);
+
+    // 水印停在新读者的快照上，没有前进时不遍历版本链，仍被引用的撤销日志不会被回收
+    txn_manager_->commit(reader, nullptr);
+    Transaction *second_reader = txn_manager_->begin(nullptr, nullptr);
+    Transaction *second_writer = txn_manager_->begin(nullptr, nullptr);
+    txn_id_t second_writer_id = second_writer->get_transaction_id();
+    execute("update t set v = 30 where id = 1;", second_writer);
+    txn_manager_->commit(second_writer, nullptr);
+    txn_manager_->GarbageCollection();
+    timestamp_t watermark = txn_manager_->gc_watermark_;
+    EXPECT_EQ(txn_manager_->txn_table_.find(writer_id), nullptr);
+    txn_manager_->GarbageCollection();
+    EXPECT_EQ(txn_manager_->gc_watermark_, watermark);
+    EXPECT_NE(txn_manager_->txn_table_.find(second_writer_id), nullptr);
+    EXPECT_EQ(visible_value(second_reader), 20);
+
+    // 最后一个读者结束后，整条版本链都不再需要
+    txn_manager_->commit(second_reader, nullptr);
+    txn_manager_->GarbageCollection();
+    EXPECT_GT(txn_manager_->gc_watermark_, watermark);
+    EXPECT_TRUE(txn_manager_->version_info_.empty());
+    EXPECT_EQ(txn_manager_->txn_table_.find(second_writer_id), nullptr);
+    Transaction *last_reader = txn_manager_->begin(nullptr, nullptr);
+    EXPECT_EQ(visible_value(last_reader), 30);
+    txn_manager_->commit(last_reader, nullptr);
+}
+
+/** OCC下的测试：表t(id int, v int)中有两条记录(1, 10)和(2, 20) */
+class OccTest : public SqlTest {
+   public:
+    Rid rids_[2];   // 两条记录的位置，按提交时的加锁顺序排列
+
+   public:
+    void SetUp() override {
+        SqlTest::SetUp();
+        txn_manager_->set_concurrency_mode(ConcurrencyMode::OCC);
+        execute("create table t (id int, v int);");
+        execute("insert into t values (1, 10);");
+        execute("insert into t values (2, 20);");
+        int i = 0;
+        for (RmScan scan(fh()); !scan.is_end(); scan.next()) {
+            rids_[i++] = scan.rid();
+        }
+        ASSERT_EQ(i, 2);
+    }
+
+    RmFileHandle *fh() { return sm_manager_->fhs_.at("t").get(); }
+
+    /** 满足条件where的记录数 */
+    int count(const std::string &where, Transaction *txn = nullptr) {
+        std::string result = execute("select * from t where " + where + ";", txn);
+        size_t pos = result.find("Total record(s): ");
+        EXPECT_NE(pos, std::string::npos) << result;
+        return std::stoi(result.substr(pos + strlen("Total record(s): ")));
+    }
+
+    /** 表堆中的元组数，包括未提交的插入 */
+    int num_tuples() {
+        int num = 0;
+        for (RmScan scan(fh()); !scan.is_end(); scan.next()) {
+            num++;
+        }
+        return num;
+    }
+
+    /** rid处元组的版本字 */
+    timestamp_t version(const Rid &rid) {
+        timestamp_t ts = 0;
+        fh()->read_tuple(rid, [&](const TupleMeta &meta, const char *data) { ts = meta.ts_; });
+        return ts;
+    }
+
+    /** 设置或清除rid处元组版本字上的锁标记，模拟其他事务正在提交 */
+    void set_lock_bit(const Rid &rid, bool locked) {
+        fh()->write_tuple(rid, [&](TupleMeta &meta, char *data) {
+            meta.ts_ = locked ? (meta.ts_ | OCC_LOCK_BIT) : (meta.ts_ & ~OCC_LOCK_BIT);
+            return true;
+        });
+    }
+
+    /** 提交事务txn，验证失败时回滚并返回false */
+    bool commit(Transaction *txn) {
+        try {
+            txn_manager_->commit(txn, nullptr);
+        } catch (TransactionAbortException &e) {
+            EXPECT_EQ(e.GetAbortReason(), AbortReason::VALIDATION_FAILED);
+            txn_manager_->abort(txn, nullptr);
+            return false;
+        }
+        return true;
+    }
+};
+
+// 读集合验证：读过的元组在提交前被其他事务修改时验证失败；缓冲的修改提交前对其他事务不可见
+TEST_F(OccTest, ValidationTest) {
+    Transaction *reader = txn_manager_->begin(nullptr, nullptr);
+    Transaction *writer = txn_manager_->begin(nullptr, nullptr);
+    EXPECT_EQ(count("id = 1 and v = 10", reader), 1);
+    execute("update t set v = 11 where id = 1;", writer);
+    EXPECT_EQ(count("id = 1 and v = 11", writer), 1);
+    EXPECT_EQ(count("v = 11"), 0);
+    timestamp_t old_version = version(rids_[0]);
+    EXPECT_TRUE(commit(writer));
+    EXPECT_GT(version(rids_[0]), old_version);
+    EXPECT_FALSE(commit(reader));
+
+    // 在修改提交之后读取的事务验证通过
+    Transaction *late_reader = txn_manager_->begin(nullptr, nullptr);
+    EXPECT_EQ(count("id = 1 and v = 11", late_reader), 1);
+    EXPECT_TRUE(commit(late_reader));
+
+    // 读过的元组正被其他事务锁住（提交中）时验证失败，锁是自己加的则不影响
+    Transaction *locked_reader = txn_manager_->begin(nullptr, nullptr);
+    EXPECT_EQ(count("id = 1", locked_reader), 1);
+    set_lock_bit(rids_[0], true);
+    EXPECT_FALSE(commit(locked_reader));
+    set_lock_bit(rids_[0], false);
+    Transaction *self_writer = txn_manager_->begin(nullptr, nullptr);
+    execute("update t set v = 12 where id = 1;", self_writer);
+    EXPECT_TRUE(commit(self_writer));
+    EXPECT_EQ(count("id = 1 and v = 12"), 1);
+}
+
+// 幻读检测：扫描过的表在提交前有其他事务插入时验证失败，本事务自己的插入不算
+TEST_F(OccTest, PhantomTest) {
+    uint64_t insert_version = fh()->get_insert_version();
+    Transaction *scanner = txn_manager_->begin(nullptr, nullptr);
+    EXPECT_EQ(count("v > 100", scanner), 0);
+    Transaction *inserter = txn_manager_->begin(nullptr, nullptr);
+    execute("insert into t values (3, 300);", inserter);
+    EXPECT_EQ(fh()->get_insert_version(), insert_version + 1);
+    EXPECT_TRUE(commit(inserter));
+    EXPECT_FALSE(commit(scanner));
+
+    Transaction *self_inserter = txn_manager_->begin(nullptr, nullptr);
+    EXPECT_EQ(count("v > 100", self_inserter), 1);
+    execute("insert into t values (4, 400);", self_inserter);
+    EXPECT_EQ(count("v > 100", self_inserter), 2);
+    EXPECT_TRUE(commit(self_inserter));
+    EXPECT_EQ(count("v > 100"), 2);
+}
+
+// 提交时按(fd, rid)的顺序给写集合加锁：靠后的元组被占用时，靠前的元组已经加锁并等待
+TEST_F(OccTest, LockOrderTest) {
+    Transaction *writer = txn_manager_->begin(nullptr, nullptr);
+    // 按与加锁顺序相反的顺序修改
+    execute("update t set v = 21 where id = 2;", writer);
+    execute("update t set v = 11 where id = 1;", writer);
+    set_lock_bit(rids_[1], true);
+    bool committed = false;
+    std::thread committer([&]() { committed = commit(writer); });
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!(version(rids_[0]) & OCC_LOCK_BIT) && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_TRUE(version(rids_[0]) & OCC_LOCK_BIT);
+    set_lock_bit(rids_[1], false);
+    committer.join();
+    EXPECT_TRUE(committed);
+    EXPECT_FALSE(version(rids_[0]) & OCC_LOCK_BIT);
+    EXPECT_FALSE(version(rids_[1]) & OCC_LOCK_BIT);
+    EXPECT_EQ(count("id = 1 and v = 11"), 1);
+    EXPECT_EQ(count("id = 2 and v = 21"), 1);
+}
+
+// 本事务插入的元组对其他事务不可见，之后的修改和删除直接作用于表堆
+TEST_F(OccTest, InsertThenDeleteTest) {
+    Transaction *txn = txn_manager_->begin(nullptr, nullptr);
+    execute("insert into t values (3, 30);", txn);
+    execute("update t set v = 31 where id = 3;", txn);
+    EXPECT_EQ(count("id = 3 and v = 31", txn), 1);
+    Transaction *other = txn_manager_->begin(nullptr, nullptr);
+    EXPECT_EQ(count("id = 3", other), 0);
+    EXPECT_TRUE(commit(other));
+    execute("delete from t where id = 3;", txn);
+    EXPECT_EQ(count("id = 3", txn), 0);
+    EXPECT_EQ(num_tuples(), 2);
+    EXPECT_TRUE(commit(txn));
+    EXPECT_EQ(count("id = 3"), 0);
+
+    Transaction *updater = txn_manager_->begin(nullptr, nullptr);
+    execute("insert into t values (4, 40);", updater);
+    execute("update t set v = 41 where id = 4;", updater);
+    EXPECT_TRUE(commit(updater));
+    EXPECT_EQ(count("id = 4 and v = 41"), 1);
+}
+
+// 回滚：显式中止和验证失败时丢弃缓冲的修改，删除本事务插入的元组并释放版本字上的锁
+TEST_F(OccTest, AbortTest) {
+    Transaction *txn = txn_manager_->begin(nullptr, nullptr);
+    execute("update t set v = 11 where id = 1;", txn);
+    execute("delete from t where id = 2;", txn);
+    execute("insert into t values (3, 30);", txn);
+    EXPECT_EQ(num_tuples(), 3);
+    txn_manager_->abort(txn, nullptr);
+    EXPECT_EQ(num_tuples(), 2);
+    EXPECT_EQ(count("id = 1 and v = 10"), 1);
+    EXPECT_EQ(count("id = 2 and v = 20"), 1);
+
+    Transaction *loser = txn_manager_->begin(nullptr, nullptr);
+    Transaction *winner = txn_manager_->begin(nullptr, nullptr);
+    execute("insert into t values (3, 30);", loser);
+    execute("update t set v = 21 where id = 2;", loser);
+    execute("update t set v = 12 where id = 1;", loser);
+    execute("update t set v = 13 where id = 1;", winner);
+    EXPECT_TRUE(commit(winner));
+    EXPECT_FALSE(commit(loser));
+    EXPECT_FALSE(version(rids_[0]) & OCC_LOCK_BIT);
+    EXPECT_FALSE(version(rids_[1]) & OCC_LOCK_BIT);
+    EXPECT_EQ(num_tuples(), 2);
+    EXPECT_EQ(count("id = 1 and v = 13"), 1);
+    EXPECT_EQ(count("id = 2 and v = 20"), 1);
+    // 回滚后释放的元组可以被其他事务修改
+    execute("update t set v = 22 where id = 2;");
+    EXPECT_EQ(count("id = 2 and v = 22"), 1);
+}